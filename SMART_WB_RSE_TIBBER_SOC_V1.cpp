@@ -20,19 +20,75 @@
 #include <secrets.h>
 #include <esp_task_wdt.h>
 #include <esp_system.h> 
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <atomic>
+#include <algorithm>
 #include <WiFi.h>
 #include <HTTPClient.h>
-#include <WebServer.h>
+#include "lwip/dns.h"
+#include "lwip/priv/tcpip_priv.h"   // tcpip_api_call(), wie AsyncTCP
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include <new>
 #include <ArduinoJson.h>
+#include <Preferences.h>
+#include <LittleFS.h>
 #include "driver/ledc.h"
+#include <esp_idf_version.h>
 #include <time.h>
+#include <sys/time.h>
 #include <Wire.h>
 #include <Adafruit_GFX.h>
+#ifdef USE_MQTT
+  #include <PubSubClient.h>
+#endif
+#if defined(USE_BENCHMARK) && defined(CONFIG_HEAP_TRACING_STANDALONE)
+  #include <esp_heap_trace.h>
+#endif
 #ifdef OLED_TYPE_SSD1306
   #include <Adafruit_SSD1306.h>
 #else
   #include <Adafruit_SH110X.h>
 #endif
+
+// ---------------- Metriken (/metrics) ----------------
+// Histogramm mit festen Eimergrenzen in µs für den Prometheus Export.
+// Erfasst wird ohne Sperre: die Eimer sind 32-Bit Atomics (auf dem ESP32 lock-free),
+// die Summe wird nur vom einen Task geschrieben, der das Histogramm erfasst.
+// Jedes Histogramm hat daher genau einen Schreiber, gelesen werden darf von überall.
+const uint8_t HISTOGRAMM_MAX_EIMER = 12;
+
+class Histogramm {
+public:
+  template <size_t N>
+  explicit Histogramm(const uint32_t (&grenzen)[N]) : grenzenUs(grenzen), anzahl(N) {
+    static_assert(N <= HISTOGRAMM_MAX_EIMER, "zu viele Eimer");
+  }
+
+  void erfassen(int64_t dauerUs) {
+    if (dauerUs < 0) dauerUs = 0;
+    uint8_t k = 0;
+    while (k < anzahl && dauerUs > grenzenUs[k]) k++;
+    eimer[k].fetch_add(1, std::memory_order_relaxed);  // k == anzahl: +Inf
+    summeS.store(summeS.load(std::memory_order_relaxed) + dauerUs / 1e6f, std::memory_order_relaxed);
+  }
+
+  const uint32_t* grenzenUs;
+  const uint8_t anzahl;
+  std::atomic<uint32_t> eimer[HISTOGRAMM_MAX_EIMER + 1] = {};
+  std::atomic<float> summeS{0.0f};
+};
+
+// Eimergrenzen in µs
+const uint32_t EIMER_MS[]     = {1000, 2000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000};
+const uint32_t EIMER_FLUSH[]  = {250, 500, 1000, 2000, 3000, 5000, 10000, 20000, 50000};
+const uint32_t EIMER_WDT[]    = {500000, 900000, 1000000, 1100000, 1500000, 2000000, 3000000, 5000000, 8000000, 10000000};
+
+Histogramm metrikLoop(EIMER_MS);          // ein Durchlauf von loop() ohne Schlafen
+Histogramm metrikWebSchritt(EIMER_MS);    // ein Schritt einer Web Antwort im async_tcp Task
+Histogramm metrikFlush(EIMER_FLUSH);      // I2C Übertragung der geänderten OLED Seiten im Flush-Task
+Histogramm metrikWdtAbstand(EIMER_WDT);   // Abstand zwischen zwei esp_task_wdt_reset()
 // ---------------------------------------------------
 // ------------- LED Betriebsarten BEGIN -------------
 // ---------------------------------------------------
@@ -49,26 +105,26 @@ struct LedController {
   ledc_channel_t channel;
   ledc_timer_t timer;
 
-  LedMode mode = LEDMODE_OFF;
+  volatile LedMode mode = LEDMODE_OFF;
   int maxBrightness = 255;  // 0..255
 
-  // Fade
+  // Fade: eine Rampe von 0 bis maxBrightness dauert maxBrightness/fadeStep * fadeDelay ms
   int fadeStep = 5;
   int fadeDelay = 30;
-  int brightness = 0;
-  int direction = 1;
-  unsigned long lastFadeUpdate = 0;
+  bool fadeAufwaerts = true;
+  int64_t fadeEndeUs = 0;  // esp_timer_get_time(), bis zu dem die laufende Rampe dauert
 
   // Blink
   int blinkInterval = 250;
   bool blinkState = false;
-  unsigned long lastBlinkUpdate = 0;
 
   // Flash
   int flashOn = 100;
   int flashOff = 3000;
   bool flashState = false;
-  unsigned long lastFlashUpdate = 0;
+
+  // Die Muster laufen im LEDC Fade-Modul und über einen esp_timer, nicht mehr in loop()
+  esp_timer_handle_t zeitgeber = NULL;
 
   void begin(int _pin, ledc_channel_t _channel, ledc_timer_t _timer,
              uint32_t freq = 5000, ledc_timer_bit_t resolution = LEDC_TIMER_8_BIT) {
@@ -98,19 +154,61 @@ struct LedController {
     };
     ledc_channel_config(&ledc_channel);
 
+    // Fade-Modul einmalig für alle Kanäle installieren
+    static bool fadeInstalliert = false;
+    if (!fadeInstalliert) {
+      ledc_fade_func_install(0);
+      fadeInstalliert = true;
+    }
+
+    // Zeitgeber für die Musterwechsel
+    esp_timer_create_args_t zeitgeberArgs = {};
+    zeitgeberArgs.callback = &LedController::zeitgeberCallback;
+    zeitgeberArgs.arg      = this;
+    zeitgeberArgs.name     = "led";
+    esp_timer_create(&zeitgeberArgs, &zeitgeber);
+
     // Startzustand
     setDuty(0);
     mode = LEDMODE_OFF;
   }
 
-  void setMode(LedMode m) { mode = m; }
+  // Schreibt nur bei einem Wechsel der Betriebsart, der Rest läuft im Hintergrund
+  void setMode(LedMode m) {
+    if (m == mode) {
+      return;
+    }
+    mode = m;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    ledc_fade_stop(LEDC_HIGH_SPEED_MODE, channel);  // laufende Rampe sofort beenden
+#endif
+    // Umschalten im esp_timer Task. Läuft dort gerade ein Schritt, der den Timer neu startet, nochmal versuchen.
+    esp_timer_stop(zeitgeber);
+    if (esp_timer_start_once(zeitgeber, 0) != ESP_OK) {
+      esp_timer_stop(zeitgeber);
+      esp_timer_start_once(zeitgeber, 0);
+    }
+  }
 
   void setDuty(int duty) {
-    ledc_set_duty(LEDC_HIGH_SPEED_MODE, channel, duty);
-    ledc_update_duty(LEDC_HIGH_SPEED_MODE, channel);
+    ledc_set_duty_and_update(LEDC_HIGH_SPEED_MODE, channel, duty, 0);
+  }
+
+  static void zeitgeberCallback(void* arg) {
+    static_cast<LedController*>(arg)->schritt();
   }
 
-  void update(unsigned long now) {
+  // Ein Musterschritt, läuft im esp_timer Task und plant den nächsten Schritt selbst ein
+  void schritt() {
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+    // Ohne ledc_fade_stop() wartet ledc_set_duty_and_update() bis zum Ende einer laufenden
+    // Rampe und blockiert damit den esp_timer Task. Stattdessen zum Rampenende wiederkommen.
+    int64_t restUs = fadeEndeUs - esp_timer_get_time();
+    if (mode != LEDMODE_FADE && restUs > 0) {
+      esp_timer_start_once(zeitgeber, (uint64_t)restUs);
+      return;
+    }
+#endif
     switch (mode) {
       case LEDMODE_OFF:
         setDuty(0);
@@ -120,43 +218,26 @@ struct LedController {
         setDuty(maxBrightness);
         break;
 
-      case LEDMODE_FADE:
-        if (now - lastFadeUpdate >= (unsigned long)fadeDelay) {
-          lastFadeUpdate = now;
-          brightness += direction * fadeStep;
-          if (brightness >= maxBrightness) {
-            brightness = maxBrightness;
-            direction = -1;
-          } else if (brightness <= 0) {
-            brightness = 0;
-            direction = 1;
-          }
-          setDuty(brightness);
-        }
+      case LEDMODE_FADE: {
+        // Die Rampe selbst erzeugt die LEDC Hardware, wir drehen nur am Ende die Richtung um
+        uint32_t dauerMs = (uint32_t)(maxBrightness / fadeStep) * fadeDelay;
+        ledc_set_fade_time_and_start(LEDC_HIGH_SPEED_MODE, channel, fadeAufwaerts ? maxBrightness : 0, dauerMs, LEDC_FADE_NO_WAIT);
+        fadeEndeUs = esp_timer_get_time() + (int64_t)(dauerMs + 1) * 1000;
+        fadeAufwaerts = !fadeAufwaerts;
+        esp_timer_start_once(zeitgeber, (uint64_t)dauerMs * 1000);
         break;
+      }
 
       case LEDMODE_BLINK:
-        if (now - lastBlinkUpdate >= (unsigned long)blinkInterval) {
-          lastBlinkUpdate = now;
-          blinkState = !blinkState;
-          setDuty(blinkState ? maxBrightness : 0);
-        }
+        blinkState = !blinkState;
+        setDuty(blinkState ? maxBrightness : 0);
+        esp_timer_start_once(zeitgeber, (uint64_t)blinkInterval * 1000);
         break;
 
       case LEDMODE_FLASH:
-        if (flashState) {
-          if (now - lastFlashUpdate >= (unsigned long)flashOn) {
-            lastFlashUpdate = now;
-            flashState = false;
-            setDuty(0);
-          }
-        } else {
-          if (now - lastFlashUpdate >= (unsigned long)flashOff) {
-            lastFlashUpdate = now;
-            flashState = true;
-            setDuty(maxBrightness);
-          }
-        }
+        flashState = !flashState;
+        setDuty(flashState ? maxBrightness : 0);
+        esp_timer_start_once(zeitgeber, (uint64_t)(flashState ? flashOn : flashOff) * 1000);
         break;
     }
   }
@@ -184,11 +265,214 @@ LedController led1, led2, led3;
 
 // Declaration for an SH1106/SSD1306 display connected to I2C (SDA, SCL pins)
 #define OLED_RESET     -1 // Reset pin # (wird oft nicht benutzt)
+#define OLED_ADRESSE 0x3C // 0x3C ist oft die Standardadresse
+#define OLED_I2C_TAKT 400000 // Hz
+#define OLED_I2C_BLOCK 64    // Datenbytes pro I2C Transfer (Wire Puffer hat 128 Bytes)
+#define OLED_SEITEN (SCREEN_HEIGHT / 8)
+
+#define OLED_FLUSH_CORE 0    // loop() läuft auf Core 1
+#define OLED_FLUSH_PRIO 1    // niedrig, der Aktor-Task hat Vorrang
+#define OLED_FLUSH_STACK 3072
+
+/*****************************************************************
+* @brief Display mit Änderungsverfolgung je 8-Pixel-Seite.
+*        Alle Zeichenfunktionen (Text, Rechtecke, Linien) landen in
+*        drawPixel/drawFastHLine/drawFastVLine/fillRect, dort wird der
+*        veränderte Spaltenbereich je Seite gemerkt. display() überträgt
+*        dann nur diese Bytes per I2C und nichts, wenn sich nichts geändert hat.
+*        Doppelpuffer: gezeichnet wird in den Puffer der Bibliothek,
+*        display() kopiert nur die geänderten Bytes in den Sendepuffer und
+*        weckt den Flush-Task auf dem anderen Core, der sie per I2C
+*        überträgt. loop() wartet damit nie auf den I2C Bus.
+******************************************************************/
+template <class OledBasis>
+class OledSeitenDisplay : public OledBasis {
+public:
+  template <typename... Args>
+  OledSeitenDisplay(Args... args) : OledBasis(args...) {
+    allesMarkieren();
+    // Der Displayinhalt ist nach dem Einschalten unbekannt: die erste Übertragung des Flush-Tasks schickt alles
+    for (uint8_t seite = 0; seite < OLED_SEITEN; seite++) {
+      offenVon[seite] = 0;
+      offenBis[seite] = SCREEN_WIDTH - 1;
+    }
+  }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    markieren(x, y, 1, 1);
+    OledBasis::drawPixel(x, y, color);
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    markieren(x, y, w, 1);
+    OledBasis::drawFastHLine(x, y, w, color);
+  }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+    markieren(x, y, 1, h);
+    OledBasis::drawFastVLine(x, y, h, color);
+  }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    markieren(x, y, w, h);
+    OledBasis::fillRect(x, y, w, h, color);
+  }
+  void clearDisplay() {
+    OledBasis::clearDisplay();
+    allesMarkieren();
+  }
+
+  // Übergibt die geänderten Spaltenbereiche jeder Seite an den Flush-Task.
+  // Solange der Task noch nicht läuft (setup), wird direkt übertragen.
+  void display() {
+    uint8_t* zeichenPuffer = this->getBuffer();
+
+    if (flushTask == NULL) {
+      for (uint8_t seite = 0; seite < OLED_SEITEN; seite++) {
+        if (spalteBis[seite] >= spalteVon[seite]) {
+          uint16_t start = seite * SCREEN_WIDTH + spalteVon[seite];
+          uint16_t anzahl = spalteBis[seite] - spalteVon[seite] + 1;
+          memcpy(sendePuffer + start, zeichenPuffer + start, anzahl);
+          seiteSenden(seite, spalteVon[seite], spalteBis[seite], zeichenPuffer + start);
+          spalteVon[seite] = SCREEN_WIDTH;
+          spalteBis[seite] = -1;
+        }
+      }
+      return;
+    }
+
+    bool neu = false;
+    portENTER_CRITICAL(&pufferMux);
+    for (uint8_t seite = 0; seite < OLED_SEITEN; seite++) {
+      int16_t von = spalteVon[seite];
+      int16_t bis = spalteBis[seite];
+      spalteVon[seite] = SCREEN_WIDTH;
+      spalteBis[seite] = -1;
+
+      // Auf die Bytes eingrenzen, die sich gegenüber dem Sendepuffer wirklich geändert haben
+      const uint8_t* z = zeichenPuffer + seite * SCREEN_WIDTH;
+      uint8_t* sp = sendePuffer + seite * SCREEN_WIDTH;
+      while (von <= bis && z[von] == sp[von]) von++;
+      while (bis >= von && z[bis] == sp[bis]) bis--;
+      if (von > bis) continue;
+
+      memcpy(sp + von, z + von, bis - von + 1);
+      if (von < offenVon[seite]) offenVon[seite] = von;
+      if (bis > offenBis[seite]) offenBis[seite] = bis;
+      neu = true;
+    }
+    portEXIT_CRITICAL(&pufferMux);
+
+    if (neu) {
+      xTaskNotifyGive(flushTask);
+    }
+  }
+
+  // Startet den Flush-Task, ab dann gehört der I2C Bus nur noch ihm
+  void flushTaskStarten() {
+    xTaskCreatePinnedToCore(flushTaskFunktion, "oled", OLED_FLUSH_STACK, this, OLED_FLUSH_PRIO, &flushTask, OLED_FLUSH_CORE);
+  }
+
+  uint32_t i2cBytes = 0;  // seit Start per I2C übertragene Bytes (inkl. Adresse und Steuerbytes)
+
+private:
+  int16_t spalteVon[OLED_SEITEN];   // geändert im Zeichenpuffer, noch nicht übergeben
+  int16_t spalteBis[OLED_SEITEN];
+  int16_t offenVon[OLED_SEITEN];    // übergeben im Sendepuffer, noch nicht übertragen
+  int16_t offenBis[OLED_SEITEN];
+  uint8_t sendePuffer[SCREEN_WIDTH * OLED_SEITEN];
+  portMUX_TYPE pufferMux = portMUX_INITIALIZER_UNLOCKED;
+  TaskHandle_t flushTask = NULL;
+
+  static void flushTaskFunktion(void* parameter) {
+    static_cast<OledSeitenDisplay*>(parameter)->flushSchleife();
+  }
+
+  void flushSchleife() {
+    uint8_t seitenDaten[SCREEN_WIDTH];
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      int64_t startUs = esp_timer_get_time();
+      bool gesendet = false;
+      for (uint8_t seite = 0; seite < OLED_SEITEN; seite++) {
+        portENTER_CRITICAL(&pufferMux);
+        int16_t von = offenVon[seite];
+        int16_t bis = offenBis[seite];
+        if (bis >= von) {
+          memcpy(seitenDaten, sendePuffer + seite * SCREEN_WIDTH + von, bis - von + 1);
+          offenVon[seite] = SCREEN_WIDTH;
+          offenBis[seite] = -1;
+        }
+        portEXIT_CRITICAL(&pufferMux);
+
+        if (bis >= von) {
+          seiteSenden(seite, von, bis, seitenDaten);
+          gesendet = true;
+        }
+      }
+      if (gesendet) {
+        metrikFlush.erfassen(esp_timer_get_time() - startUs);
+      }
+    }
+  }
+
+  void allesMarkieren() {
+    for (uint8_t seite = 0; seite < OLED_SEITEN; seite++) {
+      spalteVon[seite] = 0;
+      spalteBis[seite] = SCREEN_WIDTH - 1;
+    }
+  }
+
+  void markieren(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (w <= 0 || h <= 0) return;
+    int16_t x1 = max<int16_t>(x, 0);
+    int16_t x2 = min<int16_t>(x + w - 1, SCREEN_WIDTH - 1);
+    int16_t y1 = max<int16_t>(y, 0);
+    int16_t y2 = min<int16_t>(y + h - 1, SCREEN_HEIGHT - 1);
+    if (x1 > x2 || y1 > y2) return;
+    for (int16_t seite = y1 / 8; seite <= y2 / 8; seite++) {
+      if (x1 < spalteVon[seite]) spalteVon[seite] = x1;
+      if (x2 > spalteBis[seite]) spalteBis[seite] = x2;
+    }
+  }
+
+  void seiteSenden(uint8_t seite, int16_t von, int16_t bis, const uint8_t* daten) {
+    int16_t anzahl = bis - von + 1;
+
+    // Adressierung: Seite und Startspalte setzen
+    Wire.beginTransmission(OLED_ADRESSE);
+    Wire.write(0x00);                     // Steuerbyte: es folgen Befehle
+    #ifdef OLED_TYPE_SSD1306
+    Wire.write(0x22); Wire.write(seite); Wire.write(seite);              // Page Address (horizontaler Modus)
+    Wire.write(0x21); Wire.write((uint8_t)von); Wire.write((uint8_t)bis); // Column Address
+    i2cBytes += 8;
+    #else
+    uint8_t spalte = von + 2;             // SH1106 hat 132 Spalten, das Bild beginnt bei Spalte 2
+    Wire.write(0xB0 | seite);             // Page Address
+    Wire.write(0x10 | (spalte >> 4));     // Column High
+    Wire.write(spalte & 0x0F);            // Column Low
+    i2cBytes += 5;
+    #endif
+    Wire.endTransmission();
+
+    // Daten in Blöcken übertragen
+    while (anzahl > 0) {
+      int16_t block = min<int16_t>(anzahl, OLED_I2C_BLOCK);
+      Wire.beginTransmission(OLED_ADRESSE);
+      Wire.write(0x40);                   // Steuerbyte: es folgen Daten
+      Wire.write(daten, block);
+      Wire.endTransmission();
+      i2cBytes += block + 2;
+      daten += block;
+      anzahl -= block;
+    }
+  }
+};
+
 #ifdef OLED_TYPE_SSD1306
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+OledSeitenDisplay<Adafruit_SSD1306> display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 #else 
-Adafruit_SH1106G display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+OledSeitenDisplay<Adafruit_SH1106G> display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 #endif
+uint32_t oledI2CBytesProSek = 0;   // per I2C übertragene Bytes in der letzten Sekunde
+uint32_t oledI2CBytesZuletzt = 0;
 
 // WLAN Zugangsdaten (bitte anpassen)
 // aus secrets.h
@@ -199,354 +483,3878 @@ const char* password = WIFI_PASSWORD;
 const char* evSocUrl = EV_SOC_URL;
 #endif
 
-// IP-Adresse und URLs für lokale Requests
-const char* urlOn    = URL_ON;
-const char* urlOff   = URL_OFF;
-const char* urlParam = URL_PARAM;
+// IP-Adressen und URLs für lokale Requests, je Wallbox eine Zeile (siehe WALLBOXEN in config.h)
+struct WallboxKonfig {
+  const char* name;
+  const char* urlOn;     // Shelly EIN
+  const char* urlOff;    // Shelly AUS
+  const char* urlParam;  // SmartWB getParameters
+};
+const WallboxKonfig WALLBOX_KONFIG[] = { WALLBOXEN };
+const int WALLBOX_ANZAHL = sizeof(WALLBOX_KONFIG) / sizeof(WALLBOX_KONFIG[0]);
 
 // Blinker-Variablen
-unsigned long letzteUmschaltung = 0;
-unsigned long aktuelleUmschaltung = 0;
 bool rotStatus = false;
 const unsigned long BLINK_INTERVAL = 250; //ms
 
 // Uhrzeit-Anzeige Variable
-unsigned long letzteUhrAnzeige = 0;
-unsigned long aktuelleUhrAnzeige = 0;
 const unsigned long UHR_ANZEIGE_INTERVAL = 1000; //ms
 int currentProgress = 0; // für Fortschrittsbalken
 
 // SMartWB-Anzeige Variable
-unsigned long letzteSmartWBAnzeige = 0;
-unsigned long aktuelleSmartWBAnzeige = 0;
-const unsigned long SMARTWB_ANZEIGE_INTERVAL = 10000; //ms
-unsigned long letzteUIAnzeige = 0;
-unsigned long aktuelleUIAnzeige = 0;
+const unsigned long SMARTWB_ANZEIGE_INTERVAL = 10000; //ms, Grundtakt (Fahrzeug angesteckt, lädt nicht) und Takt der U/I Anzeige
+unsigned long smartWBIntervall = SMARTWB_ANZEIGE_INTERVAL;  // aktuelles Abfrageintervall, siehe smartWBIntervallBerechnen()
+unsigned long rseFensterStart  = 0;                         // millis() der letzten RSE Flanke
+bool rseFensterAktiv = false;                               // nach einer RSE Flanke wird ABFRAGE_RSE_FENSTER_S lang schnell abgefragt
 
 #ifdef USE_EV_SOC_API
 // EV SoC Anzeige Variablen
-unsigned long letzteSocAnzeige = 0;
-unsigned long aktuelleSocAnzeige = 0;
 const unsigned long SOC_ANZEIGE_INTERVAL = 120000; //ms -> alle 2min
+const unsigned long SOC_WIEDERHOLUNG_MS  = 5000;   // nach einer verschobenen Abfrage
+const int SOC_VERSCHOBEN = -2;                     // getSoc(): Zeitbudget zu knapp, nicht gefragt
 int soc = -1;
+bool socFahrzeugVorher = false;  // war bei der letzten Abfrage ein Fahrzeug angesteckt
 #endif
 
-//SmartWB Parameter die wir anzeigen möchten
-int  vehicleState = 1;
-bool    evseState = false;
-int    maxCurrent = 16;
-int actualCurrent = 6;
-float actualPower = 0.0;
-float   currentP1 = 0.0;
-float   currentP2 = 0.0;
-float   currentP3 = 0.0;
-float   voltageP1 = 0.0;
-float   voltageP2 = 0.0;
-float   voltageP3 = 0.0;
+//SmartWB Parameter die wir anzeigen möchten, je Wallbox
+struct WallboxWerte {
+  int   httpCode      = -1;   // Ergebnis der letzten SmartWB Abfrage, <0 = OFFLINE
+  int   vehicleState  = 1;
+  bool  evseState     = false;
+  int   maxCurrent    = 16;
+  int   actualCurrent = 6;
+  float actualPower   = 0.0;
+  float currentP1     = 0.0;
+  float currentP2     = 0.0;
+  float currentP3     = 0.0;
+  float voltageP1     = 0.0;
+  float voltageP2     = 0.0;
+  float voltageP3     = 0.0;
+};
+int wallboxAnzeige = 0;  // Wallbox, die gerade auf dem OLED steht
 
 
 // Zustandsvariablen
-volatile bool RSEAktiv = (digitalRead(RSE) == LOW);
-bool letzterRSEStatus        = !RSEAktiv;  // für Flankenerkennung
+volatile bool RSEAktiv = false;            // entprellter RSE Zustand, wird in setup() und vom aktorTask gesetzt
 bool letzterRSEStatusSmartWB = !RSEAktiv;  //damit das Auslesen der SmartWBParameters beim RSE Flankenwechsel erzwungen wird.
 int i = 1;                                 //allgemeiner Zähler um die 3 Spannungen und Ströme nacheinander anzeigen
 
-// WebServer auf Port 80
-WebServer server(80);
-          
+// RSE Flanken mit Zeitstempel: lock-freier Ringpuffer, genau ein Schreiber (isrRSE bzw. die RSE Simulation)
+// und ein Leser (aktorTask)
+struct RseEreignis {
+  int64_t zeitUs;  // esp_timer_get_time() bei der Flanke
+  bool    aktiv;   // Pegel nach der Flanke, true = RSE aktiv (LOW)
+};
+const uint32_t RSE_PUFFER_GROESSE = 64;            // muss eine Zweierpotenz sein
+RseEreignis rsePuffer[RSE_PUFFER_GROESSE];
+std::atomic<uint32_t> rseKopf(0);                  // wird nur in rseFlankeAblegen() geschrieben
+std::atomic<uint32_t> rseSchwanz(0);               // wird nur vom Aktor-Task geschrieben
+volatile uint32_t rseFlankenRoh     = 0;           // alle von der ISR erfassten Flanken
+volatile uint32_t rseUeberlauf      = 0;           // Flanken, die wegen vollem Puffer verloren gingen
+volatile uint32_t rseStoerimpulse   = 0;           // Impulse kürzer als RSE_ENTPRELL_MS, vom Filter verworfen
+const int64_t     RSE_ENTPRELL_US   = (int64_t)RSE_ENTPRELL_MS * 1000;
 
-/********************* Allgemeine Funktionen ********************/
+// Aktor-Task (Shelly Schaltung), wird direkt aus der ISR geweckt
+TaskHandle_t aktorTaskHandle = NULL;
+TaskHandle_t hauptTaskHandle = NULL;               // loop() Task, wird nach einer RSE Flanke und nach SmartWB Abfragen geweckt
+volatile int64_t aktorLatenzUs    = -1;            // letzte gemessene Zeit RSE Flanke -> HTTP Antwort der Shelly in µs
+volatile int64_t aktorLatenzMaxUs = 0;             // größte gemessene Zeit seit Neustart in µs
+volatile int     aktorHttpCode    = 0;             // letzte HTTP Antwort der Shelly
+// Core 0 gehört WiFi (Prio 23), lwIP (18), async_tcp, Webserver, OLED, Log und den SmartWB Abfragen.
+// Der Aktor-Task läuft deshalb auf Core 1, dort ist nur loop() (Prio 1), das er sofort verdrängt.
+// Seine Priorität bleibt unter lwIP und WiFi: die Shelly Anfrage braucht beide auf Core 0.
+const UBaseType_t AKTOR_TASK_PRIO   = 10;
+const BaseType_t  AKTOR_TASK_CORE   = 1;
+const uint32_t    AKTOR_TASK_STACK  = 8192;
+
+int64_t wdtResetUs = 0;                            // letzter esp_task_wdt_reset() von loop(), 0 = noch nicht überwacht
 
 /*****************************************************************
-* @brief Interrupt-Service-Routine (ISR) für RSE
-* @param -
+* @brief Zeitbudget für eine ausgehende Anfrage. Nur loop() wird vom
+*        Watchdog überwacht, dort bekommt die Anfrage höchstens den
+*        Rest bis zum Watchdog abzüglich WDT_RESERVE_MS.
+* @param maxMs Budget, wenn der Watchdog nicht drängt
+* @return Budget in ms, 0 wenn nichts mehr übrig ist
 ******************************************************************/
-void IRAM_ATTR isrRSE() {
-  RSEAktiv = (digitalRead(RSE) == LOW);
+uint32_t ioBudgetMs(uint32_t maxMs) {
+  if (wdtResetUs == 0 || xTaskGetCurrentTaskHandle() != hauptTaskHandle) {
+    return maxMs;
+  }
+  int64_t restMs = WDT_TIMEOUT_SECONDS * 1000LL - WDT_RESERVE_MS - (esp_timer_get_time() - wdtResetUs) / 1000;
+  return (uint32_t)constrain(restMs, 0LL, (int64_t)maxMs);
 }
 
+// AsyncWebServer auf Port 80: Anfragen laufen im async_tcp Task, mehrere Verbindungen gleichzeitig.
+// Der webTask prüft nur noch die Werte für /events. AsyncEventSource::send() wird aus dem webTask
+// aufgerufen, das braucht ESPAsyncWebServer ab 3.0 von ESP32Async (vorher mathieucarbou): dort
+// sperren Client-Liste und Nachrichtenpuffer gegen den async_tcp Task. Das Original von me-no-dev
+// hat diese Sperre nicht und ändert die Liste beim Trennen, während send() darüber läuft.
+#if !defined(ASYNCWEBSERVER_VERSION_MAJOR) || ASYNCWEBSERVER_VERSION_MAJOR < 3
+  #error "ESPAsyncWebServer >= 3.0 von ESP32Async nötig (events.send() aus dem webTask), siehe README"
+#endif
+AsyncWebServer server(80);
+AsyncEventSource events("/events");
+TaskHandle_t webTaskHandle = NULL;
+const UBaseType_t WEB_TASK_PRIO         = 1;
+const BaseType_t  WEB_TASK_CORE         = 0;   // loop() läuft auf Core 1
+const uint32_t    WEB_TASK_STACK        = 4096;  // Nachrichtenpuffer liegen statisch, nicht auf dem Stack
+          
+
+/********************* Allgemeine Funktionen ********************/
+
 /*****************************************************************
-* @brief Zeitstempel für Serial- und Display Ausgabe
-* @param buffer wird zurückgegben,: sollte die aktuelle Zeit oder "Keine Zeit" sein
+* @brief Legt eine Flanke im Ringpuffer ab. Aufrufer ist der einzige
+*        Schreiber: isrRSE() oder, solange die Simulation läuft und
+*        der Interrupt abgehängt ist, deren Zeitgeber.
+* @param aktiv Pegel nach der Flanke, true = RSE aktiv
 ******************************************************************/
-String getZeitstempel() {
-  struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) {
-    return "[Keine Zeit]";
+void IRAM_ATTR rseFlankeAblegen(bool aktiv) {
+  uint32_t kopf = rseKopf.load(std::memory_order_relaxed);
+  if (kopf - rseSchwanz.load(std::memory_order_acquire) < RSE_PUFFER_GROESSE) {
+    rsePuffer[kopf & (RSE_PUFFER_GROESSE - 1)].zeitUs = esp_timer_get_time();
+    rsePuffer[kopf & (RSE_PUFFER_GROESSE - 1)].aktiv  = aktiv;
+    rseKopf.store(kopf + 1, std::memory_order_release);
+  } else {
+    rseUeberlauf++;
   }
-  char buffer[30];
-  strftime(buffer, sizeof(buffer), "[%Y-%m-%d %H:%M:%S]", &timeinfo);
-  return String(buffer);
+  rseFlankenRoh++;
 }
 
 /*****************************************************************
-* @brief SmartWB JSON auslesen & Werte zuweisen
-* @param httpCode wird zurückgegeben
+* @brief Interrupt-Service-Routine (ISR) für RSE
+* @param -
 ******************************************************************/
-void getSmartWBParameters(int& httpCode) {
-  if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    http.begin(urlParam);
-    httpCode = http.GET();
+void IRAM_ATTR isrRSE() {
+  // Jede Flanke mit Zeitstempel ablegen, die Entprellung übernimmt der Aktor-Task
+  rseFlankeAblegen(digitalRead(RSE) == LOW);
 
-    if (httpCode == HTTP_CODE_OK) {
-      String payload = http.getString();
+  // Aktor-Task direkt wecken, damit die Shelly nicht auf loop() warten muss
+  BaseType_t hoeherePrioGeweckt = pdFALSE;
+  if (aktorTaskHandle != NULL) {
+    vTaskNotifyGiveFromISR(aktorTaskHandle, &hoeherePrioGeweckt);
+  }
+  if (hoeherePrioGeweckt) {
+    portYIELD_FROM_ISR();
+  }
+}
 
-      StaticJsonDocument<1024> doc;
-      DeserializationError error = deserializeJson(doc, payload);
+// Zeitstempel-Dienst: formatiert höchstens einmal pro Sekunde in statische Puffer,
+// ohne Heap und ohne auf NTP zu warten (getLocalTime() wartet bis zu 5s)
+const time_t ZEIT_GUELTIG_AB = 1609459200;       // 01.01.2021, davor ist die Uhr noch nicht per NTP gestellt
+const size_t ZEITSTEMPEL_LAENGE = 24;            // "[2025-01-31 12:34:56]"
+const size_t ZEITSTEMPEL_MS_LAENGE = 32;         // "[2025-01-31 12:34:56.789]"
+const uint8_t ZEITSTEMPEL_MS_PUFFER = 4;         // so viele ms-Zeitstempel dürfen gleichzeitig in Benutzung sein
+char zeitstempelPuffer[2][ZEITSTEMPEL_LAENGE];   // abwechselnd beschrieben, der andere bleibt gültig
+uint8_t zeitstempelAktiv = 0;
+time_t zeitstempelSekunde = 0;
+char zeitstempelMsPuffer[ZEITSTEMPEL_MS_PUFFER][ZEITSTEMPEL_MS_LAENGE];
+std::atomic<uint8_t> zeitstempelMsIndex(0);
+portMUX_TYPE zeitstempelMux = portMUX_INITIALIZER_UNLOCKED;
 
-      if (!error) {
-        JsonObject obj = doc["list"][0];
-        
-        vehicleState  = obj["vehicleState"];
-        evseState     = obj["evseState"];
-        maxCurrent    = obj["maxCurrent"];
-        actualCurrent = obj["actualCurrent"];
-        actualPower   = obj["actualPower"];
-        currentP1     = obj["currentP1"];
-        currentP2     = obj["currentP2"];
-        currentP3     = obj["currentP3"];
-        voltageP1     = obj["voltageP1"];
-        voltageP2     = obj["voltageP2"];
-        voltageP3     = obj["voltageP3"];
+/*****************************************************************
+* @brief Liefert den formatierten Zeitstempel einer Sekunde, formatiert
+*        wird nur beim Sekundenwechsel
+* @param sekunde Unix-Zeit
+* @return "[JJJJ-MM-TT hh:mm:ss]" oder "[Keine Zeit]", gültig bis zur nächsten Sekunde
+******************************************************************/
+const char* zeitstempelFuerSekunde(time_t sekunde) {
+  if (sekunde < ZEIT_GUELTIG_AB) {
+    return "[Keine Zeit]";
+  }
 
-        // Ausgabe
-        Serial.println(getZeitstempel());
-        Serial.println("------ Parameter aktualisiert ------");
-        Serial.print("maxCurrent: ");
-        Serial.println(maxCurrent);
-        Serial.print("actualCurrent: ");
-        Serial.println(actualCurrent);
-        Serial.print("actualPower: ");
-        Serial.println(actualPower);
-        Serial.println("-----------------------------------");
-      } else {
-        Serial.print(getZeitstempel());
-        Serial.print(" JSON Fehler: ");
-        Serial.println(error.c_str());
-      }
+  portENTER_CRITICAL(&zeitstempelMux);
+  bool aktuell = (sekunde == zeitstempelSekunde);
+  uint8_t aktiv = zeitstempelAktiv;
+  portEXIT_CRITICAL(&zeitstempelMux);
+  if (aktuell) {
+    return zeitstempelPuffer[aktiv];
+  }
 
-    } else {
-      Serial.print(getZeitstempel());
-      Serial.print(" HTTP Fehler: ");
-      Serial.println(httpCode);
-    }
+  // Außerhalb der Sperre formatieren, dann in den freien Puffer kopieren und umschalten
+  struct tm timeinfo;
+  char neu[ZEITSTEMPEL_LAENGE];
+  localtime_r(&sekunde, &timeinfo);
+  strftime(neu, sizeof(neu), "[%Y-%m-%d %H:%M:%S]", &timeinfo);
 
-    http.end();
-  } else {
-    Serial.print(getZeitstempel());
-    Serial.println(" WLAN nicht verbunden!");
+  portENTER_CRITICAL(&zeitstempelMux);
+  if (sekunde > zeitstempelSekunde) {
+    zeitstempelAktiv ^= 1;
+    memcpy(zeitstempelPuffer[zeitstempelAktiv], neu, sizeof(neu));
+    zeitstempelSekunde = sekunde;
   }
+  aktiv = zeitstempelAktiv;
+  portEXIT_CRITICAL(&zeitstempelMux);
+  return zeitstempelPuffer[aktiv];
 }
 
 /*****************************************************************
-* @brief Zeichnet einen Fortschrittsbalken auf dem OLED-Display.
-* @param progress Der aktuelle Fortschritt in Prozent (0-100).
+* @brief Zeitstempel für Serial- und Display Ausgabe
+* @return "[JJJJ-MM-TT hh:mm:ss]" oder "[Keine Zeit]", gültig bis zur nächsten Sekunde
 ******************************************************************/
-void drawProgressBar(int progress) {
-  // Stellen Sie sicher, dass der Wert im Bereich 0-100 liegt
-  progress = constrain(progress, 0, 100);
-
-  // Lösche den Bereich des Fortschrittsbalkens, um ihn neu zu zeichnen
-  // Zeile 3 liegt bei 24 Pixeln, da jede Textzeile (Größe 1) 8 Pixel hoch ist.
-  // Zeile 1: Y=0, Zeile 2: Y=8, Zeile 3: Y=16, Zeile 4: Y=24, etc.
-  #ifdef OLED_TYPE_SSD1306
-  display.fillRect(0, 16, SCREEN_WIDTH, 8, SSD1306_BLACK);
-  #else 
-  display.fillRect(0, 16, SCREEN_WIDTH, 8, SH110X_BLACK);
-  #endif
-  // Berechne die Breite des gefüllten Balkens
-  // Da der Balken über die gesamte Breite des Displays (128 Pixel) gehen soll.
-  int filledWidth = map(progress, 0, 100, 0, SCREEN_WIDTH - 2); 
-
-  // Zeichne den leeren Rahmen des Fortschrittsbalkens
-  #ifdef OLED_TYPE_SSD1306
-  display.drawRect(0, 16, SCREEN_WIDTH - 1, 8, SSD1306_WHITE);
-  #else 
-  display.drawRect(0, 16, SCREEN_WIDTH - 1, 8, SH110X_WHITE);
-  #endif
-
-  // Zeichne den gefüllten Teil des Fortschrittsbalkens
-  #ifdef OLED_TYPE_SSD1306
-  display.fillRect(1, 17, filledWidth, 6, SSD1306_WHITE);
-  #else 
-  display.fillRect(1, 17, filledWidth, 6, SH110X_WHITE);
-  #endif
+const char* getZeitstempel() {
+  return zeitstempelFuerSekunde(time(NULL));
+}
 
-  // Schreibe den Prozentwert in die Mitte des Balkens
-  String progressText = String(progress) + "%";
-  int textWidth = progressText.length() * 6; // Jedes Zeichen ist 6 Pixel breit
-  int textX = (SCREEN_WIDTH - textWidth) / 2;
-  int textY = 16 + 1; // 1 Pixel Abstand vom Rand
+/*****************************************************************
+* @brief Zeitstempel mit Millisekunden für Ereignis-Logs
+* @return "[JJJJ-MM-TT hh:mm:ss.mmm]" oder "[Keine Zeit]"; die
+*         Puffer werden reihum benutzt, also gleich verwenden
+******************************************************************/
+const char* getZeitstempelMs() {
+  struct timeval jetzt;
+  gettimeofday(&jetzt, NULL);  // die Systemzeit wird intern aus esp_timer fortgeschrieben
+  const char* sekunde = zeitstempelFuerSekunde(jetzt.tv_sec);
+  if (jetzt.tv_sec < ZEIT_GUELTIG_AB) {
+    return sekunde;
+  }
+  char* puffer = zeitstempelMsPuffer[zeitstempelMsIndex.fetch_add(1) % ZEITSTEMPEL_MS_PUFFER];
+  // unsigned % 1000: der Compiler sieht höchstens 3 Stellen, 20 + 1 + 3 + 1 passen in den Puffer
+  snprintf(puffer, ZEITSTEMPEL_MS_LAENGE, "%.20s.%03u]", sekunde, (unsigned)(jetzt.tv_usec / 1000) % 1000u);
+  return puffer;
+}
 
-  #ifdef OLED_TYPE_SSD1306
-  display.setTextColor(SSD1306_BLACK, SSD1306_WHITE); // Schwarzer Text auf weißem Hintergrund
-  #else 
-  display.setTextColor(SH110X_BLACK, SH110X_WHITE); // Schwarzer Text auf weißem Hintergrund
-  #endif
+// Logger: Einträge landen in einem Ringpuffer im RAM, ein Task mit niedriger
+// Priorität gibt sie auf Serial aus. Ein Logaufruf kostet damit ein snprintf
+// und ein memcpy, aber nie das Warten auf den UART.
+enum LogStufe : uint8_t {
+  LOG_FEHLER  = 1,
+  LOG_WARNUNG = 2,
+  LOG_INFO    = 3,
+  LOG_DEBUG   = 4
+};
+const uint32_t LOG_EINTRAEGE    = 64;   // Anzahl Einträge im Ringpuffer
+const size_t   LOG_TEXT_LAENGE  = 124;  // inkl. Zeitstempel
+struct LogEintrag {
+  LogStufe stufe;
+  char text[LOG_TEXT_LAENGE];
+};
+LogEintrag logPuffer[LOG_EINTRAEGE];
+uint32_t logGeschrieben = 0;            // Anzahl bisher geschriebener Einträge, Eintrag n liegt bei n % LOG_EINTRAEGE
+uint32_t logVerworfen   = 0;            // überschrieben bevor sie auf Serial ausgegeben wurden
+portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t logTaskHandle = NULL;
+const char LOG_KENNUNG[] = "?FWID";     // Kennbuchstabe je LogStufe
 
-  display.setCursor(textX, textY);
-  display.print(progressText);
+/*****************************************************************
+* @brief Schreibt einen Eintrag in den Log-Ringpuffer
+* @param stufe LOG_FEHLER..LOG_DEBUG, Einträge über LOG_STUFE (config.h) entfallen
+* @param format printf-Format, weitere Parameter wie bei printf
+******************************************************************/
+void logSchreiben(LogStufe stufe, const char* format, ...) {
+  if (stufe > LOG_STUFE) {
+    return;
+  }
+  char text[LOG_TEXT_LAENGE];
+  int laenge = snprintf(text, sizeof(text), "%s %c ", getZeitstempelMs(), LOG_KENNUNG[stufe]);
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text + laenge, sizeof(text) - laenge, format, args);
+  va_end(args);
 
-  // Sende alle Befehle an das Display
-  display.display();
+  portENTER_CRITICAL(&logMux);
+  LogEintrag& eintrag = logPuffer[logGeschrieben % LOG_EINTRAEGE];
+  eintrag.stufe = stufe;
+  memcpy(eintrag.text, text, sizeof(text));
+  logGeschrieben++;
+  portEXIT_CRITICAL(&logMux);
 
-  // und wieder zurück mit weiß auf schwarz
-  #ifdef OLED_TYPE_SSD1306
-  display.setTextColor(SSD1306_WHITE, SSD1306_BLACK); // Weißer Text auf schwarzem Hintergrund
-  #else
-  display.setTextColor(SH110X_WHITE, SH110X_BLACK); // Weißer Text auf schwarzem Hintergrund
-  #endif
+  if (logTaskHandle != NULL) {
+    xTaskNotifyGive(logTaskHandle);
+  }
 }
 
-#ifdef USE_EV_SOC_API
 /*****************************************************************
-* @brief SoC des EV von lokalem Webserver holen
-* @return soc in Prozent, -1 bei Fehler
+* @brief Log-Task: gibt neue Einträge auf Serial aus
+* @param parameter wird nicht benutzt
 ******************************************************************/
-int getSoc() {
-  HTTPClient http;
-  http.begin(evSocUrl);
-  int code = http.GET();
-  int soc = -1;
+void logTask(void* parameter) {
+  uint32_t ausgegeben = 0;
+  char text[LOG_TEXT_LAENGE];
 
-  if (code == 200) {
-    DynamicJsonDocument doc(512);
-    if (deserializeJson(doc, http.getString()) == DeserializationError::Ok) {
-      if (doc["success"].as<bool>()) {
-        soc = doc["soc"].as<int>();
-      } else {
-        Serial.println("EV SOC API: success=false");
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    for (;;) {
+      portENTER_CRITICAL(&logMux);
+      if (ausgegeben == logGeschrieben) {
+        portEXIT_CRITICAL(&logMux);
+        break;
       }
-    } else {
-      Serial.println("EV SOC API: JSON-Parsing Fehler");
+      // Wurden wir überholt, mit dem ältesten noch vorhandenen Eintrag weitermachen
+      if (logGeschrieben - ausgegeben > LOG_EINTRAEGE) {
+        logVerworfen += logGeschrieben - ausgegeben - LOG_EINTRAEGE;
+        ausgegeben = logGeschrieben - LOG_EINTRAEGE;
+      }
+      memcpy(text, logPuffer[ausgegeben % LOG_EINTRAEGE].text, sizeof(text));
+      ausgegeben++;
+      portEXIT_CRITICAL(&logMux);
+
+      Serial.println(text);
     }
-  } else {
-    Serial.printf("EV SOC API Fehler (Code: %d)\n", code);
   }
+}
 
-  http.end();
-  return soc;
+#ifdef USE_RSE_SIMULATION
+// RSE Simulation für Lasttests: ein esp_timer erzeugt abwechselnd aktive und inaktive Flanken
+// und legt sie wie die ISR in den Ringpuffer, der echte Eingang ist solange abgehängt.
+// Gemessen wird je Flanke die Zeit bis zur Antwort der (langsamsten) Shelly und bis die
+// Änderung in einer /events Nachricht an die Statusseite steht. Achtung: die Shellys werden
+// dabei wirklich geschaltet, also die URLs auf Attrappen richten oder die Wallbox abklemmen.
+struct SimMessung {
+  uint32_t* probenUs = NULL;   // je Zyklus eine Probe, RSE_SIM_MAX_PROBEN Plätze
+  uint32_t  anzahl   = 0;
+  uint32_t  fehler   = 0;      // Shelly: kein HTTP 200
+};
+esp_timer_handle_t simZeitgeber = NULL;
+volatile bool     simLaeuft       = false;
+volatile bool     simAktiv        = false;   // zuletzt simulierter Pegel
+volatile uint32_t simZyklen       = 0;       // bisher erzeugte Flanken
+volatile uint32_t simGeplant      = 0;
+volatile int64_t  simFlankeUs     = 0;       // Zeitpunkt der letzten simulierten Flanke
+volatile bool     simShellyOffen  = false;   // letzte Flanke wartet noch auf die Shelly
+volatile bool     simSseOffen     = false;   // letzte Flanke wartet noch auf /events
+volatile bool     simPegelAbgleich = false;  // Simulation beendet, aktorTask übernimmt den Pegel am Pin
+volatile uint32_t simVerpasst     = 0;       // nächste Flanke kam vor der Messung
+SimMessung simShelly, simSse;
+
+void simProbe(SimMessung& messung, int64_t dauerUs) {
+  if (messung.probenUs != NULL && messung.anzahl < RSE_SIM_MAX_PROBEN) {
+    messung.probenUs[messung.anzahl++] = (uint32_t)dauerUs;
+  }
 }
-#endif
 
 /*****************************************************************
-* @brief HTTP-Handler für die Webserver-Root-Seite
-* @param -
+* @brief Zeitgeber der Simulation: nächste Flanke, nach der letzten
+*        wieder den echten Eingang anhängen
 ******************************************************************/
-void handleRoot() {
-  String html = "<!DOCTYPE html><html lang='de'><head>";
-  html += "<meta charset='UTF-8'>";
-  html += "<meta name='viewport' content='width=device-width, initial-scale=1.0'>";
-  html += "<meta http-equiv='refresh' content='5'>"; // Auto-Refresh alle 5 Sekunden
-  html += "<title>SmartWB Monitor</title>";
-  // Favicon als Base64 eingebettetes PNG (32x32 Pixel, grüner Blitz auf dunklem Hintergrund)
-  // Um ein eigenes Favicon zu verwenden: Bild zu Base64 konvertieren mit z.B. https://base64.guru/converter/encode/image
-  html += "<link rel='icon' type='image/png' href='data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAACAAAAAgCAYAAABzenr0AAAABHNCSVQICAgIfAhkiAAAAAlwSFlzAAAA7AAAAOwBeShxvQAAABl0RVh0U29mdHdhcmUAd3d3Lmlua3NjYXBlLm9yZ5vuPBoAAAIJSURBVFiF7ZbPS1RRFMc/5707M+rYqDMWGRRBURTRpkWbFkGbINoU0SKif6BdBEHQqk0EQUG0aBMRQdCmVYsIIqJFBEEUQVEURZGN+WN8vjvnthiduXPfm3kqaO0+OJz3Pu+e7zn3xz0X/rOyBBzgC7AJ1IJSUwIrgBNgD2gDl4Ap4AewDGwBu8Ax0AQuAmuBw9cDbwFHwAxwFTgCpoF74Ax4CewAR8Ap8AS4BnQCh68HXgMOcBuYBE6AaWAMmAfWgTVgF3gNTAFXgJ3A4euBN4EjYBY4Bp4Cw8AKsAmsA9vAF+AJcBnoBU4Dh68HXgV2gHvAPPAa6ANWgQ1gA9gGdoEXwBBwGzgMHL4e+AA4AhaAR0Af8BFYAjaBbWAP+AQsAoPAHWAvcPh64GNgBxgHhoAPwEdgCfgE7AMfgEVgALgFfA8cvh5YBnaBcWAI+AQsA0vAfmDbYRE4H1h/h88zsBNFeR5FxWSi0muUoqLXvldW/TpWXveYqnR58lWfqfJOlBnT1P8K1/8K1z8JqR+E9OtL8lfz++eA/Dm8OXPzIlN5d+kkTbNdSunNUko7aZrtaq1eLaV077TU0m5Kab0U0lTTdVcppQ8opTcppamm664opbSZUlobUUpviVLaEqW09pdSekOU0lYopSX/LqXUJqW0KqW09p+U0rpfSukr//nfpQv8AJbxLmBk7cQrAAAAAElFTkSuQmCC'>";
-  html += "<style>";
-  html += "body { font-family: Arial, sans-serif; background-color: #1a1a1a; color: #ffffff; margin: 20px; }";
-  html += ".container { max-width: 600px; margin: 0 auto; background-color: #2a2a2a; padding: 20px; border-radius: 10px; box-shadow: 0 4px 6px rgba(0,0,0,0.3); }";
-  html += "h1 { text-align: center; color: #4CAF50; margin-bottom: 20px; }";
-  html += ".info-row { display: flex; justify-content: space-between; padding: 8px 0; border-bottom: 1px solid #444; }";
-  html += ".label { font-weight: bold; color: #aaa; }";
-  html += ".value { color: #fff; }";
-  html += ".status-offline { background-color: #f44336; color: white; padding: 2px 8px; border-radius: 3px; }";
-  html += ".status-ein { background-color: #4CAF50; color: white; padding: 2px 8px; border-radius: 3px; }";
-  html += ".status-aus { background-color: #ff9800; color: white; padding: 2px 8px; border-radius: 3px; }";
-  html += ".blink { animation: blink-animation 0.5s steps(2, start) infinite; }";
-  html += "@keyframes blink-animation { to { visibility: hidden; } }";
-  html += ".section { margin-top: 20px; }";
-  html += ".section-title { font-size: 1.2em; color: #4CAF50; margin-bottom: 10px; border-bottom: 2px solid #4CAF50; padding-bottom: 5px; }";
-  html += "</style>";
-  html += "</head><body>";
-  html += "<div class='container'>";
-  html += "<h1>SmartWB Monitor " VERSION "</h1>";
-
-  // Datum und Uhrzeit
-  html += "<div class='info-row'><span class='label'>Datum/Uhrzeit:</span><span class='value'>" + getZeitstempel() + "</span></div>";
-
-  // IP-Adresse
-  html += "<div class='info-row'><span class='label'>IP:</span><span class='value'>" + WiFi.localIP().toString() + "</span></div>";
-
-  // SmartWB Status
-  String statusClass = "";
-  String statusText = "";
-  if (actualPower == 0.0 && actualCurrent == 0 && maxCurrent == 0) {
-    statusClass = "status-offline";
-    statusText = "OFFLINE";
-  } else if (evseState) {
-    statusClass = "status-ein";
-    statusText = "EIN";
-  } else {
-    statusClass = "status-aus";
-    statusText = "AUS";
+void simSchritt(void* arg) {
+  if (simZyklen >= simGeplant) {
+    esp_timer_stop(simZeitgeber);
+    simLaeuft = false;
+    attachInterrupt(digitalPinToInterrupt(RSE), isrRSE, CHANGE);
+    simPegelAbgleich = true;  // den echten Pegel liest der aktorTask, die ISR bleibt einziger Schreiber
+    xTaskNotifyGive(aktorTaskHandle);
+    logSchreiben(LOG_INFO, "RSE Simulation beendet nach %u Zyklen", simZyklen);
+    return;
   }
-  html += "<div class='info-row'><span class='label'>SmartWB:</span><span class='value'><span class='" + statusClass + "'>" + statusText + "</span></span></div>";
+  if (simShellyOffen || simSseOffen) {
+    simVerpasst++;
+  }
+  simAktiv = !simAktiv;
+  simFlankeUs = esp_timer_get_time();
+  simShellyOffen = simSseOffen = true;
+  simZyklen++;
+  rseFlankeAblegen(simAktiv);
+  xTaskNotifyGive(aktorTaskHandle);
+}
 
-#ifdef USE_EV_SOC_API
-  // SOC (nur wenn Fahrzeug angeschlossen)
-  if ((vehicleState == 2 || vehicleState == 3) && soc >= 0) {
-    html += "<div class='info-row'><span class='label'>SOC:</span><span class='value'>" + String(soc) + "%</span></div>";
+/*****************************************************************
+* @brief Startet die Simulation mit zyklen Flanken
+* @return false, wenn sie schon läuft oder kein Speicher da ist
+******************************************************************/
+bool simStarten(uint32_t zyklen) {
+  if (simLaeuft || aktorTaskHandle == NULL) {
+    return false;
+  }
+  for (SimMessung* m : { &simShelly, &simSse }) {
+    if (m->probenUs == NULL) {
+      m->probenUs = (uint32_t*)malloc(RSE_SIM_MAX_PROBEN * sizeof(uint32_t));
+      if (m->probenUs == NULL) {
+        return false;
+      }
+    }
+    m->anzahl = m->fehler = 0;
   }
+  if (simZeitgeber == NULL) {
+    esp_timer_create_args_t args = {};
+    args.callback = &simSchritt;
+    args.name     = "rse_sim";
+    esp_timer_create(&args, &simZeitgeber);
+  }
+  detachInterrupt(digitalPinToInterrupt(RSE));
+  simAktiv = RSEAktiv;
+  simZyklen = simVerpasst = 0;
+  simGeplant = zyklen;
+  simShellyOffen = simSseOffen = false;
+  simLaeuft = true;
+  esp_timer_start_periodic(simZeitgeber, (uint64_t)RSE_SIM_PERIODE_MS * 1000);
+  logSchreiben(LOG_WARNUNG, "RSE Simulation gestartet: %u Zyklen alle %ums, echter Eingang abgehängt", zyklen, RSE_SIM_PERIODE_MS);
+  return true;
+}
 #endif
 
-  // Stromsection
-  html += "<div class='section'>";
-  html += "<div class='section-title'>Ladedaten</div>";
-
-  // Max Current
-  html += "<div class='info-row'><span class='label'>Max Current:</span><span class='value'>" + String(maxCurrent) + "A</span></div>";
+// Keep-alive HTTP Verbindungen: je Gegenstelle (Shelly, SmartWB, SoC Server) ein HTTPClient
+// mit eigenem WiFiClient. Die TCP Verbindung bleibt nach end() offen, wenn der Server das
+// erlaubt, und wird bei der nächsten Anfrage wiederverwendet. Der Hostname wird nur einmal
+// aufgelöst, verbunden wird mit dieser IP, im Host: Kopf steht aber der Name (virtuelle Hosts,
+// Reverse Proxies). Schlägt eine Anfrage fehl (Server hat die Verbindung inzwischen geschlossen,
+// IP hat sich geändert), wird einmal mit neu aufgelöster IP und neuer Verbindung wiederholt.
+// Jede Anfrage hat ein Zeitbudget (ms) für Verbindungsaufbau, Antwort und Wiederholung.
+// Ist es aufgebraucht, wird die Verbindung abgebrochen; ist es schon vorher zu klein,
+// wird gar nicht erst gesendet (HTTP_VERSCHOBEN) und der Aufrufer versucht es später.
+// Jede Instanz wird nur von einem Task benutzt (Shelly: aktorTask bzw. Shelly-Task,
+// SmartWB: Abfrage-Task der Wallbox, SoC: loop()).
+const int HTTP_VERSCHOBEN = -100;  // neben den HTTPC_ERROR_* (-1..-11)
+class HttpVerbindung {
+public:
+  explicit HttpVerbindung(const char* name = "") : name(name) {}
 
-  // Actual Current (mit roter Anzeige wenn RSE aktiv)
-  String currentDisplay = "";
-  if (RSEAktiv) {
-    currentDisplay = "<span style='color: red;' class='blink'>RCR aktiv</span> " + String(actualCurrent) + "A";
-  } else {
-    currentDisplay = String(actualCurrent) + "A";
+  /*****************************************************************
+  * @brief GET auf url. Die Antwort danach über http() lesen und
+  *        immer mit beenden() abschließen.
+  * @param budgetMs Zeitbudget für die ganze Anfrage, siehe ioBudgetMs()
+  * @return HTTP Code, negativ bei Verbindungsfehler (HTTPC_ERROR_*)
+  *         oder HTTP_VERSCHOBEN
+  ******************************************************************/
+  int get(const char* url, uint32_t budgetMs) {
+    startUs = esp_timer_get_time();
+    endeUs  = startUs + (int64_t)budgetMs * 1000;
+    gesendet = budgetMs >= HTTP_BUDGET_MIN_MS;
+    budgetAbbruch = false;
+    if (!gesendet) {
+      verschoben++;
+      return HTTP_VERSCHOBEN;
+    }
+    if (!zielSetzen(url)) {
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    int code = senden();
+    if (code < 0 && restMs() >= HTTP_BUDGET_MIN_MS) {
+      fehler++;
+      client.stop();
+      ipGueltig = false;
+      code = senden();
+    }
+    // Fehler, nachdem das Budget abgelaufen ist oder keine Wiederholung mehr zulässt: der
+    // Timeout kam aus dem Budget (DNS, Verbinden, Antwortkopf), die Verbindung ist unbrauchbar
+    budgetAbbruch = code < 0 && restMs() < HTTP_BUDGET_MIN_MS;
+    if (budgetAbbruch) {
+      abgebrochen++;
+      client.stop();
+    }
+    return code;
   }
-  html += "<div class='info-row'><span class='label'>Actual Current:</span><span class='value'>" + currentDisplay + "</span></div>";
 
-  // Actual Power
-  html += "<div class='info-row'><span class='label'>Actual Power:</span><span class='value'>" + String(actualPower, 2) + "kW</span></div>";
-  html += "</div>";
+  HTTPClient& http() { return httpClient; }
 
-  // Spannungen und Ströme
-  html += "<div class='section'>";
-  html += "<div class='section-title'>Phasen</div>";
-  html += "<div class='info-row'><span class='label'>U1:</span><span class='value'>" + String(voltageP1, 1) + "V</span><span class='label' style='margin-left: 20px;'>I1:</span><span class='value'>" + String(currentP1, 1) + "A</span></div>";
-  html += "<div class='info-row'><span class='label'>U2:</span><span class='value'>" + String(voltageP2, 1) + "V</span><span class='label' style='margin-left: 20px;'>I2:</span><span class='value'>" + String(currentP2, 1) + "A</span></div>";
-  html += "<div class='info-row'><span class='label'>U3:</span><span class='value'>" + String(voltageP3, 1) + "V</span><span class='label' style='margin-left: 20px;'>I3:</span><span class='value'>" + String(currentP3, 1) + "A</span></div>";
-  html += "</div>";
+  // gibt die Antwort frei, die Verbindung bleibt für die nächste Anfrage offen
+  void beenden() {
+    if (gesendet && !budgetAbbruch && restMs() == 0) {
+      abgebrochen++;  // Budget beim Lesen des Inhalts abgelaufen, Rest der Antwort steckt noch in der Verbindung
+      client.stop();
+    }
+    httpClient.end();
+    if (gesendet) {
+      dauer.erfassen(esp_timer_get_time() - startUs);  // von get() bis hier, also inkl. Lesen der Antwort
+    }
+  }
 
-  html += "</div></body></html>";
+  const char* name;
+  volatile uint32_t wiederverwendet = 0;  // Anfragen über eine schon offene Verbindung
+  volatile uint32_t neu             = 0;  // Anfragen, die eine Verbindung aufbauen mussten
+  volatile uint32_t fehler          = 0;  // fehlgeschlagene Versuche (danach neu verbunden)
+  volatile uint32_t dnsAnfragen     = 0;
+  volatile uint32_t abgebrochen     = 0;  // vom Zeitbudget beendet (DNS, Verbinden, Antwort oder Inhalt)
+  volatile uint32_t verschoben      = 0;  // Budget zu klein, nicht gesendet
+  Histogramm dauer{EIMER_MS};
 
-  server.send(200, "text/html", html);
-}
+private:
+  int64_t startUs = 0;
+  int64_t endeUs  = 0;  // Ende des Zeitbudgets
+  bool gesendet = false;
+  bool budgetAbbruch = false;  // in get() schon als abgebrochen gezählt
+  WiFiClient client;
+  HTTPClient httpClient;
+  char host[64] = "";
+  uint16_t port = 80;
+  const char* pfad = "/";
+  IPAddress ip;
+  bool ipGueltig = false;
+  SemaphoreHandle_t dnsFertig = NULL;  // von dnsErgebnis() gegeben
+  IPAddress dnsIp;
 
-// ### Setup Routine ###
-void setup() {
-  Serial.begin(115200);
+  // lwIP Rückruf (tcpip Task), kann auch noch nach Ablauf des Budgets kommen
+  static void dnsErgebnis(const char* name, const ip_addr_t* adresse, void* arg) {
+    HttpVerbindung* verbindung = static_cast<HttpVerbindung*>(arg);
+    if (strcmp(name, verbindung->host) != 0) {
+      return;  // Antwort auf eine abgebrochene Anfrage für einen anderen Host
+    }
+    verbindung->dnsIp = (adresse != NULL && IP_IS_V4(adresse)) ? IPAddress(ip_2_ip4(adresse)->addr) : IPAddress();
+    xSemaphoreGive(verbindung->dnsFertig);
+  }
 
-  // Pins konfigurieren
-  pinMode(LED1_PIN, OUTPUT);  // Grün: SmartWB Zustand: EIN bei aktiv, FADE bei nicht aktiv
-  pinMode(LED2_PIN, OUTPUT);  // Rot
-  pinMode(LED3_PIN, OUTPUT);  // Blau
-  pinMode(RSE, INPUT_PULLUP); // Hier und an GND muss der Schließer des RSE Relais angeschlossen werden
+  // dns_gethostbyname() darf nur im tcpip Task laufen. LOCK_TCPIP_CORE() hilft nur mit
+  // LWIP_TCPIP_CORE_LOCKING, das im Arduino Core 2.x (IDF 4) aus ist. tcpip_api_call() führt
+  // den Aufruf dort aus und wartet darauf, das geht mit und ohne Core Locking.
+  struct DnsAufruf {
+    struct tcpip_api_call_data aufruf;  // muss vorne stehen
+    HttpVerbindung* verbindung;
+    ip_addr_t adresse;
+    err_t err;
+  };
 
-  // LED initialisieren
-  // LED1: Fade (wenn Ereignis1 nicht aktiv, sonst Konstant AN...ggf. auch AUS wenn SmartWB(evse nicht erreichbar)
-  led1.begin(LED1_PIN, LEDC_CHANNEL_0, LEDC_TIMER_0);
-  led1.fadeStep  = 5;
-  led1.fadeDelay = 30;
+  static err_t dnsImTcpipTask(struct tcpip_api_call_data* daten) {
+    DnsAufruf* a = reinterpret_cast<DnsAufruf*>(daten);
+    a->err = dns_gethostbyname(a->verbindung->host, &a->adresse, &HttpVerbindung::dnsErgebnis, a->verbindung);
+    return ERR_OK;
+  }
 
-  // LED2: Blink (bei Ereignis2 = RSE aktiv = LOW)
-  led2.begin(LED2_PIN, LEDC_CHANNEL_1, LEDC_TIMER_1);
-  led2.blinkInterval = 250; //ms
+  // Namensauflösung im Zeitbudget. WiFi.hostByName() wartet bis zu 15 s und lässt sich
+  // nicht begrenzen, deshalb direkt über lwIP und nur so lange, wie noch Budget übrig ist.
+  bool aufloesen() {
+    if (ip.fromString(host)) {
+      return true;  // IP-Adresse in der URL
+    }
+    if (dnsFertig == NULL) {
+      dnsFertig = xSemaphoreCreateBinary();
+    }
+    dnsAnfragen++;
+    xSemaphoreTake(dnsFertig, 0);  // verspätete Antwort einer früheren Anfrage verwerfen
+    dnsIp = IPAddress();
+    DnsAufruf aufruf = {};
+    aufruf.verbindung = this;
+    aufruf.err = ERR_ARG;
+    tcpip_api_call(&HttpVerbindung::dnsImTcpipTask, &aufruf.aufruf);
+    if (aufruf.err == ERR_OK && IP_IS_V4(&aufruf.adresse)) {
+      ip = IPAddress(ip_2_ip4(&aufruf.adresse)->addr);   // aus dem lwIP Cache
+    } else if (aufruf.err == ERR_INPROGRESS && xSemaphoreTake(dnsFertig, pdMS_TO_TICKS(restMs())) == pdTRUE) {
+      ip = dnsIp;
+    } else {
+      return false;
+    }
+    return ip != IPAddress();
+  }
 
-  // LED3: Flash (immer)
-  led3.begin(LED3_PIN, LEDC_CHANNEL_2, LEDC_TIMER_2);
-  led3.flashOn  = 100;   //ms AN 125
-  led3.flashOff = 3000;  //ms AUS 2000
+  // zerlegt http://host[:port]/pfad, bei anderem Host wird die alte Verbindung geschlossen
+  bool zielSetzen(const char* url) {
+    const char* start = strstr(url, "://");
+    start = start ? start + 3 : url;
+    const char* ende = start + strcspn(start, ":/");
+    size_t laenge = ende - start;
+    if (laenge == 0 || laenge >= sizeof(host)) {
+      return false;
+    }
+    uint16_t neuerPort = (*ende == ':') ? atoi(ende + 1) : 80;
+    const char* neuerPfad = strchr(ende, '/');
+    pfad = neuerPfad ? neuerPfad : "/";
+    if (strncmp(host, start, laenge) != 0 || host[laenge] != '\0' || neuerPort != port) {
+      client.stop();
+      memcpy(host, start, laenge);
+      host[laenge] = '\0';
+      port = neuerPort;
+      ipGueltig = false;
+    }
+    return true;
+  }
+
+  uint32_t restMs() const {
+    int64_t rest = (endeUs - esp_timer_get_time()) / 1000;
+    return rest > 0 ? (uint32_t)rest : 0;
+  }
+
+  int senden() {
+    if (!ipGueltig) {
+      if (!aufloesen()) {
+        logSchreiben(LOG_FEHLER, "%s: %s nicht auflösbar", name, host);
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+      }
+      ipGueltig = true;
+    }
+    if (client.connected()) {
+      wiederverwendet++;
+    } else {
+      neu++;
+      if (!client.connect(ip, port, restMs())) {  // selbst verbinden, damit das Budget auch hier gilt
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+      }
+    }
+    uint32_t rest = max<uint32_t>(restMs(), 1);
+    httpClient.setTimeout(min<uint32_t>(rest, 65535));  // ms, Warten auf den Antwortkopf
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    client.setTimeout(rest);                   // ms, Lesen des Inhalts
+#else
+    client.setTimeout((rest + 999) / 1000);    // s, aufrunden: 0 hieße unbegrenzt
+#endif
+    httpClient.begin(client, host, port, pfad);  // client ist schon mit ip verbunden, host nur für den Host: Kopf
+    return httpClient.GET();
+  }
+};
+
+// Eine Wallbox: Konfiguration, Messwerte und je ein Task für die Shelly und die SmartWB Abfrage.
+// werte gehört loop() (Anzeige, Web, Verlauf, MQTT). Der Abfrage-Task legt neue Werte unter
+// wallboxMux in neu ab und weckt loop(), übernommen werden sie dort in wallboxenUebernehmen().
+struct Wallbox {
+  const WallboxKonfig* konfig;
+  WallboxWerte   werte;
+  WallboxWerte   neu;
+  bool           neuVorhanden = false;
+  HttpVerbindung smartWB{"SmartWB"};
+  HttpVerbindung shelly{"Shelly"};
+  TaskHandle_t   abfrageTask = NULL;
+  TaskHandle_t   shellyTask  = NULL;
+  volatile int     shellyHttpCode = 0;
+  volatile int64_t shellyLatenzUs = -1;
+  volatile bool     shellyOffen          = false;  // Sollzustand noch nicht mit HTTP 200 bestätigt
+  volatile uint32_t shellyNachgeholt     = 0;      // Wiederholungen offener Schaltbefehle
+  volatile uint32_t shellyFehlgeschlagen = 0;      // Schaltbefehle, die nach SHELLY_FRIST_MS noch offen waren
+};
+Wallbox wallboxen[WALLBOX_ANZAHL];
+portMUX_TYPE wallboxMux = portMUX_INITIALIZER_UNLOCKED;
+WallboxWerte webWerte[WALLBOX_ANZAHL];    // Momentaufnahme von werte für den webTask (/events)
+
+/*****************************************************************
+* @brief Für den Webserver: aktuelle Werte aller Wallboxen kopieren
+*        (loop() ändert werte nur unter wallboxMux). Jede Antwort und
+*        der webTask haben ihre eigene Momentaufnahme.
+* @param ziel WALLBOX_ANZAHL Einträge
+******************************************************************/
+void webMomentaufnahme(WallboxWerte* ziel) {
+  portENTER_CRITICAL(&wallboxMux);
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    ziel[wb] = wallboxen[wb].werte;
+  }
+  portEXIT_CRITICAL(&wallboxMux);
+}
+const uint32_t   WALLBOX_TASK_STACK = 6144;
+const BaseType_t WALLBOX_TASK_CORE  = 0;   // SmartWB Abfragen neben dem Webserver, nicht beim Aktor-Task
+
+#ifdef USE_EV_SOC_API
+HttpVerbindung verbindungSoc("SoC");
+#endif
+
+// Energie- und RCR-Abrechnung (§14a EnWG): geladene Energie und Dauer der RCR Begrenzung.
+// Die Zähler liegen im RTC-RAM und überstehen so Watchdog-, Panic- und Brownout-Resets.
+// In den NVS geschrieben wird nur alle ABRECHNUNG_SPEICHER_MIN Minuten, beim Tages-
+// wechsel und vor einem esp_restart(), nicht bei jeder Abfrage.
+enum AbrechnungZeitraum {
+  ZR_HEUTE, ZR_GESTERN, ZR_MONAT, ZR_VORMONAT, ZR_GESAMT,
+  ZR_ANZAHL
+};
+const char* const ZEITRAUM_NAME[ZR_ANZAHL] = { "heute", "gestern", "monat", "vormonat", "gesamt" };
+struct AbrechnungDaten {
+  uint32_t kennung;                // ABRECHNUNG_KENNUNG, sonst ungültig
+  uint32_t sequenz;                // wird bei jeder Änderung erhöht, der neuere Stand (RTC oder NVS) gewinnt
+  uint32_t tag;                    // JJJJMMTT des laufenden Tages, 0 = noch keine gültige Uhrzeit
+  uint32_t monat;                  // JJJJMM des laufenden Monats
+  uint64_t energieWs[ZR_ANZAHL];   // geladene Energie in Wattsekunden
+  uint64_t rcrMs[ZR_ANZAHL];       // Dauer RSE aktiv in ms
+  uint32_t pruefsumme;             // über alle Bytes davor
+};
+const uint32_t ABRECHNUNG_KENNUNG = 0x41425231;   // "ABR1"
+const uint32_t ABRECHNUNG_MAX_LUECKE_S = 120;     // längere Lücken zwischen zwei Abfragen werden nicht integriert
+RTC_NOINIT_ATTR AbrechnungDaten abrechnung;
+portMUX_TYPE abrechnungMux = portMUX_INITIALIZER_UNLOCKED;
+Preferences abrechnungNvs;
+uint32_t abrechnungNvsSequenz = 0;               // zuletzt in den NVS geschriebene Sequenz
+unsigned long letzteAbrechnungSpeicherung = 0;
+int64_t abrechnungLeistungUs = 0;                // Zeitpunkt der letzten Leistungsmessung
+float   abrechnungLeistungKw = 0.0;
+int64_t abrechnungRcrUs = -1;                    // seit wann RCR Zeit noch nicht gezählt ist, -1 = RSE nicht aktiv
+
+/*****************************************************************
+* @brief Prüfsumme (FNV-1a) über die Abrechnungsdaten ohne das Prüfsummenfeld
+******************************************************************/
+uint32_t abrechnungPruefsumme(const AbrechnungDaten& daten) {
+  const uint8_t* bytes = (const uint8_t*)&daten;
+  uint32_t summe = 2166136261u;
+  for (size_t k = 0; k < offsetof(AbrechnungDaten, pruefsumme); k++) {
+    summe = (summe ^ bytes[k]) * 16777619u;
+  }
+  return summe;
+}
+
+/*****************************************************************
+* @brief Schreibt den aktuellen Stand in den NVS, wenn er sich geändert hat
+******************************************************************/
+void abrechnungSpeichern() {
+  AbrechnungDaten kopie;
+  portENTER_CRITICAL(&abrechnungMux);
+  kopie = abrechnung;
+  portEXIT_CRITICAL(&abrechnungMux);
+  if (kopie.sequenz == abrechnungNvsSequenz) {
+    return;
+  }
+  abrechnungNvs.putBytes("daten", &kopie, sizeof(kopie));
+  abrechnungNvsSequenz = kopie.sequenz;
+  logSchreiben(LOG_DEBUG, "Abrechnung gespeichert (Sequenz %u)", kopie.sequenz);
+}
+
+/*****************************************************************
+* @brief Wird von esp_restart() aufgerufen: letzter Stand in den NVS
+******************************************************************/
+void abrechnungBeimNeustart() {
+  abrechnungSpeichern();
+}
+
+/*****************************************************************
+* @brief Lädt die Zähler: der neuere gültige Stand aus RTC-RAM oder NVS gewinnt
+******************************************************************/
+void abrechnungStarten() {
+  abrechnungNvs.begin("abrechnung", false);
+  AbrechnungDaten nvs;
+  bool nvsGueltig = abrechnungNvs.getBytes("daten", &nvs, sizeof(nvs)) == sizeof(nvs)
+                    && nvs.kennung == ABRECHNUNG_KENNUNG && nvs.pruefsumme == abrechnungPruefsumme(nvs);
+  bool rtcGueltig = abrechnung.kennung == ABRECHNUNG_KENNUNG && abrechnung.pruefsumme == abrechnungPruefsumme(abrechnung);
+
+  if (rtcGueltig && (!nvsGueltig || abrechnung.sequenz >= nvs.sequenz)) {
+    logSchreiben(LOG_INFO, "Abrechnung aus RTC-RAM übernommen (Sequenz %u)", abrechnung.sequenz);
+  } else if (nvsGueltig) {
+    abrechnung = nvs;
+    logSchreiben(LOG_INFO, "Abrechnung aus NVS geladen (Sequenz %u)", abrechnung.sequenz);
+  } else {
+    memset(&abrechnung, 0, sizeof(abrechnung));
+    abrechnung.kennung = ABRECHNUNG_KENNUNG;
+    abrechnung.pruefsumme = abrechnungPruefsumme(abrechnung);
+    logSchreiben(LOG_INFO, "Abrechnung neu angelegt");
+  }
+  abrechnungNvsSequenz = nvsGueltig ? nvs.sequenz : 0;
+  abrechnungSpeichern();
+  esp_register_shutdown_handler(abrechnungBeimNeustart);
+}
+
+/*****************************************************************
+* @brief Addiert Energie und RCR Dauer auf Tag, Monat und Gesamt.
+*        Aufruf nur mit gesperrtem abrechnungMux.
+******************************************************************/
+void abrechnungAddieren(uint64_t energieWs, uint64_t rcrMs) {
+  const AbrechnungZeitraum ziele[] = { ZR_HEUTE, ZR_MONAT, ZR_GESAMT };
+  for (AbrechnungZeitraum zr : ziele) {
+    abrechnung.energieWs[zr] += energieWs;
+    abrechnung.rcrMs[zr] += rcrMs;
+  }
+  abrechnung.sequenz++;
+  abrechnung.pruefsumme = abrechnungPruefsumme(abrechnung);
+}
+
+/*****************************************************************
+* @brief Integriert die Ladeleistung seit der letzten Messung (Trapezregel)
+* @param leistungKw aktuelle actualPower
+******************************************************************/
+void abrechnungLeistung(float leistungKw) {
+  int64_t jetzt = esp_timer_get_time();
+  if (abrechnungLeistungUs > 0) {
+    int64_t dauerMs = (jetzt - abrechnungLeistungUs) / 1000;
+    if (dauerMs <= (int64_t)ABRECHNUNG_MAX_LUECKE_S * 1000) {
+      float mittelW = (abrechnungLeistungKw + leistungKw) * 500.0;  // Mittelwert in W
+      uint64_t energieWs = (uint64_t)lroundf(mittelW * dauerMs / 1000.0);
+      if (energieWs > 0) {
+        portENTER_CRITICAL(&abrechnungMux);
+        abrechnungAddieren(energieWs, 0);
+        portEXIT_CRITICAL(&abrechnungMux);
+      }
+    }
+  }
+  abrechnungLeistungUs = jetzt;
+  abrechnungLeistungKw = leistungKw;
+}
+
+/*****************************************************************
+* @brief RSE Flanke mit dem Zeitstempel der Flanke verbuchen
+* @param aktiv neuer (entprellter) Zustand
+* @param zeitUs esp_timer Zeit der Flanke
+******************************************************************/
+void abrechnungRseFlanke(bool aktiv, int64_t zeitUs) {
+  portENTER_CRITICAL(&abrechnungMux);
+  if (aktiv) {
+    if (abrechnungRcrUs < 0) {
+      abrechnungRcrUs = zeitUs;
+    }
+  } else if (abrechnungRcrUs >= 0) {
+    if (zeitUs > abrechnungRcrUs) {
+      abrechnungAddieren(0, (zeitUs - abrechnungRcrUs) / 1000);
+    }
+    abrechnungRcrUs = -1;
+  }
+  portEXIT_CRITICAL(&abrechnungMux);
+}
+
+/*****************************************************************
+* @brief Regelmäßig aufrufen: laufende RCR Zeit verbuchen, Tages- und
+*        Monatswechsel, NVS Speicherung im eingestellten Intervall
+******************************************************************/
+void abrechnungTick() {
+  int64_t jetztUs = esp_timer_get_time();
+  bool wechsel = false;
+
+  struct tm zeit;
+  time_t sekunden = time(NULL);
+  uint32_t tag = 0, monat = 0;
+  if (sekunden >= ZEIT_GUELTIG_AB) {
+    localtime_r(&sekunden, &zeit);
+    monat = (zeit.tm_year + 1900) * 100 + zeit.tm_mon + 1;
+    tag = monat * 100 + zeit.tm_mday;
+  }
+
+  portENTER_CRITICAL(&abrechnungMux);
+  // Laufende RCR Begrenzung anteilig verbuchen
+  if (abrechnungRcrUs >= 0 && jetztUs - abrechnungRcrUs >= 1000) {
+    abrechnungAddieren(0, (jetztUs - abrechnungRcrUs) / 1000);
+    abrechnungRcrUs = jetztUs;
+  }
+  // Tages- und Monatswechsel
+  if (tag != 0 && tag != abrechnung.tag) {
+    if (abrechnung.tag != 0) {
+      abrechnung.energieWs[ZR_GESTERN] = abrechnung.energieWs[ZR_HEUTE];
+      abrechnung.rcrMs[ZR_GESTERN]     = abrechnung.rcrMs[ZR_HEUTE];
+      abrechnung.energieWs[ZR_HEUTE]   = 0;
+      abrechnung.rcrMs[ZR_HEUTE]       = 0;
+      wechsel = true;
+    }
+    if (monat != abrechnung.monat && abrechnung.monat != 0) {
+      abrechnung.energieWs[ZR_VORMONAT] = abrechnung.energieWs[ZR_MONAT];
+      abrechnung.rcrMs[ZR_VORMONAT]     = abrechnung.rcrMs[ZR_MONAT];
+      abrechnung.energieWs[ZR_MONAT]    = 0;
+      abrechnung.rcrMs[ZR_MONAT]        = 0;
+    }
+    abrechnung.tag = tag;
+    abrechnung.monat = monat;
+    abrechnung.sequenz++;
+    abrechnung.pruefsumme = abrechnungPruefsumme(abrechnung);
+  }
+  portEXIT_CRITICAL(&abrechnungMux);
+
+  if (wechsel || millis() - letzteAbrechnungSpeicherung >= (unsigned long)ABRECHNUNG_SPEICHER_MIN * 60000UL) {
+    letzteAbrechnungSpeicherung = millis();
+    abrechnungSpeichern();
+  }
+}
+
+// RCR Ereignis-Journal auf LittleFS: jede (entprellte) RSE Flanke mit Zeit, Pegel,
+// HTTP Ergebnis der Shelly und Schaltlatenz. Die Einträge werden nur angehängt und
+// auf Segmentdateien /rcr/<nummer>.bin verteilt, das älteste Segment wird gelöscht.
+// Der Index (/rcr/index.bin) hält je Segment die erste und letzte Zeit, damit eine
+// Abfrage nur die passenden Segmente öffnet und darin per Binärsuche einsteigt.
+struct __attribute__((packed)) JournalEintrag {
+  uint32_t zeit;       // Unix-Zeit der Flanke (s)
+  uint16_t ms;         // Millisekunden dazu
+  uint8_t  aktiv;      // 1 = RSE aktiv
+  int16_t  httpCode;   // Antwort der Shelly, -1 = nicht gesendet (kein WLAN)
+  uint32_t latenzUs;   // Flanke -> HTTP Antwort
+};
+struct JournalSegment {
+  uint32_t nummer;
+  uint32_t erste;      // Zeit des ersten Eintrags
+  uint32_t letzte;     // Zeit des letzten Eintrags
+  uint16_t anzahl;
+};
+const char*    JOURNAL_VERZEICHNIS       = "/rcr";
+const char*    JOURNAL_INDEX             = "/rcr/index.bin";
+const uint16_t JOURNAL_SEGMENT_EINTRAEGE = 256;  // 256 * 13 Bytes je Segmentdatei
+const uint8_t  JOURNAL_SEGMENTE          = 16;
+JournalSegment journalIndex[JOURNAL_SEGMENTE];   // ältestes zuerst
+uint8_t journalSegmente = 0;
+bool journalBereit = false;
+QueueHandle_t journalQueue = NULL;               // aktorTask -> loop(), damit Flash-Zugriffe nicht im RSE Pfad liegen
+SemaphoreHandle_t journalSperre = NULL;          // schützt journalIndex, loop() schreibt, der Webserver-Task liest
+uint32_t journalOhneZeit = 0;                    // verworfene Flanken vor dem ersten NTP Abgleich
+
+/*****************************************************************
+* @brief Dateiname eines Segments
+******************************************************************/
+void journalDateiname(uint32_t nummer, char* name, size_t groesse) {
+  snprintf(name, groesse, "%s/%08u.bin", JOURNAL_VERZEICHNIS, nummer);
+}
+
+/*****************************************************************
+* @brief Index neu schreiben (nur bei neuen Einträgen, also selten)
+******************************************************************/
+void journalIndexSpeichern() {
+  File datei = LittleFS.open(JOURNAL_INDEX, "w");
+  if (datei) {
+    datei.write((const uint8_t*)journalIndex, journalSegmente * sizeof(JournalSegment));
+    datei.close();
+  }
+}
+
+/*****************************************************************
+* @brief Index aus den Segmentdateien neu aufbauen (fehlende oder
+*        unvollständige index.bin, z.B. Stromausfall beim Schreiben)
+******************************************************************/
+void journalIndexAufbauen() {
+  journalSegmente = 0;
+  uint32_t kleinsteNummer = UINT32_MAX;
+  File verzeichnis = LittleFS.open(JOURNAL_VERZEICHNIS);
+  File datei = verzeichnis.openNextFile();
+  while (datei) {
+    const char* name = strrchr(datei.name(), '/');
+    name = name ? name + 1 : datei.name();
+    uint16_t anzahl = datei.size() / sizeof(JournalEintrag);
+    if (isdigit((unsigned char)name[0]) && anzahl > 0) {
+      JournalSegment segment;
+      JournalEintrag eintrag;
+      segment.nummer = strtoul(name, NULL, 10);
+      segment.anzahl = anzahl;
+      datei.read((uint8_t*)&eintrag, sizeof(eintrag));
+      segment.erste = eintrag.zeit;
+      datei.seek((size_t)(anzahl - 1) * sizeof(JournalEintrag));
+      datei.read((uint8_t*)&eintrag, sizeof(eintrag));
+      segment.letzte = eintrag.zeit;
+      kleinsteNummer = std::min(kleinsteNummer, segment.nummer);
+      // Die Reihenfolge im Verzeichnis ist beliebig: nach Nummer einsortieren und
+      // bei mehr als JOURNAL_SEGMENTE Dateien nur die neuesten behalten
+      bool behalten = true;
+      if (journalSegmente == JOURNAL_SEGMENTE) {
+        behalten = segment.nummer > journalIndex[0].nummer;
+        if (behalten) {
+          memmove(journalIndex, journalIndex + 1, (JOURNAL_SEGMENTE - 1) * sizeof(JournalSegment));
+          journalSegmente--;
+        }
+      }
+      if (behalten) {
+        uint8_t k = journalSegmente;
+        while (k > 0 && journalIndex[k - 1].nummer > segment.nummer) {
+          journalIndex[k] = journalIndex[k - 1];
+          k--;
+        }
+        journalIndex[k] = segment;
+        journalSegmente++;
+      }
+    }
+    datei.close();
+    datei = verzeichnis.openNextFile();
+  }
+  verzeichnis.close();
+  // Verworfene Segmente löschen, die Nummern sind fortlaufend vergeben
+  if (journalSegmente == JOURNAL_SEGMENTE) {
+    char name[32];
+    for (uint32_t nummer = kleinsteNummer; nummer < journalIndex[0].nummer; nummer++) {
+      journalDateiname(nummer, name, sizeof(name));
+      LittleFS.remove(name);
+    }
+  }
+  journalIndexSpeichern();
+  logSchreiben(LOG_WARNUNG, "RCR Journal: Index aus %u Segmenten neu aufgebaut", journalSegmente);
+}
+
+/*****************************************************************
+* @brief Dateisystem einbinden und Index laden
+******************************************************************/
+void journalStarten() {
+  if (!LittleFS.begin(true)) {  // true = beim ersten Mal formatieren
+    logSchreiben(LOG_FEHLER, "LittleFS nicht verfügbar, kein RCR Journal");
+    return;
+  }
+  LittleFS.mkdir(JOURNAL_VERZEICHNIS);
+  File datei = LittleFS.open(JOURNAL_INDEX, "r");
+  size_t gelesen = 0;
+  bool vorhanden = datei;
+  if (vorhanden) {
+    gelesen = datei.read((uint8_t*)journalIndex, sizeof(journalIndex));
+    datei.close();
+  }
+  journalSegmente = gelesen / sizeof(JournalSegment);
+  // Stimmt der letzte Indexeintrag nicht mit der Dateigröße überein, wurde vor dem
+  // Neustart nicht mehr fertig geschrieben -> aus den Segmenten neu aufbauen
+  bool stimmig = (gelesen % sizeof(JournalSegment)) == 0;
+  if (stimmig && journalSegmente > 0) {
+    char name[32];
+    journalDateiname(journalIndex[journalSegmente - 1].nummer, name, sizeof(name));
+    File letztes = LittleFS.open(name, "r");
+    stimmig = letztes && letztes.size() == (size_t)journalIndex[journalSegmente - 1].anzahl * sizeof(JournalEintrag);
+    if (letztes) letztes.close();
+  }
+  if (!vorhanden || !stimmig) {
+    journalIndexAufbauen();
+  }
+  journalQueue = xQueueCreate(16, sizeof(JournalEintrag));
+  journalSperre = xSemaphoreCreateMutex();
+  journalBereit = true;
+  logSchreiben(LOG_INFO, "RCR Journal: %u Segmente", journalSegmente);
+}
+
+/*****************************************************************
+* @brief Einen Eintrag anhängen, bei vollem Segment ein neues beginnen
+******************************************************************/
+void journalAnhaengen(const JournalEintrag& eintrag) {
+  char name[32];
+  if (journalSegmente == 0 || journalIndex[journalSegmente - 1].anzahl >= JOURNAL_SEGMENT_EINTRAEGE) {
+    uint32_t nummer = (journalSegmente > 0) ? journalIndex[journalSegmente - 1].nummer + 1 : 0;
+    if (journalSegmente == JOURNAL_SEGMENTE) {
+      journalDateiname(journalIndex[0].nummer, name, sizeof(name));
+      LittleFS.remove(name);
+      memmove(journalIndex, journalIndex + 1, (JOURNAL_SEGMENTE - 1) * sizeof(JournalSegment));
+      journalSegmente--;
+    }
+    journalIndex[journalSegmente].nummer = nummer;
+    journalIndex[journalSegmente].erste  = eintrag.zeit;
+    journalIndex[journalSegmente].anzahl = 0;
+    journalSegmente++;
+  }
+
+  JournalSegment& segment = journalIndex[journalSegmente - 1];
+  journalDateiname(segment.nummer, name, sizeof(name));
+  File datei = LittleFS.open(name, "a");
+  if (!datei) {
+    logSchreiben(LOG_FEHLER, "RCR Journal: %s kann nicht geschrieben werden", name);
+    return;
+  }
+  datei.write((const uint8_t*)&eintrag, sizeof(eintrag));
+  datei.close();
+  segment.letzte = eintrag.zeit;
+  segment.anzahl++;
+  journalIndexSpeichern();
+}
+
+/*****************************************************************
+* @brief Von loop() aufgerufen: Einträge aus der Queue ins Journal
+*        schreiben. Flanken vor dem ersten NTP Abgleich haben keine
+*        gültige Zeit und würden die Sortierung der Segmente brechen,
+*        sie werden nur gezählt.
+******************************************************************/
+void journalVerarbeiten() {
+  JournalEintrag eintrag;
+  while (journalBereit && xQueueReceive(journalQueue, &eintrag, 0) == pdTRUE) {
+    if (eintrag.zeit < ZEIT_GUELTIG_AB) {
+      journalOhneZeit++;
+      logSchreiben(LOG_WARNUNG, "RCR Journal: Flanke ohne gültige Uhrzeit nicht gespeichert");
+      continue;
+    }
+    xSemaphoreTake(journalSperre, portMAX_DELAY);
+    journalAnhaengen(eintrag);
+    xSemaphoreGive(journalSperre);
+  }
+}
+
+// Schaltauftrag an die Shelly-Tasks, wird vom aktorTask vor dem Wecken gesetzt
+volatile bool    shellyAuftragAktiv = false;
+volatile int64_t shellyAuftragUs    = 0;
+EventGroupHandle_t shellyFertig = NULL;     // Bit n gesetzt = Shelly der Wallbox n hat geantwortet
+const int SHELLY_VERSUCHE = 2;              // bei Timeout oder Verbindungsfehler sofort wiederholen
+const uint32_t SHELLY_WARTEN_MS = 6000;     // länger als alle Versuche zusammen
+static_assert(SHELLY_VERSUCHE * HTTP_BUDGET_SHELLY_MS < SHELLY_WARTEN_MS, "SHELLY_WARTEN_MS zu kurz");
+static_assert(WALLBOX_ANZAHL <= 24, "höchstens 24 Wallboxen (Bits einer Event Group)");
+
+// Offener Schaltbefehl (Wallbox::shellyOffen): gehört dem aktorTask, Statusseite und /metrics lesen mit
+volatile int64_t shellyBefehlUs      = 0;   // RSE Flanke des aktuellen Befehls
+volatile int64_t shellyNachholenUs   = 0;   // nächste Wiederholung, 0 = alle Shellys haben bestätigt
+uint32_t         shellyNachholenMs   = SHELLY_NACHHOLEN_MS;  // aktueller Abstand der Wiederholungen
+bool             shellyFristGemeldet = false;                // als fehlgeschlagen gezählt
+
+/*****************************************************************
+* @brief Schaltet die Shelly einer Wallbox und merkt sich Antwort
+*        und Latenz ab der RSE Flanke
+******************************************************************/
+void shellySchalten(Wallbox& wallbox, bool aktiv, int64_t flankeUs) {
+  int httpCode = -1;
+  for (int versuch = 1; versuch <= SHELLY_VERSUCHE; versuch++) {
+    httpCode = wallbox.shelly.get(aktiv ? wallbox.konfig->urlOn : wallbox.konfig->urlOff, HTTP_BUDGET_SHELLY_MS);
+    wallbox.shelly.beenden();
+    if (httpCode >= 0) {
+      break;  // Antwort erhalten, auch ein Fehlercode wird nicht wiederholt
+    }
+    logSchreiben(LOG_WARNUNG, "%s Shelly: Versuch %d ohne Antwort (%d)", wallbox.konfig->name, versuch, httpCode);
+  }
+  int64_t latenzUs = esp_timer_get_time() - flankeUs;
+  wallbox.shellyHttpCode = httpCode;
+  wallbox.shellyLatenzUs = latenzUs;
+  wallbox.shellyOffen    = (httpCode != HTTP_CODE_OK);
+  logSchreiben(httpCode == HTTP_CODE_OK ? LOG_INFO : LOG_FEHLER, "%s Shelly: HTTP Antwort %d nach %ldms",
+               wallbox.konfig->name, httpCode, (long)(latenzUs / 1000));
+}
+
+/*****************************************************************
+* @brief Shelly-Task einer weiteren Wallbox: wartet auf den Auftrag
+*        des aktorTask, damit alle Shellys gleichzeitig schalten
+* @param parameter Zeiger auf die Wallbox
+******************************************************************/
+void shellyTask(void* parameter) {
+  Wallbox& wallbox = *(Wallbox*)parameter;
+  const EventBits_t bit = 1 << (&wallbox - wallboxen);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    shellySchalten(wallbox, shellyAuftragAktiv, shellyAuftragUs);
+    xEventGroupSetBits(shellyFertig, bit);
+  }
+}
+
+/*****************************************************************
+* @brief Schaltet alle Shellys mit offenem Befehl gleichzeitig: die
+*        weiteren über ihre Shelly-Tasks, die erste direkt (ohne Umweg
+*        über einen Task)
+* @param aktiv Sollzustand
+* @param flankeUs RSE Flanke des Befehls, ab der die Latenz zählt
+* @param httpCode Zusammenfassung: der erste Fehler, sonst HTTP 200
+* @param latenzUs Zusammenfassung: die langsamste Shelly
+******************************************************************/
+void shellysSchalten(bool aktiv, int64_t flankeUs, int& httpCode, int64_t& latenzUs) {
+  EventBits_t warten = 0;
+  shellyAuftragAktiv = aktiv;
+  shellyAuftragUs    = flankeUs;
+  for (int k = 1; k < WALLBOX_ANZAHL; k++) {
+    if (wallboxen[k].shellyOffen) {
+      warten |= (EventBits_t)1 << k;
+    }
+  }
+  xEventGroupClearBits(shellyFertig, warten);
+  for (int k = 1; k < WALLBOX_ANZAHL; k++) {
+    if (warten & ((EventBits_t)1 << k)) {
+      wallboxen[k].shellyHttpCode = -1;  // bleibt so, falls keine Antwort kommt
+      wallboxen[k].shellyLatenzUs = 0;
+      xTaskNotifyGive(wallboxen[k].shellyTask);
+    }
+  }
+  if (wallboxen[0].shellyOffen) {
+    shellySchalten(wallboxen[0], aktiv, flankeUs);
+  }
+  if (warten != 0) {
+    xEventGroupWaitBits(shellyFertig, warten, pdTRUE, pdTRUE, pdMS_TO_TICKS(SHELLY_WARTEN_MS));
+  }
+
+  // Zusammenfassung: die langsamste Shelly zählt, gemeldet wird der erste Fehler
+  httpCode = HTTP_CODE_OK;
+  latenzUs = 0;
+  for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+    latenzUs = max(latenzUs, (int64_t)wallboxen[k].shellyLatenzUs);
+    if (httpCode == HTTP_CODE_OK) {
+      httpCode = wallboxen[k].shellyHttpCode;
+    }
+  }
+  aktorHttpCode = httpCode;
+  aktorLatenzUs = latenzUs;
+  if (latenzUs > aktorLatenzMaxUs) {
+    aktorLatenzMaxUs = latenzUs;
+  }
+}
+
+/*****************************************************************
+* @return true, wenn keine Shelly einen offenen Schaltbefehl hat
+******************************************************************/
+bool shellysBestaetigt() {
+  for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+    if (wallboxen[k].shellyOffen) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*****************************************************************
+* @brief Wiederholt den offenen Schaltbefehl an den Shellys, die ihn
+*        noch nicht bestätigt haben, und plant die nächste Wiederholung
+*        (doppelter Abstand bis SHELLY_NACHHOLEN_MAX_MS). Nach
+*        SHELLY_FRIST_MS zählt der Befehl einmal als fehlgeschlagen.
+* @param aktiv Sollzustand
+******************************************************************/
+void shellyNachholen(bool aktiv) {
+  if (WiFi.status() == WL_CONNECTED) {
+    for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+      if (wallboxen[k].shellyOffen) {
+        wallboxen[k].shellyNachgeholt++;
+      }
+    }
+    int httpCode;
+    int64_t latenzUs;
+    shellysSchalten(aktiv, shellyBefehlUs, httpCode, latenzUs);
+  }
+  int64_t jetztUs = esp_timer_get_time();
+  long offenS = (long)((jetztUs - shellyBefehlUs) / 1000000);
+  if (shellysBestaetigt()) {
+    logSchreiben(LOG_INFO, "Shelly: Schaltbefehl %s nach %lds bestätigt", aktiv ? "EIN" : "AUS", offenS);
+    shellyNachholenUs = 0;
+    return;
+  }
+  if (!shellyFristGemeldet && jetztUs - shellyBefehlUs >= SHELLY_FRIST_MS * 1000LL) {
+    shellyFristGemeldet = true;
+    for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+      if (wallboxen[k].shellyOffen) {
+        wallboxen[k].shellyFehlgeschlagen++;
+        logSchreiben(LOG_FEHLER, "%s Shelly: Schaltbefehl %s seit %lds nicht bestätigt", wallboxen[k].konfig->name,
+                     aktiv ? "EIN" : "AUS", offenS);
+      }
+    }
+  }
+  shellyNachholenMs = min(shellyNachholenMs * 2, (uint32_t)SHELLY_NACHHOLEN_MAX_MS);
+  shellyNachholenUs = jetztUs + shellyNachholenMs * 1000LL;
+}
+
+/*****************************************************************
+* @brief Aktor-Task: schaltet die Shelly bei jedem RSE Flankenwechsel.
+*        Läuft auf Core 1 vor loop() (siehe AKTOR_TASK_CORE) und wird von isrRSE()
+*        per Task Notification geweckt. Damit hängt die Zeit von der
+*        RSE Flanke bis zum Schaltbefehl nicht mehr von loop() ab
+*        (OLED, Webserver oder SmartWB Abfrage).
+*        Der Task leert den RSE Ringpuffer und entprellt: ein neuer Pegel
+*        gilt erst, wenn er RSE_ENTPRELL_MS lang stabil anliegt.
+*        Bei mehreren Wallboxen schalten deren Shelly-Tasks parallel
+*        zur ersten Shelly, die der aktorTask selbst schaltet.
+*        Bis alle Shellys mit HTTP 200 bestätigt haben, bleibt der Befehl
+*        offen und wird wiederholt (shellyNachholen()).
+* @param parameter wird nicht benutzt
+******************************************************************/
+void aktorTask(void* parameter) {
+  bool letzterAktorStatus = !RSEAktiv;  // erzwingt beim Start einmal den aktuellen Zustand an der Shelly
+  bool kandidat = RSEAktiv;             // zuletzt gesehener Rohpegel
+  int64_t kandidatUs = 0;               // seit wann der Rohpegel anliegt
+
+  for (;;) {
+    // Ringpuffer leeren
+    uint32_t schwanz = rseSchwanz.load(std::memory_order_relaxed);
+    uint32_t kopf    = rseKopf.load(std::memory_order_acquire);
+    while (schwanz != kopf) {
+      RseEreignis e = rsePuffer[schwanz & (RSE_PUFFER_GROESSE - 1)];
+      schwanz++;
+      if (e.aktiv != kandidat) {
+        // Rückkehr zum gültigen Zustand bevor der neue stabil war -> Störimpuls
+        if (e.aktiv == letzterAktorStatus && kandidat != letzterAktorStatus) {
+          rseStoerimpulse++;
+        }
+        kandidat   = e.aktiv;
+        kandidatUs = e.zeitUs;
+      }
+    }
+    rseSchwanz.store(schwanz, std::memory_order_release);
+#ifdef USE_RSE_SIMULATION
+    // Nach der Simulation steht im Ringpuffer noch der simulierte Pegel. Der echte wird hier
+    // gelesen und nicht in simSchritt() abgelegt, sonst gäbe es neben der ISR einen zweiten Schreiber.
+    // Die ISR hängt schon wieder, spätere Flanken kommen also wie gewohnt über den Ringpuffer.
+    if (simPegelAbgleich) {
+      simPegelAbgleich = false;
+      bool pegel = (digitalRead(RSE) == LOW);
+      if (pegel != kandidat) {
+        kandidat   = pegel;
+        kandidatUs = esp_timer_get_time();
+      }
+    }
+#endif
+
+    // Noch nicht lange genug stabil? Dann bis zum Ende der Entprellzeit warten.
+    if (kandidat != letzterAktorStatus) {
+      int64_t restUs = kandidatUs + RSE_ENTPRELL_US - esp_timer_get_time();
+      if (restUs > 0) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(restUs / 1000) + 1);
+        continue;
+      }
+    }
+
+    if (kandidat != letzterAktorStatus) {
+      bool aktiv = kandidat;
+      int64_t flankeUs = kandidatUs;
+      letzterAktorStatus = aktiv;
+      RSEAktiv = aktiv;
+      abrechnungRseFlanke(aktiv, flankeUs);
+      logSchreiben(LOG_INFO, aktiv ? "RSE wurde AKTIV → Power ON" : "RSE wurde INAKTIV → Power OFF");
+
+      // Neuer Sollzustand für alle Shellys, ein noch offener Befehl ist damit abgelöst
+      for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+        wallboxen[k].shellyOffen = true;
+      }
+      shellyBefehlUs      = flankeUs;
+      shellyNachholenMs   = SHELLY_NACHHOLEN_MS;
+      shellyFristGemeldet = false;
+
+      int httpCode = -1;
+      int64_t latenzUs = 0;
+      if (WiFi.status() == WL_CONNECTED) {
+        shellysSchalten(aktiv, flankeUs, httpCode, latenzUs);
+      }
+      shellyNachholenUs = shellysBestaetigt() ? 0 : esp_timer_get_time() + shellyNachholenMs * 1000LL;
+#ifdef USE_RSE_SIMULATION
+      if (simShellyOffen && flankeUs >= simFlankeUs) {
+        simShellyOffen = false;
+        simProbe(simShelly, latenzUs);
+        if (httpCode != HTTP_CODE_OK) {
+          simShelly.fehler++;
+        }
+      }
+#endif
+
+      // Ins Journal (geschrieben wird in loop(), hier nur in die Queue)
+      if (journalQueue != NULL) {
+        struct timeval jetzt;
+        gettimeofday(&jetzt, NULL);
+        int64_t flankeUnixMs = (int64_t)jetzt.tv_sec * 1000 + jetzt.tv_usec / 1000 - (esp_timer_get_time() - flankeUs) / 1000;
+        JournalEintrag eintrag;
+        eintrag.zeit     = flankeUnixMs / 1000;
+        eintrag.ms       = flankeUnixMs % 1000;
+        eintrag.aktiv    = aktiv;
+        eintrag.httpCode = httpCode;
+        eintrag.latenzUs = latenzUs;
+        xQueueSend(journalQueue, &eintrag, 0);
+      }
+      if (hauptTaskHandle != NULL) {
+        xTaskNotifyGive(hauptTaskHandle);  // loop() zeigt die Flanke sofort an und fragt die SmartWB ab
+      }
+    } else if (shellyNachholenUs != 0 && esp_timer_get_time() >= shellyNachholenUs) {
+      shellyNachholen(letzterAktorStatus);
+    }
+
+    // Auf die nächste Flanke warten, höchstens bis zur nächsten Wiederholung eines offenen Befehls.
+    // Kam während des GET schon eine Flanke, kehrt der Aufruf sofort zurück.
+    TickType_t warten = portMAX_DELAY;
+    if (shellyNachholenUs != 0) {
+      int64_t restUs = shellyNachholenUs - esp_timer_get_time();
+      warten = restUs > 0 ? pdMS_TO_TICKS(restUs / 1000) + 1 : 0;
+    }
+    ulTaskNotifyTake(pdTRUE, warten);
+  }
+}
+
+/*****************************************************************
+* @brief JSON Filter für /getParameters: nur die 11 Felder aus list[0],
+*        die wir auch anzeigen. Wird einmalig aufgebaut.
+* @return Filterdokument für deserializeJson()
+******************************************************************/
+const JsonDocument& getSmartWBFilter() {
+  static StaticJsonDocument<256> filter;
+  if (filter.isNull()) {
+    JsonObject f = filter["list"].createNestedObject();  // Filter für list[0] gilt für alle Elemente
+    f["vehicleState"]  = true;
+    f["evseState"]     = true;
+    f["maxCurrent"]    = true;
+    f["actualCurrent"] = true;
+    f["actualPower"]   = true;
+    f["currentP1"]     = true;
+    f["currentP2"]     = true;
+    f["currentP3"]     = true;
+    f["voltageP1"]     = true;
+    f["voltageP2"]     = true;
+    f["voltageP3"]     = true;
+  }
+  return filter;
+}
+
+/*****************************************************************
+* @brief Die angezeigten Werte aus list[0] der /getParameters Antwort
+******************************************************************/
+void smartWBWerteLesen(JsonObjectConst obj, WallboxWerte& werte) {
+  werte.vehicleState  = obj["vehicleState"];
+  werte.evseState     = obj["evseState"];
+  werte.maxCurrent    = obj["maxCurrent"];
+  werte.actualCurrent = obj["actualCurrent"];
+  werte.actualPower   = obj["actualPower"];
+  werte.currentP1     = obj["currentP1"];
+  werte.currentP2     = obj["currentP2"];
+  werte.currentP3     = obj["currentP3"];
+  werte.voltageP1     = obj["voltageP1"];
+  werte.voltageP2     = obj["voltageP2"];
+  werte.voltageP3     = obj["voltageP3"];
+}
+
+/*****************************************************************
+* @brief SmartWB JSON auslesen & Werte zuweisen
+*        Das JSON wird direkt aus dem Stream gelesen und gefiltert,
+*        so wird weder die ganze Antwort als String kopiert noch
+*        mehr als ein paar hundert Bytes Dokument benötigt.
+*        Läuft im Abfrage-Task der Wallbox.
+* @param wallbox welche Wallbox (URL und Verbindung)
+* @param werte Ziel, httpCode wird immer gesetzt. Ist die SmartWB
+*        OFFLINE, werden die Messwerte auf 0 gesetzt.
+******************************************************************/
+void getSmartWBParameters(Wallbox& wallbox, WallboxWerte& werte) {
+  const char* name = wallbox.konfig->name;
+  werte.httpCode = -1;
+  if (WiFi.status() == WL_CONNECTED) {
+    uint32_t heapVorher = ESP.getFreeHeap();
+    werte.httpCode = wallbox.smartWB.get(wallbox.konfig->urlParam, HTTP_BUDGET_MS);
+    HTTPClient& http = wallbox.smartWB.http();
+
+    if (werte.httpCode == HTTP_CODE_OK) {
+      StaticJsonDocument<384> doc;
+      DeserializationError error;
+      if (http.getSize() >= 0) {
+        // Content-Length bekannt: direkt aus dem Stream, die Verbindung bleibt dabei offen
+        error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(getSmartWBFilter()));
+      } else {
+        // chunked Antwort: getString() entfernt die Chunk-Header
+        error = deserializeJson(doc, http.getString(), DeserializationOption::Filter(getSmartWBFilter()));
+      }
+
+      // Verbindung und Dokument leben hier noch: das ist der Spitzenwert der Abfrage
+      uint32_t heapJetzt = ESP.getFreeHeap();
+      uint32_t heapBelegt = (heapVorher > heapJetzt) ? heapVorher - heapJetzt : 0;
+
+      if (!error) {
+        smartWBWerteLesen(doc["list"][0], werte);
+
+        // Ausgabe
+        logSchreiben(LOG_INFO, "%s Parameter aktualisiert: maxCurrent %d, actualCurrent %d, actualPower %.2f",
+                     name, werte.maxCurrent, werte.actualCurrent, werte.actualPower);
+        logSchreiben(LOG_DEBUG, "%s Heap belegt: %u Bytes, Stack frei (min): %u Bytes", name, heapBelegt, uxTaskGetStackHighWaterMark(NULL));
+      } else {
+        logSchreiben(LOG_FEHLER, "%s JSON Fehler: %s", name, error.c_str());
+      }
+
+    } else {
+      logSchreiben(LOG_FEHLER, "%s HTTP Fehler: %d", name, werte.httpCode);
+    }
+
+    wallbox.smartWB.beenden();
+  } else {
+    logSchreiben(LOG_WARNUNG, "WLAN nicht verbunden!");
+  }
+
+  if (werte.httpCode < 0) {
+    // SmartWB (evse) ist nicht erreichbar, alle anzuzeigenden Werte auf 0 setzen
+    werte.actualPower   = 0.0;
+    werte.actualCurrent = 0;
+    werte.maxCurrent    = 0;
+    werte.evseState     = false;
+    werte.voltageP1     = 0;
+    werte.voltageP2     = 0;
+    werte.voltageP3     = 0;
+    werte.currentP1     = 0.0;
+    werte.currentP2     = 0.0;
+    werte.currentP3     = 0.0;
+  }
+}
+
+/*****************************************************************
+* @brief Abfrage-Task einer Wallbox: fragt die SmartWB ab, sobald
+*        aufgabeSmartWB() ihn weckt. Alle Wallboxen werden so
+*        gleichzeitig abgefragt und loop() wartet nie auf HTTP.
+* @param parameter Zeiger auf die Wallbox
+******************************************************************/
+void wallboxAbfrageTask(void* parameter) {
+  Wallbox& wallbox = *(Wallbox*)parameter;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    WallboxWerte werte;
+    portENTER_CRITICAL(&wallboxMux);
+    werte = wallbox.neu;  // vehicleState bleibt bei OFFLINE erhalten
+    portEXIT_CRITICAL(&wallboxMux);
+
+    getSmartWBParameters(wallbox, werte);
+
+    portENTER_CRITICAL(&wallboxMux);
+    wallbox.neu = werte;
+    wallbox.neuVorhanden = true;
+    portEXIT_CRITICAL(&wallboxMux);
+    if (hauptTaskHandle != NULL) {
+      xTaskNotifyGive(hauptTaskHandle);
+    }
+  }
+}
+
+/*****************************************************************
+* @brief Tasks der Wallboxen starten (Shelly ab der zweiten, SmartWB
+*        Abfrage für alle)
+******************************************************************/
+void wallboxenStarten() {
+  getSmartWBFilter();  // Filter einmal aufbauen, bevor mehrere Tasks ihn benutzen
+  shellyFertig = xEventGroupCreate();
+  for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+    Wallbox& wallbox = wallboxen[k];
+    wallbox.konfig = &WALLBOX_KONFIG[k];
+    xTaskCreatePinnedToCore(wallboxAbfrageTask, "smartwb", WALLBOX_TASK_STACK, &wallbox, 1, &wallbox.abfrageTask, WALLBOX_TASK_CORE);
+    if (k > 0) {
+      xTaskCreatePinnedToCore(shellyTask, "shelly", WALLBOX_TASK_STACK, &wallbox, AKTOR_TASK_PRIO, &wallbox.shellyTask, AKTOR_TASK_CORE);
+    }
+  }
+}
+
+/*****************************************************************
+* @brief Von loop(): neue Werte der Abfrage-Tasks übernehmen
+* @return Bit n gesetzt = Wallbox n hat neue Werte
+******************************************************************/
+uint32_t wallboxenUebernehmen() {
+  uint32_t neu = 0;
+  for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+    Wallbox& wallbox = wallboxen[k];
+    portENTER_CRITICAL(&wallboxMux);
+    if (wallbox.neuVorhanden) {
+      wallbox.werte = wallbox.neu;
+      wallbox.neuVorhanden = false;
+      neu |= 1 << k;
+    }
+    portEXIT_CRITICAL(&wallboxMux);
+  }
+  return neu;
+}
+
+/*****************************************************************
+* @brief Zeichnet einen Fortschrittsbalken auf dem OLED-Display.
+* @param progress Der aktuelle Fortschritt in Prozent (0-100).
+* @param ziel OLED oder ein anderer Zeichenpuffer (Benchmark)
+******************************************************************/
+void drawProgressBar(int progress, Adafruit_GFX& ziel = display) {
+  // Stellen Sie sicher, dass der Wert im Bereich 0-100 liegt
+  progress = constrain(progress, 0, 100);
+
+  // Lösche den Bereich des Fortschrittsbalkens, um ihn neu zu zeichnen
+  // Zeile 3 liegt bei 24 Pixeln, da jede Textzeile (Größe 1) 8 Pixel hoch ist.
+  // Zeile 1: Y=0, Zeile 2: Y=8, Zeile 3: Y=16, Zeile 4: Y=24, etc.
+  #ifdef OLED_TYPE_SSD1306
+  ziel.fillRect(0, 16, SCREEN_WIDTH, 8, SSD1306_BLACK);
+  #else 
+  ziel.fillRect(0, 16, SCREEN_WIDTH, 8, SH110X_BLACK);
+  #endif
+  // Berechne die Breite des gefüllten Balkens
+  // Da der Balken über die gesamte Breite des Displays (128 Pixel) gehen soll.
+  int filledWidth = map(progress, 0, 100, 0, SCREEN_WIDTH - 2); 
+
+  // Zeichne den leeren Rahmen des Fortschrittsbalkens
+  #ifdef OLED_TYPE_SSD1306
+  ziel.drawRect(0, 16, SCREEN_WIDTH - 1, 8, SSD1306_WHITE);
+  #else 
+  ziel.drawRect(0, 16, SCREEN_WIDTH - 1, 8, SH110X_WHITE);
+  #endif
+
+  // Zeichne den gefüllten Teil des Fortschrittsbalkens
+  #ifdef OLED_TYPE_SSD1306
+  ziel.fillRect(1, 17, filledWidth, 6, SSD1306_WHITE);
+  #else 
+  ziel.fillRect(1, 17, filledWidth, 6, SH110X_WHITE);
+  #endif
+
+  // Schreibe den Prozentwert in die Mitte des Balkens
+  String progressText = String(progress) + "%";
+  int textWidth = progressText.length() * 6; // Jedes Zeichen ist 6 Pixel breit
+  int textX = (SCREEN_WIDTH - textWidth) / 2;
+  int textY = 16 + 1; // 1 Pixel Abstand vom Rand
+
+  #ifdef OLED_TYPE_SSD1306
+  ziel.setTextColor(SSD1306_BLACK, SSD1306_WHITE); // Schwarzer Text auf weißem Hintergrund
+  #else 
+  ziel.setTextColor(SH110X_BLACK, SH110X_WHITE); // Schwarzer Text auf weißem Hintergrund
+  #endif
+
+  ziel.setCursor(textX, textY);
+  ziel.print(progressText);
+  // Übertragen wird mit dem display.display() am Ende von loop()
+
+  // und wieder zurück mit weiß auf schwarz
+  #ifdef OLED_TYPE_SSD1306
+  ziel.setTextColor(SSD1306_WHITE, SSD1306_BLACK); // Weißer Text auf schwarzem Hintergrund
+  #else
+  ziel.setTextColor(SH110X_WHITE, SH110X_BLACK); // Weißer Text auf schwarzem Hintergrund
+  #endif
+}
+
+#ifdef USE_EV_SOC_API
+/*****************************************************************
+* @brief SoC des EV von lokalem Webserver holen
+* @return soc in Prozent, -1 bei Fehler, SOC_VERSCHOBEN wenn das
+*         Zeitbudget nicht mehr gereicht hat
+******************************************************************/
+int getSoc() {
+  int code = verbindungSoc.get(evSocUrl, ioBudgetMs(HTTP_BUDGET_MS));
+  HTTPClient& http = verbindungSoc.http();
+  int soc = -1;
+
+  if (code == HTTP_VERSCHOBEN) {
+    soc = SOC_VERSCHOBEN;
+    logSchreiben(LOG_DEBUG, "EV SOC API: verschoben, Watchdog zu nah");
+  } else if (code == 200) {
+    DynamicJsonDocument doc(512);
+    if (deserializeJson(doc, http.getString()) == DeserializationError::Ok) {
+      if (doc["success"].as<bool>()) {
+        soc = doc["soc"].as<int>();
+      } else {
+        logSchreiben(LOG_WARNUNG, "EV SOC API: success=false");
+      }
+    } else {
+      logSchreiben(LOG_FEHLER, "EV SOC API: JSON-Parsing Fehler");
+    }
+  } else {
+    logSchreiben(LOG_FEHLER, "EV SOC API Fehler (Code: %d)", code);
+  }
+
+  verbindungSoc.beenden();
+  return soc;
+}
+#endif
+
+// Verlauf der SmartWB Messwerte im RAM, je Wallbox ein eigener Ring mit gleich vielen Blöcken
+// Aufbau: verlaufBloecke Blöcke zu je VERLAUF_BLOCK_GROESSE Bytes als Ring, der älteste Block
+// wird überschrieben. Jeder Block beginnt mit einem VerlaufKopf, der den ersten Messwert absolut
+// enthält. Danach folgen die weiteren Messwerte als Differenz zum vorherigen:
+//   varint  Sekunden seit dem vorherigen Messwert
+//   uint8   Maske, Bit n gesetzt = Wert n hat sich geändert
+//   varint  je geändertem Wert die Differenz (ZigZag-kodiert)
+// Die Werte sind Festkommazahlen: Leistung in 10W, Ladestrom in A, Phasenströme in 0,1A, Spannungen in 0,1V.
+// Gespeichert wird im festen Raster VERLAUF_INTERVALL_S, unabhängig vom Abfrageintervall: fragt der
+// Scheduler schneller ab (Laden, nach einer RSE Flanke), wird über das Raster gemittelt.
+const uint8_t VERLAUF_WERTE = 8;
+const size_t  VERLAUF_BLOCK_GROESSE = 1024;
+const size_t  VERLAUF_BLOECKE = VERLAUF_SPEICHER_KB_JE_WALLBOX * 1024 / VERLAUF_BLOCK_GROESSE;  // je Wallbox, höchstens
+const size_t  VERLAUF_MAX_EINTRAG = 5 + 1 + VERLAUF_WERTE * 3;  // größtmöglicher Eintrag in Bytes
+const size_t  VERLAUF_EINTRAG_LADEN = 10;                       // typischer Eintrag beim Laden, für die Schätzung
+struct VerlaufKopf {
+  uint32_t startZeit;               // Unix-Zeit des ersten Messwerts
+  uint16_t anzahl;                  // Messwerte im Block inkl. dem im Kopf
+  uint16_t laenge;                  // belegte Bytes inkl. Kopf
+  int16_t  werte[VERLAUF_WERTE];    // erster Messwert
+};
+uint8_t* verlaufSpeicher[WALLBOX_ANZAHL][VERLAUF_BLOECKE];  // einzeln reservierte Blöcke, siehe verlaufReservieren()
+size_t   verlaufBloecke = 0;        // je Wallbox tatsächlich reserviert, 0 = kein Verlauf
+struct Verlauf {
+  size_t   erster = 0;              // Index des ältesten Blocks
+  size_t   belegt = 0;              // Anzahl belegter Blöcke, der letzte wird gerade beschrieben
+  uint32_t entfernt = 0;            // bisher weggefallene Blöcke, erster hat die fortlaufende Nummer entfernt
+  uint32_t letzteZeit = 0;
+  int16_t  letzteWerte[VERLAUF_WERTE];
+  uint32_t raster = 0;              // Beginn des laufenden Rasters, nur loop()
+  uint16_t proben = 0;              // Messwerte im laufenden Raster
+  int32_t  summe[VERLAUF_WERTE];
+};
+Verlauf verlaeufe[WALLBOX_ANZAHL];
+portMUX_TYPE verlaufMux = portMUX_INITIALIZER_UNLOCKED;  // loop() schreibt, der Webserver-Task liest
+
+/*****************************************************************
+* @brief Zeiger auf den n-ten Block ab dem ältesten
+* @param wb Nummer der Wallbox
+******************************************************************/
+VerlaufKopf* verlaufBlock(int wb, size_t n) {
+  return (VerlaufKopf*)verlaufSpeicher[wb][(verlaeufe[wb].erster + n) % verlaufBloecke];
+}
+
+/*****************************************************************
+* @brief Reserviert die Blöcke des Verlaufs, für alle Wallboxen
+*        gleich viele. Einzelne 1 KB Blöcke statt eines großen
+*        Bereichs, der auf dem ESP32 selten am Stück frei ist. Es
+*        bleibt immer VERLAUF_HEAP_RESERVE_KB für WiFi und Webserver.
+* @return Anzahl Blöcke je Wallbox
+******************************************************************/
+size_t verlaufReservieren() {
+  const size_t reserve = (size_t)VERLAUF_HEAP_RESERVE_KB * 1024;
+  while (verlaufBloecke < VERLAUF_BLOECKE) {
+    if (heap_caps_get_free_size(MALLOC_CAP_8BIT) < reserve + WALLBOX_ANZAHL * (VERLAUF_BLOCK_GROESSE + 16)) {
+      break;
+    }
+    int wb = 0;
+    for (; wb < WALLBOX_ANZAHL; wb++) {
+      verlaufSpeicher[wb][verlaufBloecke] = (uint8_t*)malloc(VERLAUF_BLOCK_GROESSE);
+      if (verlaufSpeicher[wb][verlaufBloecke] == NULL) {
+        break;
+      }
+    }
+    if (wb < WALLBOX_ANZAHL) {
+      while (wb-- > 0) {
+        free(verlaufSpeicher[wb][verlaufBloecke]);
+        verlaufSpeicher[wb][verlaufBloecke] = NULL;
+      }
+      break;
+    }
+    verlaufBloecke++;
+  }
+  return verlaufBloecke;
+}
+
+/*****************************************************************
+* @brief Geschätzte Dauer in s, die der volle Ring beim Laden hält
+*        (jeder Eintrag VERLAUF_EINTRAG_LADEN Bytes)
+******************************************************************/
+uint32_t verlaufReichtLadenS() {
+  size_t proBlock = (VERLAUF_BLOCK_GROESSE - sizeof(VerlaufKopf) - VERLAUF_MAX_EINTRAG / 2) / VERLAUF_EINTRAG_LADEN + 1;
+  return verlaufBloecke * proBlock * VERLAUF_INTERVALL_S;
+}
+
+/*****************************************************************
+* @brief Schreibt eine Zahl als varint (7 Bit pro Byte)
+* @return Anzahl geschriebener Bytes
+******************************************************************/
+size_t varintSchreiben(uint8_t* ziel, uint32_t wert) {
+  size_t n = 0;
+  while (wert >= 0x80) {
+    ziel[n++] = (wert & 0x7F) | 0x80;
+    wert >>= 7;
+  }
+  ziel[n++] = wert;
+  return n;
+}
+
+/*****************************************************************
+* @brief Liest eine varint Zahl
+* @return Anzahl gelesener Bytes
+******************************************************************/
+size_t varintLesen(const uint8_t* quelle, uint32_t& wert) {
+  size_t n = 0;
+  uint8_t verschiebung = 0;
+  wert = 0;
+  do {
+    wert |= (uint32_t)(quelle[n] & 0x7F) << verschiebung;
+    verschiebung += 7;
+  } while (quelle[n++] & 0x80);
+  return n;
+}
+
+/*****************************************************************
+* @brief Aktuelle Messwerte als Festkommazahlen
+******************************************************************/
+void verlaufWerteErfassen(const WallboxWerte& wb, int16_t* werte) {
+  werte[0] = lroundf(wb.actualPower * 100);  // kW -> 10W
+  werte[1] = wb.actualCurrent;
+  werte[2] = lroundf(wb.currentP1 * 10);
+  werte[3] = lroundf(wb.currentP2 * 10);
+  werte[4] = lroundf(wb.currentP3 * 10);
+  werte[5] = lroundf(wb.voltageP1 * 10);
+  werte[6] = lroundf(wb.voltageP2 * 10);
+  werte[7] = lroundf(wb.voltageP3 * 10);
+}
+
+/*****************************************************************
+* @brief Schreibt einen Eintrag in den Ring der Wallbox
+* @param wb Nummer der Wallbox
+* @param zeit Unix-Zeit des Eintrags
+* @param werte VERLAUF_WERTE Festkommawerte
+******************************************************************/
+void verlaufAnhaengen(int wb, uint32_t zeit, const int16_t* werte) {
+  Verlauf& verlauf = verlaeufe[wb];
+  portENTER_CRITICAL(&verlaufMux);
+  VerlaufKopf* block = (verlauf.belegt > 0) ? verlaufBlock(wb, verlauf.belegt - 1) : NULL;
+  if (block == NULL || block->laenge + VERLAUF_MAX_EINTRAG > VERLAUF_BLOCK_GROESSE || zeit < verlauf.letzteZeit) {
+    // Neuer Block, ist alles belegt fällt der älteste weg
+    if (verlauf.belegt == verlaufBloecke) {
+      verlauf.erster = (verlauf.erster + 1) % verlaufBloecke;
+      verlauf.entfernt++;
+    } else {
+      verlauf.belegt++;
+    }
+    block = verlaufBlock(wb, verlauf.belegt - 1);
+    block->startZeit = zeit;
+    block->anzahl = 1;
+    block->laenge = sizeof(VerlaufKopf);
+    memcpy(block->werte, werte, sizeof(block->werte));
+  } else {
+    uint8_t* ziel = (uint8_t*)block + block->laenge;
+    size_t n = varintSchreiben(ziel, zeit - verlauf.letzteZeit);
+    uint8_t& maske = ziel[n++];
+    maske = 0;
+    for (uint8_t k = 0; k < VERLAUF_WERTE; k++) {
+      int32_t differenz = werte[k] - verlauf.letzteWerte[k];
+      if (differenz != 0) {
+        maske |= 1 << k;
+        n += varintSchreiben(ziel + n, ((uint32_t)differenz << 1) ^ (uint32_t)(differenz >> 31));  // ZigZag
+      }
+    }
+    block->laenge += n;
+    block->anzahl++;
+  }
+  verlauf.letzteZeit = zeit;
+  memcpy(verlauf.letzteWerte, werte, sizeof(verlauf.letzteWerte));
+  portEXIT_CRITICAL(&verlaufMux);
+}
+
+/*****************************************************************
+* @brief Nimmt die aktuellen SmartWB Messwerte in den Verlauf auf.
+*        Je Raster VERLAUF_INTERVALL_S wird ein Mittelwert mit der
+*        Zeit des Rasterbeginns gespeichert, sobald der erste Wert
+*        des nächsten Rasters kommt. Ohne gültige Uhrzeit wird nichts
+*        gespeichert.
+* @param wb Nummer der Wallbox
+******************************************************************/
+void verlaufHinzufuegen(int wb) {
+  uint32_t zeit = time(NULL);
+  if (verlaufBloecke == 0 || zeit < ZEIT_GUELTIG_AB) {
+    return;
+  }
+  Verlauf& verlauf = verlaeufe[wb];
+  uint32_t raster = zeit - zeit % VERLAUF_INTERVALL_S;
+  if (verlauf.proben > 0 && raster != verlauf.raster) {
+    int16_t mittel[VERLAUF_WERTE];
+    for (uint8_t k = 0; k < VERLAUF_WERTE; k++) {
+      int32_t halbe = (verlauf.summe[k] < 0) ? -(verlauf.proben / 2) : verlauf.proben / 2;  // runden
+      mittel[k] = (verlauf.summe[k] + halbe) / verlauf.proben;
+    }
+    verlaufAnhaengen(wb, verlauf.raster, mittel);
+    verlauf.proben = 0;
+  }
+  if (verlauf.proben == 0) {
+    verlauf.raster = raster;
+    memset(verlauf.summe, 0, sizeof(verlauf.summe));
+  }
+  int16_t werte[VERLAUF_WERTE];
+  verlaufWerteErfassen(wallboxen[wb].werte, werte);
+  for (uint8_t k = 0; k < VERLAUF_WERTE; k++) {
+    verlauf.summe[k] += werte[k];
+  }
+  verlauf.proben++;
+}
+
+// Antworten des AsyncWebServers. Die Handler laufen im async_tcp Task und dürfen dort nicht
+// warten, bis ein langsamer Browser seine Daten abgeholt hat. Deshalb wird keine Antwort am
+// Stück geschrieben: der Server holt sie per beginChunkedResponse() stückweise ab, sobald TCP
+// wieder Platz hat. Jede Antwort ist ein kleiner Zustandsautomat, schritt() erzeugt über
+// sendeFormatiert()/sendeText() das nächste Stück und liefert nach dem letzten false.
+// So laufen mehrere Anfragen nebeneinander, jede mit festem Speicher (puffer und ihr Zustand).
+const size_t  WEB_PUFFER_GROESSE = 1536;  // größter Schritt: Kopf und Ladedaten einer Wallbox
+const uint8_t WEB_MAX_ANTWORTEN  = 8;     // gleichzeitig laufende Antworten, danach 503
+uint8_t webAntworten = 0;                 // laufende Antworten, nur im async_tcp Task
+
+struct WebAntwort {
+  WebAntwort()          { webAntworten++; }
+  virtual ~WebAntwort() { webAntworten--; }
+  // nächstes Stück erzeugen, false = das war das letzte
+  virtual bool schritt() = 0;
+  size_t fuellen(uint8_t* ziel, size_t maxLaenge);
+
+  char        puffer[WEB_PUFFER_GROESSE];
+  size_t      belegt = 0;       // formatierter Text in puffer
+  const char* text = NULL;      // danach ein langer Text ohne Kopie, siehe sendeText()
+  size_t      textLaenge = 0;
+  size_t      gelesen = 0;      // davon schon an den Server übergeben
+  bool        letzter = false;
+};
+WebAntwort* webAusgabe = NULL;  // Antwort, deren Schritt gerade läuft (Ziel von sendeFormatiert)
+
+/*****************************************************************
+* @brief Füller für beginChunkedResponse(): gibt das aktuelle Stück
+*        weiter und erzeugt das nächste erst, wenn es ganz abgeholt ist
+* @return Anzahl Bytes, 0 = Ende der Antwort
+******************************************************************/
+size_t WebAntwort::fuellen(uint8_t* ziel, size_t maxLaenge) {
+  while (gelesen == belegt + textLaenge) {  // Schritte ohne Ausgabe überspringen
+    if (letzter) {
+      return 0;
+    }
+    belegt = gelesen = textLaenge = 0;
+    text = NULL;
+    int64_t startUs = esp_timer_get_time();
+    webAusgabe = this;
+    letzter = !schritt();
+    webAusgabe = NULL;
+    metrikWebSchritt.erfassen(esp_timer_get_time() - startUs);
+  }
+  size_t n;
+  if (gelesen < belegt) {
+    n = min(maxLaenge, belegt - gelesen);
+    memcpy(ziel, puffer + gelesen, n);
+  } else {
+    n = min(maxLaenge, belegt + textLaenge - gelesen);
+    memcpy(ziel, text + (gelesen - belegt), n);
+  }
+  gelesen += n;
+  return n;
+}
+
+/*****************************************************************
+* @brief Formatiert in den Puffer der Antwort, deren Schritt gerade
+*        läuft. Mehr als WEB_PUFFER_GROESSE Bytes je Schritt werden
+*        abgeschnitten.
+* @param format printf-Format, weitere Parameter wie bei printf
+******************************************************************/
+void sendeFormatiert(const char* format, ...) {
+  WebAntwort* antwort = webAusgabe;
+  if (antwort->text != NULL) {
+    logSchreiben(LOG_FEHLER, "Web: Ausgabe nach einem langen Text im selben Schritt");
+    return;
+  }
+  size_t frei = sizeof(antwort->puffer) - antwort->belegt;
+  va_list args;
+  va_start(args, format);
+  int laenge = vsnprintf(antwort->puffer + antwort->belegt, frei, format, args);
+  va_end(args);
+  if (laenge < 0) {
+    return;
+  }
+  if ((size_t)laenge >= frei) {
+    logSchreiben(LOG_FEHLER, "Web: Schritt größer als %u Bytes, abgeschnitten", (unsigned)sizeof(antwort->puffer));
+    laenge = (frei > 0) ? frei - 1 : 0;
+  }
+  antwort->belegt += laenge;
+}
+
+/*****************************************************************
+* @brief Hängt einen Text an die laufende Antwort. Was noch in den
+*        Puffer passt, wird kopiert. Längere Texte (statische Teile
+*        der Statusseite, Verlaufsblöcke) werden nur referenziert:
+*        sie müssen bis zum nächsten Schritt gültig bleiben und das
+*        Letzte im Schritt sein.
+******************************************************************/
+void sendeText(const char* text, size_t laenge) {
+  WebAntwort* antwort = webAusgabe;
+  if (antwort->text == NULL && laenge < sizeof(antwort->puffer) - antwort->belegt) {
+    memcpy(antwort->puffer + antwort->belegt, text, laenge);
+    antwort->belegt += laenge;
+  } else if (antwort->text == NULL) {
+    antwort->text = text;
+    antwort->textLaenge = laenge;
+  } else {
+    logSchreiben(LOG_FEHLER, "Web: zwei lange Texte im selben Schritt");
+  }
+}
+
+void sendeText(const char* text) {
+  sendeText(text, strlen(text));
+}
+
+// Antwort, die außer der Schrittnummer keinen Zustand braucht
+struct SchrittAntwort : WebAntwort {
+  explicit SchrittAntwort(bool (*ausgabe)(int nr)) : ausgabe(ausgabe) {}
+  bool schritt() override { return ausgabe(nr++); }
+  bool (*ausgabe)(int nr);
+  int nr = 0;
+};
+
+/*****************************************************************
+* @brief Startet eine gestreamte Antwort. Der Server gibt sie frei,
+*        wenn sie fertig oder die Verbindung weg ist.
+* @param typ Content-Type
+* @param antwort mit new (std::nothrow) angelegt, darf NULL sein
+******************************************************************/
+void webAntwortSenden(AsyncWebServerRequest* request, const char* typ, WebAntwort* antwort) {
+  if (antwort == NULL || webAntworten > WEB_MAX_ANTWORTEN) {
+    delete antwort;
+    request->send(503, "text/plain", "Zu viele gleichzeitige Anfragen");
+    return;
+  }
+  std::shared_ptr<WebAntwort> halter(antwort);
+  request->send(request->beginChunkedResponse(typ, [halter](uint8_t* ziel, size_t maxLaenge, size_t index) -> size_t {
+    return halter->fuellen(ziel, maxLaenge);
+  }));
+}
+
+/*****************************************************************
+* @brief Query-Parameter als Zahl
+* @param standard wenn der Parameter fehlt
+******************************************************************/
+uint32_t webZahl(AsyncWebServerRequest* request, const char* name, uint32_t standard) {
+  return request->hasParam(name) ? strtoul(request->getParam(name)->value().c_str(), NULL, 10) : standard;
+}
+
+/*****************************************************************
+* @brief Wie weit der Verlauf einer Wallbox zurückreicht:
+*        von/bis/abgedecktS der gespeicherten Einträge, reichtS die
+*        Dauer des vollen Rings beim bisherigen Füllstand (nach dem
+*        ersten Umlauf genau abgedecktS) und reichtLadenS die Schätzung
+*        bei ununterbrochenem Laden
+* @param wb Nummer der Wallbox
+******************************************************************/
+void verlaufInfo(int wb, char* ziel, size_t groesse) {
+  const Verlauf& verlauf = verlaeufe[wb];
+  uint32_t von = 0, bis = 0;
+  uint64_t bytes = 0;
+  portENTER_CRITICAL(&verlaufMux);
+  size_t belegt = verlauf.belegt;
+  bool umgelaufen = verlauf.entfernt > 0;
+  if (belegt > 0) {
+    von = verlaufBlock(wb, 0)->startZeit;
+    bis = verlauf.letzteZeit;
+    bytes = (uint64_t)(belegt - 1) * VERLAUF_BLOCK_GROESSE + verlaufBlock(wb, belegt - 1)->laenge;
+  }
+  portEXIT_CRITICAL(&verlaufMux);
+  uint32_t abgedeckt = bis - von + (belegt > 0 ? VERLAUF_INTERVALL_S : 0);
+  uint32_t reicht = abgedeckt;
+  if (!umgelaufen && bytes > 0) {
+    reicht = (uint64_t)abgedeckt * verlaufBloecke * VERLAUF_BLOCK_GROESSE / bytes;
+  }
+  snprintf(ziel, groesse,
+           "{\"wb\":%d,\"intervallS\":%u,\"bloecke\":%u,\"bloeckeSoll\":%u,\"belegt\":%u,"
+           "\"von\":%u,\"bis\":%u,\"abgedecktS\":%u,\"reichtS\":%u,\"reichtLadenS\":%u}",
+           wb, VERLAUF_INTERVALL_S, (unsigned)verlaufBloecke, (unsigned)VERLAUF_BLOECKE, (unsigned)belegt,
+           von, bis, abgedeckt, reicht, verlaufReichtLadenS());
+}
+
+// /api/history: die Blöcke werden über ihre fortlaufende Nummer angesprochen und einzeln unter
+// der Sperre kopiert, loop() hängt währenddessen evtl. Messwerte an oder verwirft den ältesten Block
+struct VerlaufAntwort : WebAntwort {
+  uint32_t von, bis;
+  bool     binaer;
+  int      wb;
+  uint32_t nr = 0;              // nächster Block
+  bool     kopf = true;
+  uint16_t eintrag = 0;         // nächster Eintrag im kopierten Block
+  uint16_t eintraege = 0;
+  const uint8_t* quelle = NULL;
+  uint32_t zeit = 0;
+  int16_t  werte[VERLAUF_WERTE];
+  uint8_t  kopie[VERLAUF_BLOCK_GROESSE];
+
+  VerlaufAntwort(uint32_t von, uint32_t bis, bool binaer, int wb) : von(von), bis(bis), binaer(binaer), wb(wb) {}
+
+  // nächsten Block im Zeitraum nach kopie holen, false wenn keiner mehr kommt
+  bool blockLaden() {
+    const Verlauf& verlauf = verlaeufe[wb];
+    for (; verlaufBloecke > 0; nr++) {
+      portENTER_CRITICAL(&verlaufMux);
+      nr = max(nr, verlauf.entfernt);
+      size_t b = nr - verlauf.entfernt;
+      bool vorhanden = b < verlauf.belegt;
+      bool naechsterDavor = b + 1 < verlauf.belegt && verlaufBlock(wb, b + 1)->startZeit < von;
+      if (vorhanden && !naechsterDavor) {
+        memcpy(kopie, verlaufBlock(wb, b), verlaufBlock(wb, b)->laenge);
+      }
+      portEXIT_CRITICAL(&verlaufMux);
+      if (!vorhanden) {
+        return false;
+      }
+      // Block überspringen, wenn schon der nächste Block vor dem Zeitraum beginnt
+      if (naechsterDavor) {
+        continue;
+      }
+      nr++;
+      return ((VerlaufKopf*)kopie)->startZeit <= bis;
+    }
+    return false;
+  }
+
+  bool schritt() override {
+    if (kopf) {
+      kopf = false;
+      if (!binaer) {
+        sendeText(PSTR("time,actualPower_kW,actualCurrent_A,currentP1_A,currentP2_A,currentP3_A,voltageP1_V,voltageP2_V,voltageP3_V\n"));
+      }
+      return true;
+    }
+    if (binaer) {
+      // je Schritt ein Block unverändert
+      if (!blockLaden()) {
+        return false;
+      }
+      sendeText((const char*)kopie, ((VerlaufKopf*)kopie)->laenge);
+      return true;
+    }
+    // CSV: Zeilen beim Dekodieren sammeln, bis der Puffer voll ist
+    while (belegt < sizeof(puffer) - 96) {
+      if (eintrag == eintraege) {
+        if (!blockLaden()) {
+          return false;
+        }
+        VerlaufKopf* block = (VerlaufKopf*)kopie;
+        zeit = block->startZeit;
+        memcpy(werte, block->werte, sizeof(werte));
+        quelle = kopie + sizeof(VerlaufKopf);
+        eintrag = 0;
+        eintraege = block->anzahl;
+      }
+      if (eintrag++ > 0) {
+        uint32_t wert;
+        quelle += varintLesen(quelle, wert);
+        zeit += wert;
+        uint8_t maske = *quelle++;
+        for (uint8_t k = 0; k < VERLAUF_WERTE; k++) {
+          if (maske & (1 << k)) {
+            quelle += varintLesen(quelle, wert);
+            werte[k] += (int32_t)(wert >> 1) ^ -(int32_t)(wert & 1);
+          }
+        }
+      }
+      if (zeit < von || zeit > bis) {
+        continue;
+      }
+      sendeFormatiert("%u,%.2f,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                      zeit, werte[0] / 100.0, werte[1], werte[2] / 10.0, werte[3] / 10.0, werte[4] / 10.0,
+                      werte[5] / 10.0, werte[6] / 10.0, werte[7] / 10.0);
+    }
+    return true;
+  }
+};
+
+/*****************************************************************
+* @brief HTTP-Handler für /api/history?from=&to=&format=csv|bin|info&wb=
+*        from/to in Unix-Zeit (Sekunden), ohne Angabe alles.
+*        wb: Nummer der Wallbox (ab 0), ohne Angabe die erste.
+*        csv: eine Zeile je Messwert, wird beim Dekodieren gestreamt.
+*        bin: die betroffenen Blöcke unverändert (Aufbau siehe oben).
+*        info: JSON mit der tatsächlichen Dauer, siehe verlaufInfo().
+*        Die Antwort wird nie komplett im Speicher aufgebaut.
+* @param request Anfrage
+******************************************************************/
+void handleHistory(AsyncWebServerRequest* request) {
+  uint32_t wb = webZahl(request, "wb", 0);
+  if (wb >= WALLBOX_ANZAHL) {
+    request->send(404, "text/plain", "Unbekannte Wallbox");
+    return;
+  }
+  String format = request->hasParam("format") ? request->getParam("format")->value() : String();
+  if (format == "info") {
+    char info[256];
+    verlaufInfo(wb, info, sizeof(info));
+    request->send(200, "application/json", info);
+    return;
+  }
+  bool binaer = format == "bin";
+  webAntwortSenden(request, binaer ? "application/octet-stream" : "text/csv",
+                   new (std::nothrow) VerlaufAntwort(webZahl(request, "from", 0), webZahl(request, "to", UINT32_MAX), binaer, wb));
+}
+
+// Statische Teile der Statusseite, liegen als Konstanten im Flash
+static const char STATUS_KOPF[] PROGMEM =
+  "<!DOCTYPE html><html lang='de'><head>"
+  "<meta charset='UTF-8'>"
+  "<meta name='viewport' content='width=device-width, initial-scale=1.0'>"
+  "<title>SmartWB Monitor</title>"
+  // Favicon als Base64 eingebettetes PNG (32x32 Pixel, grüner Blitz auf dunklem Hintergrund)
+  // Um ein eigenes Favicon zu verwenden: Bild zu Base64 konvertieren mit z.B. https://base64.guru/converter/encode/image
+  "<link rel='icon' type='image/png' href='data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAACAAAAAgCAYAAABzenr0AAAABHNCSVQICAgIfAhkiAAAAAlwSFlzAAAA7AAAAOwBeShxvQAAABl0RVh0U29mdHdhcmUAd3d3Lmlua3NjYXBlLm9yZ5vuPBoAAAIJSURBVFiF7ZbPS1RRFMc/5707M+rYqDMWGRRBURTRpkWbFkGbINoU0SKif6BdBEHQqk0EQUG0aBMRQdCmVYsIIqJFBEEUQVEURZGN+WN8vjvnthiduXPfm3kqaO0+OJz3Pu+e7zn3xz0X/rOyBBzgC7AJ1IJSUwIrgBNgD2gDl4Ap4AewDGwBu8Ax0AQuAmuBw9cDbwFHwAxwFTgCpoF74Ax4CewAR8Ap8AS4BnQCh68HXgMOcBuYBE6AaWAMmAfWgTVgF3gNTAFXgJ3A4euBN4EjYBY4Bp4Cw8AKsAmsA9vAF+AJcBnoBU4Dh68HXgV2gHvAPPAa6ANWgQ1gA9gGdoEXwBBwGzgMHL4e+AA4AhaAR0Af8BFYAjaBbWAP+AQsAoPAHWAvcPh64GNgBxgHhoAPwEdgCfgE7AMfgEVgALgFfA8cvh5YBnaBcWAI+AQsA0vAfmDbYRE4H1h/h88zsBNFeR5FxWSi0muUoqLXvldW/TpWXveYqnR58lWfqfJOlBnT1P8K1/8K1z8JqR+E9OtL8lfz++eA/Dm8OXPzIlN5d+kkTbNdSunNUko7aZrtaq1eLaV077TU0m5Kab0U0lTTdVcppQ8opTcppamm664opbSZUlobUUpviVLaEqW09pdSekOU0lYopSX/LqXUJqW0KqW09p+U0rpfSukr//nfpQv8AJbxLmBk7cQrAAAAAElFTkSuQmCC'>"
+  "<style>"
+  "body { font-family: Arial, sans-serif; background-color: #1a1a1a; color: #ffffff; margin: 20px; }"
+  ".container { max-width: 600px; margin: 0 auto; background-color: #2a2a2a; padding: 20px; border-radius: 10px; box-shadow: 0 4px 6px rgba(0,0,0,0.3); }"
+  "h1 { text-align: center; color: #4CAF50; margin-bottom: 20px; }"
+  ".info-row { display: flex; justify-content: space-between; padding: 8px 0; border-bottom: 1px solid #444; }"
+  ".label { font-weight: bold; color: #aaa; }"
+  ".value { color: #fff; }"
+  ".status-offline { background-color: #f44336; color: white; padding: 2px 8px; border-radius: 3px; }"
+  ".status-ein { background-color: #4CAF50; color: white; padding: 2px 8px; border-radius: 3px; }"
+  ".status-aus { background-color: #ff9800; color: white; padding: 2px 8px; border-radius: 3px; }"
+  ".blink { animation: blink-animation 0.5s steps(2, start) infinite; }"
+  "@keyframes blink-animation { to { visibility: hidden; } }"
+  ".section { margin-top: 20px; }"
+  ".section-title { font-size: 1.2em; color: #4CAF50; margin-bottom: 10px; border-bottom: 2px solid #4CAF50; padding-bottom: 5px; }"
+  "</style>"
+  "</head><body>"
+  "<div class='container'>"
+  "<h1>SmartWB Monitor " VERSION "</h1>";
+
+// %s: bei mehreren Wallboxen " " + Name, sonst leer
+static const char STATUS_LADEDATEN[] PROGMEM =
+  "<div class='section'>"
+  "<div class='section-title'>Ladedaten%s</div>";
+
+static const char STATUS_PHASEN[] PROGMEM =
+  "</div>"
+  "<div class='section'>"
+  "<div class='section-title'>Phasen%s</div>";
+
+static const char STATUS_RCR[] PROGMEM =
+  "<div class='section'>"
+  "<div class='section-title'>RCR</div>";
+
+// Am Ende der Seite: Änderungen kommen per Server-Sent Events über /events und
+// werden direkt in die Elemente mit passender id geschrieben (statt Meta-Refresh).
+// Werte einer Wallbox haben die id "<feld>-<nummer>", z.B. pow-0.
+static const char STATUS_ENDE[] PROGMEM =
+  "</div>"
+  "</div>"
+  "<script>"
+  "var q=new EventSource('/events');"
+  "q.onmessage=function(m){var d=JSON.parse(m.data);for(var k in d){var v=d[k];"
+  "if(k=='rse'){document.querySelectorAll('.rse').forEach(function(e){e.style.display=(v=='1')?'':'none';});continue;}"
+  "var e=document.getElementById(k);if(!e)continue;"
+  "e.textContent=v;var t=k.split('-');"
+  "if(t[0]=='status')e.className='status-'+v.toLowerCase();"
+  "if(t[0]=='soc')document.getElementById('socrow-'+t[1]).style.display=v?'':'none';}};"
+  "</script>"
+  "</body></html>";
+
+static const char STATUS_PHASE_ZEILE[] PROGMEM =
+  "<div class='info-row'><span class='label'>U%d:</span><span class='value' id='u%d-%d'>%s</span><span class='label' style='margin-left: 20px;'>I%d:</span><span class='value' id='i%d-%d'>%s</span></div>";
+
+// Werte der Statusseite, die id wird auf der Seite und in den SSE Nachrichten verwendet.
+// Nach den allgemeinen Feldern folgen je Wallbox FELD_WB_ANZAHL Felder, siehe statusFeld().
+enum StatusFeld {
+  FELD_ZEIT, FELD_RSE, FELD_LAT, FELD_FLANKEN, FELD_SHELLY,
+  FELD_ALLGEMEIN
+};
+enum WallboxFeld {
+  FELD_STATUS, FELD_SOC, FELD_MAX, FELD_CUR, FELD_POW,
+  FELD_U1, FELD_I1, FELD_U2, FELD_I2, FELD_U3, FELD_I3,
+  FELD_WB_ANZAHL
+};
+const int FELD_ANZAHL = FELD_ALLGEMEIN + WALLBOX_ANZAHL * FELD_WB_ANZAHL;
+const char* const STATUS_FELD_ID[FELD_ALLGEMEIN] = {
+  "zeit", "rse", "lat", "flanken", "shelly"
+};
+const char* const WALLBOX_FELD_ID[FELD_WB_ANZAHL] = {
+  "status", "soc", "max", "cur", "pow",
+  "u1", "i1", "u2", "i2", "u3", "i3"
+};
+const size_t STATUS_WERT_LAENGE = 64;
+
+/*****************************************************************
+* @brief Nummer eines Wallbox-Felds in der Feldliste
+******************************************************************/
+int statusFeld(int wb, int wallboxFeld) {
+  return FELD_ALLGEMEIN + wb * FELD_WB_ANZAHL + wallboxFeld;
+}
+
+/*****************************************************************
+* @brief id eines Felds auf der Seite, Wallbox-Felder mit -<nummer>
+* @param puffer Ziel, mindestens 16 Bytes
+******************************************************************/
+void statusFeldId(int feld, char* puffer) {
+  if (feld < FELD_ALLGEMEIN) {
+    strlcpy(puffer, STATUS_FELD_ID[feld], 16);
+  } else {
+    feld -= FELD_ALLGEMEIN;
+    snprintf(puffer, 16, "%s-%d", WALLBOX_FELD_ID[feld % FELD_WB_ANZAHL], feld / FELD_WB_ANZAHL);
+  }
+}
+
+/*****************************************************************
+* @brief Formatiert einen Wert einer Wallbox als Text
+******************************************************************/
+void wallboxWertFormatieren(const WallboxWerte& wb, int feld, char* puffer) {
+  const size_t n = STATUS_WERT_LAENGE;
+  switch (feld) {
+    case FELD_STATUS:
+      if (wb.actualPower == 0.0 && wb.actualCurrent == 0 && wb.maxCurrent == 0) {
+        snprintf(puffer, n, "OFFLINE");
+      } else {
+        snprintf(puffer, n, wb.evseState ? "EIN" : "AUS");
+      }
+      break;
+    case FELD_SOC:
+      puffer[0] = '\0';  // leer = Zeile ausblenden
+#ifdef USE_EV_SOC_API
+      // SOC (nur wenn Fahrzeug angeschlossen)
+      if ((wb.vehicleState == 2 || wb.vehicleState == 3) && soc >= 0) {
+        snprintf(puffer, n, "%d%%", soc);
+      }
+#endif
+      break;
+    case FELD_MAX:     snprintf(puffer, n, "%dA", wb.maxCurrent);      break;
+    case FELD_CUR:     snprintf(puffer, n, "%dA", wb.actualCurrent);   break;
+    case FELD_POW:     snprintf(puffer, n, "%.2fkW", wb.actualPower);  break;
+    case FELD_U1:      snprintf(puffer, n, "%.1fV", wb.voltageP1);     break;
+    case FELD_I1:      snprintf(puffer, n, "%.1fA", wb.currentP1);     break;
+    case FELD_U2:      snprintf(puffer, n, "%.1fV", wb.voltageP2);     break;
+    case FELD_I2:      snprintf(puffer, n, "%.1fA", wb.currentP2);     break;
+    case FELD_U3:      snprintf(puffer, n, "%.1fV", wb.voltageP3);     break;
+    case FELD_I3:      snprintf(puffer, n, "%.1fA", wb.currentP3);     break;
+    default:           puffer[0] = '\0';                               break;
+  }
+}
+
+/*****************************************************************
+* @brief Formatiert einen Wert der Statusseite als Text
+* @param feld welcher Wert (StatusFeld oder statusFeld())
+* @param puffer Ziel, mindestens STATUS_WERT_LAENGE Bytes
+* @param werte Momentaufnahme aller Wallboxen
+******************************************************************/
+void statusWertFormatieren(int feld, char* puffer, const WallboxWerte* werte) {
+  const size_t n = STATUS_WERT_LAENGE;
+  if (feld >= FELD_ALLGEMEIN) {
+    feld -= FELD_ALLGEMEIN;
+    wallboxWertFormatieren(werte[feld / FELD_WB_ANZAHL], feld % FELD_WB_ANZAHL, puffer);
+    return;
+  }
+  switch (feld) {
+    case FELD_ZEIT:
+      snprintf(puffer, n, "%s", getZeitstempel());
+      break;
+    case FELD_RSE:
+      snprintf(puffer, n, RSEAktiv ? "1" : "0");
+      break;
+    case FELD_LAT:
+      if (aktorLatenzUs >= 0) {
+        snprintf(puffer, n, "%ldms (max %ldms, HTTP %d)", (long)(aktorLatenzUs / 1000), (long)(aktorLatenzMaxUs / 1000), aktorHttpCode);
+      } else {
+        snprintf(puffer, n, "-");
+      }
+      break;
+    case FELD_FLANKEN:
+      snprintf(puffer, n, "%u (Störimpulse %u, verloren %u)", rseFlankenRoh, rseStoerimpulse, rseUeberlauf);
+      break;
+    case FELD_SHELLY: {
+      // Schaltbefehle aller Shellys: offen seit der Flanke, wiederholt, nach der Frist fehlgeschlagen
+      uint32_t nachgeholt = 0;
+      uint32_t fehlgeschlagen = 0;
+      for (int k = 0; k < WALLBOX_ANZAHL; k++) {
+        nachgeholt     += wallboxen[k].shellyNachgeholt;
+        fehlgeschlagen += wallboxen[k].shellyFehlgeschlagen;
+      }
+      int64_t befehlUs = shellyBefehlUs;
+      if (shellyNachholenUs != 0) {
+        snprintf(puffer, n, "offen seit %lds, %u nachgeholt, %u fehlgeschlagen",
+                 (long)((esp_timer_get_time() - befehlUs) / 1000000), nachgeholt, fehlgeschlagen);
+      } else {
+        snprintf(puffer, n, "bestätigt, %u nachgeholt, %u fehlgeschlagen", nachgeholt, fehlgeschlagen);
+      }
+      break;
+    }
+    default:
+      puffer[0] = '\0';
+      break;
+  }
+}
+
+/*****************************************************************
+* @brief Sendet eine Zeile "Label: Wert" der Statusseite
+* @param label Beschriftung
+* @param feld welcher Wert, bestimmt auch die id des Elements
+* @param werte Momentaufnahme aller Wallboxen
+******************************************************************/
+void sendeZeile(const char* label, int feld, const WallboxWerte* werte) {
+  char wert[STATUS_WERT_LAENGE];
+  char id[16];
+  statusWertFormatieren(feld, wert, werte);
+  statusFeldId(feld, id);
+  sendeFormatiert("<div class='info-row'><span class='label'>%s:</span><span class='value' id='%s'>%s</span></div>", label, id, wert);
+}
+
+/*****************************************************************
+* @brief Eine Diagnosezeile mit den Zählern einer HTTP Verbindung
+* @param zusatz z.B. Name der Wallbox, darf leer sein
+******************************************************************/
+void sendeVerbindung(const HttpVerbindung& verbindung, const char* zusatz) {
+  sendeFormatiert("<div class='info-row'><span class='label'>HTTP %s%s:</span><span class='value'>%u neu, %u wiederverwendet, %u Fehler, %u DNS, %u abgebrochen, %u verschoben</span></div>",
+                  verbindung.name, zusatz, verbindung.neu, verbindung.wiederverwendet, verbindung.fehler, verbindung.dnsAnfragen,
+                  verbindung.abgebrochen, verbindung.verschoben);
+}
+
+/*****************************************************************
+* @brief Abschnitt einer Wallbox auf der Statusseite, in zwei Teilen,
+*        damit jeder in den Puffer einer Antwort passt
+* @param wb Nummer der Wallbox
+* @param teil 0 = Status und Ladedaten, 1 = Phasen
+* @param werte Momentaufnahme aller Wallboxen
+******************************************************************/
+void sendeWallbox(int wb, int teil, const WallboxWerte* werte) {
+  char wert[STATUS_WERT_LAENGE];
+  char wert2[STATUS_WERT_LAENGE];
+  char titel[24] = "";
+  if (WALLBOX_ANZAHL > 1) {
+    snprintf(titel, sizeof(titel), " %s", WALLBOX_KONFIG[wb].name);
+  }
+
+  if (teil == 1) {
+    // Spannungen und Ströme
+    sendeFormatiert(STATUS_PHASEN, titel);
+    for (int phase = 1; phase <= 3; phase++) {
+      statusWertFormatieren(statusFeld(wb, FELD_U1 + 2 * (phase - 1)), wert, werte);
+      statusWertFormatieren(statusFeld(wb, FELD_I1 + 2 * (phase - 1)), wert2, werte);
+      sendeFormatiert(STATUS_PHASE_ZEILE, phase, phase, wb, wert, phase, phase, wb, wert2);
+    }
+    sendeText("</div>");
+    return;
+  }
+
+  // SmartWB Status, die CSS-Klasse ergibt sich aus dem Text (status-offline, status-ein, status-aus)
+  statusWertFormatieren(statusFeld(wb, FELD_STATUS), wert, werte);
+  strlcpy(wert2, wert, sizeof(wert2));
+  for (char* c = wert2; *c; c++) {
+    *c = tolower(*c);
+  }
+  sendeFormatiert("<div class='info-row'><span class='label'>SmartWB%s:</span><span class='value'><span id='status-%d' class='status-%s'>%s</span></span></div>",
+                  titel, wb, wert2, wert);
+
+#ifdef USE_EV_SOC_API
+  // SOC (nur wenn Fahrzeug angeschlossen, sonst ausgeblendet)
+  statusWertFormatieren(statusFeld(wb, FELD_SOC), wert, werte);
+  sendeFormatiert("<div class='info-row' id='socrow-%d'%s><span class='label'>SOC:</span><span class='value' id='soc-%d'>%s</span></div>",
+                  wb, wert[0] ? "" : " style='display: none;'", wb, wert);
+#endif
+
+  // Stromsection
+  sendeFormatiert(STATUS_LADEDATEN, titel);
+
+  // Max Current
+  sendeZeile("Max Current", statusFeld(wb, FELD_MAX), werte);
+
+  // Actual Current (mit roter Anzeige wenn RSE aktiv)
+  statusWertFormatieren(statusFeld(wb, FELD_CUR), wert, werte);
+  sendeFormatiert("<div class='info-row'><span class='label'>Actual Current:</span><span class='value'>"
+                  "<span class='rse blink' style='color: red;%s'>RCR aktiv </span><span id='cur-%d'>%s</span></span></div>",
+                  RSEAktiv ? "" : " display: none;", wb, wert);
+
+  // Actual Power
+  sendeZeile("Actual Power", statusFeld(wb, FELD_POW), werte);
+}
+
+// Statusseite: statische Teile direkt aus dem Flash, Werte über den Puffer der Antwort.
+// Alle Abschnitte zeigen den Stand der Momentaufnahme beim Aufruf.
+struct StatusAntwort : WebAntwort {
+  WallboxWerte werte[WALLBOX_ANZAHL];
+  int nr = 0;
+
+  StatusAntwort() { webMomentaufnahme(werte); }
+
+  bool schritt() override {
+    // die Abschnitte der Reihe nach durchzählen, je Schritt einer
+    int k = 0;
+    int teil = nr++;
+    if (teil == k++) {
+      sendeText(STATUS_KOPF);
+      return true;
+    }
+    if (teil == k++) {
+      sendeZeile("Datum/Uhrzeit", FELD_ZEIT, werte);
+      IPAddress ip = WiFi.localIP();
+      sendeFormatiert("<div class='info-row'><span class='label'>IP:</span><span class='value'>%u.%u.%u.%u</span></div>", ip[0], ip[1], ip[2], ip[3]);
+      return true;
+    }
+    // je Wallbox Status, SOC, Ladedaten und Phasen
+    for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+      for (int wbTeil = 0; wbTeil < 2; wbTeil++) {
+        if (teil == k++) {
+          sendeWallbox(wb, wbTeil, werte);
+          return true;
+        }
+      }
+    }
+    if (teil == k++) {
+      // Schaltlatenz RSE Flanke -> Shelly Antwort (die langsamste Shelly)
+      sendeText(STATUS_RCR);
+      sendeZeile("RCR Latenz", FELD_LAT, werte);
+      sendeZeile("RSE Flanken", FELD_FLANKEN, werte);
+      sendeZeile("Shelly Befehle", FELD_SHELLY, werte);
+      // Diagnose, ändert sich jede Sekunde und wird daher nicht per /events verschickt
+      sendeFormatiert("<div class='info-row'><span class='label'>OLED I2C:</span><span class='value'>%u Bytes/s</span></div>", oledI2CBytesProSek);
+      return true;
+    }
+    for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+      if (teil == k++) {
+        char zusatz[24] = "";
+        if (WALLBOX_ANZAHL > 1) {
+          snprintf(zusatz, sizeof(zusatz), " %s", WALLBOX_KONFIG[wb].name);
+        }
+        sendeVerbindung(wallboxen[wb].shelly, zusatz);
+        sendeVerbindung(wallboxen[wb].smartWB, zusatz);
+        return true;
+      }
+    }
+#ifdef USE_EV_SOC_API
+    sendeVerbindung(verbindungSoc, "");
+#endif
+    sendeText(STATUS_ENDE);
+    return false;
+  }
+};
+
+/*****************************************************************
+* @brief HTTP-Handler für die Webserver-Root-Seite
+*        Die Seite wird per Chunked Transfer-Encoding gestreamt, der
+*        Heap pro Anfrage bleibt konstant, egal wie viele Browser-Tabs
+*        offen sind. Aktualisiert wird danach per /events, nicht per
+*        Reload.
+* @param request Anfrage
+******************************************************************/
+void handleRoot(AsyncWebServerRequest* request) {
+  webAntwortSenden(request, "text/html", new (std::nothrow) StatusAntwort());
+}
+
+// Server-Sent Events über /events (AsyncEventSource). Die Nachrichten wachsen mit der Zahl der
+// Wallboxen und liegen deshalb statisch: sseNachricht gehört dem webTask, die Nachricht für neue
+// Clients baut der async_tcp Task in eigene Puffer.
+const int SSE_MAX_CLIENTS = 4;
+char sseLetzterWert[FELD_ANZAHL][STATUS_WERT_LAENGE];  // zuletzt an alle Clients gesendete Werte
+const size_t SSE_NACHRICHT_LAENGE = 320 + WALLBOX_ANZAHL * 384;  // alle Felder in einer Nachricht
+char sseNachricht[SSE_NACHRICHT_LAENGE];
+const unsigned long SSE_PRUEF_INTERVAL     = 100;   //ms, so oft werden die Werte auf Änderungen geprüft
+const unsigned long SSE_KEEPALIVE_INTERVAL = 15000; //ms, leeres Ereignis, damit tote Verbindungen auffallen
+unsigned long letzterKeepaliveSSE = 0;
+
+/*****************************************************************
+* @brief Baut den Inhalt einer SSE Nachricht (JSON) mit allen
+*        geänderten Werten, "data:" ergänzt AsyncEventSource
+* @param puffer Ziel
+* @param groesse Größe des Ziels
+* @param alle true = alle Werte (neuer Client), false = nur Änderungen
+*             gegenüber sseLetzterWert. sseLetzterWert wird erst
+*             übernommen, wenn die ganze Nachricht in den Puffer passt,
+*             sonst gingen die Änderungen für alle Clients verloren.
+* @param werte Momentaufnahme aller Wallboxen
+* @return Länge der Nachricht, 0 wenn sich nichts geändert hat oder
+*         der Puffer zu klein ist
+******************************************************************/
+size_t sseNachrichtBauen(char* puffer, size_t groesse, bool alle, const WallboxWerte* werte) {
+  static bool feldGeaendert[FELD_ANZAHL];  // nur bei alle == false, das kommt nur aus sseAktualisieren()
+  char wert[STATUS_WERT_LAENGE];
+  char id[16];
+  size_t pos = snprintf(puffer, groesse, "{");
+  bool geaendert = false;
+
+  // FELD_ZEIT wird nicht verglichen, sonst gäbe es jede Sekunde eine Nachricht
+  for (int feld = FELD_ZEIT + 1; feld < FELD_ANZAHL; feld++) {
+    statusWertFormatieren(feld, wert, werte);
+    if (!alle) {
+      feldGeaendert[feld] = (strcmp(wert, sseLetzterWert[feld]) != 0);
+      if (!feldGeaendert[feld]) {
+        continue;
+      }
+    }
+    statusFeldId(feld, id);
+    pos += snprintf(puffer + pos, groesse - pos, "\"%s\":\"%s\",", id, wert);
+    geaendert = true;
+    if (pos >= groesse) {
+      logSchreiben(LOG_FEHLER, "SSE Nachricht passt nicht in %u Bytes", (unsigned)groesse);
+      return 0;
+    }
+  }
+  if (!geaendert) {
+    return 0;
+  }
+  statusWertFormatieren(FELD_ZEIT, wert, werte);
+  pos += snprintf(puffer + pos, groesse - pos, "\"%s\":\"%s\"}", STATUS_FELD_ID[FELD_ZEIT], wert);
+  if (pos >= groesse) {
+    logSchreiben(LOG_FEHLER, "SSE Nachricht passt nicht in %u Bytes", (unsigned)groesse);
+    return 0;
+  }
+  if (!alle) {
+    // Nachricht ist vollständig, erst jetzt gelten die Werte als gesendet
+    for (int feld = FELD_ZEIT + 1; feld < FELD_ANZAHL; feld++) {
+      if (feldGeaendert[feld]) {
+        statusWertFormatieren(feld, sseLetzterWert[feld], werte);
+      }
+    }
+  }
+  return pos;
+}
+
+/*****************************************************************
+* @brief Neuer /events Client (async_tcp Task): sofort alle Werte
+*        schicken. Eigene Puffer, damit der async_tcp Task nie auf
+*        den webTask wartet.
+* @param client die neue Verbindung
+******************************************************************/
+void eventsVerbunden(AsyncEventSourceClient* client) {
+  static WallboxWerte werte[WALLBOX_ANZAHL];
+  static char nachricht[SSE_NACHRICHT_LAENGE];
+  if (events.count() > SSE_MAX_CLIENTS) {
+    client->close();  // Zu viele offene /events Verbindungen
+    return;
+  }
+  webMomentaufnahme(werte);
+  if (sseNachrichtBauen(nachricht, sizeof(nachricht), true, werte) > 0) {
+    client->send(nachricht);
+  }
+}
+
+/*****************************************************************
+* @brief Inhalt von /api/energie: geladene Energie (kWh) und
+*        Dauer der RCR Begrenzung (Minuten) je Zeitraum als JSON
+* @param nr Schritt, es gibt nur einen
+******************************************************************/
+bool energieSchritt(int nr) {
+  AbrechnungDaten kopie;
+  portENTER_CRITICAL(&abrechnungMux);
+  kopie = abrechnung;
+  portEXIT_CRITICAL(&abrechnungMux);
+
+  sendeFormatiert("{\"tag\":%u,\"monat\":%u", kopie.tag, kopie.monat);
+  for (int zr = 0; zr < ZR_ANZAHL; zr++) {
+    sendeFormatiert(",\"%s\":{\"kWh\":%.3f,\"rcrMinuten\":%.1f}", ZEITRAUM_NAME[zr],
+                    kopie.energieWs[zr] / 3600000.0, kopie.rcrMs[zr] / 60000.0);
+  }
+  sendeFormatiert("}");
+  return false;
+}
+
+void handleEnergie(AsyncWebServerRequest* request) {
+  webAntwortSenden(request, "application/json", new (std::nothrow) SchrittAntwort(energieSchritt));
+}
+
+/*****************************************************************
+* @brief Sucht in einer Segmentdatei den ersten Eintrag mit zeit >= von
+*        (die Einträge sind nach Zeit sortiert und gleich groß)
+* @return Index des Eintrags, anzahl wenn keiner passt
+******************************************************************/
+uint16_t journalSuchen(File& datei, uint16_t anzahl, uint32_t von) {
+  uint16_t links = 0, rechts = anzahl;
+  JournalEintrag eintrag;
+  while (links < rechts) {
+    uint16_t mitte = (links + rechts) / 2;
+    datei.seek((size_t)mitte * sizeof(JournalEintrag));
+    datei.read((uint8_t*)&eintrag, sizeof(eintrag));
+    if (eintrag.zeit < von) {
+      links = mitte + 1;
+    } else {
+      rechts = mitte;
+    }
+  }
+  return links;
+}
+
+// /api/rcr: der Index wird beim Aufruf kopiert, loop() kann währenddessen anhängen oder das
+// älteste Segment löschen. Je Schritt so viele Einträge, wie in den Puffer passen.
+struct JournalAntwort : WebAntwort {
+  uint32_t von, bis;
+  JournalSegment index[JOURNAL_SEGMENTE];
+  uint8_t segmente = 0;
+  uint8_t naechstes = 0;   // nächstes Segment im Index
+  bool kopf = true;
+  File datei;
+
+  JournalAntwort(uint32_t von, uint32_t bis) : von(von), bis(bis) {
+    if (journalBereit) {
+      xSemaphoreTake(journalSperre, portMAX_DELAY);
+      segmente = journalSegmente;
+      memcpy(index, journalIndex, segmente * sizeof(JournalSegment));
+      xSemaphoreGive(journalSperre);
+    }
+  }
+  ~JournalAntwort() {
+    if (datei) {
+      datei.close();
+    }
+  }
+
+  // nächste Segmentdatei im Zeitraum öffnen und per Binärsuche einsteigen
+  bool segmentOeffnen() {
+    char name[32];
+    while (naechstes < segmente) {
+      const JournalSegment& segment = index[naechstes++];
+      if (segment.letzte < von || segment.erste > bis || segment.anzahl == 0) {
+        continue;
+      }
+      journalDateiname(segment.nummer, name, sizeof(name));
+      datei = LittleFS.open(name, "r");
+      if (datei) {
+        uint16_t anzahl = datei.size() / sizeof(JournalEintrag);
+        datei.seek((size_t)journalSuchen(datei, anzahl, von) * sizeof(JournalEintrag));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool schritt() override {
+    if (kopf) {
+      kopf = false;
+      sendeText(PSTR("time,ms,rse_active,http_code,latency_ms\n"));
+      return true;
+    }
+    JournalEintrag eintrag;
+    while (belegt < sizeof(puffer) - 48) {
+      if (!datei && !segmentOeffnen()) {
+        return false;
+      }
+      if (datei.read((uint8_t*)&eintrag, sizeof(eintrag)) != sizeof(eintrag) || eintrag.zeit > bis) {
+        datei.close();
+        continue;
+      }
+      sendeFormatiert("%u,%u,%u,%d,%.1f\n", eintrag.zeit, eintrag.ms, eintrag.aktiv, eintrag.httpCode, eintrag.latenzUs / 1000.0);
+    }
+    return true;
+  }
+};
+
+/*****************************************************************
+* @brief HTTP-Handler für /api/rcr?from=&to=: RCR Ereignisse im
+*        Zeitraum (Unix-Zeit in s) als CSV. Es werden nur Segmente
+*        gelesen, deren Zeitbereich laut Index passt.
+* @param request Anfrage
+******************************************************************/
+void handleRcrJournal(AsyncWebServerRequest* request) {
+  webAntwortSenden(request, "text/csv",
+                   new (std::nothrow) JournalAntwort(webZahl(request, "from", 0), webZahl(request, "to", UINT32_MAX)));
+}
+
+// /log: die Nummern der Einträge werden beim Aufruf festgelegt, was währenddessen im Ring
+// überschrieben wird, fällt weg
+struct LogAntwort : WebAntwort {
+  uint32_t nr, ende;
+
+  explicit LogAntwort(uint32_t anzahl) {
+    portENTER_CRITICAL(&logMux);
+    ende = logGeschrieben;
+    portEXIT_CRITICAL(&logMux);
+    nr = (ende > anzahl) ? ende - anzahl : 0;
+  }
+
+  bool schritt() override {
+    for (; nr < ende && belegt + LOG_TEXT_LAENGE < sizeof(puffer); nr++) {
+      char* text = puffer + belegt;
+      portENTER_CRITICAL(&logMux);
+      bool vorhanden = (logGeschrieben - nr <= LOG_EINTRAEGE);  // inzwischen überschrieben?
+      if (vorhanden) {
+        memcpy(text, logPuffer[nr % LOG_EINTRAEGE].text, LOG_TEXT_LAENGE);
+      }
+      portEXIT_CRITICAL(&logMux);
+      if (vorhanden) {
+        size_t laenge = strnlen(text, LOG_TEXT_LAENGE - 1);
+        text[laenge++] = '\n';
+        belegt += laenge;
+      }
+    }
+    return nr < ende;
+  }
+};
+
+/*****************************************************************
+* @brief HTTP-Handler für /log: liefert die letzten Log-Einträge
+*        als Text, Anzahl über ?n= (Standard und Maximum LOG_EINTRAEGE)
+* @param request Anfrage
+******************************************************************/
+void handleLog(AsyncWebServerRequest* request) {
+  uint32_t anzahl = constrain(webZahl(request, "n", LOG_EINTRAEGE), 1U, (uint32_t)LOG_EINTRAEGE);
+  webAntwortSenden(request, "text/plain; charset=utf-8", new (std::nothrow) LogAntwort(anzahl));
+}
+
+/*****************************************************************
+* @brief Gibt es eine erreichbare Wallbox mit einem dieser Fahrzeugzustände?
+* @param nurLaden true = nur vehicleState 3 (lädt), sonst 2 oder 3
+******************************************************************/
+bool wallboxMitFahrzeug(bool nurLaden) {
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    const WallboxWerte& werte = wallboxen[wb].werte;
+    if (werte.httpCode >= 0 && (werte.vehicleState == 3 || (!nurLaden && werte.vehicleState == 2))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*****************************************************************
+* @brief Nächstes SmartWB Abfrageintervall nach Zustand:
+*        schnell nach einer RSE Flanke und beim Laden, sonst der
+*        Grundtakt. Ohne Fahrzeug oder wenn die SmartWB OFFLINE ist,
+*        wird das Intervall bei jeder Abfrage verdoppelt. Bei mehreren
+*        Wallboxen bestimmt die aktivste das gemeinsame Intervall.
+******************************************************************/
+void smartWBIntervallBerechnen() {
+  unsigned long vorher = smartWBIntervall;
+  if (rseFensterAktiv && millis() - rseFensterStart >= (unsigned long)ABFRAGE_RSE_FENSTER_S * 1000) {
+    rseFensterAktiv = false;
+  }
+  if (rseFensterAktiv) {
+    smartWBIntervall = ABFRAGE_SCHNELL_MS;  // sehen, ob die Wallbox die Leistung wirklich reduziert
+  } else if (wallboxMitFahrzeug(true)) {
+    smartWBIntervall = ABFRAGE_SCHNELL_MS;  // lädt
+  } else if (wallboxMitFahrzeug(false)) {
+    smartWBIntervall = SMARTWB_ANZEIGE_INTERVAL;
+  } else {
+    // kein Fahrzeug oder OFFLINE: exponentiell bis ABFRAGE_MAX_MS zurückfahren
+    smartWBIntervall = constrain(vorher * 2, SMARTWB_ANZEIGE_INTERVAL, (unsigned long)ABFRAGE_MAX_MS);
+  }
+  if (smartWBIntervall != vorher) {
+    logSchreiben(LOG_DEBUG, "SmartWB Abfrage alle %lums", smartWBIntervall);
+  }
+}
+
+/*****************************************************************
+* @brief Vom webTask: prüft die Werte auf Änderungen und schickt
+*        die Änderungen an alle offenen /events Verbindungen
+* @param now aktuelle millis()
+******************************************************************/
+void sseAktualisieren(unsigned long now) {
+  webMomentaufnahme(webWerte);
+#ifdef USE_RSE_SIMULATION
+  bool rseVorher = RSEAktiv;  // der Wert, der gleich in die Nachricht kommt
+#endif
+  size_t laenge = sseNachrichtBauen(sseNachricht, sizeof(sseNachricht), false, webWerte);
+#ifdef USE_RSE_SIMULATION
+  if (simSseOffen && laenge > 0 && rseVorher == simAktiv) {
+    simSseOffen = false;
+    simProbe(simSse, esp_timer_get_time() - simFlankeUs);
+  }
+#endif
+  if (laenge > 0) {
+    // AsyncEventSource kopiert die Nachricht je Client in dessen Warteschlange, ein hängender
+    // Browser verliert Nachrichten statt die anderen aufzuhalten
+    events.send(sseNachricht);
+  } else if (now - letzterKeepaliveSSE >= SSE_KEEPALIVE_INTERVAL) {
+    events.send("", "keepalive");  // benanntes Ereignis, die Seite reagiert nur auf "message"
+  } else {
+    return;
+  }
+  letzterKeepaliveSSE = now;
+}
+
+#ifdef USE_MQTT
+#if defined(MQTT_SOC_TOPIC) && !defined(USE_EV_SOC_API)
+  #error "MQTT_SOC_TOPIC braucht USE_EV_SOC_API (SoC Anzeige)"
+#endif
+// MQTT: Zustand und Messwerte als retained Topics unter MQTT_PREFIX/..., damit andere Systeme
+// (PV Regler, pv-automat) nicht pollen müssen. Gesendet wird nur, was sich seit der letzten
+// Veröffentlichung geändert hat, gesammelt einmal pro MQTT_INTERVALL_MS (RSE sofort).
+// Bei mehreren Wallboxen liegen deren Werte unter MQTT_PREFIX/<name>/..., rse und soc bleiben oben.
+// PubSubClient veröffentlicht nur mit QoS 0, abonniert wird mit QoS 1.
+enum MqttWert {
+  MQTT_RSE, MQTT_SOC,                 // allgemein
+  MQTT_EVSE, MQTT_FAHRZEUG, MQTT_LEISTUNG, MQTT_STROM, MQTT_MAX_STROM,
+  MQTT_U1, MQTT_U2, MQTT_U3, MQTT_I1, MQTT_I2, MQTT_I3,
+  MQTT_ANZAHL
+};
+const int MQTT_ALLGEMEIN = MQTT_EVSE;  // ab hier je Wallbox
+const char* const MQTT_TOPIC[MQTT_ANZAHL] = {
+  "rse", "soc",
+  "evse", "vehicleState", "actualPower", "actualCurrent", "maxCurrent",
+  "voltageP1", "voltageP2", "voltageP3", "currentP1", "currentP2", "currentP3"
+};
+const uint8_t MQTT_WERT_LAENGE = 12;
+char mqttLetzterWert[WALLBOX_ANZAHL][MQTT_ANZAHL][MQTT_WERT_LAENGE];  // zuletzt veröffentlichte Werte
+WiFiClient mqttNetz;
+PubSubClient mqtt(mqttNetz);
+unsigned long mqttNaechsterVersuch = 0;               // millis(), vorher kein neuer Verbindungsversuch
+unsigned long mqttWartezeit = 5000;                   // ms, verdoppelt sich bei jedem Fehlschlag bis 60s
+
+/*****************************************************************
+* @brief Formatiert einen MQTT Wert als Text ohne Einheit
+* @param wb Wallbox für die Werte ab MQTT_ALLGEMEIN
+******************************************************************/
+void mqttWertFormatieren(const WallboxWerte& wb, int nr, char* puffer, size_t n) {
+  switch (nr) {
+    case MQTT_RSE:       snprintf(puffer, n, "%d", RSEAktiv ? 1 : 0); break;
+#ifdef USE_EV_SOC_API
+    case MQTT_SOC:       snprintf(puffer, n, "%d", soc); break;
+#endif
+    case MQTT_EVSE:      snprintf(puffer, n, "%d", (wb.httpCode >= 0) ? (wb.evseState ? 1 : 0) : -1); break;
+    case MQTT_FAHRZEUG:  snprintf(puffer, n, "%d", wb.vehicleState); break;
+    case MQTT_LEISTUNG:  snprintf(puffer, n, "%.2f", wb.actualPower); break;
+    case MQTT_STROM:     snprintf(puffer, n, "%d", wb.actualCurrent); break;
+    case MQTT_MAX_STROM: snprintf(puffer, n, "%d", wb.maxCurrent); break;
+    case MQTT_U1:        snprintf(puffer, n, "%.1f", wb.voltageP1); break;
+    case MQTT_U2:        snprintf(puffer, n, "%.1f", wb.voltageP2); break;
+    case MQTT_U3:        snprintf(puffer, n, "%.1f", wb.voltageP3); break;
+    case MQTT_I1:        snprintf(puffer, n, "%.1f", wb.currentP1); break;
+    case MQTT_I2:        snprintf(puffer, n, "%.1f", wb.currentP2); break;
+    case MQTT_I3:        snprintf(puffer, n, "%.1f", wb.currentP3); break;
+    default:             puffer[0] = '\0'; break;
+  }
+}
+
+#ifdef MQTT_SOC_TOPIC
+/*****************************************************************
+* @brief Empfangene MQTT Nachrichten: SoC als Zahl oder als JSON
+*        mit "soc" (wie die EV SOC API)
+******************************************************************/
+void mqttEmpfangen(char* topic, byte* nutzdaten, unsigned int laenge) {
+  if (strcmp(topic, MQTT_SOC_TOPIC) != 0) {
+    return;
+  }
+  char text[64];
+  laenge = min(laenge, (unsigned int)sizeof(text) - 1);
+  memcpy(text, nutzdaten, laenge);
+  text[laenge] = '\0';
+  if (text[0] == '{') {
+    StaticJsonDocument<128> doc;
+    if (deserializeJson(doc, text) == DeserializationError::Ok && doc["soc"].is<int>()) {
+      soc = doc["soc"].as<int>();
+    }
+  } else {
+    soc = atoi(text);
+  }
+  logSchreiben(LOG_INFO, "SoC per MQTT: %d%%", soc);
+}
+#endif
+
+/*****************************************************************
+* @brief Verbindung zum Broker aufbauen, mit Last Will auf
+*        MQTT_PREFIX/status. Danach werden alle Werte neu gesendet.
+******************************************************************/
+bool mqttVerbinden() {
+  if (WiFi.status() != WL_CONNECTED || (long)(millis() - mqttNaechsterVersuch) < 0) {
+    return false;
+  }
+  if (ioBudgetMs(MQTT_VERBINDEN_MS) < MQTT_VERBINDEN_MS) {
+    return false;  // Verbindungsaufbau könnte den Watchdog reißen, beim nächsten Lauf wieder versuchen
+  }
+  char id[32];
+  snprintf(id, sizeof(id), "smartwb-rse-%06x", (uint32_t)ESP.getEfuseMac() & 0xFFFFFF);
+  const char* benutzer = (MQTT_USER[0] != '\0') ? MQTT_USER : NULL;  // ohne Anmeldung keinen leeren Benutzer senden
+  if (!mqtt.connect(id, benutzer, MQTT_PASSWORD, MQTT_PREFIX "/status", 0, true, "offline")) {
+    mqttNaechsterVersuch = millis() + mqttWartezeit;
+    logSchreiben(LOG_WARNUNG, "MQTT Verbindung fehlgeschlagen (%d), neuer Versuch in %lus", mqtt.state(), mqttWartezeit / 1000);
+    mqttWartezeit = min(mqttWartezeit * 2, 60000UL);
+    return false;
+  }
+  mqttWartezeit = 5000;
+  mqtt.publish(MQTT_PREFIX "/status", "online", true);
+#ifdef MQTT_SOC_TOPIC
+  mqtt.subscribe(MQTT_SOC_TOPIC, 1);
+#endif
+  memset(mqttLetzterWert, 0, sizeof(mqttLetzterWert));  // Broker evtl. neu gestartet: alles neu senden
+  logSchreiben(LOG_INFO, "MQTT verbunden mit " MQTT_SERVER);
+  return true;
+}
+
+/*****************************************************************
+* @brief Aufgabe: Verbindung halten, eingehende Nachrichten
+*        bearbeiten und geänderte Werte retained veröffentlichen
+******************************************************************/
+void aufgabeMqtt() {
+  if (!mqtt.connected() && !mqttVerbinden()) {
+    return;
+  }
+  mqtt.loop();
+
+  char topic[64];
+  char wert[MQTT_WERT_LAENGE];
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    // allgemeine Werte nur einmal (bei der ersten Wallbox)
+    for (int nr = (wb == 0) ? 0 : MQTT_ALLGEMEIN; nr < MQTT_ANZAHL; nr++) {
+      mqttWertFormatieren(wallboxen[wb].werte, nr, wert, sizeof(wert));
+      if (wert[0] == '\0' || strcmp(wert, mqttLetzterWert[wb][nr]) == 0) {
+        continue;
+      }
+      if (nr >= MQTT_ALLGEMEIN && WALLBOX_ANZAHL > 1) {
+        snprintf(topic, sizeof(topic), MQTT_PREFIX "/%s/%s", WALLBOX_KONFIG[wb].name, MQTT_TOPIC[nr]);
+      } else {
+        snprintf(topic, sizeof(topic), MQTT_PREFIX "/%s", MQTT_TOPIC[nr]);
+      }
+      if (!mqtt.publish(topic, wert, true)) {
+        return;  // Verbindung weg, beim nächsten Lauf neu
+      }
+      strlcpy(mqttLetzterWert[wb][nr], wert, MQTT_WERT_LAENGE);
+    }
+  }
+}
+#endif
+
+// Periodische Aufgaben von loop(). Jede Aufgabe hat ein Intervall und den nächsten
+// Fälligkeitszeitpunkt. loop() führt die fälligen aus und schläft dann per Task-
+// Benachrichtigung bis zur nächsten Fälligkeit. Geweckt wird vorher vom aktorTask
+// (RSE Flanke). Bei sechs Aufgaben reicht eine Tabelle, ein Heap lohnt sich nicht.
+// Der Webserver ist keine Aufgabe, er läuft im async_tcp Task, /events im webTask.
+struct Aufgabe {
+  const char*   name;
+  void        (*funktion)();
+  unsigned long intervall;        // ms, darf von der Aufgabe selbst geändert werden
+  unsigned long faellig;          // millis() des nächsten Laufs
+  uint32_t      laeufe;
+  uint32_t      verspaetet;       // Start mehr als AUFGABE_TOLERANZ_MS nach der Fälligkeit
+  uint32_t      maxVerspaetungMs;
+  uint32_t      maxDauerMs;
+};
+enum AufgabeNr {
+  AUFGABE_RSE = 0,
+  AUFGABE_UHR,
+  AUFGABE_SMARTWB,
+  AUFGABE_UI,
+  AUFGABE_SOC,
+  AUFGABE_MQTT,
+  AUFGABE_ANZAHL
+};
+const unsigned long AUFGABE_TOLERANZ_MS = 50;
+uint64_t schlafUs = 0;                         // Zeit, die loop() seit dem Start geschlafen hat
+
+void aufgabeRseAnzeige();
+void aufgabeUhr();
+void aufgabeSmartWB();
+void aufgabeUI();
+void aufgabeSoc();
+void aufgabeMqtt();
+
+Aufgabe aufgaben[AUFGABE_ANZAHL] = {
+  { "rse",     aufgabeRseAnzeige, BLINK_INTERVAL,               0, 0, 0, 0, 0 },
+  { "uhr",     aufgabeUhr,        UHR_ANZEIGE_INTERVAL,         0, 0, 0, 0, 0 },
+  { "smartwb", aufgabeSmartWB,    SMARTWB_ANZEIGE_INTERVAL,     0, 0, 0, 0, 0 },
+  { "ui",      aufgabeUI,         SMARTWB_ANZEIGE_INTERVAL / 3, 0, 0, 0, 0, 0 },
+#if defined(USE_EV_SOC_API) && !defined(MQTT_SOC_TOPIC)
+  { "soc",     aufgabeSoc,        SOC_ANZEIGE_INTERVAL,         0, 0, 0, 0, 0 },
+#else
+  { "soc",     NULL,              0,                            0, 0, 0, 0, 0 },  // SoC kommt per MQTT oder gar nicht
+#endif
+#ifdef USE_MQTT
+  { "mqtt",    aufgabeMqtt,       MQTT_INTERVALL_MS,            0, 0, 0, 0, 0 },
+#else
+  { "mqtt",    NULL,              0,                            0, 0, 0, 0, 0 },
+#endif
+};
+
+#ifdef USE_LOOP_PROFILER
+// Profiler für loop(): jeder Abschnitt (alle Aufgaben und die festen Schritte in loop())
+// wird mit dem CPU Taktzähler gemessen, min/avg/max stehen unter /api/profil.
+// Im RTC-RAM liegen der gerade laufende Abschnitt und der langsamste seit dem Start.
+// Hängt ein Abschnitt bis der Watchdog auslöst, ist er nach dem Neustart noch als
+// "laufend" eingetragen und wird zusammen mit dem langsamsten ausgegeben.
+enum ProfilNr {
+  PROFIL_AUSWERTEN = AUFGABE_ANZAHL,  // davor: je Aufgabe ein Abschnitt
+  PROFIL_JOURNAL,
+  PROFIL_DISPLAY,
+  PROFIL_ANZAHL
+};
+const char* const PROFIL_NAME[PROFIL_ANZAHL - AUFGABE_ANZAHL] = { "auswerten", "journal", "display" };
+
+struct ProfilStatistik {
+  uint32_t anzahl;
+  uint32_t minZyklen;
+  uint32_t maxZyklen;
+  uint64_t summeZyklen;
+};
+ProfilStatistik profilStatistik[PROFIL_ANZAHL];
+
+struct ProfilMomentaufnahme {
+  int8_t   abschnitt;   // -1 = keiner
+  uint32_t dauerUs;     // beim laufenden Abschnitt 0
+  time_t   zeit;        // Unix Zeit beim Start des Abschnitts
+  uint32_t heapFrei;    // freier Heap beim Start bzw. Ende
+};
+struct ProfilRtc {
+  uint32_t kennung;                 // PROFIL_KENNUNG, sonst ungültig
+  ProfilMomentaufnahme laufend;     // gerade laufender Abschnitt
+  ProfilMomentaufnahme langsamster; // langsamster abgeschlossener Abschnitt seit dem Start
+};
+const uint32_t PROFIL_KENNUNG = 0x50524631;  // "PRF1"
+RTC_NOINIT_ATTR ProfilRtc profilRtc;
+ProfilRtc profilVorNeustart;                  // Stand aus dem RTC-RAM beim Start, für /api/profil
+
+const char* profilName(int nr) {
+  if (nr < 0 || nr >= PROFIL_ANZAHL) return "-";
+  return nr < AUFGABE_ANZAHL ? aufgaben[nr].name : PROFIL_NAME[nr - AUFGABE_ANZAHL];
+}
+
+// Misst einen Abschnitt von der Erzeugung bis zum Ende des Blocks
+class ProfilMessung {
+public:
+  explicit ProfilMessung(int nr) : nr(nr), startZyklen(ESP.getCycleCount()) {
+    profilRtc.laufend.abschnitt = nr;
+    profilRtc.laufend.zeit      = time(NULL);
+    profilRtc.laufend.heapFrei  = ESP.getFreeHeap();
+  }
+  ~ProfilMessung() {
+    uint32_t zyklen = ESP.getCycleCount() - startZyklen;  // läuft erst nach ~17s bei 240MHz über
+    profilRtc.laufend.abschnitt = -1;
+    ProfilStatistik& st = profilStatistik[nr];
+    if (st.anzahl == 0 || zyklen < st.minZyklen) st.minZyklen = zyklen;
+    if (zyklen > st.maxZyklen) st.maxZyklen = zyklen;
+    st.summeZyklen += zyklen;
+    st.anzahl++;
+    uint32_t dauerUs = zyklen / ESP.getCpuFreqMHz();
+    if (dauerUs > profilRtc.langsamster.dauerUs) {
+      profilRtc.langsamster.abschnitt = nr;
+      profilRtc.langsamster.dauerUs   = dauerUs;
+      profilRtc.langsamster.zeit      = profilRtc.laufend.zeit;
+      profilRtc.langsamster.heapFrei  = ESP.getFreeHeap();
+    }
+  }
+private:
+  int nr;
+  uint32_t startZyklen;
+};
+#define PROFIL(nr) ProfilMessung profilMessung(nr)
+
+/*****************************************************************
+* @brief Zeitpunkt einer Momentaufnahme, zeitstempelFuerSekunde()
+*        taugt dafür nicht, es formatiert nur die aktuelle Sekunde
+******************************************************************/
+void profilZeit(time_t zeit, char* puffer, size_t n) {
+  struct tm timeinfo;
+  if (zeit < ZEIT_GUELTIG_AB) {
+    snprintf(puffer, n, "[Keine Zeit]");
+    return;
+  }
+  localtime_r(&zeit, &timeinfo);
+  strftime(puffer, n, "[%Y-%m-%d %H:%M:%S]", &timeinfo);
+}
+
+/*****************************************************************
+* @brief Beim Start: Stand aus dem RTC-RAM ausgeben (nach einem
+*        Watchdog-Neustart steht dort der hängende Abschnitt) und
+*        für den neuen Lauf zurücksetzen
+* @param grund Grund des letzten Neustarts
+******************************************************************/
+void profilStarten(esp_reset_reason_t grund) {
+  bool gueltig = profilRtc.kennung == PROFIL_KENNUNG && grund != ESP_RST_POWERON && grund != ESP_RST_BROWNOUT;
+  if (gueltig) {
+    profilVorNeustart = profilRtc;
+    const ProfilMomentaufnahme& l = profilRtc.laufend;
+    const ProfilMomentaufnahme& m = profilRtc.langsamster;
+    char zeit[ZEITSTEMPEL_LAENGE];
+    if (l.abschnitt >= 0) {
+      profilZeit(l.zeit, zeit, sizeof(zeit));
+      logSchreiben(grund == ESP_RST_TASK_WDT ? LOG_FEHLER : LOG_WARNUNG,
+                   "Profil: vor dem Neustart lief Abschnitt '%s' seit %s, Heap frei %u",
+                   profilName(l.abschnitt), zeit, l.heapFrei);
+    }
+    if (m.abschnitt >= 0) {
+      profilZeit(m.zeit, zeit, sizeof(zeit));
+      logSchreiben(LOG_INFO, "Profil: langsamster Abschnitt vor dem Neustart '%s' mit %ums um %s, Heap frei %u",
+                   profilName(m.abschnitt), m.dauerUs / 1000, zeit, m.heapFrei);
+    }
+  } else {
+    memset(&profilVorNeustart, 0, sizeof(profilVorNeustart));
+    profilVorNeustart.laufend.abschnitt = profilVorNeustart.langsamster.abschnitt = -1;
+  }
+  memset(&profilRtc, 0, sizeof(profilRtc));
+  profilRtc.laufend.abschnitt = profilRtc.langsamster.abschnitt = -1;
+  profilRtc.kennung = PROFIL_KENNUNG;
+}
+
+/*****************************************************************
+* @brief Eine Momentaufnahme als JSON Objekt senden
+******************************************************************/
+void sendeMomentaufnahme(const char* name, const ProfilMomentaufnahme& m) {
+  sendeFormatiert("\"%s\":{\"abschnitt\":\"%s\",\"dauerUs\":%u,\"zeit\":%ld,\"heapFrei\":%u}",
+                  name, profilName(m.abschnitt), m.dauerUs, (long)m.zeit, m.heapFrei);
+}
+
+/*****************************************************************
+* @brief Inhalt von /api/profil: min/avg/max je Abschnitt von loop()
+*        in µs und die Momentaufnahmen
+* @param nr Schritt: je Abschnitt einer, dann die Momentaufnahmen
+******************************************************************/
+bool profilSchritt(int nr) {
+  if (nr < PROFIL_ANZAHL) {
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    const ProfilStatistik& st = profilStatistik[nr];
+    sendeFormatiert("%s{\"name\":\"%s\",\"anzahl\":%u,\"minUs\":%u,\"avgUs\":%u,\"maxUs\":%u}",
+                    nr > 0 ? "," : "{\"abschnitte\":[", profilName(nr), st.anzahl, st.minZyklen / mhz,
+                    st.anzahl ? (uint32_t)(st.summeZyklen / st.anzahl / mhz) : 0, st.maxZyklen / mhz);
+    return true;
+  }
+  sendeFormatiert("],");
+  sendeMomentaufnahme("langsamster", profilRtc.langsamster);
+  sendeFormatiert(",\"vorNeustart\":{");
+  sendeMomentaufnahme("laufend", profilVorNeustart.laufend);
+  sendeFormatiert(",");
+  sendeMomentaufnahme("langsamster", profilVorNeustart.langsamster);
+  sendeFormatiert("}}");
+  return false;
+}
+
+void handleProfil(AsyncWebServerRequest* request) {
+  webAntwortSenden(request, "application/json", new (std::nothrow) SchrittAntwort(profilSchritt));
+}
+#else
+#define PROFIL(nr)
+#endif
+
+/*****************************************************************
+* @brief Aufgabe beim nächsten Durchlauf von loop() ausführen
+******************************************************************/
+void aufgabeJetzt(AufgabeNr nr) {
+  aufgaben[nr].faellig = millis();
+}
+
+/*****************************************************************
+* @brief LED Steuerung und RSE Anzeige auf dem OLED. Die RSE Flanke
+*        selbst (Shelly schalten) erledigt der aktorTask.
+******************************************************************/
+void aufgabeRseAnzeige() {
+  if (RSEAktiv) {
+    //digitalWrite(LED_GRUEN, LOW);
+    led2.setMode(LEDMODE_BLINK); // RSE aktiv rote LED blinken
+    // led1.setMode(LEDMODE_OFF);   //Grüne LED aus
+
+    // Blink-Logik für Rot: diese Aufgabe läuft im BLINK_INTERVAL
+    rotStatus = !rotStatus;
+    //digitalWrite(LED_ROT, rotStatus);
+    //RSE Anzeige im  OLED setzen
+    display.setCursor(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y); // y=78 (13.Spalte), x=40 (5.Zeile)
+    if (rotStatus) {
+      display.print("RSE akt"); //RSE Anzeige blinken lassen -> Ein
+    } else {
+      #ifdef OLED_TYPE_SSD1306
+        display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SSD1306_BLACK); //RSE Anzeige blinken lassen -> Aus
+      #else
+        display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SH110X_BLACK); //RSE Anzeige blinken lassen -> Aus
+      #endif        
+    }    
+    display.display(); 
+
+  } else {
+    // Normalzustand → Rot aus, Grün an
+    //digitalWrite(LED_ROT, LOW);
+    //digitalWrite(LED_GRUEN, HIGH);
+    led2.setMode(LEDMODE_OFF);
+    bool erreichbar = false, ein = false;
+    for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+      erreichbar |= wallboxen[wb].werte.httpCode >= 0;
+      ein        |= wallboxen[wb].werte.evseState;
+    }
+    if (erreichbar) { //wenn eine SmartWB erreichbar ist, dann entweder FADE (bei bereit) oder ON (eine ist EIN)
+      led1.setMode(ein ? LEDMODE_ON : LEDMODE_FADE);
+    }
+    else {
+      led1.setMode(LEDMODE_OFF); //SmartWB ist nicht erreichbar also AUS schalten
+    }
+    //RSE Anzeige im OLED löschen, nur wenn sie gerade sichtbar ist (sonst wäre die Seite bei jedem Durchlauf geändert)
+    if (rotStatus) {
+      rotStatus = false;
+      display.setCursor(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y); // x=78 (13.Spalte), y=40 (5.Zeile)
+      // RSE Anzeige wieder  löschen // x=78 (13.Spalte), y=40 (5.Zeile)
+      #ifdef OLED_TYPE_SSD1306
+      display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SSD1306_BLACK);
+      #else
+      display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SH110X_BLACK);
+      #endif
+      display.display();
+    }
+  }
+}
+
+/*****************************************************************
+* @brief Uhrzeit auf dem OLED, Abrechnung und Watchdog, jede Sekunde
+******************************************************************/
+void aufgabeUhr() {
+  display.setCursor(0,0);           //Cursor wieder oben links setzen für Zeitausgabe
+  // Zeile überschreiben mit schwarzem Rechteck (löschen)
+  #ifdef OLED_TYPE_SSD1306
+  display.fillRect(0, 0, SCREEN_WIDTH, CHAR_SIZE_Y, SSD1306_BLACK);
+  #else
+  display.fillRect(0, 0, SCREEN_WIDTH, CHAR_SIZE_Y, SH110X_BLACK);
+  #endif
+  
+  display.print(getZeitstempel());  //Zeit auf OLED schreiben
+  oledI2CBytesProSek  = display.i2cBytes - oledI2CBytesZuletzt;  // I2C Last der letzten Sekunde
+  oledI2CBytesZuletzt = display.i2cBytes;
+  abrechnungTick();                 // RCR Dauer, Tageswechsel und ggf. NVS Speicherung
+  // Vielleicht zeige ich in dem Fortschrittsbalken mal den SOC vom angeschlossenen Auto an...
+  // Inkrementiere den Fortschritt und setze ihn bei 100% zurück
+  // currentProgress = (currentProgress >= 10) ? 0 : currentProgress + 1; //10sec
+  // Serial.print("Progress: " + String(currentProgress));
+  // Übergabe des Fortschritts an die Routine
+  //drawProgressBar(currentProgress*10);
+  // Watchdog reset
+  //Es scheint so zu sein, als wäre er Systemseitig auf 5sec eingestellt. Das führt bei Power-On schon zu einem Reboot. Daher auch schon mal in der Setup Routine zurücksetzen!
+  // esp_task_wdt_reset(); // Watchdog zurücksetzen (sollte alle 1000ms passieren, da die Zeitanzeige jede Sekunde aufgerufen wird
+  esp_err_t err_code = esp_task_wdt_reset(); 
+  int64_t jetztUs = esp_timer_get_time();
+  metrikWdtAbstand.erfassen(jetztUs - wdtResetUs);
+  wdtResetUs = jetztUs;
+  logSchreiben(LOG_DEBUG, "Watchdog reset... Ergebnis: %d", err_code);
+
+  display.display();                //
+}
+
+#ifdef USE_EV_SOC_API
+/*****************************************************************
+* @brief SoC vom lokalen EV-SOC-Server holen, nur mit angestecktem Fahrzeug
+******************************************************************/
+void aufgabeSoc() {
+  if (wallboxMitFahrzeug(false)) {
+    int neu = getSoc();
+    if (neu == SOC_VERSCHOBEN) {
+      aufgaben[AUFGABE_SOC].intervall = SOC_WIEDERHOLUNG_MS;  // bald nochmal, der alte SoC bleibt solange stehen
+      return;
+    }
+    soc = neu;
+    logSchreiben(LOG_INFO, "SoC: %d%%", soc);
+  }
+  aufgaben[AUFGABE_SOC].intervall = SOC_ANZEIGE_INTERVAL;
+}
+#endif
+
+/*****************************************************************
+* @brief Im smartWBIntervall alle Abfrage-Tasks wecken. Die Wallboxen
+*        werden gleichzeitig abgefragt, die Ergebnisse übernimmt
+*        loop() per wallboxenAuswerten(), sobald sie da sind.
+******************************************************************/
+void aufgabeSmartWB() {
+  smartWBIntervallBerechnen();     // nächstes Intervall nach Fahrzeugzustand und RSE
+  aufgaben[AUFGABE_SMARTWB].intervall = smartWBIntervall;
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    xTaskNotifyGive(wallboxen[wb].abfrageTask);
+  }
+}
+
+/*****************************************************************
+* @brief Zeilen 3-6 des OLED: Zustand und Ladedaten der Wallbox
+*        wallboxAnzeige
+* @param ziel OLED oder ein anderer Zeichenpuffer (Benchmark)
+******************************************************************/
+void wallboxZeichnen(Adafruit_GFX& ziel = display) {
+  const WallboxWerte& werte = wallboxen[wallboxAnzeige].werte;
+
+  // Zeile überschreiben mit schwarzem Rechteck (löschen) in Abhängigkeit des OLED Typs
+  #ifdef OLED_TYPE_SSD1306
+  ziel.fillRect(0, 3 * CHAR_SIZE_Y, SCREEN_WIDTH, 4 * CHAR_SIZE_Y, SSD1306_BLACK);    // Ab der Zeile 3 die nächsten 4 Zeilen löschen
+  #else
+  ziel.fillRect(0, 3 * CHAR_SIZE_Y, SCREEN_WIDTH, 4 * CHAR_SIZE_Y, SH110X_BLACK);    // Ab der Zeile 3 die nächsten 4 Zeilen löschen
+  #endif
+    
+  //Check ob SmartWB online, wenn ja die geholten Werte anzeigen, sonst "OFFLINE" (die Werte sind dann 0)
+  
+  ziel.setCursor(0, 3 * CHAR_SIZE_Y);                                   // Cursor auf die Zeile 3 setzen
+  if (WALLBOX_ANZAHL > 1) {
+    ziel.print(WALLBOX_KONFIG[wallboxAnzeige].name);                    // bei mehreren Wallboxen deren Name
+    ziel.print(": ");
+  } else {
+    ziel.print("SmartWB: ");
+  }
+
+  //Testen ob SmartWB online ist
+  if (werte.httpCode >= 0) {
+    ziel.println(werte.evseState ? "EIN" : "AUS");
+    // nur wenn die SmartWB ONLINE ist und das Fzg. angeschlossen (vehicleState=2) oder lädt (vehicleState=3), zeigen wir auch den SOC an, sonst nicht
+    #ifdef USE_EV_SOC_API
+    if (werte.vehicleState==2||werte.vehicleState==3) {
+      ziel.setCursor( 13 * CHAR_SIZE_X, 3 * CHAR_SIZE_Y);
+      ziel.println("SOC: " + String(soc) + "%");
+    }
+    #endif
+  }
+  else {
+    #ifdef OLED_TYPE_SSD1306
+    ziel.setTextColor(SSD1306_BLACK, SSD1306_WHITE);
+    #else 
+    ziel.setTextColor(SH110X_BLACK, SH110X_WHITE);
+    #endif
+    ziel.println("OFFLINE"); //SmartWB (evse) ist nicht erreichbar , das soll INVERS angezeigt werden
+    // und jetzt wieder die normale Farbdarstellung
+     #ifdef OLED_TYPE_SSD1306
+    ziel.setTextColor(SSD1306_WHITE, SSD1306_BLACK);
+    #else 
+    ziel.setTextColor(SH110X_WHITE, SH110X_BLACK);
+    #endif
+  }
+  //Falls nur 1-stellig, führendes " " hinzufügen
+  ziel.print("Max Cur: ");
+  ziel.println((werte.maxCurrent < 10 ? " " : "") + String(werte.maxCurrent) + "A"); // maxCurrent auf Display schreiben
+
+  ziel.print("Act Cur: ");
+  ziel.println((werte.actualCurrent < 10 ? " " : "") + String(werte.actualCurrent) + "A");
+
+  ziel.print("Act Pow: ");
+  char leistung[16];  // nicht String(float), das formatiert in einem Puffer auf dem Heap
+  snprintf(leistung, sizeof(leistung), "%s%.2fkW", werte.actualPower < 10 ? " " : "", werte.actualPower);
+  ziel.println(leistung); // Die aktuelle Leistung die vom EV geladen wird
+}
+
+/*****************************************************************
+* @brief Von loop(): neue Ergebnisse der Abfrage-Tasks übernehmen,
+*        anzeigen, im Verlauf ablegen und die Energie aufintegrieren
+******************************************************************/
+void wallboxenAuswerten() {
+  uint32_t neu = wallboxenUebernehmen();
+  if (neu == 0) {
+    return;
+  }
+  float leistungKw = 0.0;
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    if (neu & (1 << wb)) {
+      verlaufHinzufuegen(wb); // Messwerte (bzw. OFFLINE = 0) im Verlauf ablegen
+    }
+    leistungKw += wallboxen[wb].werte.actualPower;
+  }
+  abrechnungLeistung(leistungKw); // geladene Energie aller Wallboxen aufintegrieren
+  if (neu & (1 << wallboxAnzeige)) {
+    wallboxZeichnen();
+  }
+
+#ifdef USE_EV_SOC_API
+  // Wird ein Fahrzeug neu angesteckt, den SoC sofort holen
+  bool socFahrzeug = wallboxMitFahrzeug(false);
+  if (socFahrzeug && !socFahrzeugVorher) {
+    aufgabeJetzt(AUFGABE_SOC);
+  }
+  socFahrzeugVorher = socFahrzeug;
+#endif
+}
+
+/*****************************************************************
+* @brief U + I Werte der drei Phasen nacheinander anzeigen, danach
+*        bei mehreren Wallboxen zur nächsten wechseln
+******************************************************************/
+void aufgabeUI() {
+  const WallboxWerte& werte = wallboxen[wallboxAnzeige].werte;
+  // Zeile überschreiben mit schwarzem Rechteck (löschen) in Abhängigkeit des OLED Typs
+  #ifdef OLED_TYPE_SSD1306
+  display.fillRect(0, 7 * CHAR_SIZE_Y, SCREEN_WIDTH, CHAR_SIZE_Y, SSD1306_BLACK);   // Die 7.Zeile löschen
+  #else
+  display.fillRect(0, 7 * CHAR_SIZE_Y, SCREEN_WIDTH, CHAR_SIZE_Y, SH110X_BLACK);    // Die 7.Zeile löschen
+  #endif
+  display.setCursor(0, 7 * CHAR_SIZE_Y);                                  // Cursor auf die 7. Zeile setzen
+  switch (i) {
+    case 1:
+      display.print("U1: " + String(werte.voltageP1, 1) + "V I1: " + (werte.currentP1 < 10 ? " " : "") + String(werte.currentP1, 1) + "A");
+    break;
+    case 2:
+      display.print("U2: " + String(werte.voltageP2, 1) + "V I2: " + (werte.currentP2 < 10 ? " " : "") + String(werte.currentP2, 1) + "A");
+    break;
+    case 3:
+      display.print("U3: " + String(werte.voltageP3, 1) + "V I3: " + (werte.currentP3 < 10 ? " " : "") + String(werte.currentP3, 1) + "A");
+    break;
+  }
+   
+  i = (i + 1 > 3) ? 1 : i + 1;  //Zähler +1 prüfen ob schon > 3, wenn ja, auf 1 setzten, sonst erhöhen
+  if (i == 1 && WALLBOX_ANZAHL > 1) {
+    wallboxAnzeige = (wallboxAnzeige + 1) % WALLBOX_ANZAHL;  // alle drei Phasen gezeigt -> nächste Wallbox
+    wallboxZeichnen();
+  }
+}
+
+/*****************************************************************
+* @brief Webserver-Task: schickt Änderungen an /events unabhängig
+*        von loop(). Die Anfragen selbst bedient der AsyncWebServer
+*        im async_tcp Task. Was loop() gehört, lesen beide nur als
+*        Momentaufnahme oder unter der jeweiligen Sperre.
+* @param parameter wird nicht benutzt
+******************************************************************/
+void webTask(void* parameter) {
+  for (;;) {
+    sseAktualisieren(millis());
+    vTaskDelay(pdMS_TO_TICKS(SSE_PRUEF_INTERVAL));
+  }
+}
+
+/*****************************************************************
+* @brief Führt alle fälligen Aufgaben aus und führt die Statistik
+* @return ms bis zur nächsten Fälligkeit
+******************************************************************/
+unsigned long aufgabenAusfuehren() {
+  unsigned long warten = ULONG_MAX;
+  for (int nr = 0; nr < AUFGABE_ANZAHL; nr++) {
+    Aufgabe& aufgabe = aufgaben[nr];
+    if (aufgabe.funktion == NULL) {
+      continue;
+    }
+    unsigned long start = millis();
+    long verspaetung = (long)(start - aufgabe.faellig);
+    if (verspaetung >= 0) {
+      {
+        PROFIL(nr);
+        aufgabe.funktion();
+      }
+      unsigned long dauer = millis() - start;
+      aufgabe.laeufe++;
+      if ((unsigned long)verspaetung > AUFGABE_TOLERANZ_MS) {
+        aufgabe.verspaetet++;
+      }
+      aufgabe.maxVerspaetungMs = max(aufgabe.maxVerspaetungMs, (uint32_t)verspaetung);
+      aufgabe.maxDauerMs       = max(aufgabe.maxDauerMs, (uint32_t)dauer);
+      // im festen Takt weiter, nach längerer Verspätung aber nicht nachholen
+      aufgabe.faellig += aufgabe.intervall;
+      if ((long)(millis() - aufgabe.faellig) >= 0) {
+        aufgabe.faellig = millis() + aufgabe.intervall;
+      }
+    }
+    long rest = (long)(aufgabe.faellig - millis());
+    warten = min(warten, (unsigned long)max(rest, 0L));
+  }
+  return warten;
+}
+
+/*****************************************************************
+* @brief Inhalt von /api/aufgaben: Statistik der Aufgaben von loop()
+*        und Anteil der Zeit, die loop() geschlafen hat
+* @param nr Schritt: Kopf, dann je Aufgabe einer
+******************************************************************/
+bool aufgabenSchritt(int nr) {
+  if (nr == 0) {
+    sendeFormatiert("{\"schlafAnteil\":%.3f,\"aufgaben\":[", schlafUs / 1000.0 / max(millis(), 1UL));
+    return true;
+  }
+  nr--;
+  if (nr < AUFGABE_ANZAHL) {
+    const Aufgabe& aufgabe = aufgaben[nr];
+    if (aufgabe.funktion != NULL) {
+      sendeFormatiert("%s{\"name\":\"%s\",\"intervallMs\":%lu,\"laeufe\":%u,\"verspaetet\":%u,\"maxVerspaetungMs\":%u,\"maxDauerMs\":%u}",
+                      nr > 0 ? "," : "", aufgabe.name, aufgabe.intervall, aufgabe.laeufe, aufgabe.verspaetet,
+                      aufgabe.maxVerspaetungMs, aufgabe.maxDauerMs);
+    }
+    return true;
+  }
+  sendeFormatiert("]}");
+  return false;
+}
+
+void handleAufgaben(AsyncWebServerRequest* request) {
+  webAntwortSenden(request, "application/json", new (std::nothrow) SchrittAntwort(aufgabenSchritt));
+}
+
+/*****************************************************************
+* @brief Ein Histogramm im Prometheus Textformat senden (kumulative
+*        Eimer in Sekunden, _sum und _count)
+* @param name Name der Metrik
+* @param labels zusätzliche Labels ohne Klammern, z.B. ziel="soc", darf leer sein
+******************************************************************/
+void sendeHistogramm(const char* name, const char* labels, const Histogramm& h) {
+  const char* trenner = labels[0] ? "," : "";
+  uint32_t summe = 0;
+  for (uint8_t k = 0; k <= h.anzahl; k++) {
+    summe += h.eimer[k].load(std::memory_order_relaxed);
+    if (k < h.anzahl) {
+      sendeFormatiert("%s_bucket{%s%sle=\"%g\"} %u\n", name, labels, trenner, h.grenzenUs[k] / 1e6, summe);
+    } else {
+      sendeFormatiert("%s_bucket{%s%sle=\"+Inf\"} %u\n", name, labels, trenner, summe);
+    }
+  }
+  sendeFormatiert("%s_sum{%s} %.6f\n%s_count{%s} %u\n", name, labels,
+                  h.summeS.load(std::memory_order_relaxed), name, labels, summe);
+}
+
+/*****************************************************************
+* @brief Einen Zähler der Zeitbudgets für die HTTP Verbindungen
+*        einer Wallbox
+* @param name Name der Metrik
+* @param abgebrochen true = abgebrochen, false = verschoben
+* @param wb Nummer der Wallbox
+******************************************************************/
+void sendeBudgetZaehler(const char* name, bool abgebrochen, int wb) {
+  const Wallbox& w = wallboxen[wb];
+  sendeFormatiert("%s{ziel=\"shelly\",wallbox=\"%s\"} %u\n%s{ziel=\"smartwb\",wallbox=\"%s\"} %u\n",
+                  name, w.konfig->name, abgebrochen ? w.shelly.abgebrochen : w.shelly.verschoben,
+                  name, w.konfig->name, abgebrochen ? w.smartWB.abgebrochen : w.smartWB.verschoben);
+}
+
+// Schaltbefehle je Shelly, Reihenfolge wie in sendeShellyZaehler()
+const int SHELLY_METRIK_ANZAHL = 3;
+static const char* const SHELLY_METRIK_KOPF[SHELLY_METRIK_ANZAHL] = {
+  "# HELP smartwb_shelly_offen Schaltbefehl noch nicht mit HTTP 200 bestätigt\n# TYPE smartwb_shelly_offen gauge\n",
+  "# HELP smartwb_shelly_nachgeholt_total Wiederholungen offener Schaltbefehle\n# TYPE smartwb_shelly_nachgeholt_total counter\n",
+  "# HELP smartwb_shelly_fehlgeschlagen_total Schaltbefehle, die nach SHELLY_FRIST_MS noch offen waren\n# TYPE smartwb_shelly_fehlgeschlagen_total counter\n",
+};
+
+/*****************************************************************
+* @brief Eine Zeile der Shelly Schaltbefehle für /metrics
+* @param metrik 0 = offen, 1 = nachgeholt, 2 = fehlgeschlagen
+* @param wb Nummer der Wallbox
+******************************************************************/
+void sendeShellyZaehler(int metrik, int wb) {
+  const Wallbox& w = wallboxen[wb];
+  const char* name = WALLBOX_KONFIG[wb].name;
+  switch (metrik) {
+    case 0:  sendeFormatiert("smartwb_shelly_offen{wallbox=\"%s\"} %d\n", name, w.shellyOffen ? 1 : 0);                 break;
+    case 1:  sendeFormatiert("smartwb_shelly_nachgeholt_total{wallbox=\"%s\"} %u\n", name, w.shellyNachgeholt);         break;
+    default: sendeFormatiert("smartwb_shelly_fehlgeschlagen_total{wallbox=\"%s\"} %u\n", name, w.shellyFehlgeschlagen); break;
+  }
+}
+
+/*****************************************************************
+* @brief Inhalt von /metrics: Laufzeiten, HTTP Latenzen, Heap,
+*        RSE Flanken und Watchdog im Prometheus Textformat
+* @param nr Schritt, je Histogramm bzw. Wallbox einer
+******************************************************************/
+bool metrikSchritt(int nr) {
+  // die Abschnitte der Reihe nach durchzählen, je Schritt einer
+  char labels[64];
+  int k = 0;
+  if (nr == k++) {
+    sendeFormatiert("# HELP smartwb_loop_dauer_sekunden Ein Durchlauf von loop() ohne Schlafen\n# TYPE smartwb_loop_dauer_sekunden histogram\n");
+    sendeHistogramm("smartwb_loop_dauer_sekunden", "", metrikLoop);
+    return true;
+  }
+  if (nr == k++) {
+    sendeFormatiert("# HELP smartwb_web_schritt_sekunden Ein Schritt einer Web Antwort im async_tcp Task\n# TYPE smartwb_web_schritt_sekunden histogram\n");
+    sendeHistogramm("smartwb_web_schritt_sekunden", "", metrikWebSchritt);
+    return true;
+  }
+  if (nr == k++) {
+    sendeFormatiert("# HELP smartwb_oled_flush_sekunden I2C Übertragung der geänderten OLED Seiten\n# TYPE smartwb_oled_flush_sekunden histogram\n");
+    sendeHistogramm("smartwb_oled_flush_sekunden", "", metrikFlush);
+    return true;
+  }
+  if (nr == k++) {
+    sendeFormatiert("# HELP smartwb_http_dauer_sekunden HTTP Anfrage von GET bis zum Ende der Antwort\n# TYPE smartwb_http_dauer_sekunden histogram\n");
+#ifdef USE_EV_SOC_API
+    sendeHistogramm("smartwb_http_dauer_sekunden", "ziel=\"soc\"", verbindungSoc.dauer);
+#endif
+    return true;
+  }
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    if (nr == k++) {
+      snprintf(labels, sizeof(labels), "ziel=\"shelly\",wallbox=\"%s\"", WALLBOX_KONFIG[wb].name);
+      sendeHistogramm("smartwb_http_dauer_sekunden", labels, wallboxen[wb].shelly.dauer);
+      return true;
+    }
+    if (nr == k++) {
+      snprintf(labels, sizeof(labels), "ziel=\"smartwb\",wallbox=\"%s\"", WALLBOX_KONFIG[wb].name);
+      sendeHistogramm("smartwb_http_dauer_sekunden", labels, wallboxen[wb].smartWB.dauer);
+      return true;
+    }
+  }
+  if (nr == k++) {
+    sendeFormatiert("# HELP smartwb_http_abgebrochen_total Anfragen, die ihr Zeitbudget überschritten haben\n# TYPE smartwb_http_abgebrochen_total counter\n");
+#ifdef USE_EV_SOC_API
+    sendeFormatiert("smartwb_http_abgebrochen_total{ziel=\"soc\"} %u\n", verbindungSoc.abgebrochen);
+#endif
+    return true;
+  }
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    if (nr == k++) {
+      sendeBudgetZaehler("smartwb_http_abgebrochen_total", true, wb);
+      return true;
+    }
+  }
+  if (nr == k++) {
+    sendeFormatiert("# HELP smartwb_http_verschoben_total Anfragen, die mangels Zeitbudget nicht gesendet wurden\n# TYPE smartwb_http_verschoben_total counter\n");
+#ifdef USE_EV_SOC_API
+    sendeFormatiert("smartwb_http_verschoben_total{ziel=\"soc\"} %u\n", verbindungSoc.verschoben);
+#endif
+    return true;
+  }
+  for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+    if (nr == k++) {
+      sendeBudgetZaehler("smartwb_http_verschoben_total", false, wb);
+      return true;
+    }
+  }
+  for (int m = 0; m < SHELLY_METRIK_ANZAHL; m++) {
+    if (nr == k++) {
+      sendeText(SHELLY_METRIK_KOPF[m]);
+      return true;
+    }
+    for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+      if (nr == k++) {
+        sendeShellyZaehler(m, wb);
+        return true;
+      }
+    }
+  }
+  if (nr == k++) {
+    sendeFormatiert("# HELP smartwb_wdt_abstand_sekunden Abstand zwischen zwei Watchdog Resets von loop()\n# TYPE smartwb_wdt_abstand_sekunden histogram\n");
+    sendeHistogramm("smartwb_wdt_abstand_sekunden", "", metrikWdtAbstand);
+    return true;
+  }
+  sendeFormatiert("# TYPE smartwb_wdt_timeout_sekunden gauge\nsmartwb_wdt_timeout_sekunden %d\n", WDT_TIMEOUT_SECONDS);
+  sendeFormatiert("# TYPE smartwb_wdt_seit_reset_sekunden gauge\nsmartwb_wdt_seit_reset_sekunden %.3f\n",
+                  (esp_timer_get_time() - wdtResetUs) / 1e6);
+
+  sendeFormatiert("# TYPE smartwb_heap_frei_bytes gauge\nsmartwb_heap_frei_bytes %u\n", ESP.getFreeHeap());
+  sendeFormatiert("# TYPE smartwb_heap_min_frei_bytes gauge\nsmartwb_heap_min_frei_bytes %u\n", ESP.getMinFreeHeap());
+
+  sendeFormatiert("# HELP smartwb_rse_flanken_total Von der ISR erfasste RSE Flanken\n# TYPE smartwb_rse_flanken_total counter\nsmartwb_rse_flanken_total %u\n", rseFlankenRoh);
+  sendeFormatiert("# TYPE smartwb_rse_stoerimpulse_total counter\nsmartwb_rse_stoerimpulse_total %u\n", rseStoerimpulse);
+  sendeFormatiert("# TYPE smartwb_rse_verloren_total counter\nsmartwb_rse_verloren_total %u\n", rseUeberlauf);
+  sendeFormatiert("# TYPE smartwb_rcr_ohne_zeit_total counter\nsmartwb_rcr_ohne_zeit_total %u\n", journalOhneZeit);
+  sendeFormatiert("# TYPE smartwb_laufzeit_sekunden counter\nsmartwb_laufzeit_sekunden %.3f\n", esp_timer_get_time() / 1e6);
+  return false;
+}
+
+void handleMetrics(AsyncWebServerRequest* request) {
+  webAntwortSenden(request, "text/plain; version=0.0.4", new (std::nothrow) SchrittAntwort(metrikSchritt));
+}
+
+#ifdef USE_BENCHMARK
+// Benchmarks der heißen Pfade auf dem Gerät (/api/benchmark): Zeit je Aufruf in ns und was
+// dabei auf dem Heap liegen bleibt. Als Vergleichswert vor und nach einer Optimierung.
+// Läuft im async_tcp Task, je Benchmark ein Schritt der Antwort. Andere Anfragen warten solange,
+// loop() und die Anzeige laufen weiter.
+// Die Anzahl malloc/free je Aufruf zählt der Heap Trace von ESP-IDF. Er muss in der sdkconfig
+// eingeschaltet sein (CONFIG_HEAP_TRACING_STANDALONE, die vorkompilierten Arduino Bibliotheken
+// haben ihn nicht), sonst fehlen die Spalten. Gezählt wird alles, was während der Messung
+// angefordert wird, also auch von anderen Tasks.
+
+// Aufgezeichnete Antwort einer SmartWB auf /getParameters
+const char BENCH_PARAMETER[] PROGMEM = R"({"type":"parameters","list":[{"vehicleState":3,"evseState":true,"maxCurrent":16,"actualCurrent":16,"actualPower":10.87,"duration":5421339,"alwaysActive":false,"lastActionUser":"GUI","lastActionUID":"GUI","energy":14.32,"mileage":95.2,"meterReading":4711.42,"currentP1":15.8,"currentP2":15.7,"currentP3":15.9,"voltageP1":229.6,"voltageP2":231.2,"voltageP3":230.4,"useMeter":true,"RFIDUID":"","lastUsedAt":"","rseActive":false,"rseValue":100}]})";
+
+GFXcanvas1* benchLeinwand = NULL;   // emulierter OLED Zeichenpuffer
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+heap_trace_record_t benchSpuren[64];  // die Anzahl zählt der Trace auch, wenn die Spuren überlaufen
+#endif
+volatile int benchErgebnis = 0;     // damit der Compiler nichts wegoptimiert
+
+void benchJson() {
+  StaticJsonDocument<384> doc;
+  WallboxWerte werte;
+  if (deserializeJson(doc, BENCH_PARAMETER, DeserializationOption::Filter(getSmartWBFilter())) == DeserializationError::Ok) {
+    smartWBWerteLesen(doc["list"][0], werte);
+  }
+  benchErgebnis += werte.maxCurrent;
+}
+
+void benchStatus() {
+  static WallboxWerte werte[WALLBOX_ANZAHL];
+  static char puffer[SSE_NACHRICHT_LAENGE];
+  webMomentaufnahme(werte);
+  benchErgebnis += sseNachrichtBauen(puffer, sizeof(puffer), true, werte);  // alle Werte der Statusseite formatieren
+}
+
+void benchZeitstempel() {
+  benchErgebnis += getZeitstempel()[1];
+}
+
+void benchZeitstempelMs() {
+  benchErgebnis += getZeitstempelMs()[1];
+}
+
+void benchBalken() {
+  static int fortschritt = 0;
+  fortschritt = (fortschritt + 7) % 101;
+  drawProgressBar(fortschritt, *benchLeinwand);
+}
+
+void benchWallbox() {
+  wallboxZeichnen(*benchLeinwand);
+}
+
+void benchSeite() {
+  // Statusseite wie für "/", die Antwort liegt statt auf dem Heap in einem festen Speicher
+  alignas(StatusAntwort) static uint8_t speicher[sizeof(StatusAntwort)];
+  static uint8_t stueck[1024];  // wie der Webserver je Paket abholt
+  WebAntwort* aufrufer = webAusgabe;  // läuft selbst in einem Schritt von /api/benchmark
+  StatusAntwort* antwort = new (speicher) StatusAntwort();
+  size_t n;
+  while ((n = antwort->fuellen(stueck, sizeof(stueck))) > 0) {
+    benchErgebnis += n;
+  }
+  antwort->~StatusAntwort();
+  webAusgabe = aufrufer;
+}
+
+void benchLed() {
+  // Wechsel der Betriebsart wie aus loop(), je Aufruf hin und zurück zum Blitzen der Watchdog LED.
+  // Die Muster selbst laufen im esp_timer Task und zählen nur beim Heap mit.
+  static const LedMode MODI[] = { LEDMODE_ON, LEDMODE_FADE, LEDMODE_BLINK, LEDMODE_OFF };
+  static uint32_t k = 0;
+  led3.setMode(MODI[k++ % (sizeof(MODI) / sizeof(MODI[0]))]);
+  led3.setMode(LEDMODE_FLASH);
+}
+
+struct Benchmark {
+  const char* name;
+  uint32_t    anzahl;     // Aufrufe je Messung
+  void      (*funktion)();
+};
+const Benchmark BENCHMARKS[] = {
+  { "json_parameter", 200,   benchJson },
+  { "status_werte",   100,   benchStatus },
+  { "status_seite",   20,    benchSeite },
+  { "zeitstempel",    10000, benchZeitstempel },
+  { "zeitstempel_ms", 10000, benchZeitstempelMs },
+  { "oled_balken",    1000,  benchBalken },
+  { "oled_wallbox",   1000,  benchWallbox },
+  { "led_modus",      1000,  benchLed },
+};
+
+struct BenchMessung {
+  uint32_t nsProAufruf;
+  int      heapDeltaBytes;    // nach der Messung mehr belegt als vorher
+  uint32_t minFreiBytes;
+  bool     trace;             // malloc/free gezählt, nur mit Heap Trace
+  float    mallocProAufruf;
+  float    freeProAufruf;
+};
+
+/*****************************************************************
+* @brief Legt beim ersten Aufruf den Zeichenpuffer und den Heap
+*        Trace für die Benchmarks an
+******************************************************************/
+void benchVorbereiten() {
+  if (benchLeinwand == NULL) {
+    benchLeinwand = new GFXcanvas1(SCREEN_WIDTH, SCREEN_HEIGHT);
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+    heap_trace_init_standalone(benchSpuren, sizeof(benchSpuren) / sizeof(benchSpuren[0]));
+#endif
+  }
+}
+
+/*****************************************************************
+* @brief Einen Benchmark messen: einmal zum Aufwärmen (Filter,
+*        Puffer und Caches anlegen), dann anzahl Mal
+* @param b Benchmark
+* @param anzahl Aufrufe
+* @return Zeit je Aufruf und Heap
+******************************************************************/
+BenchMessung benchMessen(const Benchmark& b, uint32_t anzahl) {
+  BenchMessung m = {};
+  b.funktion();
+  multi_heap_info_t vorher, nachher;
+  heap_caps_get_info(&vorher, MALLOC_CAP_8BIT);
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+  m.trace = heap_trace_start(HEAP_TRACE_ALL) == ESP_OK;
+#endif
+  int64_t startUs = esp_timer_get_time();
+  for (uint32_t k = 0; k < anzahl; k++) {
+    b.funktion();
+  }
+  int64_t dauerUs = esp_timer_get_time() - startUs;
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+  if (m.trace) {
+    heap_trace_summary_t spur = {};
+    heap_trace_stop();
+    heap_trace_summary(&spur);
+    m.mallocProAufruf = (float)spur.total_allocations / anzahl;
+    m.freeProAufruf   = (float)spur.total_frees / anzahl;
+  }
+#endif
+  heap_caps_get_info(&nachher, MALLOC_CAP_8BIT);
+  m.nsProAufruf    = (uint32_t)(dauerUs * 1000 / anzahl);
+  m.heapDeltaBytes = (int)(nachher.total_allocated_bytes - vorher.total_allocated_bytes);
+  m.minFreiBytes   = nachher.minimum_free_bytes;
+  return m;
+}
+
+// /api/benchmark: je Schritt ein Benchmark
+struct BenchmarkAntwort : WebAntwort {
+  String nur;          // nur dieser Benchmark, leer = alle
+  size_t nr = 0;
+  bool   kopf = true;
+  bool   erster = true;
+
+  explicit BenchmarkAntwort(const String& nur) : nur(nur) {}
+
+  bool schritt() override {
+    if (kopf) {
+      kopf = false;
+      sendeFormatiert("{\"cpuMHz\":%u,\"benchmarks\":[", ESP.getCpuFreqMHz());
+      return true;
+    }
+    if (nr == sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0])) {
+      sendeFormatiert("]}");
+      return false;
+    }
+    const Benchmark& b = BENCHMARKS[nr++];
+    if (nur.length() > 0 && nur != b.name) {
+      return true;
+    }
+    BenchMessung m = benchMessen(b, b.anzahl);
+    sendeFormatiert("%s{\"name\":\"%s\",\"anzahl\":%u,\"nsProAufruf\":%u,\"heapDeltaBytes\":%d,\"minFreiBytes\":%u",
+                    erster ? "" : ",", b.name, b.anzahl, m.nsProAufruf, m.heapDeltaBytes, m.minFreiBytes);
+    if (m.trace) {
+      sendeFormatiert(",\"mallocProAufruf\":%.2f,\"freeProAufruf\":%.2f", m.mallocProAufruf, m.freeProAufruf);
+    }
+    sendeFormatiert("}");
+    erster = false;
+    return true;
+  }
+};
+
+/*****************************************************************
+* @brief HTTP-Handler für /api/benchmark[?name=...]: führt die
+*        Benchmarks aus, je einmal zum Aufwärmen und dann anzahl Mal
+* @param request Anfrage
+******************************************************************/
+void handleBenchmark(AsyncWebServerRequest* request) {
+  benchVorbereiten();
+  String nur = request->hasParam("name") ? request->getParam("name")->value() : String();
+  webAntwortSenden(request, "application/json", new (std::nothrow) BenchmarkAntwort(nur));
+}
+#endif
+
+#ifdef USE_RSE_SIMULATION
+/*****************************************************************
+* @brief Perzentile einer Messreihe als JSON Objekt senden
+******************************************************************/
+void sendeSimMessung(const char* name, SimMessung& messung) {
+  uint32_t n = messung.anzahl;
+  uint32_t p50 = 0, p99 = 0, maxUs = 0;
+  if (n > 0) {
+    uint32_t* sortiert = (uint32_t*)malloc(n * sizeof(uint32_t));
+    if (sortiert != NULL) {
+      memcpy(sortiert, messung.probenUs, n * sizeof(uint32_t));
+      std::sort(sortiert, sortiert + n);
+      p50   = sortiert[(n - 1) / 2];
+      p99   = sortiert[(n - 1) * 99 / 100];
+      maxUs = sortiert[n - 1];
+      free(sortiert);
+    }
+  }
+  sendeFormatiert("\"%s\":{\"anzahl\":%u,\"fehler\":%u,\"p50Us\":%u,\"p99Us\":%u,\"maxUs\":%u}",
+                  name, n, messung.fehler, p50, p99, maxUs);
+}
+
+/*****************************************************************
+* @brief Inhalt von /api/simulation
+* @param nr Schritt, es gibt nur einen
+******************************************************************/
+bool simulationSchritt(int nr) {
+  sendeFormatiert("{\"laeuft\":%s,\"zyklen\":%u,\"geplant\":%u,\"periodeMs\":%u,\"verpasst\":%u,",
+                  simLaeuft ? "true" : "false", simZyklen, simGeplant, RSE_SIM_PERIODE_MS, simVerpasst);
+  sendeSimMessung("shelly", simShelly);
+  sendeFormatiert(",");
+  sendeSimMessung("statusseite", simSse);
+  sendeFormatiert("}");
+  return false;
+}
+
+/*****************************************************************
+* @brief HTTP-Handler für /api/simulation[?start=zyklen]: startet die
+*        RSE Simulation und liefert die Latenzen Flanke -> Shelly und
+*        Flanke -> Statusseite (/events)
+* @param request Anfrage
+******************************************************************/
+void handleSimulation(AsyncWebServerRequest* request) {
+  if (request->hasParam("start")) {
+    uint32_t zyklen = webZahl(request, "start", 0);
+    if (!simStarten(zyklen > 0 ? zyklen : RSE_SIM_ZYKLEN)) {
+      request->send(409, "text/plain", "Simulation läuft schon oder kein Speicher");
+      return;
+    }
+  }
+  webAntwortSenden(request, "application/json", new (std::nothrow) SchrittAntwort(simulationSchritt));
+}
+#endif
+
+// ### Setup Routine ###
+void setup() {
+  Serial.begin(115200);
+  xTaskCreatePinnedToCore(logTask, "log", 3072, NULL, 1, &logTaskHandle, 0);  // Log-Ausgabe im Hintergrund auf Core 0
+
+  // Speicher für den Messwertverlauf gleich zu Beginn reservieren, solange der Heap noch nicht zerstückelt ist
+  if (verlaufReservieren() < VERLAUF_BLOECKE) {
+    logSchreiben(LOG_FEHLER, "Messwertverlauf: nur %u von %u KB je Wallbox frei, reicht beim Laden etwa %uh",
+                 verlaufBloecke, VERLAUF_BLOECKE, verlaufReichtLadenS() / 3600);
+  }
+
+  // Energie- und RCR-Zähler aus RTC-RAM bzw. NVS übernehmen
+  abrechnungStarten();
+  // RCR Journal auf LittleFS
+  journalStarten();
+
+  // Pins konfigurieren
+  pinMode(LED1_PIN, OUTPUT);  // Grün: SmartWB Zustand: EIN bei aktiv, FADE bei nicht aktiv
+  pinMode(LED2_PIN, OUTPUT);  // Rot
+  pinMode(LED3_PIN, OUTPUT);  // Blau
+  pinMode(RSE, INPUT_PULLUP); // Hier und an GND muss der Schließer des RSE Relais angeschlossen werden
+
+  // LED initialisieren
+  // LED1: Fade (wenn Ereignis1 nicht aktiv, sonst Konstant AN...ggf. auch AUS wenn SmartWB(evse nicht erreichbar)
+  led1.begin(LED1_PIN, LEDC_CHANNEL_0, LEDC_TIMER_0);
+  led1.fadeStep  = 5;
+  led1.fadeDelay = 30;
+
+  // LED2: Blink (bei Ereignis2 = RSE aktiv = LOW)
+  led2.begin(LED2_PIN, LEDC_CHANNEL_1, LEDC_TIMER_1);
+  led2.blinkInterval = 250; //ms
+
+  // LED3: Flash (immer)
+  led3.begin(LED3_PIN, LEDC_CHANNEL_2, LEDC_TIMER_2);
+  led3.flashOn  = 100;   //ms AN 125
+  led3.flashOff = 3000;  //ms AUS 2000
 
   // Startzustände
   led1.setMode(LEDMODE_FADE); //SmartWB ist online aber nicht aktiv
@@ -556,16 +4364,18 @@ void setup() {
   // OLED Initialisieren, Preprozessor entscheidet anhand der OLED_TYPE_xxx welcher Initialisierungsteil genutzt werden soll.
   
   #ifdef OLED_TYPE_SSD1306
-  if(!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) { // 0x3C ist oft die Standardadresse
+  if(!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADRESSE)) {
     Serial.println(F("SSD1306 allocation failed"));
     for(;;); // Abbruch
   }
   #else
-  if(!display.begin(0x3C, true)) { // 0x3C ist oft die Standardadresse
+  if(!display.begin(OLED_ADRESSE, true)) {
     Serial.println(F("SH110X allocation failed"));
     for(;;); // Abbruch
   }
   #endif
+  Wire.setClock(OLED_I2C_TAKT);       // die Bibliothek stellt nach begin() wieder auf 100kHz zurück
+  display.flushTaskStarten();         // ab hier überträgt der Flush-Task im Hintergrund
 
   display.clearDisplay();             //OLED löschen
   display.setTextSize(1);             // Textgröße
@@ -579,7 +4389,7 @@ void setup() {
   display.setCursor(0,0);             // Startposition
 
   // WLAN verbinden und auf serial und OLED ausgeben
-  Serial.println(getZeitstempel() + " Verbinde mit WLAN");
+  logSchreiben(LOG_INFO, "Verbinde mit WLAN");
   display.print("Verbinde mit WLAN"); // ebenfalls auf das OLED schreiben
   WiFi.begin(ssid, password);
 
@@ -589,14 +4399,13 @@ void setup() {
     display.print("."); // auch auf das OLED schreiben
     display.display();
   }
-  Serial.print("Sketch-Dateiname: ");
-  Serial.println(__FILE__);
-  Serial.println("Programmversion: " VERSION);
-
   Serial.println("");
+  logSchreiben(LOG_INFO, "Sketch-Dateiname: %s", __FILE__);
+  logSchreiben(LOG_INFO, "Programmversion: " VERSION);
+
   display.println();
-  Serial.println(getZeitstempel() + " WLAN verbunden!");
-  Serial.println(getZeitstempel() + " IP-Adresse: " + WiFi.localIP().toString());
+  logSchreiben(LOG_INFO, "WLAN verbunden!");
+  logSchreiben(LOG_INFO, "IP-Adresse: %s", WiFi.localIP().toString().c_str());
   display.clearDisplay();                           // OLED Display löschen
   display.setCursor(0, 8);                         // Cursor auf die 2. Zeile setzten
   display.print("IP: "+ WiFi.localIP().toString()); // IP auf OLED anzeigen
@@ -610,261 +4419,107 @@ void setup() {
   display.print(getZeitstempel());  //Zeit auf OLED schreiben
   display.display();                //
 
-  // Webserver konfigurieren und starten
-  server.on("/", handleRoot);
-  server.begin();
-  Serial.println(getZeitstempel() + " Webserver gestartet auf http://" + WiFi.localIP().toString());
+  // Aktor-Task starten, er übernimmt ab jetzt die Shelly Schaltung und weckt danach loop()
+  hauptTaskHandle = xTaskGetCurrentTaskHandle();  // setup() und loop() laufen im selben Task
+  wallboxenStarten();
+  RSEAktiv = (digitalRead(RSE) == LOW);
+  xTaskCreatePinnedToCore(aktorTask, "aktor", AKTOR_TASK_STACK, NULL, AKTOR_TASK_PRIO, &aktorTaskHandle, AKTOR_TASK_CORE);
 
   // Interrupt konfigurieren
   attachInterrupt(digitalPinToInterrupt(RSE), isrRSE, CHANGE);
 
-// Erstmalige Initialisierung um einen SoC zu erhalten
-#ifdef USE_EV_SOC_API
-  soc = getSoc();
+  // Webserver konfigurieren und starten. Erst nach wallboxenStarten(), die Handler lesen die
+  // Konfiguration der Wallboxen (/metrics)
+  server.on("/", HTTP_GET, handleRoot);
+  server.on("/log", HTTP_GET, handleLog);
+  server.on("/api/history", HTTP_GET, handleHistory);
+  server.on("/api/energie", HTTP_GET, handleEnergie);
+  server.on("/api/rcr", HTTP_GET, handleRcrJournal);
+  server.on("/api/aufgaben", HTTP_GET, handleAufgaben);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+#ifdef USE_LOOP_PROFILER
+  server.on("/api/profil", HTTP_GET, handleProfil);
+#endif
+#ifdef USE_BENCHMARK
+  server.on("/api/benchmark", HTTP_GET, handleBenchmark);
+#endif
+#ifdef USE_RSE_SIMULATION
+  server.on("/api/simulation", HTTP_GET, handleSimulation);
+#endif
+  server.onNotFound([](AsyncWebServerRequest* request) {
+    request->send(404, "text/plain", "Nicht gefunden");
+  });
+  events.onConnect(eventsVerbunden);
+  server.addHandler(&events);
+  server.begin();
+  xTaskCreatePinnedToCore(webTask, "web", WEB_TASK_STACK, NULL, WEB_TASK_PRIO, &webTaskHandle, WEB_TASK_CORE);
+  logSchreiben(LOG_INFO, "Webserver gestartet auf http://%s", WiFi.localIP().toString().c_str());
+
+// Den ersten SoC holt aufgabeSoc(), sobald die erste SmartWB Abfrage ein Fahrzeug meldet
+// (wallboxenAuswerten()). Ohne Fahrzeug wird der SoC Server nicht gefragt.
+
+#ifdef USE_MQTT
+  mqtt.setServer(MQTT_SERVER, MQTT_PORT);
+  mqtt.setSocketTimeout(2);  // s, Standard sind 15s und damit mehr als der Watchdog erlaubt
+#ifdef MQTT_SOC_TOPIC
+  mqtt.setCallback(mqttEmpfangen);
+#endif
 #endif
 
     // Fügt die aktuelle Task dem Watchdog hinzu. 
   // Das ESP-IDF-Framework initialisiert den Watchdog oft automatisch.
-  Serial.println("Watchdog-Task wird zur Überwachung hinzugefügt...");
+  logSchreiben(LOG_INFO, "Watchdog-Task wird zur Überwachung hinzugefügt...");
   esp_task_wdt_add(NULL);
 
   // Optional: Checke den Reset-Grund für Debug-Zwecke
   esp_reset_reason_t reason = esp_reset_reason();
   if (reason == ESP_RST_TASK_WDT) {
-    Serial.println("Letzter Neustart wurde durch den Task Watchdog ausgelöst.");
+    logSchreiben(LOG_WARNUNG, "Letzter Neustart wurde durch den Task Watchdog ausgelöst.");
   }
-  Serial.println("Watchdog 1. reset..."); 
+#ifdef USE_LOOP_PROFILER
+  profilStarten(reason);  // nach einem Watchdog-Neustart: welcher Abschnitt hing
+#endif
+  logSchreiben(LOG_DEBUG, "Watchdog 1. reset...");
   esp_task_wdt_reset(); // Watchdog zurücksetzen...
+  wdtResetUs = esp_timer_get_time();
 
 }
 
-
+// ### Loop Routine ###
 void loop() {
-  unsigned long now = millis();
-  int httpCode;
-
-  // RSE Flankenerkennung
-  if (RSEAktiv != letzterRSEStatus) {
-    letzterRSEStatus = RSEAktiv;
-
-    if (RSEAktiv) {
-      Serial.println(getZeitstempel() + " RSE wurde AKTIV → Power ON");
-      if (WiFi.status() == WL_CONNECTED) {
-        HTTPClient http;
-        http.begin(urlOn);
-        int httpCode = http.GET();
-        Serial.println(getZeitstempel() + " HTTP Antwort: " + String(httpCode));
-        http.end();
-      }
-    } else {
-      Serial.println(getZeitstempel() + " RSE wurde INAKTIV → Power OFF");
-      if (WiFi.status() == WL_CONNECTED) {
-        HTTPClient http;
-        http.begin(urlOff);
-        int httpCode = http.GET();
-        Serial.println(getZeitstempel() + " HTTP Antwort: " + String(httpCode));
-        http.end();
-      }
-    }
-  }
-
-  // LED Steuerung und RSE Anzeige auf OLED
-  if (RSEAktiv) {
-    //digitalWrite(LED_GRUEN, LOW);
-    led2.setMode(LEDMODE_BLINK); // RSE aktiv rote LED blinken
-    // led1.setMode(LEDMODE_OFF);   //Grüne LED aus
-
-    // Blink-Logik für Rot mit millis()
-    aktuelleUmschaltung = millis();
-    if (aktuelleUmschaltung - letzteUmschaltung >= led2.blinkInterval) {
-      letzteUmschaltung = aktuelleUmschaltung;
-      rotStatus = !rotStatus;
-      //digitalWrite(LED_ROT, rotStatus);
-      //RSE Anzeige im  OLED setzen
-      display.setCursor(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y); // y=78 (13.Spalte), x=40 (5.Zeile)
-      if (rotStatus) {
-        display.print("RSE akt"); //RSE Anzeige blinken lassen -> Ein
-      } else {
-        #ifdef OLED_TYPE_SSD1306
-          display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SSD1306_BLACK); //RSE Anzeige blinken lassen -> Aus
-        #else
-          display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SH110X_BLACK); //RSE Anzeige blinken lassen -> Aus
-        #endif        
-      }    
-      display.display(); 
-    }
-
-  } else {
-    // Normalzustand → Rot aus, Grün an
-    //digitalWrite(LED_ROT, LOW);
-    //digitalWrite(LED_GRUEN, HIGH);
-    led2.setMode(LEDMODE_OFF);
-    if (httpCode >=0 ){ //wenn die SmartWB erreichbar ist, dann entweder FADE (bei bereit) oder ON (bei EIN)
-      led1.setMode(evseState ? LEDMODE_ON : LEDMODE_FADE);
-    }
-    else {
-      led1.setMode(LEDMODE_OFF); //SmartWB ist nicht erreichbar also AUS schalten
-    }
-    //RSE Anzeige im OLED löschen
-    display.setCursor(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y); // x=78 (13.Spalte), y=40 (5.Zeile)
-    // RSE Anzeige wieder  löschen // x=78 (13.Spalte), y=40 (5.Zeile)
-    #ifdef OLED_TYPE_SSD1306
-    display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SSD1306_BLACK);
-    #else
-    display.fillRect(13 * CHAR_SIZE_X, 5 * CHAR_SIZE_Y, SCREEN_WIDTH - 13 * CHAR_SIZE_X, CHAR_SIZE_Y, SH110X_BLACK);
-    #endif
-    display.display();
-  }
-  //Uhrzeit und Fortschrittsbalken alle CLOCKCOUNT sec anzeigen
-  aktuelleUhrAnzeige = millis();
-  if (aktuelleUhrAnzeige - letzteUhrAnzeige >= UHR_ANZEIGE_INTERVAL) {
-      letzteUhrAnzeige = aktuelleUhrAnzeige;
-      display.setCursor(0,0);           //Cursor wieder oben links setzen für Zeitausgabe
-      // Zeile überschreiben mit schwarzem Rechteck (löschen)
-      #ifdef OLED_TYPE_SSD1306
-      display.fillRect(0, 0, SCREEN_WIDTH, CHAR_SIZE_Y, SSD1306_BLACK);
-      #else
-      display.fillRect(0, 0, SCREEN_WIDTH, CHAR_SIZE_Y, SH110X_BLACK);
-      #endif
-      
-      display.print(getZeitstempel());  //Zeit auf OLED schreiben
-      // Vielleicht zeige ich in dem Fortschrittsbalken mal den SOC vom angeschlossenen Auto an...
-      // Inkrementiere den Fortschritt und setze ihn bei 100% zurück
-      // currentProgress = (currentProgress >= 10) ? 0 : currentProgress + 1; //10sec
-      // Serial.print("Progress: " + String(currentProgress));
-      // Übergabe des Fortschritts an die Routine
-      //drawProgressBar(currentProgress*10);
-      // Watchdog reset
-    Serial.print("Watchdog reset..."); //Es scheint so zu sein, als wäre er Systemseitig auf 5sec eingestellt. Das führt bei Power-On schon zu einem Reboot. Daher auch schon mal in der Setup Routine zurücksetzen!
-    // esp_task_wdt_reset(); // Watchdog zurücksetzen (sollte alle 1000ms passieren, da die Zeitanzeige jede Sekunde aufgerufen wird
-    esp_err_t err_code = esp_task_wdt_reset(); 
-    Serial.println("Ergebnis: " + String(err_code));
-
-
-      display.display();                //
+  int64_t loopStartUs = esp_timer_get_time();
+  // Bei einer RSE Flanke sofort abfragen und danach eine Weile schnell, um die Reduzierung der Wallbox zu sehen
+  if (RSEAktiv != letzterRSEStatusSmartWB) {
+    letzterRSEStatusSmartWB = RSEAktiv;
+    rseFensterStart = millis();
+    rseFensterAktiv = true;
+    smartWBIntervall = ABFRAGE_SCHNELL_MS;
+    aufgaben[AUFGABE_SMARTWB].intervall = smartWBIntervall;
+    aufgabeJetzt(AUFGABE_SMARTWB);
+    aufgabeJetzt(AUFGABE_RSE);
+    aufgabeJetzt(AUFGABE_MQTT);
   }
 
-#ifdef USE_EV_SOC_API
-  // Alle SOC_ANZEIGE_INTERVAL msec SoC vom lokalen EV-SOC-Server holen
-  aktuelleSocAnzeige = millis();
-  if (aktuelleSocAnzeige - letzteSocAnzeige >= SOC_ANZEIGE_INTERVAL) {
-    letzteSocAnzeige = aktuelleSocAnzeige;
-    soc = getSoc();
-    Serial.printf("SoC: %d%%\n", soc);
+  {
+    PROFIL(PROFIL_AUSWERTEN);
+    wallboxenAuswerten();       // Ergebnisse der SmartWB Abfrage-Tasks
   }
-#endif
-
-  //Werte aus der SmartWB alle SMARTWBCOUNT msec anzeigen
-  aktuelleSmartWBAnzeige = millis();
-  if (aktuelleSmartWBAnzeige - letzteSmartWBAnzeige >= SMARTWB_ANZEIGE_INTERVAL) {
-    letzteSmartWBAnzeige = aktuelleSmartWBAnzeige;
-      
-    // Zeile überschreiben mit schwarzem Rechteck (löschen) in Abhängigkeit des OLED Typs
-    #ifdef OLED_TYPE_SSD1306
-    display.fillRect(0, 3 * CHAR_SIZE_Y, SCREEN_WIDTH, 4 * CHAR_SIZE_Y, SSD1306_BLACK);    // Ab der Zeile 3 die nächsten 4 Zeilen löschen
-    #else
-    display.fillRect(0, 3 * CHAR_SIZE_Y, SCREEN_WIDTH, 4 * CHAR_SIZE_Y, SH110X_BLACK);    // Ab der Zeile 3 die nächsten 4 Zeilen löschen
-    #endif
-      
-    //Check ob SmartWB online, wenn ja die Funktion SmartWB aufrufen und die geholten Werte anzeigen, 
-    // sonst alle Werte auf 0 setzten und evseState als "OFFLINE" anzeigen
-    
-    display.setCursor(0, 3 * CHAR_SIZE_Y);                                   // Cursor auf die Zeile 3 setzen
-    display.print("SmartWB: ");
-
-    Serial.println("Watchdog reset..."); //Es scheint so zu sein, als wäre er Systemseitig auf 5sec eingestellt. Das führt bei Power-On schon zu einem Reboot. Daher auch schon mal in der Setup Routine zurücksetzen!
-    // Watchdog nochmal zurücksetzten, da der getSmartWBParameters Aufruf u.U. verzögert wird...
-    esp_err_t err_code = esp_task_wdt_reset(); 
-    Serial.println("Ergebnis vor getSmartWBParameters: " + String(err_code));
-
-    getSmartWBParameters(httpCode);
-    //Testen ob SmartWB online ist
-    if (httpCode >= 0) {
-      display.println(evseState ? "EIN" : "AUS");
-      // nur wenn die SmartWB ONLINE ist und das Fzg. angeschlossen (vehicleState=2) oder lädt (vehicleState=3), zeigen wir auch den SOC an, sonst nicht
-      #ifdef USE_EV_SOC_API
-      if (vehicleState==2||vehicleState==3) {
-        display.setCursor( 13 * CHAR_SIZE_X, 3 * CHAR_SIZE_Y);
-        display.println("SOC: " + String(soc) + "%");
-      }
-      #endif
-    }
-    else {
-      #ifdef OLED_TYPE_SSD1306
-      display.setTextColor(SSD1306_BLACK, SSD1306_WHITE);
-      #else 
-      display.setTextColor(SH110X_BLACK, SH110X_WHITE);
-      #endif
-      display.println("OFFLINE"); //SmartWB (evse) ist nicht erreichbar , das soll INVERS angezeigt werden und alle anderen anzuzeigenden Werte auf 0 setzen
-      actualPower = 0.0;
-      actualCurrent = 0;
-      maxCurrent = 0;
-      evseState = false;
-      voltageP1 = 0;
-      voltageP2 = 0;
-      voltageP3 = 0;
-      currentP1 = 0.0;
-      currentP2 = 0.0;
-      currentP3 = 0.0;
-      // und jetzt wieder die normale Farbdarstellung
-       #ifdef OLED_TYPE_SSD1306
-      display.setTextColor(SSD1306_WHITE, SSD1306_BLACK);
-      #else 
-      display.setTextColor(SH110X_WHITE, SH110X_BLACK);
-      #endif
-    }
-    //Falls nur 1-stellig, führendes " " hinzufügen
-    display.print("Max Cur: ");
-    display.println((maxCurrent < 10 ? " " : "") + String(maxCurrent) + "A"); // maxCurrent auf Display schreiben
-
-    display.print("Act Cur: ");
-    display.println((actualCurrent < 10 ? " " : "") + String(actualCurrent) + "A");
-
-    display.print("Act Pow: ");
-    display.println((actualPower < 10 ? " " : "") + String(actualPower) + "kW"); // Die aktuelle Leistung die vom EV geladen wird
-      
+  unsigned long warten = aufgabenAusfuehren();
+  {
+    PROFIL(PROFIL_JOURNAL);
+    journalVerarbeiten();       // neue RCR Ereignisse ins Journal schreiben
   }
-  
-  //U + I Werte aus der SmartWB alle SMARTWBCOUNT/3 sec anzeigen
-  aktuelleUIAnzeige = millis();
-  if (aktuelleUIAnzeige - letzteUIAnzeige >= SMARTWB_ANZEIGE_INTERVAL/3) {
-    letzteUIAnzeige = aktuelleUIAnzeige;
-    // Zeile überschreiben mit schwarzem Rechteck (löschen) in Abhängigkeit des OLED Typs
-    #ifdef OLED_TYPE_SSD1306
-    display.fillRect(0, 7 * CHAR_SIZE_Y, SCREEN_WIDTH, CHAR_SIZE_Y, SSD1306_BLACK);   // Die 7.Zeile löschen
-    #else
-    display.fillRect(0, 7 * CHAR_SIZE_Y, SCREEN_WIDTH, CHAR_SIZE_Y, SH110X_BLACK);    // Die 7.Zeile löschen
-    #endif
-    display.setCursor(0, 7 * CHAR_SIZE_Y);                                  // Cursor auf die 7. Zeile setzen
-    switch (i) {
-      case 1:
-        display.print("U1: " + String(voltageP1, 1) + "V I1: " + (currentP1 < 10 ? " " : "") + String(currentP1, 1) + "A");
-      break;
-      case 2:
-        display.print("U2: " + String(voltageP2, 1) + "V I2: " + (currentP2 < 10 ? " " : "") + String(currentP2, 1) + "A");
-      break;
-      case 3:
-        display.print("U3: " + String(voltageP3, 1) + "V I3: " + (currentP3 < 10 ? " " : "") + String(currentP3, 1) + "A");
-      break;
-    }
-     
-    i = (i + 1 > 3) ? 1 : i + 1;  //Zähler +1 prüfen ob schon > 3, wenn ja, auf 1 setzten, sonst erhöhen
-    
 
+  //Updates
+  {
+    PROFIL(PROFIL_DISPLAY);
+    display.display();
   }
+  // LEDs brauchen hier nichts mehr: die Muster laufen in der LEDC Hardware und per esp_timer
 
-  //Updates
-  display.display();
-  server.handleClient(); // Webserver-Anfragen bearbeiten
-  led1.update(now); // SmartWB (evse) Status anzeigen: BEREIT: Grün Fade, EIN: Grün kontinuierlich an, OFFLINE: Grün aus
-  led2.update(now); // RSE aktiv: Rot blinkt, RSE nicht aktiv: Rot aus
-  led3.update(now); // Watchdog LED sollte immer blitzen, solange der Watchdog aufgerufen wird
-      
+  // Bis zur nächsten Fälligkeit schlafen, der aktorTask weckt bei einer RSE Flanke früher
+  int64_t schlafStart = esp_timer_get_time();
+  metrikLoop.erfassen(schlafStart - loopStartUs);
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(warten));
+  schlafUs += esp_timer_get_time() - schlafStart;
 }
-
-
-
-
-
-
-
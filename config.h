@@ -5,9 +5,17 @@
 
 // ----- URLs -----
 // Please dajust to your IPs and Shelly commands
-#define URL_ON    "http://10.0.0.5/cm?cmnd=Power%20On";
-#define URL_OFF   "http://10.0.0.5/cm?cmnd=Power%20Off";
-#define URL_PARAM "http://10.0.1.0/getParameters";
+#define URL_ON    "http://10.0.0.5/cm?cmnd=Power%20On"
+#define URL_OFF   "http://10.0.0.5/cm?cmnd=Power%20Off"
+#define URL_PARAM "http://10.0.1.0/getParameters"
+
+// ----- Wallboxen -----
+// Je SmartWB hinter dem Rundsteuerempfänger eine Zeile { Name, Shelly EIN, Shelly AUS, SmartWB getParameters }.
+// Bei einer RSE Flanke werden alle Shellys gleichzeitig geschaltet, die SmartWBs werden gleichzeitig abgefragt.
+// Beispiel für eine zweite Wallbox (jede Zeile außer der letzten endet mit \):
+//   { "WB2", "http://10.0.0.6/cm?cmnd=Power%20On", "http://10.0.0.6/cm?cmnd=Power%20Off", "http://10.0.1.1/getParameters" },
+#define WALLBOXEN \
+  { "WB1", URL_ON, URL_OFF, URL_PARAM },
 
 // EV SOC API (lokaler Webserver)
 // Auskommentieren wenn kein lokaler EV-SOC-Server vorhanden
@@ -17,6 +25,97 @@
   #define EV_SOC_URL "http://pv-automat:5001/api/ev_soc"
 #endif
 
+// MQTT (optional): Zustand und Messwerte retained unter MQTT_PREFIX/... veröffentlichen
+// Auskommentieren wenn kein MQTT Broker vorhanden. Benutzer/Passwort stehen in secrets.h
+//#define USE_MQTT
+
+#ifdef USE_MQTT
+  #define MQTT_SERVER       "pv-automat"
+  #define MQTT_PORT         1883
+  #define MQTT_PREFIX       "smartwb"
+  #define MQTT_INTERVALL_MS 1000   // geänderte Werte werden gesammelt und so oft gesendet
+  // SoC per MQTT abonnieren statt EV_SOC_URL abzufragen (Zahl oder JSON mit "soc")
+  //#define MQTT_SOC_TOPIC  "ev/soc"
+#endif
+
+// ----- RSE Eingang -----
+// Entprellzeit in ms: ein neuer RSE Pegel wird erst übernommen, wenn er so lange stabil anliegt.
+// Kürzere Impulse werden als Störimpulse gezählt und verworfen.
+#define RSE_ENTPRELL_MS 20
+
+// ----- Abfrage der SmartWB -----
+// Nach einer RSE Flanke und beim Laden wird alle ABFRAGE_SCHNELL_MS abgefragt, mit angestecktem
+// Fahrzeug alle 10s. Ohne Fahrzeug oder wenn die SmartWB nicht antwortet, verdoppelt sich das
+// Intervall bis ABFRAGE_MAX_MS.
+#define ABFRAGE_SCHNELL_MS    1000
+#define ABFRAGE_MAX_MS        60000
+#define ABFRAGE_RSE_FENSTER_S 30
+
+// ----- Zeitbudget für ausgehende Verbindungen -----
+// Jede HTTP Anfrage bekommt ein Zeitbudget für Verbindungsaufbau und Antwort, danach wird sie
+// abgebrochen und beim nächsten Mal wiederholt. In loop() (Watchdog überwacht) gilt höchstens
+// der Rest bis zum Watchdog abzüglich WDT_RESERVE_MS; reicht der nicht für HTTP_BUDGET_MIN_MS,
+// wird die Anfrage verschoben statt den Watchdog zu riskieren.
+#define HTTP_BUDGET_MS        3000
+#define HTTP_BUDGET_SHELLY_MS 2000   // je Versuch, die Shelly wird einmal wiederholt
+#define HTTP_BUDGET_MIN_MS    300
+#define WDT_RESERVE_MS        1000
+#define MQTT_VERBINDEN_MS     5000   // Verbindungsaufbau (3s) plus Warten auf CONNACK (Socket Timeout 2s)
+
+// ----- Schaltbefehle an die Shelly -----
+// Ein Schaltbefehl bleibt offen, bis die Shelly ihn mit HTTP 200 bestätigt (auch wenn das WLAN
+// fehlt). Offene Befehle werden nach SHELLY_NACHHOLEN_MS wiederholt, der Abstand verdoppelt sich
+// bis SHELLY_NACHHOLEN_MAX_MS. Nach SHELLY_FRIST_MS zählt der Befehl als fehlgeschlagen
+// (/metrics, Statusseite) und wird weiter wiederholt, bis er bestätigt oder von der nächsten
+// RSE Flanke abgelöst wird.
+#define SHELLY_NACHHOLEN_MS     1000
+#define SHELLY_NACHHOLEN_MAX_MS 30000
+#define SHELLY_FRIST_MS         60000
+
+// ----- Messwertverlauf -----
+// RAM für den Verlauf der SmartWB Messwerte (/api/history), je Wallbox. Gespeichert wird alle
+// VERLAUF_INTERVALL_S ein Eintrag, schnellere Abfragen werden gemittelt.
+// Ein Eintrag braucht 2 Bytes ohne Änderung und 9-10 Bytes beim Laden (alle 8 Werte ändern sich
+// um wenige Einheiten). 24h ununterbrochenes Laden im 10s Raster sind 8640 Einträge, mit
+// Blockköpfen und Verschnitt knapp 90 KB: 96 KB je Wallbox reichen für einen ganzen Ladetag.
+// Reserviert wird in 1 KB Blöcken. Bleibt dabei weniger als VERLAUF_HEAP_RESERVE_KB frei (WiFi,
+// Webserver), werden weniger Blöcke benutzt; die tatsächliche Dauer zeigt /api/history?format=info.
+#define VERLAUF_INTERVALL_S 10
+#define VERLAUF_SPEICHER_KB_JE_WALLBOX 96
+#define VERLAUF_HEAP_RESERVE_KB 96
+
+// ----- Energie- und RCR-Abrechnung -----
+// Die Zähler werden nur in diesem Intervall (und beim Tageswechsel / Neustart) in den Flash (NVS) geschrieben
+#define ABRECHNUNG_SPEICHER_MIN 60
+
+// ----- Profiler -----
+// Misst jeden Abschnitt von loop() mit dem CPU Taktzähler (min/avg/max unter /api/profil).
+// Der gerade laufende und der langsamste Abschnitt liegen im RTC-RAM und werden nach
+// einem Watchdog-Neustart ausgegeben. Auskommentiert kostet er nichts.
+//#define USE_LOOP_PROFILER
+
+// ----- Benchmark -----
+// /api/benchmark misst die heißen Pfade (JSON der SmartWB, Statuswerte und -seite, Zeitstempel,
+// OLED Zeichnen in einen Puffer im RAM, LED Betriebsarten) in ns je Aufruf. Nur zum Messen
+// einschalten. Dieselben Benchmarks auf dem Host: smartwb_bench, siehe README.
+//#define USE_BENCHMARK
+
+// ----- RSE Simulation -----
+// /api/simulation?start=N erzeugt N RSE Flanken (abwechselnd aktiv/inaktiv) ohne Rundsteuer-
+// empfänger und misst p50/p99/max der Zeit bis zur Shelly Antwort und bis zur Statusseite.
+// Die Shellys werden dabei wirklich geschaltet! Nur für Lasttests einschalten.
+//#define USE_RSE_SIMULATION
+
+#ifdef USE_RSE_SIMULATION
+  #define RSE_SIM_PERIODE_MS  1000   // Abstand der Flanken, deutlich länger als eine Shelly Antwort
+  #define RSE_SIM_ZYKLEN      2000   // ohne Angabe bei start=
+  #define RSE_SIM_MAX_PROBEN  4000   // je Messreihe, 16 KB RAM
+#endif
+
+// ----- Logging -----
+// Ausgabe auf Serial und unter /log: 1=Fehler, 2=Warnungen, 3=Info, 4=Debug (z.B. jeder Watchdog Reset)
+#define LOG_STUFE 3
+
 // ----- Pins -----
 
 
@@ -0,0 +1,19 @@
+// Host-Build der ganzen Steuerung für tools/rse_latenz.py: die config.h des Sketches mit RSE
+// Simulation, die Gegenstellen zeigen auf die Stand-ins aus tools/standins.py auf diesem Rechner.
+// Wird über den Include-Pfad vor der config.h im Hauptverzeichnis gefunden.
+#define USE_RSE_SIMULATION
+#include "../../config.h"
+
+#undef URL_ON
+#undef URL_OFF
+#undef URL_PARAM
+#undef EV_SOC_URL
+#define URL_ON     "http://127.0.0.1:18081/cm?cmnd=Power%20On"
+#define URL_OFF    "http://127.0.0.1:18081/cm?cmnd=Power%20Off"
+#define URL_PARAM  "http://127.0.0.1:18082/getParameters"
+#define EV_SOC_URL "http://127.0.0.1:18083/api/ev_soc"
+
+// Lokal antworten die Stand-ins in wenigen ms, tausende Zyklen sollen nicht Stunden dauern.
+// Mehr als das doppelte SSE_PRUEF_INTERVAL, sonst kommt die nächste Flanke vor der Statusseite.
+#undef RSE_SIM_PERIODE_MS
+#define RSE_SIM_PERIODE_MS 250
@@ -0,0 +1,10 @@
+// Host-Build der ganzen Steuerung: wie der Arduino Core erst setup(), dann loop() ohne Ende.
+// Der Webserver lauscht auf SMARTWB_HTTP_PORT, LittleFS liegt unter SMARTWB_FS.
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+
+int main() {
+  setup();
+  for (;;) {
+    loop();
+  }
+}
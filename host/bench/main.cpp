@@ -0,0 +1,53 @@
+// Host-Build der Benchmarks aus /api/benchmark (USE_BENCHMARK): Zeit je Aufruf und malloc/free
+// je Aufruf der heißen Pfade, als Tabelle auf stdout. Gezählt wird wie auf dem Gerät mit dem
+// Heap Trace über alle Threads, String verwaltet seinen Speicher wie der ESP32 Core.
+//
+//     smartwb_bench [--runden N] [--faktor F] [name ...]
+//
+// Je Benchmark N Runden mit F mal so vielen Aufrufen wie auf dem Gerät. Ausgegeben wird die
+// Zeit der schnellsten Runde und malloc/free der Runde mit den meisten. Ohne Namen laufen alle.
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+
+static bool ausgewaehlt(const char* name, int argc, char** argv, int erstesArgument) {
+  if (erstesArgument >= argc) return true;
+  for (int k = erstesArgument; k < argc; k++) {
+    if (strcmp(argv[k], name) == 0) return true;
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  uint32_t runden = 5;
+  uint32_t faktor = 10;
+  int k = 1;
+  for (; k + 1 < argc && strncmp(argv[k], "--", 2) == 0; k += 2) {
+    if (strcmp(argv[k], "--runden") == 0) {
+      runden = max(1, atoi(argv[k + 1]));
+    } else if (strcmp(argv[k], "--faktor") == 0) {
+      faktor = max(1, atoi(argv[k + 1]));
+    } else {
+      fprintf(stderr, "unbekannte Option %s\n", argv[k]);
+      return 2;
+    }
+  }
+
+  led3.begin(LED3_PIN, LEDC_CHANNEL_2, LEDC_TIMER_2);  // led_modus wie nach setup()
+  led3.setMode(LEDMODE_FLASH);
+  benchVorbereiten();
+
+  printf("%-16s %8s %10s %10s %10s\n", "benchmark", "anzahl", "ns/op", "allocs/op", "frees/op");
+  for (const Benchmark& b : BENCHMARKS) {
+    if (!ausgewaehlt(b.name, argc, argv, k)) continue;
+    uint32_t anzahl = b.anzahl * faktor;
+    BenchMessung ergebnis = {};
+    for (uint32_t r = 0; r < runden; r++) {
+      BenchMessung m = benchMessen(b, anzahl);
+      if (r == 0 || m.nsProAufruf < ergebnis.nsProAufruf) ergebnis.nsProAufruf = m.nsProAufruf;
+      // ein einzelnes malloc soll nicht hinter einer schnelleren Runde verschwinden
+      ergebnis.mallocProAufruf = max(ergebnis.mallocProAufruf, m.mallocProAufruf);
+      ergebnis.freeProAufruf   = max(ergebnis.freeProAufruf, m.freeProAufruf);
+    }
+    printf("%-16s %8u %10u %10.2f %10.2f\n", b.name, anzahl, ergebnis.nsProAufruf, ergebnis.mallocProAufruf, ergebnis.freeProAufruf);
+  }
+  return 0;
+}
@@ -0,0 +1,124 @@
+// Host-Build: Adafruit_GFX mit den Zeichenfunktionen, die der Sketch benutzt. Wie im Original
+// landen Text, Linien und Rechtecke über virtuelle Funktionen bei drawPixel(). Zeichen sind
+// 6x8 Pixel groß, das Glyph ist ein Muster aus dem Zeichencode statt der echten Schrift.
+#pragma once
+#include "Arduino.h"
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+  virtual ~Adafruit_GFX() {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  virtual void writePixel(int16_t x, int16_t y, uint16_t color) { drawPixel(x, y, color); }
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    for (int16_t k = 0; k < h; k++) writePixel(x, y + k, color);
+  }
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    for (int16_t k = 0; k < w; k++) writePixel(x + k, y, color);
+  }
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t k = x; k < x + w; k++) drawFastVLine(k, y, h, color);
+  }
+  virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+  virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+  }
+  virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (x0 == x1) {
+      drawFastVLine(x0, min(y0, y1), abs(y1 - y0) + 1, color);
+    } else if (y0 == y1) {
+      drawFastHLine(min(x0, x1), y0, abs(x1 - x0) + 1, color);
+    } else {
+      int16_t dx = abs(x1 - x0), dy = -abs(y1 - y0);
+      int16_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+      int16_t fehler = dx + dy;
+      for (;;) {
+        writePixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int16_t f2 = 2 * fehler;
+        if (f2 >= dy) { fehler += dy; x0 += sx; }
+        if (f2 <= dx) { fehler += dx; y0 += sy; }
+      }
+    }
+  }
+
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    if (x >= _width || y >= _height || x + 6 * size - 1 < 0 || y + 8 * size - 1 < 0) return;
+    for (int8_t spalte = 0; spalte < 6; spalte++) {
+      // 5 Spalten Glyph, die sechste ist der Abstand
+      uint8_t bits = (spalte < 5 && c > ' ') ? (uint8_t)(((c * 0x9E3779B1u) >> (spalte * 5)) & 0x7F) | 0x01 : 0;
+      for (int8_t zeile = 0; zeile < 8; zeile++, bits >>= 1) {
+        if (bits & 1) {
+          if (size == 1) writePixel(x + spalte, y + zeile, color);
+          else fillRect(x + spalte * size, y + zeile * size, size, size, color);
+        } else if (bg != color) {
+          if (size == 1) writePixel(x + spalte, y + zeile, bg);
+          else fillRect(x + spalte * size, y + zeile * size, size, size, bg);
+        }
+      }
+    }
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    } else if (c != '\r') {
+      if (wrap && (cursor_x + textsize_x * 6) > _width) {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x);
+      cursor_x += textsize_x * 6;
+    }
+    return 1;
+  }
+  using Print::write;
+
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+  void setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+  void setTextSize(uint8_t s) { textsize_x = textsize_y = s > 0 ? s : 1; }
+  void setTextWrap(bool w) { wrap = w; }
+  void setRotation(uint8_t r) { rotation = r & 3; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+  int16_t getCursorX() const { return cursor_x; }
+  int16_t getCursorY() const { return cursor_y; }
+
+protected:
+  const int16_t WIDTH, HEIGHT;
+  int16_t _width, _height;
+  int16_t cursor_x = 0, cursor_y = 0;
+  uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+  uint8_t textsize_x = 1, textsize_y = 1;
+  uint8_t rotation = 0;
+  bool wrap = true;
+};
+
+// 1 Bit je Pixel, zeilenweise wie im Original
+class GFXcanvas1 : public Adafruit_GFX {
+public:
+  GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h), buffer(new uint8_t[((w + 7) / 8) * h]()) {}
+  ~GFXcanvas1() { delete[] buffer; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    uint8_t* ptr = &buffer[(x / 8) + y * ((WIDTH + 7) / 8)];
+    if (color) *ptr |= 0x80 >> (x & 7);
+    else *ptr &= ~(0x80 >> (x & 7));
+  }
+  bool getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return false;
+    return buffer[(x / 8) + y * ((WIDTH + 7) / 8)] & (0x80 >> (x & 7));
+  }
+  void fillScreen(uint16_t color) override { memset(buffer, color ? 0xFF : 0x00, ((WIDTH + 7) / 8) * HEIGHT); }
+  uint8_t* getBuffer() const { return buffer; }
+
+private:
+  uint8_t* buffer;
+};
@@ -0,0 +1,67 @@
+// Host-Build: gemeinsame Basis der monochromen OLEDs. Der Puffer ist seitenweise
+// organisiert wie im Display-RAM: Byte x + (y / 8) * Breite, Bit y % 8.
+#pragma once
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define MONOOLED_BLACK   0
+#define MONOOLED_WHITE   1
+#define MONOOLED_INVERSE 2
+
+class Adafruit_GrayOLED : public Adafruit_GFX {
+public:
+  Adafruit_GrayOLED(uint8_t bpp, uint16_t w, uint16_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                    uint32_t preclk = 400000, uint32_t postclk = 100000)
+    : Adafruit_GFX(w, h), wire(twi), wireClk(preclk), restoreClk(postclk) {}
+  ~Adafruit_GrayOLED() { free(buffer); }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (!buffer || x < 0 || y < 0 || x >= _width || y >= _height) return;
+    uint8_t& byte = buffer[x + (y / 8) * WIDTH];
+    uint8_t bit = 1 << (y & 7);
+    switch (color) {
+      case MONOOLED_WHITE:   byte |= bit; break;
+      case MONOOLED_BLACK:   byte &= ~bit; break;
+      case MONOOLED_INVERSE: byte ^= bit; break;
+    }
+  }
+  bool getPixel(int16_t x, int16_t y) const {
+    if (!buffer || x < 0 || y < 0 || x >= _width || y >= _height) return false;
+    return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+  }
+  void clearDisplay() {
+    if (buffer) memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+  }
+  uint8_t* getBuffer() { return buffer; }
+  void display() {
+    // überträgt den ganzen Puffer, seitenweise wie die Bibliothek
+    if (!buffer) return;
+    wire->setClock(wireClk);
+    for (int16_t seite = 0; seite < (HEIGHT + 7) / 8; seite++) {
+      wire->beginTransmission(i2caddr);
+      wire->write((uint8_t)0x40);
+      wire->write(buffer + seite * WIDTH, WIDTH);
+      wire->endTransmission();
+    }
+    wire->setClock(restoreClk);
+  }
+
+protected:
+  bool _init(uint8_t addr, bool reset) {
+    if (!buffer) buffer = (uint8_t*)malloc(WIDTH * ((HEIGHT + 7) / 8));
+    if (!buffer) return false;
+    clearDisplay();
+    i2caddr = addr;
+    wire->begin();
+    wire->setClock(wireClk);
+    wire->beginTransmission(i2caddr);
+    wire->endTransmission();
+    wire->setClock(restoreClk);  // wie das Original: nach begin() wieder der langsame Takt
+    return true;
+  }
+
+  TwoWire* wire;
+  uint8_t* buffer = NULL;
+  uint8_t i2caddr = 0;
+  uint32_t wireClk, restoreClk;
+};
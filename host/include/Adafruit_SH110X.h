@@ -0,0 +1,23 @@
+// Host-Build: SH1106G über Adafruit_GrayOLED
+#pragma once
+#include "Adafruit_GrayOLED.h"
+
+#define SH110X_BLACK   0
+#define SH110X_WHITE   1
+#define SH110X_INVERSE 2
+
+class Adafruit_SH110X : public Adafruit_GrayOLED {
+public:
+  Adafruit_SH110X(uint16_t w, uint16_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                  uint32_t preclk = 400000, uint32_t postclk = 100000)
+    : Adafruit_GrayOLED(1, w, h, twi, rst_pin, preclk, postclk) {}
+};
+
+class Adafruit_SH1106G : public Adafruit_SH110X {
+public:
+  Adafruit_SH1106G(uint16_t w, uint16_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                   uint32_t preclk = 400000, uint32_t postclk = 100000)
+    : Adafruit_SH110X(w, h, twi, rst_pin, preclk, postclk) {}
+
+  bool begin(uint8_t i2caddr = 0x3C, bool reset = true) { return _init(i2caddr, reset); }
+};
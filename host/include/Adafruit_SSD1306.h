@@ -0,0 +1,26 @@
+// Host-Build: SSD1306 über Adafruit_GrayOLED, die Linienfunktionen sind wie im Original überschrieben
+#pragma once
+#include "Adafruit_GrayOLED.h"
+
+#define SSD1306_BLACK   0
+#define SSD1306_WHITE   1
+#define SSD1306_INVERSE 2
+#define SSD1306_EXTERNALVCC  0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+class Adafruit_SSD1306 : public Adafruit_GrayOLED {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                   uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL)
+    : Adafruit_GrayOLED(1, w, h, twi, rst_pin, clkDuring, clkAfter) {}
+
+  bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0, bool reset = true, bool periphBegin = true) {
+    return _init(i2caddr ? i2caddr : 0x3C, reset);
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    for (int16_t k = 0; k < w; k++) Adafruit_GrayOLED::drawPixel(x + k, y, color);
+  }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+    for (int16_t k = 0; k < h; k++) Adafruit_GrayOLED::drawPixel(x, y + k, color);
+  }
+};
@@ -0,0 +1,121 @@
+// Host-Build: die vom Sketch benutzten Teile des Arduino ESP32 Cores für Linux.
+// Wird per -include vor jede Übersetzungseinheit gesetzt, wie es die Arduino IDE tut.
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sys/time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+#include "WString.h"
+#include "Print.h"
+#include "IPAddress.h"
+
+using std::min;
+using std::max;
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+
+#define constrain(wert, unten, oben) ((wert) < (unten) ? (unten) : ((wert) > (oben) ? (oben) : (wert)))
+
+inline long map(long x, long vonMin, long vonMax, long nachMin, long nachMax) {
+  return (x - vonMin) * (nachMax - nachMin) / (vonMax - vonMin) + nachMin;
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+// Uhr des Hosts: millis(), micros(), esp_timer_get_time(), die Ticks, delay() und die Zeitlimits
+// der Stand-ins (FreeRTOS Wartezeiten, esp_timer, Sockets, LEDC Rampen) laufen auf ihr. Sie geht
+// mit der Wanduhr, bis ein Test sie anhält; dann bewegt sie sich nur mit hostUhrVorstellen() und
+// hostUhrZurNaechstenFrist(). Datum und Uhrzeit (time(), gettimeofday()) bleiben die des Hosts.
+int64_t hostUhrUs();                          // µs seit dem Start
+void hostUhrAnhalten(bool angehalten);        // false: läuft ab dem aktuellen Stand weiter
+void hostUhrVorstellen(uint32_t ms);          // weckt alle, deren Frist damit erreicht ist
+bool hostUhrZurNaechstenFrist(uint32_t ruheMs);  // angehalten: zur frühesten Frist springen, deren
+                                                 // Thread schon ruheMs (Wanduhr) wartet
+void hostUhrSchlafenBis(int64_t bisUs);       // wie delay(), bis hostUhrUs() bisUs erreicht
+
+// GPIO: Pegel liegen in einem Feld, Eingänge setzt der Test mit hostPinSetzen()
+void pinMode(uint8_t pin, uint8_t modus);
+int  digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t pegel);
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterrupt(uint8_t pin, void (*isr)(), int modus);
+void detachInterrupt(uint8_t pin);
+void hostPinSetzen(uint8_t pin, int pegel);  // ändert den Pegel und ruft eine passende ISR im Aufrufer auf
+
+// Die Systemzeit des Hosts ist schon gestellt, NTP entfällt
+inline void configTime(long gmtOffsetS, int sommerzeitOffsetS, const char* server1,
+                       const char* server2 = NULL, const char* server3 = NULL) {}
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+inline size_t strlcpy(char* ziel, const char* quelle, size_t groesse) {
+  size_t laenge = strlen(quelle);
+  if (groesse > 0) {
+    size_t n = laenge < groesse - 1 ? laenge : groesse - 1;
+    memcpy(ziel, quelle, n);
+    ziel[n] = '\0';
+  }
+  return laenge;
+}
+#endif
+
+// Serial schreibt auf stdout
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  void end() {}
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void flush() override { fflush(stdout); }
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* puffer, size_t laenge) override { return fwrite(puffer, 1, laenge, stdout); }
+  using Print::write;
+  operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getCycleCount();        // aus der Wanduhr bei 240 MHz, zählt auch bei angehaltener hostUhr
+  uint64_t getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+  void restart();
+};
+extern EspClass ESP;
+void hostHeapGroesseSetzen(size_t bytes);  // Host: kleineren oder größeren ESP32 Heap vorgeben
@@ -0,0 +1,466 @@
+// Host-Build: die vom Sketch benutzte Teilmenge von ArduinoJson 6. Der Speicher wird wie im
+// Original gezählt: 16 Bytes je Element oder Member, kopierte Texte mit Länge + 1 (gleiche Texte
+// nur einmal), const char* Schlüssel und Werte nur als Zeiger. So meldet deserializeJson() bei
+// denselben Dokumentgrößen NoMemory wie auf dem ESP32. StaticJsonDocument liegt ganz im Objekt.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "Arduino.h"
+
+#define ARDUINOJSON_VERSION_MAJOR 6
+#define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+#define ARDUINOJSON_SLOT_GROESSE 16
+
+struct JsonKnoten {
+  enum Typ : uint8_t { NUL, BOOL, INT, FLOAT, TEXT, OBJEKT, FELD };
+  Typ typ = NUL;
+  const char* schluessel = NULL;  // nur bei Membern eines Objekts
+  union {
+    bool b;
+    long long i;
+    double d;
+    const char* s;
+  } wert = {};
+  JsonKnoten* erstes = NULL;    // Kinder von Objekt oder Feld
+  JsonKnoten* letztes = NULL;
+  JsonKnoten* naechstes = NULL;
+
+  void leeren() { typ = NUL; wert.i = 0; erstes = letztes = NULL; }
+  const JsonKnoten* member(const char* name) const;
+  const JsonKnoten* element(size_t index) const;
+  size_t groesse() const;
+};
+
+// Speicher eines Dokuments: Knoten und Texte aus festen Puffern, gezählt gegen die Kapazität
+class JsonSpeicher {
+public:
+  JsonSpeicher(JsonKnoten* knoten, size_t knotenAnzahl, char* text, size_t kapazitaet)
+    : knoten(knoten), knotenAnzahl(knotenAnzahl), text(text), kapazitaet(kapazitaet) {}
+
+  JsonKnoten* knotenHolen();
+  const char* textKopieren(const char* quelle, size_t laenge);
+  void leeren() { knotenBelegt = 0; textBelegt = 0; ueberlauf = false; }
+  size_t belegt() const { return knotenBelegt * ARDUINOJSON_SLOT_GROESSE + textBelegt; }
+  size_t groesse() const { return kapazitaet; }
+  bool uebergelaufen() const { return ueberlauf; }
+
+private:
+  JsonKnoten* knoten;
+  size_t knotenAnzahl;
+  size_t knotenBelegt = 0;
+  char* text;
+  size_t textBelegt = 0;
+  size_t kapazitaet;
+  bool ueberlauf = false;
+};
+
+class JsonVariantConst;
+class JsonVariant;
+class JsonObject;
+class JsonObjectConst;
+class JsonArray;
+class JsonArrayConst;
+
+namespace ArduinoJsonHost {
+template <typename T>
+using istZahl = std::integral_constant<bool, std::is_arithmetic<T>::value>;
+template <typename T>
+using istWandelbar = std::integral_constant<bool, istZahl<T>::value || std::is_same<T, const char*>::value || std::is_same<T, String>::value>;
+
+bool alsBool(const JsonKnoten* k);
+long long alsGanzzahl(const JsonKnoten* k);
+double alsGleitkomma(const JsonKnoten* k);
+String alsString(const JsonKnoten* k);
+
+template <typename T>
+typename std::enable_if<std::is_same<T, bool>::value, T>::type wandeln(const JsonKnoten* k) { return alsBool(k); }
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, T>::type wandeln(const JsonKnoten* k) { return (T)alsGanzzahl(k); }
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, T>::type wandeln(const JsonKnoten* k) { return (T)alsGleitkomma(k); }
+template <typename T>
+typename std::enable_if<std::is_same<T, const char*>::value, T>::type wandeln(const JsonKnoten* k) {
+  return k && k->typ == JsonKnoten::TEXT ? k->wert.s : NULL;
+}
+template <typename T>
+typename std::enable_if<std::is_same<T, String>::value, T>::type wandeln(const JsonKnoten* k) { return alsString(k); }
+
+template <typename T>
+typename std::enable_if<std::is_same<T, bool>::value, bool>::type pruefen(const JsonKnoten* k) { return k && k->typ == JsonKnoten::BOOL; }
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type pruefen(const JsonKnoten* k) {
+  if (!k || k->typ != JsonKnoten::INT) return false;
+  if (std::is_signed<T>::value) {
+    return k->wert.i >= (long long)std::numeric_limits<T>::min() && k->wert.i <= (long long)std::numeric_limits<T>::max();
+  }
+  return k->wert.i >= 0 && (unsigned long long)k->wert.i <= (unsigned long long)std::numeric_limits<T>::max();
+}
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type pruefen(const JsonKnoten* k) {
+  return k && (k->typ == JsonKnoten::INT || k->typ == JsonKnoten::FLOAT);
+}
+template <typename T>
+typename std::enable_if<std::is_same<T, const char*>::value || std::is_same<T, String>::value, bool>::type pruefen(const JsonKnoten* k) {
+  return k && k->typ == JsonKnoten::TEXT;
+}
+template <typename T>
+typename std::enable_if<std::is_same<T, JsonObject>::value || std::is_same<T, JsonObjectConst>::value, bool>::type pruefen(const JsonKnoten* k) {
+  return k && k->typ == JsonKnoten::OBJEKT;
+}
+template <typename T>
+typename std::enable_if<std::is_same<T, JsonArray>::value || std::is_same<T, JsonArrayConst>::value, bool>::type pruefen(const JsonKnoten* k) {
+  return k && k->typ == JsonKnoten::FELD;
+}
+}  // namespace ArduinoJsonHost
+
+class JsonVariantConst {
+public:
+  JsonVariantConst() {}
+  explicit JsonVariantConst(const JsonKnoten* knoten) : knoten(knoten) {}
+
+  bool isNull() const { return !knoten || knoten->typ == JsonKnoten::NUL; }
+  size_t size() const { return knoten ? knoten->groesse() : 0; }
+  JsonVariantConst operator[](const char* name) const { return JsonVariantConst(knoten ? knoten->member(name) : NULL); }
+  JsonVariantConst operator[](const String& name) const { return (*this)[name.c_str()]; }
+  JsonVariantConst operator[](int index) const { return JsonVariantConst(knoten && index >= 0 ? knoten->element(index) : NULL); }
+  JsonVariantConst operator[](size_t index) const { return JsonVariantConst(knoten ? knoten->element(index) : NULL); }
+
+  template <typename T>
+  T as() const { return ArduinoJsonHost::wandeln<T>(knoten); }
+  template <typename T>
+  bool is() const { return ArduinoJsonHost::pruefen<T>(knoten); }
+  template <typename T, typename = typename std::enable_if<ArduinoJsonHost::istWandelbar<T>::value>::type>
+  operator T() const { return as<T>(); }
+
+  const JsonKnoten* knotenHolen() const { return knoten; }
+
+private:
+  const JsonKnoten* knoten = NULL;
+};
+
+// Veränderbarer Wert. Wie die MemberProxy/ElementProxy des Originals wird ein fehlender Member
+// oder ein fehlendes Element erst beim Schreiben angelegt. Schreiben über zwei fehlende Ebenen
+// (doc["a"]["b"] = 1 ohne "a") unterstützt der Host-Build nicht, das braucht der Sketch nicht.
+class JsonVariant {
+public:
+  JsonVariant() {}
+  JsonVariant(JsonSpeicher* speicher, JsonKnoten* knoten) : speicher(speicher), knoten(knoten) {}
+  JsonVariant(JsonSpeicher* speicher, JsonKnoten* eltern, const char* name, bool nameKopieren)
+    : speicher(speicher), eltern(eltern), name(name), nameKopieren(nameKopieren) {
+    knoten = eltern ? const_cast<JsonKnoten*>(eltern->member(name)) : NULL;
+  }
+  JsonVariant(JsonSpeicher* speicher, JsonKnoten* eltern, size_t index)
+    : speicher(speicher), eltern(eltern), index(index), istElement(true) {
+    knoten = eltern ? const_cast<JsonKnoten*>(eltern->element(index)) : NULL;
+  }
+
+  bool isNull() const { return !knoten || knoten->typ == JsonKnoten::NUL; }
+  size_t size() const { return knoten ? knoten->groesse() : 0; }
+
+  JsonVariant operator[](const char* name) const { return JsonVariant(speicher, knoten, name, false); }
+  JsonVariant operator[](const String& name) const { return JsonVariant(speicher, knoten, name.c_str(), true); }
+  JsonVariant operator[](int index) const { return JsonVariant(speicher, knoten, (size_t)index); }
+  JsonVariant operator[](size_t index) const { return JsonVariant(speicher, knoten, index); }
+
+  template <typename T>
+  T as() const { return ArduinoJsonHost::wandeln<T>(knoten); }
+  template <typename T>
+  bool is() const { return ArduinoJsonHost::pruefen<T>(knoten); }
+  template <typename T, typename = typename std::enable_if<ArduinoJsonHost::istWandelbar<T>::value>::type>
+  operator T() const { return as<T>(); }
+  operator JsonVariantConst() const { return JsonVariantConst(knoten); }
+
+  bool set(bool wert);
+  bool set(long long wert);
+  bool set(double wert);
+  bool set(const char* wert);       // nur der Zeiger wird gespeichert
+  bool set(const String& wert);     // wird kopiert
+  bool set(char* wert) { return set(String(wert)); }
+  bool set(JsonVariantConst wert);  // tiefe Kopie
+
+  JsonVariant& operator=(bool wert) { set(wert); return *this; }
+  JsonVariant& operator=(const char* wert) { set(wert); return *this; }
+  JsonVariant& operator=(char* wert) { set(wert); return *this; }
+  JsonVariant& operator=(const String& wert) { set(wert); return *this; }
+  JsonVariant& operator=(float wert) { set((double)wert); return *this; }
+  JsonVariant& operator=(double wert) { set(wert); return *this; }
+  template <typename T, typename = typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+  JsonVariant& operator=(T wert) { set((long long)wert); return *this; }
+
+  JsonObject createNestedObject();
+  JsonObject createNestedObject(const char* name);
+  JsonArray createNestedArray();
+  JsonArray createNestedArray(const char* name);
+  JsonObject to_object();
+  JsonArray to_array();
+  JsonVariant add();
+
+  JsonKnoten* knotenHolen() const { return knoten; }
+  JsonSpeicher* speicherHolen() const { return speicher; }
+  // legt den fehlenden Member oder das fehlende Element an, ein leerer Elternknoten wird
+  // dabei zum Objekt oder Feld
+  JsonKnoten* anlegen();
+
+private:
+  JsonSpeicher* speicher = NULL;
+  JsonKnoten* knoten = NULL;
+  JsonKnoten* eltern = NULL;
+  const char* name = NULL;
+  size_t index = 0;
+  bool nameKopieren = false;
+  bool istElement = false;
+};
+
+class JsonObjectConst {
+public:
+  JsonObjectConst() {}
+  JsonObjectConst(JsonVariantConst v) : knoten(v.is<JsonObjectConst>() ? v.knotenHolen() : NULL) {}
+  JsonObjectConst(const JsonVariant& v) : JsonObjectConst(JsonVariantConst(v)) {}
+
+  bool isNull() const { return knoten == NULL; }
+  size_t size() const { return knoten ? knoten->groesse() : 0; }
+  bool containsKey(const char* name) const { return knoten && knoten->member(name); }
+  JsonVariantConst operator[](const char* name) const { return JsonVariantConst(knoten ? knoten->member(name) : NULL); }
+  JsonVariantConst operator[](const String& name) const { return (*this)[name.c_str()]; }
+
+private:
+  const JsonKnoten* knoten = NULL;
+};
+
+class JsonObject {
+public:
+  JsonObject() {}
+  JsonObject(JsonSpeicher* speicher, JsonKnoten* knoten) : speicher(speicher), knoten(knoten) {}
+  JsonObject(const JsonVariant& v)
+    : speicher(v.speicherHolen()), knoten(v.is<JsonObject>() ? v.knotenHolen() : NULL) {}
+
+  bool isNull() const { return knoten == NULL; }
+  size_t size() const { return knoten ? knoten->groesse() : 0; }
+  bool containsKey(const char* name) const { return knoten && knoten->member(name); }
+  JsonVariant operator[](const char* name) const { return JsonVariant(speicher, knoten, name, false); }
+  JsonVariant operator[](const String& name) const { return JsonVariant(speicher, knoten, name.c_str(), true); }
+  JsonObject createNestedObject(const char* name) const { return (*this)[name].createNestedObject(); }
+  JsonArray createNestedArray(const char* name) const;
+  operator JsonObjectConst() const { return JsonObjectConst(JsonVariantConst(knoten)); }
+  operator JsonVariantConst() const { return JsonVariantConst(knoten); }
+
+private:
+  JsonSpeicher* speicher = NULL;
+  JsonKnoten* knoten = NULL;
+};
+
+class JsonArrayConst {
+public:
+  JsonArrayConst() {}
+  JsonArrayConst(JsonVariantConst v) : knoten(v.is<JsonArrayConst>() ? v.knotenHolen() : NULL) {}
+  JsonArrayConst(const JsonVariant& v) : JsonArrayConst(JsonVariantConst(v)) {}
+
+  bool isNull() const { return knoten == NULL; }
+  size_t size() const { return knoten ? knoten->groesse() : 0; }
+  JsonVariantConst operator[](size_t index) const { return JsonVariantConst(knoten ? knoten->element(index) : NULL); }
+
+private:
+  const JsonKnoten* knoten = NULL;
+};
+
+class JsonArray {
+public:
+  JsonArray() {}
+  JsonArray(JsonSpeicher* speicher, JsonKnoten* knoten) : speicher(speicher), knoten(knoten) {}
+  JsonArray(const JsonVariant& v)
+    : speicher(v.speicherHolen()), knoten(v.is<JsonArray>() ? v.knotenHolen() : NULL) {}
+
+  bool isNull() const { return knoten == NULL; }
+  size_t size() const { return knoten ? knoten->groesse() : 0; }
+  JsonVariant operator[](size_t index) const { return JsonVariant(speicher, knoten, index); }
+  JsonVariant add() const { return JsonVariant(speicher, knoten).add(); }
+  template <typename T>
+  bool add(const T& wert) const { JsonVariant v = add(); return v.knotenHolen() && v.set(wert); }
+  JsonObject createNestedObject() const { return JsonVariant(speicher, knoten).createNestedObject(); }
+  operator JsonArrayConst() const { return JsonArrayConst(JsonVariantConst(knoten)); }
+
+private:
+  JsonSpeicher* speicher = NULL;
+  JsonKnoten* knoten = NULL;
+};
+
+inline JsonArray JsonObject::createNestedArray(const char* name) const { return (*this)[name].createNestedArray(); }
+
+class JsonDocument {
+public:
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
+
+  bool isNull() const { return wurzel.typ == JsonKnoten::NUL; }
+  void clear() { wurzel.leeren(); speicher.leeren(); }
+  size_t capacity() const { return speicher.groesse(); }
+  size_t memoryUsage() const { return speicher.belegt(); }
+  bool overflowed() const { return speicher.uebergelaufen(); }
+  size_t size() const { return wurzel.groesse(); }
+
+  JsonVariant operator[](const char* name) { return JsonVariant(&speicher, &wurzel, name, false); }
+  JsonVariant operator[](const String& name) { return JsonVariant(&speicher, &wurzel, name.c_str(), true); }
+  JsonVariant operator[](int index) { return JsonVariant(&speicher, &wurzel, (size_t)index); }
+  JsonVariantConst operator[](const char* name) const { return as<JsonVariantConst>()[name]; }
+  JsonVariantConst operator[](int index) const { return as<JsonVariantConst>()[index]; }
+
+  template <typename T>
+  typename std::enable_if<std::is_same<T, JsonVariantConst>::value, T>::type as() const { return JsonVariantConst(&wurzel); }
+  template <typename T>
+  typename std::enable_if<std::is_same<T, JsonObject>::value, T>::type as() { return JsonObject(getVariant()); }
+  template <typename T>
+  typename std::enable_if<!std::is_same<T, JsonVariantConst>::value && !std::is_same<T, JsonObject>::value, T>::type as() const {
+    return JsonVariantConst(&wurzel).as<T>();
+  }
+  template <typename T>
+  bool is() const { return JsonVariantConst(&wurzel).is<T>(); }
+  JsonVariant getVariant() { return JsonVariant(&speicher, &wurzel); }
+  JsonObject to_object() { clear(); return getVariant().to_object(); }
+  JsonArray to_array() { clear(); return getVariant().to_array(); }
+  JsonObject createNestedObject() { return getVariant().createNestedObject(); }
+  JsonArray createNestedArray() { return getVariant().createNestedArray(); }
+  operator JsonVariantConst() const { return JsonVariantConst(&wurzel); }
+
+  JsonKnoten& wurzelHolen() { return wurzel; }
+  JsonSpeicher& speicherHolen() { return speicher; }
+
+protected:
+  JsonDocument(JsonKnoten* knoten, size_t knotenAnzahl, char* text, size_t kapazitaet)
+    : speicher(knoten, knotenAnzahl, text, kapazitaet) {}
+  ~JsonDocument() {}
+
+private:
+  JsonKnoten wurzel;  // kostet wie im Original nichts
+  JsonSpeicher speicher;
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {
+public:
+  StaticJsonDocument() : JsonDocument(knoten, sizeof(knoten) / sizeof(knoten[0]), text, N) {}
+
+private:
+  JsonKnoten knoten[N / ARDUINOJSON_SLOT_GROESSE + 1];
+  char text[N];
+};
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+  explicit DynamicJsonDocument(size_t kapazitaet)
+    : DynamicJsonDocument(kapazitaet, new JsonKnoten[kapazitaet / ARDUINOJSON_SLOT_GROESSE + 1], new char[kapazitaet + 1]) {}
+  ~DynamicJsonDocument() {
+    delete[] knoten;
+    delete[] text;
+  }
+
+private:
+  DynamicJsonDocument(size_t kapazitaet, JsonKnoten* k, char* t)
+    : JsonDocument(k, kapazitaet / ARDUINOJSON_SLOT_GROESSE + 1, t, kapazitaet), knoten(k), text(t) {}
+  JsonKnoten* knoten;
+  char* text;
+};
+
+class DeserializationError {
+public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+  DeserializationError() {}
+  DeserializationError(Code code) : _code(code) {}
+
+  Code code() const { return _code; }
+  const char* c_str() const;
+  explicit operator bool() const { return _code != Ok; }
+  friend bool operator==(const DeserializationError& a, const DeserializationError& b) { return a._code == b._code; }
+  friend bool operator!=(const DeserializationError& a, const DeserializationError& b) { return a._code != b._code; }
+  friend bool operator==(const DeserializationError& a, Code b) { return a._code == b; }
+  friend bool operator!=(const DeserializationError& a, Code b) { return a._code != b; }
+
+private:
+  Code _code = Ok;
+};
+
+namespace DeserializationOption {
+class Filter {
+public:
+  explicit Filter(JsonVariantConst filter) : filter(filter) {}
+  explicit Filter(const JsonDocument& dokument) : filter(dokument.as<JsonVariantConst>()) {}
+  JsonVariantConst filter;
+};
+
+class NestingLimit {
+public:
+  explicit NestingLimit(uint8_t tiefe = ARDUINOJSON_DEFAULT_NESTING_LIMIT) : tiefe(tiefe) {}
+  uint8_t tiefe;
+};
+}  // namespace DeserializationOption
+
+// Eingabe Zeichen für Zeichen. Ein Stream wird wie im Original mit readBytes() je Zeichen
+// gelesen, so gilt sein Zeitlimit und nach der schließenden Klammer wird nichts mehr gelesen.
+class JsonLeser {
+public:
+  virtual ~JsonLeser() {}
+  virtual int lesen() = 0;  // -1 = Ende
+};
+
+DeserializationError jsonLesen(JsonDocument& dokument, JsonLeser& leser, const JsonKnoten* filter, uint8_t tiefe);
+
+namespace ArduinoJsonHost {
+class TextLeser : public JsonLeser {
+public:
+  TextLeser(const char* text, size_t laenge) : p(text), ende(text + laenge) {}
+  int lesen() override { return p < ende ? (uint8_t)*p++ : -1; }
+
+private:
+  const char* p;
+  const char* ende;
+};
+
+class StreamLeser : public JsonLeser {
+public:
+  explicit StreamLeser(Stream& stream) : stream(stream) {}
+  int lesen() override {
+    char c;
+    return stream.readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+  }
+
+private:
+  Stream& stream;
+};
+
+// true als Filter lässt alles durch, wie ohne Filter
+inline const JsonKnoten* allesErlaubt() {
+  static JsonKnoten wahr = [] { JsonKnoten k; k.typ = JsonKnoten::BOOL; k.wert.b = true; return k; }();
+  return &wahr;
+}
+}  // namespace ArduinoJsonHost
+
+inline DeserializationError deserializeJson(JsonDocument& dokument, const char* text,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter(JsonVariantConst(ArduinoJsonHost::allesErlaubt())),
+                                            DeserializationOption::NestingLimit limit = DeserializationOption::NestingLimit()) {
+  ArduinoJsonHost::TextLeser leser(text ? text : "", text ? strlen(text) : 0);
+  return jsonLesen(dokument, leser, filter.filter.knotenHolen(), limit.tiefe);
+}
+inline DeserializationError deserializeJson(JsonDocument& dokument, char* text,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter(JsonVariantConst(ArduinoJsonHost::allesErlaubt()))) {
+  return deserializeJson(dokument, (const char*)text, filter);
+}
+inline DeserializationError deserializeJson(JsonDocument& dokument, const String& text,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter(JsonVariantConst(ArduinoJsonHost::allesErlaubt()))) {
+  ArduinoJsonHost::TextLeser leser(text.c_str(), text.length());
+  return jsonLesen(dokument, leser, filter.filter.knotenHolen(), ARDUINOJSON_DEFAULT_NESTING_LIMIT);
+}
+inline DeserializationError deserializeJson(JsonDocument& dokument, Stream& stream,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter(JsonVariantConst(ArduinoJsonHost::allesErlaubt()))) {
+  ArduinoJsonHost::StreamLeser leser(stream);
+  return jsonLesen(dokument, leser, filter.filter.knotenHolen(), ARDUINOJSON_DEFAULT_NESTING_LIMIT);
+}
+inline DeserializationError deserializeJson(JsonDocument& dokument, const char* text, size_t laenge) {
+  ArduinoJsonHost::TextLeser leser(text, laenge);
+  return jsonLesen(dokument, leser, ArduinoJsonHost::allesErlaubt(), ARDUINOJSON_DEFAULT_NESTING_LIMIT);
+}
+
+size_t serializeJson(JsonVariantConst wert, char* puffer, size_t groesse);
+size_t serializeJson(JsonVariantConst wert, String& ziel);
+size_t serializeJson(const JsonDocument& dokument, String& ziel);
@@ -0,0 +1,177 @@
+// Host-Build: AsyncWebServer auf einem eigenen Thread als async_tcp Task. Alle Handler, Füller
+// und onConnect laufen dort. Gestreamte Antworten werden mit Transfer-Encoding: chunked und
+// Connection: close gesendet, der Füller wird erst aufgerufen, wenn der Socket wieder Platz hat.
+// Der Port kommt aus SMARTWB_HTTP_PORT, sonst aus dem Konstruktor.
+// Für Tests ohne Netz lassen sich Anfragen aus einer URL bauen und direkt an einen Handler geben.
+#pragma once
+
+// Version wie ESP32Async/ESPAsyncWebServer, der Sketch prüft darauf (send() aus anderen Tasks)
+#define ASYNCWEBSERVER_VERSION_MAJOR 3
+#define ASYNCWEBSERVER_VERSION_MINOR 6
+#define ASYNCWEBSERVER_VERSION_REVISION 0
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Arduino.h"
+
+typedef enum {
+  HTTP_GET     = 0b00000001,
+  HTTP_POST    = 0b00000010,
+  HTTP_DELETE  = 0b00000100,
+  HTTP_PUT     = 0b00001000,
+  HTTP_PATCH   = 0b00010000,
+  HTTP_HEAD    = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY     = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String& name, const String& wert) : _name(name), _value(wert) {}
+  const String& name() const { return _name; }
+  const String& value() const { return _value; }
+
+private:
+  String _name;
+  String _value;
+};
+
+typedef std::function<size_t(uint8_t* puffer, size_t maxLaenge, size_t index)> AwsResponseFiller;
+
+class AsyncWebServerResponse {
+public:
+  AsyncWebServerResponse(int code, const String& typ, const String& inhalt)
+    : code(code), typ(typ), inhalt(inhalt) {}
+  AsyncWebServerResponse(const String& typ, AwsResponseFiller fueller)
+    : code(200), typ(typ), fueller(fueller) {}
+
+  int code;
+  String typ;
+  String inhalt;                // feste Antwort
+  AwsResponseFiller fueller;    // gestreamte Antwort, leer bei fester
+  size_t index = 0;             // bisher vom Füller gelieferte Bytes
+  size_t stuecke = 0;           // Aufrufe des Füllers mit Ergebnis > 0
+
+  bool gestreamt() const { return (bool)fueller; }
+  // nächstes Stück, 0 = Ende
+  size_t fuellen(uint8_t* puffer, size_t maxLaenge);
+  // Host: ganze Antwort in Stücken zu maxStueck Bytes abholen
+  String alles(size_t maxStueck = 1460);
+};
+
+class AsyncWebServerRequest {
+public:
+  explicit AsyncWebServerRequest(const char* url, WebRequestMethodComposite methode = HTTP_GET);
+
+  const String& url() const { return pfad; }
+  WebRequestMethodComposite method() const { return methode; }
+  bool hasParam(const char* name, bool post = false, bool datei = false) const;
+  const AsyncWebParameter* getParam(const char* name, bool post = false, bool datei = false) const;
+
+  AsyncWebServerResponse* beginResponse(int code, const char* typ = "", const String& inhalt = String());
+  AsyncWebServerResponse* beginChunkedResponse(const char* typ, AwsResponseFiller fueller);
+  void send(AsyncWebServerResponse* antwort);
+  void send(int code, const char* typ = "", const String& inhalt = String());
+
+  // Host: die gesendete Antwort, NULL solange keine gesendet wurde
+  AsyncWebServerResponse* antwort() { return gesendet.get(); }
+
+private:
+  String pfad;
+  WebRequestMethodComposite methode;
+  std::vector<AsyncWebParameter> parameter;
+  std::unique_ptr<AsyncWebServerResponse> gesendet;
+  std::vector<std::unique_ptr<AsyncWebServerResponse>> angelegt;  // mit begin*() erzeugt, noch nicht gesendet
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() {}
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+  String uri;
+  WebRequestMethodComposite methode = HTTP_ANY;
+  ArRequestHandlerFunction funktion;
+};
+
+class AsyncEventSource;
+class AsyncWebServer;
+
+class AsyncEventSourceClient {
+public:
+  AsyncEventSourceClient(AsyncEventSource* quelle, int fd) : quelle(quelle), fd(fd) {}
+  void send(const char* nachricht, const char* ereignis = NULL, uint32_t id = 0, uint32_t neuVerbinden = 0);
+  void close();
+  bool connected() const { return !geschlossen; }
+
+private:
+  friend class AsyncEventSource;
+  friend class AsyncWebServer;
+  AsyncEventSource* quelle;
+  int fd;
+  bool geschlossen = false;
+  std::string ausgang;  // noch nicht gesendet, unter der Sperre der Quelle
+  uint32_t verworfen = 0;
+};
+
+typedef std::function<void(AsyncEventSourceClient* client)> ArEventHandlerFunction;
+
+class AsyncEventSource : public AsyncWebHandler {
+public:
+  explicit AsyncEventSource(const String& url) : url(url) {}
+  void onConnect(ArEventHandlerFunction funktion) { beiVerbindung = funktion; }
+  // aus jedem Task aufrufbar, die Nachricht landet in der Warteschlange jedes Clients
+  void send(const char* nachricht, const char* ereignis = NULL, uint32_t id = 0, uint32_t neuVerbinden = 0);
+  size_t count() const;
+
+  static const size_t MAX_WARTESCHLANGE = 16384;  // Bytes je Client, darüber werden Nachrichten verworfen
+
+private:
+  friend class AsyncEventSourceClient;
+  friend class AsyncWebServer;
+  String url;
+  ArEventHandlerFunction beiVerbindung;
+  mutable std::mutex sperre;
+  std::list<std::unique_ptr<AsyncEventSourceClient>> clients;
+  AsyncWebServer* server = NULL;
+
+  static std::string nachrichtBauen(const char* nachricht, const char* ereignis, uint32_t id, uint32_t neuVerbinden);
+  void anhaengen(AsyncEventSourceClient* client, const std::string& text);
+};
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t port) : port(port) {}
+  ~AsyncWebServer();
+
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite methode, ArRequestHandlerFunction funktion);
+  void onNotFound(ArRequestHandlerFunction funktion) { nichtGefunden = funktion; }
+  AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+  void begin();
+  void end();
+
+  // Host: Anfrage direkt bearbeiten, ohne Netz
+  void bearbeiten(AsyncWebServerRequest* request);
+  uint16_t hostPort() const { return port; }
+  void wecken();  // Netz-Thread aus poll() holen, z.B. nach events.send()
+
+private:
+  struct Verbindung;
+  uint16_t port;
+  std::list<std::unique_ptr<AsyncCallbackWebHandler>> handler;
+  std::vector<AsyncEventSource*> quellen;
+  ArRequestHandlerFunction nichtGefunden;
+  int lauscher = -1;
+  int weckRohr[2] = {-1, -1};
+  volatile bool laeuft = false;
+
+  void netzSchleife();
+};
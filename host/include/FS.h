@@ -0,0 +1,62 @@
+// Host-Build: FS und File wie im Arduino ESP32 Core über ein Verzeichnis des Hosts.
+// Kopien eines File teilen sich die offene Datei, close() schließt sie für alle.
+#pragma once
+#include <memory>
+#include "Arduino.h"
+
+namespace fs {
+
+struct DateiZustand;
+
+class File : public Stream {
+public:
+  File() {}
+  explicit File(std::shared_ptr<DateiZustand> zustand) : zustand(zustand) {}
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* puffer, size_t laenge) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  size_t read(uint8_t* puffer, size_t laenge);
+  size_t readBytes(uint8_t* puffer, size_t laenge) override { return read(puffer, laenge); }
+  using Stream::readBytes;
+  int peek() override;
+  void flush() override;
+  bool seek(uint32_t position);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  operator bool() const { return (bool)zustand; }
+  const char* name() const;   // nur der Dateiname wie ab Core 2.0
+  const char* path() const;
+  bool isDirectory() const;
+  File openNextFile(const char* modus = "r");
+
+private:
+  std::shared_ptr<DateiZustand> zustand;
+};
+
+class FS {
+public:
+  File open(const char* pfad, const char* modus = "r", bool anlegen = false);
+  File open(const String& pfad, const char* modus = "r", bool anlegen = false) { return open(pfad.c_str(), modus, anlegen); }
+  bool exists(const char* pfad);
+  bool remove(const char* pfad);
+  bool rename(const char* von, const char* nach);
+  bool mkdir(const char* pfad);
+  bool rmdir(const char* pfad);
+
+  // Host: Verzeichnis, das als Wurzel dient
+  const std::string& wurzel() const { return basis; }
+  void wurzelSetzen(const std::string& verzeichnis) { basis = verzeichnis; }
+
+protected:
+  std::string basis;
+  std::string hostPfad(const char* pfad) const;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,62 @@
+// Host-Build: HTTPClient wie im Arduino ESP32 Core, nur GET. Die Verbindung bleibt nach end()
+// offen, wenn der Server sie nicht schließt (Connection: close) und HTTP/1.1 spricht.
+#pragma once
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+typedef enum {
+  HTTP_CODE_OK                    = 200,
+  HTTP_CODE_NO_CONTENT            = 204,
+  HTTP_CODE_BAD_REQUEST           = 400,
+  HTTP_CODE_NOT_FOUND             = 404,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+  HTTP_CODE_SERVICE_UNAVAILABLE   = 503,
+} t_http_codes;
+
+class HTTPClient {
+public:
+  bool begin(WiFiClient& client, const String& host, uint16_t port, const String& uri = "/", bool https = false);
+  void end();
+  bool connected() { return client != NULL && client->connected(); }
+
+  void setReuse(bool wiederverwenden) { reuse = wiederverwenden; }
+  void setTimeout(uint16_t ms) { tcpZeitlimitMs = ms; }
+  void setConnectTimeout(int32_t ms) { verbindenZeitlimitMs = ms; }
+
+  int GET();
+  int getSize() { return groesse; }
+  WiFiClient& getStream() { return *client; }
+  String getString();
+  static String errorToString(int fehler);
+
+private:
+  WiFiClient* client = NULL;
+  String host;
+  uint16_t port = 80;
+  String uri;
+  bool reuse = true;
+  bool wiederverwendbar = false;   // laut Antwort darf die Verbindung offen bleiben
+  bool chunked = false;
+  int groesse = -1;
+  int code = 0;
+  uint16_t tcpZeitlimitMs = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+  int32_t verbindenZeitlimitMs = 5000;
+
+  bool verbinden();
+  int kopfLesen();
+  bool zeileLesen(String& zeile, unsigned long zeitlimitMs);
+};
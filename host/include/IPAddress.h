@@ -0,0 +1,38 @@
+// Host-Build: IPv4 Adresse wie im Arduino Core
+#pragma once
+#include <arpa/inet.h>
+#include <cstdint>
+#include <cstring>
+#include "WString.h"
+
+class IPAddress {
+public:
+  IPAddress() { memset(bytes, 0, sizeof(bytes)); }
+  IPAddress(uint32_t adresse) { memcpy(bytes, &adresse, sizeof(bytes)); }  // Netzwerk-Bytefolge wie lwIP
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { bytes[0] = a; bytes[1] = b; bytes[2] = c; bytes[3] = d; }
+
+  bool fromString(const char* text) {
+    in_addr adresse;
+    if (text == NULL || inet_pton(AF_INET, text, &adresse) != 1) {
+      return false;
+    }
+    memcpy(bytes, &adresse.s_addr, sizeof(bytes));
+    return true;
+  }
+  bool fromString(const String& text) { return fromString(text.c_str()); }
+
+  String toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+  }
+
+  operator uint32_t() const { uint32_t a; memcpy(&a, bytes, sizeof(a)); return a; }
+  uint8_t operator[](int k) const { return bytes[k]; }
+  uint8_t& operator[](int k) { return bytes[k]; }
+  bool operator==(const IPAddress& rechts) const { return memcmp(bytes, rechts.bytes, sizeof(bytes)) == 0; }
+  bool operator!=(const IPAddress& rechts) const { return !(*this == rechts); }
+
+private:
+  uint8_t bytes[4];
+};
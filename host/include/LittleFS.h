@@ -0,0 +1,19 @@
+// Host-Build: LittleFS liegt in $SMARTWB_FS, ohne die Variable in einem neuen
+// Verzeichnis unter /tmp. begin(true) legt es an.
+#pragma once
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+  bool begin(bool formatieren = false, const char* basisPfad = "/littlefs", uint8_t maxDateien = 10, const char* partition = "spiffs");
+  void end() {}
+  bool format();
+  size_t totalBytes() { return 0x100000; }
+  size_t usedBytes();
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,28 @@
+// Host-Build: NVS im Speicher des Prozesses. Alle Preferences Objekte mit demselben
+// Namensraum sehen dieselben Daten, hostNvsLeeren() entspricht einem gelöschten Flash.
+#pragma once
+#include "Arduino.h"
+
+class Preferences {
+public:
+  bool begin(const char* name, bool nurLesen = false, const char* partition = NULL);
+  void end() { namensraum.clear(); }
+  bool clear();
+  bool remove(const char* schluessel);
+  bool isKey(const char* schluessel);
+
+  size_t putBytes(const char* schluessel, const void* wert, size_t laenge);
+  size_t getBytes(const char* schluessel, void* puffer, size_t maxLaenge);
+  size_t getBytesLength(const char* schluessel);
+  size_t putUInt(const char* schluessel, uint32_t wert) { return putBytes(schluessel, &wert, sizeof(wert)); }
+  uint32_t getUInt(const char* schluessel, uint32_t vorgabe = 0) {
+    uint32_t wert;
+    return getBytes(schluessel, &wert, sizeof(wert)) == sizeof(wert) ? wert : vorgabe;
+  }
+
+private:
+  std::string namensraum;
+  bool nurLesen = false;
+};
+
+void hostNvsLeeren();
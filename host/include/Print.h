@@ -0,0 +1,78 @@
+// Host-Build: Print und Stream wie im Arduino Core
+#pragma once
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "WString.h"
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* puffer, size_t laenge) {
+    size_t n = 0;
+    while (laenge--) n += write(*puffer++);
+    return n;
+  }
+  size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+  size_t write(const char* text, size_t laenge) { return write((const uint8_t*)text, laenge); }
+
+  size_t print(const char* text) { return write(text); }
+  size_t print(const String& text) { return write(text.c_str(), text.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int wert, int basis = 10) { return print(String(wert, (unsigned char)basis)); }
+  size_t print(unsigned int wert, int basis = 10) { return print(String(wert, (unsigned char)basis)); }
+  size_t print(long wert, int basis = 10) { return print(String(wert, (unsigned char)basis)); }
+  size_t print(unsigned long wert, int basis = 10) { return print(String(wert, (unsigned char)basis)); }
+  size_t print(double wert, int stellen = 2) { return print(String(wert, (unsigned int)stellen)); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(const T& wert) { size_t n = print(wert); return n + println(); }
+  template <typename T> size_t println(const T& wert, int format) { size_t n = print(wert, format); return n + println(); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char puffer[256];
+    va_list args;
+    va_start(args, format);
+    int laenge = vsnprintf(puffer, sizeof(puffer), format, args);
+    va_end(args);
+    if (laenge < 0) return 0;
+    return write(puffer, (size_t)laenge < sizeof(puffer) ? laenge : sizeof(puffer) - 1);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+
+  void setTimeout(unsigned long ms) { zeitlimitMs = ms; }
+  unsigned long getTimeout() const { return zeitlimitMs; }
+
+  size_t readBytes(char* puffer, size_t laenge) { return readBytes((uint8_t*)puffer, laenge); }
+  virtual size_t readBytes(uint8_t* puffer, size_t laenge) {
+    size_t n = 0;
+    while (n < laenge) {
+      int c = timedRead();
+      if (c < 0) break;
+      puffer[n++] = (uint8_t)c;
+    }
+    return n;
+  }
+  String readString() {
+    String text;
+    int c;
+    while ((c = timedRead()) >= 0) text += (char)c;
+    return text;
+  }
+
+protected:
+  unsigned long zeitlimitMs = 1000;
+
+  // wartet höchstens ms auf neue Daten, false = es kommt nichts mehr
+  virtual bool aufDatenWarten(unsigned long ms);
+  int timedRead();
+};
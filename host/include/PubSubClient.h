@@ -0,0 +1,56 @@
+// Host-Build: PubSubClient ohne Broker. connect() schlägt fehl wie bei einem nicht
+// erreichbaren Broker, state() meldet dann MQTT_CONNECT_FAILED.
+#pragma once
+#include <functional>
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+
+class PubSubClient {
+public:
+  typedef std::function<void(char*, uint8_t*, unsigned int)> Rueckruf;
+
+  PubSubClient() {}
+  explicit PubSubClient(Client& client) : client(&client) {}
+
+  PubSubClient& setServer(const char* domain, uint16_t port) { return *this; }
+  PubSubClient& setServer(IPAddress ip, uint16_t port) { return *this; }
+  PubSubClient& setCallback(Rueckruf rueckruf) { this->rueckruf = rueckruf; return *this; }
+  PubSubClient& setClient(Client& client) { this->client = &client; return *this; }
+  PubSubClient& setSocketTimeout(uint16_t sekunden) { return *this; }
+  PubSubClient& setKeepAlive(uint16_t sekunden) { return *this; }
+  bool setBufferSize(uint16_t groesse) { return true; }
+
+  bool connect(const char* id) { return verbinden(); }
+  bool connect(const char* id, const char* user, const char* pass) { return verbinden(); }
+  bool connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage) { return verbinden(); }
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos,
+               bool willRetain, const char* willMessage, bool cleanSession = true) { return verbinden(); }
+  void disconnect() { zustand = MQTT_DISCONNECTED; }
+  bool publish(const char* topic, const char* payload) { return false; }
+  bool publish(const char* topic, const char* payload, bool retained) { return false; }
+  bool subscribe(const char* topic, uint8_t qos = 0) { return false; }
+  bool loop() { return false; }
+  bool connected() { return false; }
+  int state() { return zustand; }
+
+  // Host: eine Nachricht wie vom Broker zustellen
+  void hostEmpfangen(const char* topic, const char* payload) {
+    if (rueckruf) rueckruf(const_cast<char*>(topic), (uint8_t*)payload, strlen(payload));
+  }
+
+private:
+  Client* client = NULL;
+  Rueckruf rueckruf;
+  int zustand = MQTT_DISCONNECTED;
+
+  bool verbinden() {
+    zustand = MQTT_CONNECT_FAILED;
+    return false;
+  }
+};
@@ -0,0 +1,222 @@
+// Host-Build: Arduino String mit der Speicherverwaltung des ESP32 Core (cores/esp32/WString.cpp),
+// damit Heap Trace und /api/benchmark auf dem Host dieselben Anforderungen sehen wie auf dem
+// Gerät. Bis 13 Zeichen steht der Text im Objekt (SSO, 15 Bytes bei 32-Bit Zeigern), längerer
+// auf dem Heap in Schritten von 16 Bytes per realloc, also bei jedem Anhängen über die Kapazität
+// hinaus neu. String(float) holt sich wie dort einen Zwischenpuffer mit malloc.
+// std::string hätte bis 15 Zeichen im Objekt und verdoppelt beim Wachsen.
+#pragma once
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+class String {
+public:
+  String(const char* text = "") { kopieren(text ? text : "", text ? strlen(text) : 0); }
+  String(const char* text, size_t laenge) { kopieren(text, laenge); }
+  String(const std::string& text) { kopieren(text.data(), text.size()); }
+  String(const String& text) { kopieren(text.puffer(), text.laenge); }
+  String(String&& text) { uebernehmen(text); }
+  explicit String(char c) { kopieren(&c, 1); }
+  explicit String(int wert, unsigned char basis = 10) { zahl((long long)wert, basis); }
+  explicit String(unsigned int wert, unsigned char basis = 10) { zahl((unsigned long long)wert, basis); }
+  explicit String(long wert, unsigned char basis = 10) { zahl((long long)wert, basis); }
+  explicit String(unsigned long wert, unsigned char basis = 10) { zahl((unsigned long long)wert, basis); }
+  explicit String(long long wert, unsigned char basis = 10) { zahl(wert, basis); }
+  explicit String(unsigned long long wert, unsigned char basis = 10) { zahl(wert, basis); }
+  explicit String(float wert, unsigned int stellen = 2) { gleitkomma(wert, stellen); }
+  explicit String(double wert, unsigned int stellen = 2) { gleitkomma(wert, stellen); }
+  ~String() { free(heap); }
+
+  String& operator=(const String& rechts) {
+    if (this != &rechts) kopieren(rechts.puffer(), rechts.laenge);
+    return *this;
+  }
+  String& operator=(String&& rechts) {
+    if (this != &rechts) uebernehmen(rechts);
+    return *this;
+  }
+  String& operator=(const char* rechts) { kopieren(rechts ? rechts : "", rechts ? strlen(rechts) : 0); return *this; }
+
+  const char* c_str() const { return puffer(); }
+  unsigned int length() const { return laenge; }
+  bool isEmpty() const { return laenge == 0; }
+  bool reserve(unsigned int groesse) {
+    if (hatPuffer() && kapazitaet() >= groesse) return true;
+    if (!pufferAendern(groesse)) return false;
+    if (laenge == 0) schreibPuffer()[0] = '\0';
+    return true;
+  }
+  long toInt() const { return strtol(puffer(), NULL, 10); }
+  float toFloat() const { return strtof(puffer(), NULL); }
+  int indexOf(char c, unsigned int ab = 0) const {
+    if (ab >= laenge) return -1;
+    const char* p = strchr(puffer() + ab, c);
+    return p ? (int)(p - puffer()) : -1;
+  }
+  int indexOf(const char* text, unsigned int ab = 0) const {
+    if (ab >= laenge) return -1;
+    const char* p = strstr(puffer() + ab, text);
+    return p ? (int)(p - puffer()) : -1;
+  }
+  bool startsWith(const char* text) const {
+    size_t n = strlen(text);
+    return laenge >= n && strncmp(puffer(), text, n) == 0;
+  }
+  bool endsWith(const char* text) const {
+    size_t n = strlen(text);
+    return laenge >= n && strcmp(puffer() + laenge - n, text) == 0;
+  }
+  String substring(unsigned int von) const { return substring(von, laenge); }
+  String substring(unsigned int von, unsigned int bis) const {
+    if (von > bis) std::swap(von, bis);
+    if (von >= laenge) return String();
+    if (bis > laenge) bis = laenge;
+    return String(puffer() + von, bis - von);
+  }
+  void toLowerCase() {
+    for (unsigned int k = 0; k < laenge; k++) schreibPuffer()[k] = tolower((unsigned char)schreibPuffer()[k]);
+  }
+  void trim() {
+    if (laenge == 0) return;
+    char* anfang = schreibPuffer();
+    while (isspace((unsigned char)*anfang)) anfang++;
+    char* ende = schreibPuffer() + laenge - 1;
+    while (ende >= anfang && isspace((unsigned char)*ende)) ende--;
+    laenge = ende + 1 - anfang;
+    memmove(schreibPuffer(), anfang, laenge);
+    schreibPuffer()[laenge] = '\0';
+  }
+  char operator[](unsigned int k) const { return k < laenge ? puffer()[k] : '\0'; }
+  char& operator[](unsigned int k) { return schreibPuffer()[k]; }
+
+  bool concat(const char* text, size_t laengeText) {
+    if (text == NULL) return false;
+    if (laengeText == 0) return true;
+    // text kann im eigenen Puffer liegen, den reserve() verschiebt
+    const char* alt = puffer();
+    bool eigener = text >= alt && text < alt + laenge;
+    size_t versatz = text - alt;
+    if (!reserve(laenge + laengeText)) return false;
+    if (eigener) text = puffer() + versatz;
+    memmove(schreibPuffer() + laenge, text, laengeText);
+    laenge += laengeText;
+    schreibPuffer()[laenge] = '\0';
+    return true;
+  }
+  String& operator+=(const String& rechts) { concat(rechts.puffer(), rechts.laenge); return *this; }
+  String& operator+=(const char* rechts) { if (rechts) concat(rechts, strlen(rechts)); return *this; }
+  String& operator+=(char c) { concat(&c, 1); return *this; }
+
+  bool operator==(const String& rechts) const { return laenge == rechts.laenge && strcmp(puffer(), rechts.puffer()) == 0; }
+  bool operator==(const char* rechts) const { return strcmp(puffer(), rechts ? rechts : "") == 0; }
+  bool operator!=(const String& rechts) const { return !(*this == rechts); }
+  bool operator!=(const char* rechts) const { return !(*this == rechts); }
+  bool operator<(const String& rechts) const { return strcmp(puffer(), rechts.puffer()) < 0; }
+
+private:
+  static const unsigned int SSO_GROESSE = 15;  // Zeiger, Kapazität und Länge (12 Bytes) + 4 - 1
+
+  char*        heap = NULL;   // Text auf dem Heap, sonst im Objekt
+  bool         imObjekt = false;
+  unsigned int kap = 0;       // ohne '\0', nur für heap
+  unsigned int laenge = 0;
+  char         sso[SSO_GROESSE];
+
+  // Ein neues Objekt hat noch keinen Puffer, erst das erste reserve() legt ihn an
+  bool hatPuffer() const { return heap != NULL || imObjekt; }
+  unsigned int kapazitaet() const { return heap ? kap : imObjekt ? SSO_GROESSE - 1 : 0; }
+  const char* puffer() const { return heap ? heap : imObjekt ? sso : ""; }
+  char* schreibPuffer() { return heap ? heap : sso; }
+
+  // changeBuffer() des Core
+  bool pufferAendern(unsigned int maxLaenge) {
+    if (maxLaenge < SSO_GROESSE - 1 && heap == NULL) {
+      imObjekt = true;
+      return true;
+    }
+    size_t neu = (maxLaenge + 16) & ~(size_t)0xf;
+    char* p = (char*)realloc(heap, neu);
+    if (p == NULL) return false;
+    if (heap == NULL && imObjekt) memcpy(p, sso, sizeof(sso));
+    heap = p;
+    imObjekt = false;
+    kap = neu - 1;
+    return true;
+  }
+
+  // copy() des Core
+  void kopieren(const char* text, size_t n) {
+    if (!reserve(n)) {
+      laenge = 0;
+      return;
+    }
+    memmove(schreibPuffer(), text, n);
+    laenge = n;
+    schreibPuffer()[n] = '\0';
+  }
+
+  // move() des Core: den Heap Puffer übernehmen statt kopieren
+  void uebernehmen(String& rechts) {
+    if (hatPuffer() && kapazitaet() >= rechts.laenge) {
+      memmove(schreibPuffer(), rechts.puffer(), rechts.laenge + 1);
+      laenge = rechts.laenge;
+    } else {
+      free(heap);
+      heap = rechts.heap;
+      imObjekt = rechts.imObjekt;
+      kap = rechts.kap;
+      laenge = rechts.laenge;
+      memcpy(sso, rechts.sso, sizeof(sso));
+      rechts.heap = NULL;
+    }
+    free(rechts.heap);
+    rechts.heap = NULL;
+    rechts.imObjekt = false;
+    rechts.kap = rechts.laenge = 0;
+  }
+
+  void zahl(long long wert, unsigned char basis) {
+    if (basis == 10) {
+      char puffer[24];
+      snprintf(puffer, sizeof(puffer), "%lld", wert);
+      kopieren(puffer, strlen(puffer));
+    } else {
+      zahl((unsigned long long)wert, basis);
+    }
+  }
+  void zahl(unsigned long long wert, unsigned char basis) {
+    char puffer[72];
+    char* p = puffer + sizeof(puffer) - 1;
+    *p = '\0';
+    do {
+      unsigned d = wert % basis;
+      *--p = d < 10 ? '0' + d : 'a' + d - 10;
+      wert /= basis;
+    } while (wert > 0);
+    kopieren(p, puffer + sizeof(puffer) - 1 - p);
+  }
+  // wie dtostrf() mit Breite stellen + 2, der Zwischenpuffer liegt auch im Core auf dem Heap
+  void gleitkomma(double wert, unsigned int stellen) {
+    char* puffer = (char*)malloc(stellen + 42);
+    if (puffer == NULL) {
+      kopieren("nan", 3);
+      return;
+    }
+    snprintf(puffer, stellen + 42, "%*.*f", (int)stellen + 2, (int)stellen, wert);
+    kopieren(puffer, strlen(puffer));
+    free(puffer);
+  }
+};
+
+// Wie StringSumHelper im Core: ein temporärer linker Teil wird weiterverwendet, nicht kopiert
+inline String operator+(const String& links, const String& rechts) { String e(links); e += rechts; return e; }
+inline String operator+(const String& links, const char* rechts) { String e(links); e += rechts; return e; }
+inline String operator+(const String& links, char rechts) { String e(links); e += rechts; return e; }
+inline String operator+(String&& links, const String& rechts) { links += rechts; return std::move(links); }
+inline String operator+(String&& links, const char* rechts) { links += rechts; return std::move(links); }
+inline String operator+(String&& links, char rechts) { links += rechts; return std::move(links); }
+inline String operator+(const char* links, const String& rechts) { String e(links); e += rechts; return e; }
+inline bool operator==(const char* links, const String& rechts) { return rechts == links; }
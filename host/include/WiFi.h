@@ -0,0 +1,84 @@
+// Host-Build: WLAN ist immer verbunden (per hostWlanSetzen() abschaltbar), WiFiClient ist
+// ein TCP Socket des Hosts.
+#pragma once
+#include <memory>
+#include "Arduino.h"
+#include "esp_idf_version.h"
+
+typedef enum {
+  WL_IDLE_STATUS     = 0,
+  WL_NO_SSID_AVAIL   = 1,
+  WL_SCAN_COMPLETED  = 2,
+  WL_CONNECTED       = 3,
+  WL_CONNECT_FAILED  = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED    = 6,
+} wl_status_t;
+
+class WiFiClass {
+public:
+  wl_status_t begin(const char* ssid, const char* passwort = NULL) { return status(); }
+  wl_status_t status() { return verbunden ? WL_CONNECTED : WL_DISCONNECTED; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  bool disconnect(bool wlanAus = false) { verbunden = false; return true; }
+
+  volatile bool verbunden = true;
+};
+extern WiFiClass WiFi;
+
+inline void hostWlanSetzen(bool verbunden) { WiFi.verbunden = verbunden; }
+
+class Client : public Stream {
+public:
+  virtual int connect(IPAddress ip, uint16_t port) = 0;
+  virtual int connect(const char* host, uint16_t port) = 0;
+  virtual uint8_t connected() = 0;
+  virtual void stop() = 0;
+  virtual int read(uint8_t* puffer, size_t laenge) = 0;
+  using Stream::read;
+  virtual operator bool() = 0;
+};
+
+class WiFiClient : public Client {
+public:
+  WiFiClient() {}
+  ~WiFiClient() {}
+
+  int connect(IPAddress ip, uint16_t port) override { return connect(ip, port, 3000); }
+  int connect(const char* host, uint16_t port) override { return connect(host, port, 3000); }
+  int connect(IPAddress ip, uint16_t port, int32_t zeitlimitMs);
+  int connect(const char* host, uint16_t port, int32_t zeitlimitMs);
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* puffer, size_t laenge) override;
+  using Print::write;
+
+  int available() override;
+  int read() override;
+  int read(uint8_t* puffer, size_t laenge) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+  int fd() const { return socket ? socket->fd : -1; }
+
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+  // Arduino Core 2.x: WiFiClient::setTimeout() nimmt Sekunden, 0 heißt ohne Grenze
+  int setTimeout(uint32_t sekunden) {
+    Stream::setTimeout(sekunden > 0 ? sekunden * 1000 : 0xFFFFFFFFUL);
+    return 0;
+  }
+#endif
+
+protected:
+  friend class HTTPClient;  // wartet beim Lesen des Kopfes auf den Socket statt zu pollen
+  bool aufDatenWarten(unsigned long ms) override;
+
+private:
+  struct Socket {
+    int fd = -1;
+    ~Socket();
+  };
+  std::shared_ptr<Socket> socket;  // Kopien teilen sich die Verbindung wie auf dem ESP32
+};
@@ -0,0 +1,31 @@
+// Host-Build: I2C ohne Gerät. Gezählt wird, was übertragen würde.
+#pragma once
+#include "Arduino.h"
+
+class TwoWire : public Print {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequenz = 0) { if (frequenz) takt = frequenz; return true; }
+  bool setClock(uint32_t frequenz) { takt = frequenz; return true; }
+  uint32_t getClock() const { return takt; }
+  void beginTransmission(uint8_t adresse) { this->adresse = adresse; uebertragungen++; }
+  uint8_t endTransmission(bool stop = true) { return 0; }
+  size_t write(uint8_t c) override { bytes++; return 1; }
+  size_t write(const uint8_t* puffer, size_t laenge) override { bytes += laenge; return laenge; }
+  using Print::write;
+  // wie im Core, sonst wäre write(0x00) mehrdeutig (0 ist auch ein Nullzeiger)
+  size_t write(int n) { return write((uint8_t)n); }
+  size_t write(unsigned int n) { return write((uint8_t)n); }
+  size_t write(long n) { return write((uint8_t)n); }
+  size_t write(unsigned long n) { return write((uint8_t)n); }
+  uint8_t requestFrom(uint8_t adresse, size_t anzahl, bool stop = true) { return 0; }
+  int available() { return 0; }
+  int read() { return -1; }
+
+  // Host: Zähler für Tests
+  uint32_t takt = 100000;
+  uint8_t adresse = 0;
+  uint32_t uebertragungen = 0;
+  uint32_t bytes = 0;
+};
+
+extern TwoWire Wire;
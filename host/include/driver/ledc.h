@@ -0,0 +1,161 @@
+// Host-Build: LEDC Treiber. Jeder Kanal merkt sich Tastgrad und laufende Rampe, die
+// Helligkeit während einer Rampe wird aus der Zeit berechnet. Wie in ESP-IDF wartet
+// ledc_set_duty_and_update() das Ende einer laufenden Rampe ab, die Wartezeit wird gezählt.
+// Ganz im Header, damit jedes Testprogramm seine eigene IDF Version (ledc_fade_stop) hat.
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include "esp_err.h"
+#include "esp_idf_version.h"
+#include "esp_timer.h"
+
+typedef enum {
+  LEDC_HIGH_SPEED_MODE = 0,
+  LEDC_LOW_SPEED_MODE,
+  LEDC_SPEED_MODE_MAX,
+} ledc_mode_t;
+
+typedef enum {
+  LEDC_TIMER_1_BIT = 1, LEDC_TIMER_2_BIT, LEDC_TIMER_3_BIT, LEDC_TIMER_4_BIT, LEDC_TIMER_5_BIT,
+  LEDC_TIMER_6_BIT, LEDC_TIMER_7_BIT, LEDC_TIMER_8_BIT, LEDC_TIMER_9_BIT, LEDC_TIMER_10_BIT,
+  LEDC_TIMER_11_BIT, LEDC_TIMER_12_BIT, LEDC_TIMER_13_BIT, LEDC_TIMER_14_BIT, LEDC_TIMER_15_BIT,
+  LEDC_TIMER_BIT_MAX,
+} ledc_timer_bit_t;
+
+typedef enum { LEDC_TIMER_0 = 0, LEDC_TIMER_1, LEDC_TIMER_2, LEDC_TIMER_3, LEDC_TIMER_MAX } ledc_timer_t;
+
+typedef enum {
+  LEDC_CHANNEL_0 = 0, LEDC_CHANNEL_1, LEDC_CHANNEL_2, LEDC_CHANNEL_3,
+  LEDC_CHANNEL_4, LEDC_CHANNEL_5, LEDC_CHANNEL_6, LEDC_CHANNEL_7,
+  LEDC_CHANNEL_MAX,
+} ledc_channel_t;
+
+typedef enum { LEDC_INTR_DISABLE = 0, LEDC_INTR_FADE_END } ledc_intr_type_t;
+typedef enum { LEDC_AUTO_CLK = 0 } ledc_clk_cfg_t;
+typedef enum { LEDC_FADE_NO_WAIT = 0, LEDC_FADE_WAIT_DONE } ledc_fade_mode_t;
+
+typedef struct {
+  ledc_mode_t      speed_mode;
+  ledc_timer_bit_t duty_resolution;
+  ledc_timer_t     timer_num;
+  uint32_t         freq_hz;
+  ledc_clk_cfg_t   clk_cfg;
+} ledc_timer_config_t;
+
+typedef struct {
+  int              gpio_num;
+  ledc_mode_t      speed_mode;
+  ledc_channel_t   channel;
+  ledc_intr_type_t intr_type;
+  ledc_timer_t     timer_sel;
+  uint32_t         duty;
+  int              hpoint;
+} ledc_channel_config_t;
+
+// Zustand eines Kanals, für die Tests lesbar
+struct LedcHostKanal {
+  int      gpio = -1;
+  uint32_t duty = 0;             // zuletzt gesetzter Tastgrad bzw. Start der Rampe
+  uint32_t rampenZiel = 0;
+  int64_t  rampenStartUs = 0;
+  int64_t  rampenEndeUs = 0;     // 0 = keine Rampe
+  uint32_t dutyGesetzt = 0;      // Aufrufe von ledc_set_duty_and_update()
+  uint32_t rampen = 0;           // gestartete Rampen
+  uint32_t rampenGestoppt = 0;   // per ledc_fade_stop() beendet
+  uint32_t blockiert = 0;        // ledc_set_duty_and_update() musste auf das Rampenende warten
+  int64_t  blockiertUs = 0;
+};
+
+inline std::mutex ledcHostSperre;
+inline LedcHostKanal ledcHostKanaele[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+inline bool ledcHostFadeInstalliert = false;
+
+inline LedcHostKanal& ledcHostKanal(ledc_channel_t kanal, ledc_mode_t modus = LEDC_HIGH_SPEED_MODE) {
+  return ledcHostKanaele[modus][kanal];
+}
+
+// Tastgrad jetzt, während einer Rampe linear zwischen Start und Ziel
+inline uint32_t ledcHostDutyJetzt(const LedcHostKanal& k, int64_t jetztUs) {
+  if (k.rampenEndeUs == 0) return k.duty;
+  if (jetztUs >= k.rampenEndeUs) return k.rampenZiel;
+  int64_t dauer = k.rampenEndeUs - k.rampenStartUs;
+  int64_t anteil = dauer > 0 ? (jetztUs - k.rampenStartUs) * 1000 / dauer : 1000;
+  return (uint32_t)((int64_t)k.duty + ((int64_t)k.rampenZiel - (int64_t)k.duty) * anteil / 1000);
+}
+
+inline esp_err_t ledc_timer_config(const ledc_timer_config_t* konfig) {
+  return konfig->timer_num < LEDC_TIMER_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+inline esp_err_t ledc_channel_config(const ledc_channel_config_t* konfig) {
+  if (konfig->channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> sperre(ledcHostSperre);
+  LedcHostKanal& k = ledcHostKanaele[konfig->speed_mode][konfig->channel];
+  k = LedcHostKanal();
+  k.gpio = konfig->gpio_num;
+  k.duty = konfig->duty;
+  return ESP_OK;
+}
+
+inline esp_err_t ledc_fade_func_install(int intrFlags) {
+  if (ledcHostFadeInstalliert) return ESP_ERR_INVALID_STATE;
+  ledcHostFadeInstalliert = true;
+  return ESP_OK;
+}
+
+inline uint32_t ledc_get_duty(ledc_mode_t modus, ledc_channel_t kanal) {
+  std::lock_guard<std::mutex> sperre(ledcHostSperre);
+  return ledcHostDutyJetzt(ledcHostKanaele[modus][kanal], esp_timer_get_time());
+}
+
+inline esp_err_t ledc_set_duty_and_update(ledc_mode_t modus, ledc_channel_t kanal, uint32_t duty, uint32_t hpoint) {
+  std::unique_lock<std::mutex> sperre(ledcHostSperre);
+  LedcHostKanal& k = ledcHostKanaele[modus][kanal];
+  int64_t jetzt = esp_timer_get_time();
+  if (k.rampenEndeUs > jetzt) {
+    // Eine laufende Rampe lässt sich nicht unterbrechen: warten bis sie fertig ist
+    int64_t warten = k.rampenEndeUs - jetzt;
+    k.blockiert++;
+    k.blockiertUs += warten;
+    sperre.unlock();
+    hostUhrSchlafenBis(jetzt + warten);
+    sperre.lock();
+  }
+  k.duty = duty;
+  k.rampenEndeUs = 0;
+  k.dutyGesetzt++;
+  return ESP_OK;
+}
+
+inline esp_err_t ledc_set_fade_time_and_start(ledc_mode_t modus, ledc_channel_t kanal, uint32_t zielDuty,
+                                              uint32_t dauerMs, ledc_fade_mode_t warten) {
+  if (!ledcHostFadeInstalliert) return ESP_ERR_INVALID_STATE;
+  std::unique_lock<std::mutex> sperre(ledcHostSperre);
+  LedcHostKanal& k = ledcHostKanaele[modus][kanal];
+  int64_t jetzt = esp_timer_get_time();
+  k.duty = ledcHostDutyJetzt(k, jetzt);
+  k.rampenZiel = zielDuty;
+  k.rampenStartUs = jetzt;
+  k.rampenEndeUs = jetzt + (int64_t)dauerMs * 1000;
+  k.rampen++;
+  if (warten == LEDC_FADE_WAIT_DONE) {
+    int64_t endeUs = k.rampenEndeUs;
+    sperre.unlock();
+    hostUhrSchlafenBis(endeUs);
+  }
+  return ESP_OK;
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+inline esp_err_t ledc_fade_stop(ledc_mode_t modus, ledc_channel_t kanal) {
+  std::lock_guard<std::mutex> sperre(ledcHostSperre);
+  LedcHostKanal& k = ledcHostKanaele[modus][kanal];
+  int64_t jetzt = esp_timer_get_time();
+  if (k.rampenEndeUs > jetzt) {
+    k.duty = ledcHostDutyJetzt(k, jetzt);
+    k.rampenEndeUs = 0;
+    k.rampenGestoppt++;
+  }
+  return ESP_OK;
+}
+#endif
@@ -0,0 +1,35 @@
+// Host-Build: Heap Trace (standalone) wie in ESP-IDF. heap_trace.cpp ersetzt dafür malloc,
+// calloc, realloc und free des Prozesses.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "esp_err.h"
+
+typedef enum {
+  HEAP_TRACE_ALL,
+  HEAP_TRACE_LEAKS,
+} heap_trace_mode_t;
+
+typedef struct {
+  uint32_t ccount;
+  void*    address;
+  size_t   size;
+  bool     freed;
+} heap_trace_record_t;
+
+typedef struct {
+  heap_trace_mode_t mode;
+  size_t total_allocations;
+  size_t total_frees;
+  size_t count;
+  size_t capacity;
+  size_t high_water_mark;
+  size_t has_overflowed;
+} heap_trace_summary_t;
+
+esp_err_t heap_trace_init_standalone(heap_trace_record_t* record_buffer, size_t num_records);
+esp_err_t heap_trace_start(heap_trace_mode_t mode);
+esp_err_t heap_trace_stop(void);
+esp_err_t heap_trace_resume(void);
+size_t    heap_trace_get_count(void);
+esp_err_t heap_trace_summary(heap_trace_summary_t* summary);
@@ -0,0 +1,20 @@
+// Host-Build: ESP-IDF Version. Standard ist der Arduino Core 3.x (IDF 5.1), mit
+// -DESP_IDF_VERSION_MAJOR=4 wird der Core 2.x (IDF 4.4) nachgebildet.
+#pragma once
+
+#ifndef ESP_IDF_VERSION_MAJOR
+#define ESP_IDF_VERSION_MAJOR 5
+#endif
+#ifndef ESP_IDF_VERSION_MINOR
+#if ESP_IDF_VERSION_MAJOR >= 5
+#define ESP_IDF_VERSION_MINOR 1
+#else
+#define ESP_IDF_VERSION_MINOR 4
+#endif
+#endif
+#ifndef ESP_IDF_VERSION_PATCH
+#define ESP_IDF_VERSION_PATCH 0
+#endif
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(ESP_IDF_VERSION_MAJOR, ESP_IDF_VERSION_MINOR, ESP_IDF_VERSION_PATCH)
@@ -0,0 +1,24 @@
+// Host-Build: Neustartgrund und Shutdown-Handler
+#pragma once
+#include "esp_err.h"
+
+typedef enum {
+  ESP_RST_UNKNOWN,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+  ESP_RST_DEEPSLEEP,
+  ESP_RST_BROWNOUT,
+  ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+typedef void (*shutdown_handler_t)(void);
+
+esp_reset_reason_t esp_reset_reason(void);
+void hostResetGrundSetzen(esp_reset_reason_t grund);  // Host: Grund für den nächsten Start vorgeben
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler);
+void esp_restart(void);  // ruft die Shutdown-Handler auf und beendet den Prozess
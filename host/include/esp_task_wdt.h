@@ -0,0 +1,9 @@
+// Host-Build: Task Watchdog. Überwacht wird nicht, gezählt werden die Resets.
+#pragma once
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+esp_err_t esp_task_wdt_add(TaskHandle_t task);
+esp_err_t esp_task_wdt_delete(TaskHandle_t task);
+esp_err_t esp_task_wdt_reset(void);
+uint32_t hostWdtResets();
@@ -0,0 +1,33 @@
+// Host-Build: esp_timer mit eigenem Thread als esp_timer Task. Wie in ESP-IDF liefert
+// esp_timer_start_*() ESP_ERR_INVALID_STATE für einen laufenden Timer und esp_timer_stop()
+// für einen, der nicht läuft. Rückrufe laufen nacheinander im Timer-Thread.
+#pragma once
+#include <cstdint>
+#include "esp_err.h"
+
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum {
+  ESP_TIMER_TASK,
+  ESP_TIMER_MAX,
+} esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t       callback;
+  void*                arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char*          name;
+  bool                 skip_unhandled_events;
+} esp_timer_create_args_t;
+
+struct esp_timer;
+typedef struct esp_timer* esp_timer_handle_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodeUs);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+bool      esp_timer_is_active(esp_timer_handle_t timer);
+int64_t   esp_timer_get_time(void);  // µs auf der Uhr des Hosts, siehe hostUhrUs() in Arduino.h
+void      hostUhrSchlafenBis(int64_t bisUs);  // für die LEDC Rampen
@@ -0,0 +1,79 @@
+// Host-Build: die benutzten FreeRTOS Funktionen auf std::thread. Jeder Task ist ein Thread,
+// Prioritäten, Cores und Stackgrößen werden ignoriert. Ein Tick ist eine Millisekunde.
+#pragma once
+#include <cstdint>
+#include <mutex>
+
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t     TickType_t;
+typedef uint32_t     EventBits_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+#define errQUEUE_FULL 0
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(...)
+
+// Kritische Abschnitte: auf dem ESP32 ein Spinlock mit gesperrten Interrupts, hier ein Mutex
+struct portMUX_TYPE {
+  std::mutex sperre;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux)     (mux)->sperre.lock()
+#define portEXIT_CRITICAL(mux)      (mux)->sperre.unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->sperre.lock()
+#define portEXIT_CRITICAL_ISR(mux)  (mux)->sperre.unlock()
+
+struct HostTask;
+struct HostSemaphore;
+struct HostQueue;
+struct HostEventGroup;
+typedef HostTask*       TaskHandle_t;
+typedef HostSemaphore*  SemaphoreHandle_t;
+typedef HostQueue*      QueueHandle_t;
+typedef HostEventGroup* EventGroupHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Tasks
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t funktion, const char* name, uint32_t stack, void* parameter,
+                                   UBaseType_t prio, TaskHandle_t* handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t funktion, const char* name, uint32_t stack, void* parameter,
+                       UBaseType_t prio, TaskHandle_t* handle);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t   xTaskGetTickCount();
+void         vTaskDelay(TickType_t ticks);
+UBaseType_t  uxTaskGetStackHighWaterMark(TaskHandle_t task);
+uint32_t     ulTaskNotifyTake(BaseType_t loeschen, TickType_t warten);
+BaseType_t   xTaskNotifyGive(TaskHandle_t task);
+void         vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* hoeherePrioGeweckt);
+
+// Semaphoren
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maximum, UBaseType_t start);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t warten);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t semaphore);
+void              vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+// Queues
+QueueHandle_t xQueueCreate(UBaseType_t laenge, UBaseType_t groesse);
+BaseType_t    xQueueSend(QueueHandle_t queue, const void* element, TickType_t warten);
+BaseType_t    xQueueReceive(QueueHandle_t queue, void* element, TickType_t warten);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t queue);
+#define xQueueSendToBack xQueueSend
+
+// Event Groups
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t        xEventGroupSetBits(EventGroupHandle_t gruppe, EventBits_t bits);
+EventBits_t        xEventGroupClearBits(EventGroupHandle_t gruppe, EventBits_t bits);
+EventBits_t        xEventGroupGetBits(EventGroupHandle_t gruppe);
+EventBits_t        xEventGroupWaitBits(EventGroupHandle_t gruppe, EventBits_t bits, BaseType_t loeschen,
+                                       BaseType_t alle, TickType_t warten);
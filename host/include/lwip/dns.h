@@ -0,0 +1,35 @@
+// Host-Build: lwIP Namensauflösung. dns_gethostbyname() löst in einem eigenen Thread
+// per getaddrinfo() auf und meldet das Ergebnis wie lwIP über den Rückruf.
+#pragma once
+#include <cstdint>
+
+typedef int8_t err_t;
+#define ERR_OK          0
+#define ERR_MEM        -1
+#define ERR_INPROGRESS -5
+#define ERR_VAL        -6
+#define ERR_ARG       -16
+
+#define IPADDR_TYPE_V4 0U
+#define IPADDR_TYPE_V6 6U
+
+typedef struct {
+  uint32_t addr;  // Netzwerk-Bytefolge
+} ip4_addr_t;
+
+typedef struct {
+  union {
+    ip4_addr_t ip4;
+  } u_addr;
+  uint8_t type;
+} ip_addr_t;
+
+#define IP_IS_V4(adresse) ((adresse)->type == IPADDR_TYPE_V4)
+#define ip_2_ip4(adresse) (&((adresse)->u_addr.ip4))
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* adresse, void* arg);
+
+err_t dns_gethostbyname(const char* name, ip_addr_t* adresse, dns_found_callback gefunden, void* arg);
+
+// Host: künstliche Dauer jeder Auflösung (langsamer DNS Server)
+void hostDnsVerzoegerung(uint32_t ms);
@@ -0,0 +1,13 @@
+// Host-Build: tcpip_api_call() führt die Funktion wie lwIP im tcpip Thread aus und wartet darauf
+#pragma once
+#include "lwip/dns.h"
+
+struct tcpip_api_call_data {
+  int reserviert;  // lwIP: Semaphore und Fehler, hier nicht gebraucht
+};
+typedef err_t (*tcpip_api_call_fn)(struct tcpip_api_call_data* aufruf);
+
+err_t tcpip_api_call(tcpip_api_call_fn funktion, struct tcpip_api_call_data* aufruf);
+
+// Host: Aufrufe von dns_gethostbyname() außerhalb des tcpip Threads
+uint32_t hostDnsAusserhalbTcpip();
@@ -0,0 +1,277 @@
+// Host-Build: Zeit, GPIO, Serial, ESP, Stream, Neustart, Watchdog und Heap
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <malloc.h>
+#include <unistd.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Arduino.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "esp_task_wdt.h"
+#include "uhr.h"
+
+// ---------------------------------------------------------------- Uhr
+
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+
+static int64_t wanduhrUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+static std::mutex uhrSperre;                  // Stellen der Uhr und die Liste der Fristen
+static std::condition_variable uhrGestellt;   // weckt hostUhrSchlafenBis()
+static std::atomic<int64_t> uhrVersatzUs{0};  // läuft: Wanduhr plus Versatz
+static std::atomic<int64_t> uhrStandUs{-1};   // angehalten: fester Stand, sonst -1
+static HostUhrFrist* uhrFristen = NULL;       // cv NULL: pollt selbst oder wartet auf uhrGestellt
+
+int64_t hostUhrUs() {
+  int64_t stand = uhrStandUs.load();
+  return stand >= 0 ? stand : wanduhrUs() + uhrVersatzUs.load();
+}
+
+// unter uhrSperre: alle Wartenden prüfen ihre Frist neu
+static void uhrWecken() {
+  uhrGestellt.notify_all();
+  for (HostUhrFrist* f = uhrFristen; f != NULL; f = f->naechste) {
+    if (f->cv) f->cv->notify_all();
+  }
+}
+
+void hostUhrAnhalten(bool angehalten) {
+  std::lock_guard<std::mutex> l(uhrSperre);
+  int64_t jetzt = hostUhrUs();
+  if (angehalten) {
+    uhrStandUs = jetzt;
+  } else {
+    uhrVersatzUs = jetzt - wanduhrUs();
+    uhrStandUs = -1;
+  }
+  uhrWecken();
+}
+
+void hostUhrVorstellen(uint32_t ms) {
+  std::lock_guard<std::mutex> l(uhrSperre);
+  if (uhrStandUs.load() >= 0) {
+    uhrStandUs += (int64_t)ms * 1000;
+  } else {
+    uhrVersatzUs += (int64_t)ms * 1000;
+  }
+  uhrWecken();
+}
+
+bool hostUhrZurNaechstenFrist(uint32_t ruheMs) {
+  std::lock_guard<std::mutex> l(uhrSperre);
+  int64_t stand = uhrStandUs.load();
+  if (stand < 0 || uhrFristen == NULL) return false;
+  const HostUhrFrist* naechste = uhrFristen;
+  for (HostUhrFrist* f = uhrFristen; f != NULL; f = f->naechste) {
+    if (f->bisUs < naechste->bisUs) naechste = f;
+  }
+  // Wer gerade erst wartet, bekommt vielleicht gleich Daten oder eine Benachrichtigung
+  if (wanduhrUs() - naechste->seitUs < (int64_t)ruheMs * 1000) return false;
+  if (naechste->bisUs > stand) uhrStandUs = naechste->bisUs;
+  uhrWecken();
+  return true;
+}
+
+HostUhrFrist::HostUhrFrist(int64_t bisUs, std::condition_variable* cv) : bisUs(bisUs), cv(cv), seitUs(wanduhrUs()) {
+  std::lock_guard<std::mutex> l(uhrSperre);
+  naechste = uhrFristen;
+  if (naechste) naechste->vorige = this;
+  uhrFristen = this;
+}
+
+HostUhrFrist::~HostUhrFrist() {
+  std::lock_guard<std::mutex> l(uhrSperre);
+  if (vorige) {
+    vorige->naechste = naechste;
+  } else {
+    uhrFristen = naechste;
+  }
+  if (naechste) naechste->vorige = vorige;
+}
+
+void hostUhrSchlafenBis(int64_t bisUs) {
+  HostUhrFrist frist(bisUs, NULL);
+  std::unique_lock<std::mutex> l(uhrSperre);
+  for (;;) {
+    int64_t restUs = bisUs - hostUhrUs();
+    if (restUs <= 0) break;
+    uhrGestellt.wait_for(l, std::chrono::microseconds(restUs));  // Stellen weckt unter uhrSperre
+  }
+}
+
+unsigned long millis() {
+  return (unsigned long)(hostUhrUs() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)hostUhrUs();
+}
+
+void delay(uint32_t ms) {
+  if (ms == 0) {
+    std::this_thread::yield();
+    return;
+  }
+  hostUhrSchlafenBis(hostUhrUs() + (int64_t)ms * 1000);
+}
+
+// ---------------------------------------------------------------- GPIO
+
+static const int HOST_PINS = 40;
+static std::atomic<int> pinPegel[HOST_PINS];
+static std::atomic<void (*)()> pinIsr[HOST_PINS];
+static int pinIsrModus[HOST_PINS];
+
+void pinMode(uint8_t pin, uint8_t modus) {
+  if (pin < HOST_PINS && modus == INPUT_PULLUP) pinPegel[pin] = HIGH;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < HOST_PINS ? pinPegel[pin].load() : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t pegel) {
+  if (pin < HOST_PINS) pinPegel[pin] = pegel ? HIGH : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int modus) {
+  if (pin >= HOST_PINS) return;
+  pinIsrModus[pin] = modus;
+  pinIsr[pin] = isr;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < HOST_PINS) pinIsr[pin] = NULL;
+}
+
+void hostPinSetzen(uint8_t pin, int pegel) {
+  if (pin >= HOST_PINS) return;
+  pegel = pegel ? HIGH : LOW;
+  int vorher = pinPegel[pin].exchange(pegel);
+  void (*isr)() = pinIsr[pin];
+  if (isr == NULL || vorher == pegel) return;
+  int modus = pinIsrModus[pin];
+  if (modus == CHANGE || (modus == RISING && pegel == HIGH) || (modus == FALLING && pegel == LOW)) {
+    isr();
+  }
+}
+
+// ---------------------------------------------------------------- Serial, ESP
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// Der Heap des Prozesses ist größer und enthält den Testrahmen. Gemeldet wird ein Heap
+// in der Größe des ESP32, belegt ist, was seit dem ersten Aufruf dazugekommen ist.
+static size_t hostHeapGroesse = 320 * 1024;  // wie ein ESP32 ohne PSRAM
+static std::atomic<size_t> hostHeapMinimum{SIZE_MAX};
+
+static size_t hostHeapBelegt() {
+  static const size_t basis = mallinfo2().uordblks;
+  size_t belegt = mallinfo2().uordblks;
+  return belegt > basis ? belegt - basis : 0;
+}
+
+static size_t hostHeapFrei() {
+  size_t belegt = hostHeapBelegt();
+  size_t frei = belegt < hostHeapGroesse ? hostHeapGroesse - belegt : 0;
+  size_t minimum = hostHeapMinimum.load();
+  while (frei < minimum && !hostHeapMinimum.compare_exchange_weak(minimum, frei)) {
+  }
+  return frei;
+}
+
+void hostHeapGroesseSetzen(size_t bytes) { hostHeapGroesse = bytes; }
+
+uint32_t EspClass::getHeapSize() { return hostHeapGroesse; }
+uint32_t EspClass::getFreeHeap() { return hostHeapFrei(); }
+uint32_t EspClass::getMinFreeHeap() {
+  hostHeapFrei();
+  return hostHeapMinimum.load();
+}
+uint32_t EspClass::getCycleCount() {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hostStart).count();
+  return (uint32_t)(ns * 240 / 1000);
+}
+void EspClass::restart() { esp_restart(); }
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+  struct mallinfo2 m = mallinfo2();
+  memset(info, 0, sizeof(*info));
+  info->total_free_bytes = hostHeapFrei();
+  info->total_allocated_bytes = hostHeapBelegt();
+  info->largest_free_block = info->total_free_bytes;
+  info->minimum_free_bytes = hostHeapMinimum.load();
+  info->allocated_blocks = 0;  // zählt mallinfo2 nicht
+  info->free_blocks = m.ordblks;
+  info->total_blocks = info->free_blocks;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) { return hostHeapFrei(); }
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  hostHeapFrei();
+  return hostHeapMinimum.load();
+}
+
+// ---------------------------------------------------------------- Stream
+
+bool Stream::aufDatenWarten(unsigned long ms) {
+  delay(1);
+  return true;
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  for (;;) {
+    int c = read();
+    if (c >= 0) return c;
+    unsigned long vergangen = millis() - start;
+    if (vergangen >= zeitlimitMs) return -1;
+    if (!aufDatenWarten(zeitlimitMs - vergangen)) return -1;
+  }
+}
+
+// ---------------------------------------------------------------- Neustart, Watchdog
+
+static esp_reset_reason_t hostResetGrund = ESP_RST_POWERON;
+static std::mutex shutdownSperre;
+static std::vector<shutdown_handler_t> shutdownHandler;
+static std::atomic<uint32_t> wdtResets{0};
+
+esp_reset_reason_t esp_reset_reason(void) { return hostResetGrund; }
+
+void hostResetGrundSetzen(esp_reset_reason_t grund) { hostResetGrund = grund; }
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler) {
+  std::lock_guard<std::mutex> sperre(shutdownSperre);
+  for (shutdown_handler_t h : shutdownHandler) {
+    if (h == handler) return ESP_ERR_INVALID_STATE;
+  }
+  shutdownHandler.push_back(handler);
+  return ESP_OK;
+}
+
+void esp_restart(void) {
+  std::vector<shutdown_handler_t> handler;
+  {
+    std::lock_guard<std::mutex> sperre(shutdownSperre);
+    handler = shutdownHandler;
+  }
+  for (auto it = handler.rbegin(); it != handler.rend(); ++it) (*it)();
+  fflush(stdout);
+  _exit(0);
+}
+
+esp_err_t esp_task_wdt_add(TaskHandle_t task) { return ESP_OK; }
+esp_err_t esp_task_wdt_delete(TaskHandle_t task) { return ESP_OK; }
+esp_err_t esp_task_wdt_reset(void) {
+  wdtResets++;
+  return ESP_OK;
+}
+uint32_t hostWdtResets() { return wdtResets.load(); }
@@ -0,0 +1,671 @@
+// Host-Build: ArduinoJson 6 Teilmenge, Speicher, Zugriff und Parser
+#include "ArduinoJson.h"
+#include <cerrno>
+
+// ---------------------------------------------------------------- Knoten und Speicher
+
+const JsonKnoten* JsonKnoten::member(const char* name) const {
+  if (typ != OBJEKT || !name) return NULL;
+  for (const JsonKnoten* k = erstes; k; k = k->naechstes) {
+    if (k->schluessel && strcmp(k->schluessel, name) == 0) return k;
+  }
+  return NULL;
+}
+
+const JsonKnoten* JsonKnoten::element(size_t index) const {
+  if (typ != FELD) return NULL;
+  for (const JsonKnoten* k = erstes; k; k = k->naechstes) {
+    if (index-- == 0) return k;
+  }
+  return NULL;
+}
+
+size_t JsonKnoten::groesse() const {
+  if (typ != OBJEKT && typ != FELD) return 0;
+  size_t n = 0;
+  for (const JsonKnoten* k = erstes; k; k = k->naechstes) n++;
+  return n;
+}
+
+JsonKnoten* JsonSpeicher::knotenHolen() {
+  if (belegt() + ARDUINOJSON_SLOT_GROESSE > kapazitaet || knotenBelegt >= knotenAnzahl) {
+    ueberlauf = true;
+    return NULL;
+  }
+  JsonKnoten* k = &knoten[knotenBelegt++];
+  *k = JsonKnoten();
+  return k;
+}
+
+const char* JsonSpeicher::textKopieren(const char* quelle, size_t laenge) {
+  // gleiche Texte nur einmal ablegen, wie ArduinoJson ab 6.15
+  for (size_t p = 0; p < textBelegt; p += strlen(text + p) + 1) {
+    if (strlen(text + p) == laenge && memcmp(text + p, quelle, laenge) == 0) return text + p;
+  }
+  if (belegt() + laenge + 1 > kapazitaet) {
+    ueberlauf = true;
+    return NULL;
+  }
+  char* ziel = text + textBelegt;
+  memcpy(ziel, quelle, laenge);
+  ziel[laenge] = '\0';
+  textBelegt += laenge + 1;
+  return ziel;
+}
+
+static void kindAnhaengen(JsonKnoten* eltern, JsonKnoten* kind) {
+  if (eltern->letztes) {
+    eltern->letztes->naechstes = kind;
+  } else {
+    eltern->erstes = kind;
+  }
+  eltern->letztes = kind;
+}
+
+// ---------------------------------------------------------------- Umwandlungen
+
+namespace ArduinoJsonHost {
+
+bool alsBool(const JsonKnoten* k) {
+  if (!k) return false;
+  switch (k->typ) {
+    case JsonKnoten::BOOL:  return k->wert.b;
+    case JsonKnoten::INT:   return k->wert.i != 0;
+    case JsonKnoten::FLOAT: return k->wert.d != 0;
+    default:                return false;
+  }
+}
+
+long long alsGanzzahl(const JsonKnoten* k) {
+  if (!k) return 0;
+  switch (k->typ) {
+    case JsonKnoten::BOOL:  return k->wert.b ? 1 : 0;
+    case JsonKnoten::INT:   return k->wert.i;
+    case JsonKnoten::FLOAT: return (long long)k->wert.d;
+    case JsonKnoten::TEXT:  return strtoll(k->wert.s, NULL, 10);
+    default:                return 0;
+  }
+}
+
+double alsGleitkomma(const JsonKnoten* k) {
+  if (!k) return 0;
+  switch (k->typ) {
+    case JsonKnoten::BOOL:  return k->wert.b ? 1 : 0;
+    case JsonKnoten::INT:   return (double)k->wert.i;
+    case JsonKnoten::FLOAT: return k->wert.d;
+    case JsonKnoten::TEXT:  return strtod(k->wert.s, NULL);
+    default:                return 0;
+  }
+}
+
+String alsString(const JsonKnoten* k) {
+  if (k && k->typ == JsonKnoten::TEXT) return String(k->wert.s);
+  String text;
+  serializeJson(JsonVariantConst(k), text);
+  return text;
+}
+
+}  // namespace ArduinoJsonHost
+
+// ---------------------------------------------------------------- Schreiben
+
+JsonKnoten* JsonVariant::anlegen() {
+  if (knoten) return knoten;
+  if (!speicher || !eltern) return NULL;
+  if (eltern->typ == JsonKnoten::NUL) eltern->typ = istElement ? JsonKnoten::FELD : JsonKnoten::OBJEKT;
+  if (istElement) {
+    if (eltern->typ != JsonKnoten::FELD) return NULL;
+    // wie im Original werden fehlende Elemente davor mit null aufgefüllt
+    size_t anzahl = eltern->groesse();
+    while (anzahl <= index) {
+      JsonKnoten* k = speicher->knotenHolen();
+      if (!k) return NULL;
+      kindAnhaengen(eltern, k);
+      anzahl++;
+    }
+    knoten = const_cast<JsonKnoten*>(eltern->element(index));
+  } else {
+    if (eltern->typ != JsonKnoten::OBJEKT) return NULL;
+    const char* schluessel = nameKopieren ? speicher->textKopieren(name, strlen(name)) : name;
+    if (!schluessel) return NULL;
+    JsonKnoten* k = speicher->knotenHolen();
+    if (!k) return NULL;
+    k->schluessel = schluessel;
+    kindAnhaengen(eltern, k);
+    knoten = k;
+  }
+  return knoten;
+}
+
+bool JsonVariant::set(bool wert) {
+  if (!anlegen()) return false;
+  knoten->leeren();
+  knoten->typ = JsonKnoten::BOOL;
+  knoten->wert.b = wert;
+  return true;
+}
+
+bool JsonVariant::set(long long wert) {
+  if (!anlegen()) return false;
+  knoten->leeren();
+  knoten->typ = JsonKnoten::INT;
+  knoten->wert.i = wert;
+  return true;
+}
+
+bool JsonVariant::set(double wert) {
+  if (!anlegen()) return false;
+  knoten->leeren();
+  knoten->typ = JsonKnoten::FLOAT;
+  knoten->wert.d = wert;
+  return true;
+}
+
+bool JsonVariant::set(const char* wert) {
+  if (!anlegen()) return false;
+  knoten->leeren();
+  if (wert) {
+    knoten->typ = JsonKnoten::TEXT;
+    knoten->wert.s = wert;
+  }
+  return true;
+}
+
+bool JsonVariant::set(const String& wert) {
+  if (!anlegen()) return false;
+  const char* kopie = speicher->textKopieren(wert.c_str(), wert.length());
+  if (!kopie) return false;
+  knoten->leeren();
+  knoten->typ = JsonKnoten::TEXT;
+  knoten->wert.s = kopie;
+  return true;
+}
+
+bool JsonVariant::set(JsonVariantConst wert) {
+  const JsonKnoten* quelle = wert.knotenHolen();
+  if (!anlegen()) return false;
+  knoten->leeren();
+  if (!quelle) return true;
+  switch (quelle->typ) {
+    case JsonKnoten::OBJEKT:
+      knoten->typ = JsonKnoten::OBJEKT;
+      for (const JsonKnoten* k = quelle->erstes; k; k = k->naechstes) {
+        JsonVariant kind(speicher, knoten, k->schluessel, true);
+        if (!kind.set(JsonVariantConst(k))) return false;
+      }
+      return true;
+    case JsonKnoten::FELD:
+      knoten->typ = JsonKnoten::FELD;
+      for (const JsonKnoten* k = quelle->erstes; k; k = k->naechstes) {
+        if (!add().set(JsonVariantConst(k))) return false;
+      }
+      return true;
+    case JsonKnoten::TEXT:
+      return set(String(quelle->wert.s));
+    default:
+      knoten->typ = quelle->typ;
+      knoten->wert = quelle->wert;
+      return true;
+  }
+}
+
+JsonVariant JsonVariant::add() {
+  if (!anlegen()) return JsonVariant();
+  if (knoten->typ == JsonKnoten::NUL) knoten->typ = JsonKnoten::FELD;
+  if (knoten->typ != JsonKnoten::FELD) return JsonVariant();
+  JsonKnoten* k = speicher->knotenHolen();
+  if (!k) return JsonVariant();
+  kindAnhaengen(knoten, k);
+  return JsonVariant(speicher, k);
+}
+
+JsonObject JsonVariant::to_object() {
+  if (!anlegen()) return JsonObject();
+  knoten->leeren();
+  knoten->typ = JsonKnoten::OBJEKT;
+  return JsonObject(speicher, knoten);
+}
+
+JsonArray JsonVariant::to_array() {
+  if (!anlegen()) return JsonArray();
+  knoten->leeren();
+  knoten->typ = JsonKnoten::FELD;
+  return JsonArray(speicher, knoten);
+}
+
+JsonObject JsonVariant::createNestedObject() {
+  JsonVariant element = add();
+  return element.knotenHolen() ? element.to_object() : JsonObject();
+}
+
+JsonObject JsonVariant::createNestedObject(const char* name) {
+  if (!anlegen()) return JsonObject();
+  if (knoten->typ == JsonKnoten::NUL) knoten->typ = JsonKnoten::OBJEKT;
+  return (*this)[name].to_object();
+}
+
+JsonArray JsonVariant::createNestedArray() {
+  JsonVariant element = add();
+  return element.knotenHolen() ? element.to_array() : JsonArray();
+}
+
+JsonArray JsonVariant::createNestedArray(const char* name) {
+  if (!anlegen()) return JsonArray();
+  if (knoten->typ == JsonKnoten::NUL) knoten->typ = JsonKnoten::OBJEKT;
+  return (*this)[name].to_array();
+}
+
+const char* DeserializationError::c_str() const {
+  switch (_code) {
+    case Ok:              return "Ok";
+    case EmptyInput:      return "EmptyInput";
+    case IncompleteInput: return "IncompleteInput";
+    case InvalidInput:    return "InvalidInput";
+    case NoMemory:        return "NoMemory";
+    case TooDeep:         return "TooDeep";
+  }
+  return "???";
+}
+
+// ---------------------------------------------------------------- Parser
+
+namespace {
+
+// Filter wie in ArduinoJson 6: true lässt alles durch, ein Objekt wählt Member aus,
+// ein Feld gibt mit seinem ersten Element den Filter für alle Elemente vor.
+// Ohne Erlaubnis wird der Wert trotzdem vollständig geprüft, aber nicht gespeichert.
+bool filterErlaubt(const JsonKnoten* f) { return f && f->typ != JsonKnoten::NUL; }
+bool filterWert(const JsonKnoten* f) { return f && f->typ == JsonKnoten::BOOL && f->wert.b; }
+bool filterObjekt(const JsonKnoten* f) { return filterWert(f) || (f && f->typ == JsonKnoten::OBJEKT); }
+bool filterFeld(const JsonKnoten* f) { return filterWert(f) || (f && f->typ == JsonKnoten::FELD); }
+const JsonKnoten* filterMember(const JsonKnoten* f, const char* name) { return filterWert(f) ? f : f->member(name); }
+const JsonKnoten* filterElement(const JsonKnoten* f) { return filterWert(f) ? f : f->element(0); }
+
+class Parser {
+public:
+  Parser(JsonLeser& leser, JsonSpeicher& speicher) : leser(leser), speicher(speicher) {}
+
+  DeserializationError::Code wert(JsonKnoten* ziel, const JsonKnoten* filter, uint8_t tiefe) {
+    DeserializationError::Code fehler = leerzeichenUeberspringen();
+    if (fehler) return fehler;
+    switch (aktuell()) {
+      case '{':
+        if (tiefe == 0) return DeserializationError::TooDeep;
+        return objekt(filterObjekt(filter) ? ziel : NULL, filter, tiefe - 1);
+      case '[':
+        if (tiefe == 0) return DeserializationError::TooDeep;
+        return feld(filterFeld(filter) ? ziel : NULL, filter, tiefe - 1);
+      case '"':
+      case '\'':
+        return textWert(filterWert(filter) ? ziel : NULL);
+      default:
+        return einfacherWert(filterWert(filter) ? ziel : NULL);
+    }
+  }
+
+  DeserializationError::Code leerzeichenUeberspringen() {
+    for (;;) {
+      int c = aktuell();
+      if (c < 0) return DeserializationError::IncompleteInput;
+      if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        weiter();
+      } else if (c == '/') {
+        // Kommentare wie im Original erlaubt
+        weiter();
+        int art = aktuell();
+        if (art == '/') {
+          while (aktuell() >= 0 && aktuell() != '\n') weiter();
+        } else if (art == '*') {
+          weiter();
+          int vorher = 0;
+          for (;;) {
+            int z = aktuell();
+            if (z < 0) return DeserializationError::IncompleteInput;
+            weiter();
+            if (vorher == '*' && z == '/') break;
+            vorher = z;
+          }
+        } else {
+          return art < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+        }
+      } else {
+        return DeserializationError::Ok;
+      }
+    }
+  }
+
+  int aktuell() {
+    if (!gelesen) {
+      zeichen = leser.lesen();
+      gelesen = true;
+    }
+    return zeichen;
+  }
+  void weiter() { gelesen = false; }
+  bool amEnde() { return aktuell() < 0; }
+
+private:
+  JsonLeser& leser;
+  JsonSpeicher& speicher;
+  int zeichen = -1;
+  bool gelesen = false;
+  std::string puffer;
+
+  DeserializationError::Code objekt(JsonKnoten* ziel, const JsonKnoten* filter, uint8_t tiefe) {
+    weiter();  // '{'
+    if (ziel) ziel->typ = JsonKnoten::OBJEKT;
+    DeserializationError::Code fehler = leerzeichenUeberspringen();
+    if (fehler) return fehler;
+    if (aktuell() == '}') {
+      weiter();
+      return DeserializationError::Ok;
+    }
+    for (;;) {
+      if (aktuell() != '"' && aktuell() != '\'') return DeserializationError::InvalidInput;
+      fehler = textLesen();
+      if (fehler) return fehler;
+      fehler = leerzeichenUeberspringen();
+      if (fehler) return fehler;
+      if (aktuell() != ':') return DeserializationError::InvalidInput;
+      weiter();
+
+      JsonKnoten* member = NULL;
+      const JsonKnoten* memberFilter = ziel ? filterMember(filter, puffer.c_str()) : NULL;
+      if (ziel && filterErlaubt(memberFilter)) {
+        // doppelte Schlüssel überschreiben den ersten Wert
+        member = const_cast<JsonKnoten*>(ziel->member(puffer.c_str()));
+        if (member) {
+          member->leeren();
+        } else {
+          const char* schluessel = speicher.textKopieren(puffer.data(), puffer.size());
+          if (!schluessel) return DeserializationError::NoMemory;
+          member = speicher.knotenHolen();
+          if (!member) return DeserializationError::NoMemory;
+          member->schluessel = schluessel;
+          kindAnhaengen(ziel, member);
+        }
+      }
+      fehler = wert(member, memberFilter, tiefe);
+      if (fehler) return fehler;
+
+      fehler = leerzeichenUeberspringen();
+      if (fehler) return fehler;
+      if (aktuell() == '}') {
+        weiter();
+        return DeserializationError::Ok;
+      }
+      if (aktuell() != ',') return DeserializationError::InvalidInput;
+      weiter();
+      fehler = leerzeichenUeberspringen();
+      if (fehler) return fehler;
+    }
+  }
+
+  DeserializationError::Code feld(JsonKnoten* ziel, const JsonKnoten* filter, uint8_t tiefe) {
+    weiter();  // '['
+    if (ziel) ziel->typ = JsonKnoten::FELD;
+    const JsonKnoten* elementFilter = ziel ? filterElement(filter) : NULL;
+    DeserializationError::Code fehler = leerzeichenUeberspringen();
+    if (fehler) return fehler;
+    if (aktuell() == ']') {
+      weiter();
+      return DeserializationError::Ok;
+    }
+    for (;;) {
+      JsonKnoten* element = NULL;
+      if (ziel && filterErlaubt(elementFilter)) {
+        element = speicher.knotenHolen();
+        if (!element) return DeserializationError::NoMemory;
+        kindAnhaengen(ziel, element);
+      }
+      fehler = wert(element, elementFilter, tiefe);
+      if (fehler) return fehler;
+      fehler = leerzeichenUeberspringen();
+      if (fehler) return fehler;
+      if (aktuell() == ']') {
+        weiter();
+        return DeserializationError::Ok;
+      }
+      if (aktuell() != ',') return DeserializationError::InvalidInput;
+      weiter();
+    }
+  }
+
+  DeserializationError::Code textWert(JsonKnoten* ziel) {
+    DeserializationError::Code fehler = textLesen();
+    if (fehler || !ziel) return fehler;
+    const char* text = speicher.textKopieren(puffer.data(), puffer.size());
+    if (!text) return DeserializationError::NoMemory;
+    ziel->typ = JsonKnoten::TEXT;
+    ziel->wert.s = text;
+    return DeserializationError::Ok;
+  }
+
+  static int hexWert(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  void utf8Anhaengen(uint32_t codepunkt) {
+    if (codepunkt < 0x80) {
+      puffer += (char)codepunkt;
+    } else if (codepunkt < 0x800) {
+      puffer += (char)(0xC0 | (codepunkt >> 6));
+      puffer += (char)(0x80 | (codepunkt & 0x3F));
+    } else if (codepunkt < 0x10000) {
+      puffer += (char)(0xE0 | (codepunkt >> 12));
+      puffer += (char)(0x80 | ((codepunkt >> 6) & 0x3F));
+      puffer += (char)(0x80 | (codepunkt & 0x3F));
+    } else {
+      puffer += (char)(0xF0 | (codepunkt >> 18));
+      puffer += (char)(0x80 | ((codepunkt >> 12) & 0x3F));
+      puffer += (char)(0x80 | ((codepunkt >> 6) & 0x3F));
+      puffer += (char)(0x80 | (codepunkt & 0x3F));
+    }
+  }
+
+  DeserializationError::Code hexLesen(uint32_t& wert) {
+    wert = 0;
+    for (int k = 0; k < 4; k++) {
+      int c = aktuell();
+      if (c < 0) return DeserializationError::IncompleteInput;
+      int h = hexWert(c);
+      if (h < 0) return DeserializationError::InvalidInput;
+      wert = (wert << 4) | h;
+      weiter();
+    }
+    return DeserializationError::Ok;
+  }
+
+  DeserializationError::Code textLesen() {
+    int ende = aktuell();
+    weiter();
+    puffer.clear();
+    for (;;) {
+      int c = aktuell();
+      if (c < 0) return DeserializationError::IncompleteInput;
+      weiter();
+      if (c == ende) return DeserializationError::Ok;
+      if (c != '\\') {
+        puffer += (char)c;
+        continue;
+      }
+      c = aktuell();
+      if (c < 0) return DeserializationError::IncompleteInput;
+      weiter();
+      switch (c) {
+        case '"':  puffer += '"';  break;
+        case '\'': puffer += '\''; break;
+        case '\\': puffer += '\\'; break;
+        case '/':  puffer += '/';  break;
+        case 'b':  puffer += '\b'; break;
+        case 'f':  puffer += '\f'; break;
+        case 'n':  puffer += '\n'; break;
+        case 'r':  puffer += '\r'; break;
+        case 't':  puffer += '\t'; break;
+        case 'u': {
+          uint32_t codepunkt;
+          DeserializationError::Code fehler = hexLesen(codepunkt);
+          if (fehler) return fehler;
+          if (codepunkt >= 0xD800 && codepunkt < 0xDC00) {
+            // Ersatzpaar
+            if (aktuell() != '\\') return amEnde() ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+            weiter();
+            if (aktuell() != 'u') return amEnde() ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+            weiter();
+            uint32_t tief;
+            fehler = hexLesen(tief);
+            if (fehler) return fehler;
+            if (tief < 0xDC00 || tief > 0xDFFF) return DeserializationError::InvalidInput;
+            codepunkt = 0x10000 + ((codepunkt - 0xD800) << 10) + (tief - 0xDC00);
+          }
+          utf8Anhaengen(codepunkt);
+          break;
+        }
+        default:
+          return DeserializationError::InvalidInput;
+      }
+    }
+  }
+
+  DeserializationError::Code einfacherWert(JsonKnoten* ziel) {
+    puffer.clear();
+    for (;;) {
+      int c = aktuell();
+      if (c < 0 || !(isalnum(c) || c == '+' || c == '-' || c == '.' || c == '_')) break;
+      puffer += (char)c;
+      weiter();
+      if (puffer.size() > 63) return DeserializationError::InvalidInput;
+    }
+    if (puffer.empty()) return amEnde() ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+
+    JsonKnoten wert;
+    if (puffer == "true" || puffer == "false") {
+      wert.typ = JsonKnoten::BOOL;
+      wert.wert.b = puffer == "true";
+    } else if (puffer == "null") {
+      wert.typ = JsonKnoten::NUL;
+    } else {
+      const char* anfang = puffer.c_str();
+      char* ende = NULL;
+      bool gleitkomma = puffer.find_first_of(".eE") != std::string::npos;
+      if (!gleitkomma) {
+        errno = 0;
+        long long ganz = strtoll(anfang, &ende, 10);
+        if (*ende == '\0' && errno == 0) {
+          wert.typ = JsonKnoten::INT;
+          wert.wert.i = ganz;
+        } else if (*ende == '\0') {
+          gleitkomma = true;  // zu groß für eine Ganzzahl
+        } else {
+          return DeserializationError::InvalidInput;
+        }
+      }
+      if (gleitkomma) {
+        double d = strtod(anfang, &ende);
+        if (*ende != '\0' || !(isdigit((unsigned char)anfang[0]) || anfang[0] == '-')) return DeserializationError::InvalidInput;
+        wert.typ = JsonKnoten::FLOAT;
+        wert.wert.d = d;
+      }
+    }
+    if (ziel) {
+      ziel->typ = wert.typ;
+      ziel->wert = wert.wert;
+    }
+    return DeserializationError::Ok;
+  }
+};
+
+}  // namespace
+
+DeserializationError jsonLesen(JsonDocument& dokument, JsonLeser& leser, const JsonKnoten* filter, uint8_t tiefe) {
+  dokument.clear();
+  Parser parser(leser, dokument.speicherHolen());
+  DeserializationError::Code fehler = parser.leerzeichenUeberspringen();
+  if (fehler == DeserializationError::IncompleteInput) return DeserializationError::EmptyInput;
+  if (fehler) return fehler;
+  fehler = parser.wert(&dokument.wurzelHolen(), filter, tiefe);
+  return fehler;
+}
+
+// ---------------------------------------------------------------- Ausgabe
+
+static void ausgeben(const JsonKnoten* k, std::string& ziel) {
+  if (!k) {
+    ziel += "null";
+    return;
+  }
+  char zahl[32];
+  switch (k->typ) {
+    case JsonKnoten::NUL:
+      ziel += "null";
+      break;
+    case JsonKnoten::BOOL:
+      ziel += k->wert.b ? "true" : "false";
+      break;
+    case JsonKnoten::INT:
+      snprintf(zahl, sizeof(zahl), "%lld", k->wert.i);
+      ziel += zahl;
+      break;
+    case JsonKnoten::FLOAT:
+      snprintf(zahl, sizeof(zahl), "%.9g", k->wert.d);
+      ziel += zahl;
+      break;
+    case JsonKnoten::TEXT:
+      ziel += '"';
+      for (const char* p = k->wert.s; *p; p++) {
+        switch (*p) {
+          case '"':  ziel += "\\\""; break;
+          case '\\': ziel += "\\\\"; break;
+          case '\n': ziel += "\\n";  break;
+          case '\r': ziel += "\\r";  break;
+          case '\t': ziel += "\\t";  break;
+          default:   ziel += *p;
+        }
+      }
+      ziel += '"';
+      break;
+    case JsonKnoten::OBJEKT:
+      ziel += '{';
+      for (const JsonKnoten* m = k->erstes; m; m = m->naechstes) {
+        if (m != k->erstes) ziel += ',';
+        ziel += '"';
+        ziel += m->schluessel;
+        ziel += "\":";
+        ausgeben(m, ziel);
+      }
+      ziel += '}';
+      break;
+    case JsonKnoten::FELD:
+      ziel += '[';
+      for (const JsonKnoten* e = k->erstes; e; e = e->naechstes) {
+        if (e != k->erstes) ziel += ',';
+        ausgeben(e, ziel);
+      }
+      ziel += ']';
+      break;
+  }
+}
+
+size_t serializeJson(JsonVariantConst wert, char* puffer, size_t groesse) {
+  std::string text;
+  ausgeben(wert.knotenHolen(), text);
+  if (groesse == 0) return 0;
+  size_t n = min(text.size(), groesse - 1);
+  memcpy(puffer, text.data(), n);
+  puffer[n] = '\0';
+  return n;
+}
+
+size_t serializeJson(JsonVariantConst wert, String& ziel) {
+  std::string text;
+  ausgeben(wert.knotenHolen(), text);
+  ziel = String(text);
+  return text.size();
+}
+
+size_t serializeJson(const JsonDocument& dokument, String& ziel) {
+  return serializeJson(dokument.as<JsonVariantConst>(), ziel);
+}
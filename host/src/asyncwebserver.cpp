@@ -0,0 +1,467 @@
+// Host-Build: AsyncWebServer und AsyncEventSource auf nicht blockierenden Sockets.
+// Ein Thread (async_tcp) nimmt Verbindungen an, ruft Handler, Füller und onConnect auf und
+// schreibt nur so viel, wie der Socket gerade annimmt.
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include "Arduino.h"
+#include "ESPAsyncWebServer.h"
+
+static const size_t WEB_STUECK = 1460;  // eine TCP MSS, so viel holt der Server je Aufruf beim Füller ab
+
+// ---------------------------------------------------------------- Antwort und Anfrage
+
+size_t AsyncWebServerResponse::fuellen(uint8_t* puffer, size_t maxLaenge) {
+  size_t n;
+  if (fueller) {
+    n = fueller(puffer, maxLaenge, index);
+    if (n > maxLaenge) n = maxLaenge;
+    if (n > 0) stuecke++;
+  } else {
+    n = index < inhalt.length() ? min<size_t>(maxLaenge, inhalt.length() - index) : 0;
+    memcpy(puffer, inhalt.c_str() + index, n);
+  }
+  index += n;
+  return n;
+}
+
+String AsyncWebServerResponse::alles(size_t maxStueck) {
+  String text;
+  std::vector<uint8_t> puffer(maxStueck);
+  size_t n;
+  while ((n = fuellen(puffer.data(), maxStueck)) > 0) {
+    text.concat((const char*)puffer.data(), n);
+  }
+  return text;
+}
+
+static String urlDekodieren(const std::string& text) {
+  std::string ergebnis;
+  for (size_t k = 0; k < text.size(); k++) {
+    char c = text[k];
+    if (c == '+') {
+      ergebnis += ' ';
+    } else if (c == '%' && k + 2 < text.size() && isxdigit((unsigned char)text[k + 1]) && isxdigit((unsigned char)text[k + 2])) {
+      ergebnis += (char)strtol(text.substr(k + 1, 2).c_str(), NULL, 16);
+      k += 2;
+    } else {
+      ergebnis += c;
+    }
+  }
+  return String(ergebnis);
+}
+
+AsyncWebServerRequest::AsyncWebServerRequest(const char* url, WebRequestMethodComposite methode) : methode(methode) {
+  std::string text = url ? url : "/";
+  size_t frage = text.find('?');
+  pfad = urlDekodieren(text.substr(0, frage));
+  if (frage == std::string::npos) return;
+  std::string abfrage = text.substr(frage + 1);
+  size_t start = 0;
+  while (start <= abfrage.size()) {
+    size_t ende = abfrage.find('&', start);
+    if (ende == std::string::npos) ende = abfrage.size();
+    std::string teil = abfrage.substr(start, ende - start);
+    if (!teil.empty()) {
+      size_t gleich = teil.find('=');
+      parameter.emplace_back(urlDekodieren(teil.substr(0, gleich)),
+                             gleich == std::string::npos ? String() : urlDekodieren(teil.substr(gleich + 1)));
+    }
+    start = ende + 1;
+  }
+}
+
+bool AsyncWebServerRequest::hasParam(const char* name, bool post, bool datei) const {
+  return getParam(name, post, datei) != NULL;
+}
+
+const AsyncWebParameter* AsyncWebServerRequest::getParam(const char* name, bool post, bool datei) const {
+  if (post || datei) return NULL;
+  for (const AsyncWebParameter& p : parameter) {
+    if (p.name() == name) return &p;
+  }
+  return NULL;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* typ, const String& inhalt) {
+  angelegt.emplace_back(new AsyncWebServerResponse(code, typ, inhalt));
+  return angelegt.back().get();
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const char* typ, AwsResponseFiller fueller) {
+  angelegt.emplace_back(new AsyncWebServerResponse(typ, fueller));
+  return angelegt.back().get();
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* antwort) {
+  std::unique_ptr<AsyncWebServerResponse> besitz;
+  for (auto it = angelegt.begin(); it != angelegt.end(); ++it) {
+    if (it->get() == antwort) {
+      besitz = std::move(*it);
+      angelegt.erase(it);
+      break;
+    }
+  }
+  if (!besitz) besitz.reset(antwort);
+  if (gesendet) return;  // wie die Bibliothek: nur die erste Antwort zählt
+  gesendet = std::move(besitz);
+}
+
+void AsyncWebServerRequest::send(int code, const char* typ, const String& inhalt) {
+  send(beginResponse(code, typ, inhalt));
+}
+
+// ---------------------------------------------------------------- Server-Sent Events
+
+std::string AsyncEventSource::nachrichtBauen(const char* nachricht, const char* ereignis, uint32_t id, uint32_t neuVerbinden) {
+  std::string text;
+  if (neuVerbinden) text += "retry: " + std::to_string(neuVerbinden) + "\r\n";
+  if (id) text += "id: " + std::to_string(id) + "\r\n";
+  if (ereignis) text += std::string("event: ") + ereignis + "\r\n";
+  if (nachricht) {
+    // jede Zeile als eigenes data: Feld, eine leere Nachricht ergibt ein leeres data:
+    const char* p = nachricht;
+    do {
+      size_t laenge = strcspn(p, "\r\n");
+      text += "data: ";
+      text.append(p, laenge);
+      text += "\r\n";
+      p += laenge;
+      if (*p == '\r' && p[1] == '\n') p++;
+      if (*p) p++;
+    } while (*p);
+  }
+  text += "\r\n";
+  return text;
+}
+
+void AsyncEventSource::anhaengen(AsyncEventSourceClient* client, const std::string& text) {
+  if (client->geschlossen) return;
+  if (client->ausgang.size() + text.size() > MAX_WARTESCHLANGE) {
+    client->verworfen++;  // langsamer Client: wie die Bibliothek mit voller Warteschlange verwerfen
+    return;
+  }
+  client->ausgang += text;
+}
+
+void AsyncEventSource::send(const char* nachricht, const char* ereignis, uint32_t id, uint32_t neuVerbinden) {
+  std::string text = nachrichtBauen(nachricht, ereignis, id, neuVerbinden);
+  {
+    std::lock_guard<std::mutex> l(sperre);
+    for (auto& client : clients) anhaengen(client.get(), text);
+  }
+  if (server) server->wecken();
+}
+
+size_t AsyncEventSource::count() const {
+  std::lock_guard<std::mutex> l(sperre);
+  size_t anzahl = 0;
+  for (auto& client : clients) {
+    if (!client->geschlossen) anzahl++;
+  }
+  return anzahl;
+}
+
+void AsyncEventSourceClient::send(const char* nachricht, const char* ereignis, uint32_t id, uint32_t neuVerbinden) {
+  std::string text = AsyncEventSource::nachrichtBauen(nachricht, ereignis, id, neuVerbinden);
+  {
+    std::lock_guard<std::mutex> l(quelle->sperre);
+    quelle->anhaengen(this, text);
+  }
+  if (quelle->server) quelle->server->wecken();
+}
+
+void AsyncEventSourceClient::close() {
+  {
+    std::lock_guard<std::mutex> l(quelle->sperre);
+    geschlossen = true;
+  }
+  if (quelle->server) quelle->server->wecken();
+}
+
+// ---------------------------------------------------------------- Server
+
+struct AsyncWebServer::Verbindung {
+  int fd;
+  std::string eingang;
+  std::string ausgang;
+  std::unique_ptr<AsyncWebServerRequest> request;
+  AsyncWebServerResponse* antwort = NULL;   // gehört request
+  AsyncEventSourceClient* sse = NULL;       // gehört der Quelle
+  AsyncEventSource* quelle = NULL;
+  bool fertig = false;                      // nach dem Senden von ausgang schließen
+};
+
+AsyncWebServer::~AsyncWebServer() { end(); }
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite methode, ArRequestHandlerFunction funktion) {
+  handler.emplace_back(new AsyncCallbackWebHandler());
+  AsyncCallbackWebHandler& h = *handler.back();
+  h.uri = uri;
+  h.methode = methode;
+  h.funktion = funktion;
+  return h;
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* h) {
+  AsyncEventSource* quelle = dynamic_cast<AsyncEventSource*>(h);
+  if (quelle) {
+    quelle->server = this;
+    quellen.push_back(quelle);
+  }
+  return *h;
+}
+
+void AsyncWebServer::bearbeiten(AsyncWebServerRequest* request) {
+  for (auto& h : handler) {
+    const String& url = request->url();
+    bool passt = h->uri == url || (h->uri.length() > 0 && url.startsWith((h->uri + "/").c_str()) && h->uri != "/");
+    if (passt && (h->methode & request->method())) {
+      h->funktion(request);
+      return;
+    }
+  }
+  if (nichtGefunden) {
+    nichtGefunden(request);
+  } else {
+    request->send(404);
+  }
+}
+
+void AsyncWebServer::wecken() {
+  if (weckRohr[1] >= 0) {
+    char c = 1;
+    (void)!::write(weckRohr[1], &c, 1);
+  }
+}
+
+void AsyncWebServer::begin() {
+  if (laeuft) return;
+  const char* umgebung = getenv("SMARTWB_HTTP_PORT");
+  if (umgebung && *umgebung) port = atoi(umgebung);
+
+  lauscher = ::socket(AF_INET, SOCK_STREAM, 0);
+  int eins = 1;
+  setsockopt(lauscher, SOL_SOCKET, SO_REUSEADDR, &eins, sizeof(eins));
+  sockaddr_in adresse = {};
+  adresse.sin_family = AF_INET;
+  adresse.sin_port = htons(port);
+  adresse.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (::bind(lauscher, (sockaddr*)&adresse, sizeof(adresse)) != 0 || ::listen(lauscher, 16) != 0) {
+    fprintf(stderr, "AsyncWebServer: Port %u nicht verfügbar: %s\n", port, strerror(errno));
+    ::close(lauscher);
+    lauscher = -1;
+    return;
+  }
+  socklen_t laenge = sizeof(adresse);
+  getsockname(lauscher, (sockaddr*)&adresse, &laenge);
+  port = ntohs(adresse.sin_port);  // bei Port 0 der vom System vergebene
+  fcntl(lauscher, F_SETFL, fcntl(lauscher, F_GETFL, 0) | O_NONBLOCK);
+  if (::pipe(weckRohr) == 0) {
+    fcntl(weckRohr[0], F_SETFL, fcntl(weckRohr[0], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(weckRohr[1], F_SETFL, fcntl(weckRohr[1], F_GETFL, 0) | O_NONBLOCK);
+  }
+  laeuft = true;
+  std::thread([this] { netzSchleife(); }).detach();
+}
+
+void AsyncWebServer::end() {
+  if (!laeuft) return;
+  laeuft = false;
+  wecken();
+}
+
+static const char* statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+void AsyncWebServer::netzSchleife() {
+  std::list<std::unique_ptr<Verbindung>> verbindungen;
+  std::vector<pollfd> fds;
+  std::vector<uint8_t> stueck(WEB_STUECK);
+
+  auto schliessen = [&](Verbindung& v) {
+    if (v.sse) {
+      std::lock_guard<std::mutex> l(v.quelle->sperre);
+      for (auto it = v.quelle->clients.begin(); it != v.quelle->clients.end(); ++it) {
+        if (it->get() == v.sse) {
+          v.quelle->clients.erase(it);
+          break;
+        }
+      }
+      v.sse = NULL;
+    }
+    ::close(v.fd);
+    v.fd = -1;
+  };
+
+  auto anfrageBearbeiten = [&](Verbindung& v) {
+    size_t kopfEnde = v.eingang.find("\r\n\r\n");
+    std::string zeile = v.eingang.substr(0, v.eingang.find("\r\n"));
+    char methode[16] = "", ziel[1024] = "";
+    if (sscanf(zeile.c_str(), "%15s %1023s", methode, ziel) != 2) {
+      v.ausgang = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+      v.fertig = true;
+      return;
+    }
+    WebRequestMethodComposite m = HTTP_GET;
+    if (strcmp(methode, "POST") == 0) m = HTTP_POST;
+    else if (strcmp(methode, "PUT") == 0) m = HTTP_PUT;
+    else if (strcmp(methode, "DELETE") == 0) m = HTTP_DELETE;
+    else if (strcmp(methode, "HEAD") == 0) m = HTTP_HEAD;
+    else if (strcmp(methode, "OPTIONS") == 0) m = HTTP_OPTIONS;
+    else if (strcmp(methode, "PATCH") == 0) m = HTTP_PATCH;
+    v.eingang.erase(0, kopfEnde + 4);
+    v.request.reset(new AsyncWebServerRequest(ziel, m));
+
+    for (AsyncEventSource* quelle : quellen) {
+      if (quelle->url == v.request->url() && m == HTTP_GET) {
+        v.ausgang = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\nConnection: keep-alive\r\n\r\n";
+        v.quelle = quelle;
+        AsyncEventSourceClient* client = new AsyncEventSourceClient(quelle, v.fd);
+        {
+          std::lock_guard<std::mutex> l(quelle->sperre);
+          quelle->clients.emplace_back(client);
+        }
+        v.sse = client;
+        // wie die Bibliothek: der Client zählt schon in onConnect mit
+        if (quelle->beiVerbindung) quelle->beiVerbindung(client);
+        return;
+      }
+    }
+
+    bearbeiten(v.request.get());
+    v.antwort = v.request->antwort();
+    if (v.antwort == NULL) {
+      v.request->send(500, "text/plain", "keine Antwort");
+      v.antwort = v.request->antwort();
+    }
+    char kopf[256];
+    if (v.antwort->gestreamt()) {
+      snprintf(kopf, sizeof(kopf), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n",
+               v.antwort->code, statusText(v.antwort->code), v.antwort->typ.c_str());
+      v.ausgang = kopf;
+    } else {
+      snprintf(kopf, sizeof(kopf), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n\r\n",
+               v.antwort->code, statusText(v.antwort->code), v.antwort->typ.c_str(), v.antwort->inhalt.length());
+      v.ausgang = kopf;
+      if (m != HTTP_HEAD) v.ausgang.append(v.antwort->inhalt.c_str(), v.antwort->inhalt.length());
+      v.fertig = true;
+    }
+  };
+
+  while (laeuft) {
+    fds.clear();
+    fds.push_back({lauscher, POLLIN, 0});
+    fds.push_back({weckRohr[0], POLLIN, 0});
+    for (auto& v : verbindungen) {
+      short ereignisse = POLLIN;
+      bool schreiben = !v->ausgang.empty() || (v->antwort && v->antwort->gestreamt() && !v->fertig);
+      if (v->sse) {
+        std::lock_guard<std::mutex> l(v->quelle->sperre);
+        schreiben = schreiben || !v->sse->ausgang.empty() || v->sse->geschlossen;
+      }
+      if (schreiben) ereignisse |= POLLOUT;
+      fds.push_back({v->fd, ereignisse, 0});
+    }
+    ::poll(fds.data(), fds.size(), 100);
+    if (!laeuft) break;
+
+    if (fds[1].revents & POLLIN) {
+      char muell[64];
+      while (::read(weckRohr[0], muell, sizeof(muell)) > 0) {
+      }
+    }
+    if (fds[0].revents & POLLIN) {
+      int fd;
+      while ((fd = ::accept(lauscher, NULL, NULL)) >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int eins = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &eins, sizeof(eins));
+        Verbindung* v = new Verbindung();
+        v->fd = fd;
+        verbindungen.emplace_back(v);
+      }
+    }
+
+    size_t k = 2;
+    for (auto it = verbindungen.begin(); it != verbindungen.end(); ++k) {
+      Verbindung& v = **it;
+      short revents = k < fds.size() && fds[k].fd == v.fd ? fds[k].revents : 0;
+      bool weg = false;
+
+      if (revents & (POLLIN | POLLHUP | POLLERR)) {
+        char puffer[2048];
+        ssize_t n = ::recv(v.fd, puffer, sizeof(puffer), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+          weg = true;  // Gegenstelle hat geschlossen
+        } else if (n > 0 && !v.request) {
+          v.eingang.append(puffer, n);
+          if (v.eingang.find("\r\n\r\n") != std::string::npos) {
+            anfrageBearbeiten(v);
+          } else if (v.eingang.size() > 8192) {
+            weg = true;
+          }
+        }
+      }
+
+      if (!weg && (revents & POLLOUT)) {
+        // gestreamte Antwort: das nächste Stück erst holen, wenn das vorige raus ist
+        if (v.ausgang.empty() && v.antwort && v.antwort->gestreamt() && !v.fertig) {
+          size_t n = v.antwort->fuellen(stueck.data(), stueck.size() - 16);
+          char laenge[16];
+          snprintf(laenge, sizeof(laenge), "%zx\r\n", n);
+          v.ausgang += laenge;
+          v.ausgang.append((const char*)stueck.data(), n);
+          v.ausgang += "\r\n";
+          if (n == 0) v.fertig = true;  // "0\r\n\r\n"
+        }
+        if (v.sse) {
+          std::lock_guard<std::mutex> l(v.quelle->sperre);
+          if (v.sse->geschlossen && v.ausgang.empty() && v.sse->ausgang.empty()) {
+            v.fertig = true;
+          } else if (v.ausgang.size() < WEB_STUECK) {
+            v.ausgang += v.sse->ausgang;
+            v.sse->ausgang.clear();
+          }
+        }
+        if (!v.ausgang.empty()) {
+          ssize_t n = ::send(v.fd, v.ausgang.data(), v.ausgang.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+          if (n > 0) {
+            v.ausgang.erase(0, n);
+          } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            weg = true;
+          }
+        }
+        if (v.fertig && v.ausgang.empty()) weg = true;
+      }
+
+      if (weg) {
+        schliessen(v);
+        it = verbindungen.erase(it);  // gibt request und damit die Antwort frei
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  for (auto& v : verbindungen) schliessen(*v);
+  verbindungen.clear();
+  ::close(lauscher);
+  lauscher = -1;
+}
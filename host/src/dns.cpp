@@ -0,0 +1,108 @@
+// Host-Build: lwIP tcpip Thread und dns_gethostbyname() über getaddrinfo() in einem eigenen Thread
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <netdb.h>
+#include <string>
+#include <thread>
+#include "Arduino.h"
+#include "lwip/dns.h"
+#include "lwip/priv/tcpip_priv.h"
+
+static std::atomic<uint32_t> dnsVerzoegerungMs{0};
+static std::atomic<uint32_t> dnsAusserhalbTcpip{0};
+
+void hostDnsVerzoegerung(uint32_t ms) { dnsVerzoegerungMs = ms; }
+uint32_t hostDnsAusserhalbTcpip() { return dnsAusserhalbTcpip.load(); }
+
+// ---------------------------------------------------------------- tcpip Thread
+static thread_local bool imTcpipThread = false;
+
+class TcpipThread {
+public:
+  void ausfuehren(std::function<void()> auftrag) {
+    std::lock_guard<std::mutex> sperre(this->sperre);
+    if (!laeuft) {
+      laeuft = true;
+      std::thread([this] { schleife(); }).detach();  // lebt bis zum Prozessende wie der tcpip Task
+    }
+    auftraege.push_back(std::move(auftrag));
+    neu.notify_one();
+  }
+
+private:
+  void schleife() {
+    imTcpipThread = true;
+    for (;;) {
+      std::function<void()> auftrag;
+      {
+        std::unique_lock<std::mutex> sperre(this->sperre);
+        neu.wait(sperre, [this] { return !auftraege.empty(); });
+        auftrag = std::move(auftraege.front());
+        auftraege.pop_front();
+      }
+      auftrag();
+    }
+  }
+
+  std::mutex sperre;
+  std::condition_variable neu;
+  std::deque<std::function<void()>> auftraege;
+  bool laeuft = false;
+};
+
+static TcpipThread& tcpip() {
+  static TcpipThread* thread = new TcpipThread();  // nie abgebaut, detached Thread benutzt ihn
+  return *thread;
+}
+
+err_t tcpip_api_call(tcpip_api_call_fn funktion, struct tcpip_api_call_data* aufruf) {
+  std::mutex sperre;
+  std::condition_variable fertig;
+  bool erledigt = false;
+  err_t ergebnis = ERR_OK;
+  tcpip().ausfuehren([&] {
+    ergebnis = funktion(aufruf);
+    std::lock_guard<std::mutex> l(sperre);
+    erledigt = true;
+    fertig.notify_one();
+  });
+  std::unique_lock<std::mutex> l(sperre);
+  fertig.wait(l, [&] { return erledigt; });
+  return ergebnis;
+}
+
+// ---------------------------------------------------------------- DNS
+err_t dns_gethostbyname(const char* name, ip_addr_t* adresse, dns_found_callback gefunden, void* arg) {
+  if (!imTcpipThread) dnsAusserhalbTcpip++;
+  if (name == NULL || adresse == NULL || gefunden == NULL) return ERR_ARG;
+  // IP-Adressen löst lwIP sofort auf
+  in_addr direkt;
+  if (inet_pton(AF_INET, name, &direkt) == 1) {
+    adresse->type = IPADDR_TYPE_V4;
+    adresse->u_addr.ip4.addr = direkt.s_addr;
+    return ERR_OK;
+  }
+  std::string kopie(name);
+  uint32_t verzoegerung = dnsVerzoegerungMs;
+  std::thread([kopie, gefunden, arg, verzoegerung] {
+    if (verzoegerung > 0) delay(verzoegerung);
+    addrinfo hinweis = {};
+    hinweis.ai_family = AF_INET;
+    addrinfo* ergebnis = NULL;
+    ip_addr_t gefundeneAdresse = {};
+    bool ok = getaddrinfo(kopie.c_str(), NULL, &hinweis, &ergebnis) == 0 && ergebnis != NULL;
+    if (ok) {
+      gefundeneAdresse.type = IPADDR_TYPE_V4;
+      gefundeneAdresse.u_addr.ip4.addr = ((sockaddr_in*)ergebnis->ai_addr)->sin_addr.s_addr;
+    }
+    if (ergebnis) freeaddrinfo(ergebnis);
+    // wie lwIP: der Rückruf kommt im tcpip Thread
+    tcpip().ausfuehren([kopie, gefunden, arg, ok, gefundeneAdresse] {
+      gefunden(kopie.c_str(), ok ? &gefundeneAdresse : NULL, arg);
+    });
+  }).detach();
+  return ERR_INPROGRESS;
+}
@@ -0,0 +1,132 @@
+// Host-Build: esp_timer mit einem Thread, der die Rückrufe nacheinander ausführt. Zeit und
+// Fälligkeit kommen von der Uhr des Hosts (hostUhrUs()).
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Arduino.h"
+#include "esp_timer.h"
+#include "uhr.h"
+
+struct esp_timer {
+  esp_timer_create_args_t args;
+  bool aktiv = false;
+  int64_t faelligUs = 0;
+  uint64_t periodeUs = 0;  // 0 = einmalig
+};
+
+int64_t esp_timer_get_time(void) { return hostUhrUs(); }
+
+namespace {
+
+class TimerTask {
+public:
+  static TimerTask& instanz() {
+    static TimerTask* task = new TimerTask();  // lebt bis zum Prozessende, der Thread ebenso
+    return *task;
+  }
+
+  std::mutex sperre;
+  std::condition_variable cv;
+  std::vector<esp_timer*> timer;
+
+private:
+  TimerTask() {
+    std::thread([this] { schleife(); }).detach();
+  }
+
+  void schleife() {
+    std::unique_lock<std::mutex> l(sperre);
+    for (;;) {
+      esp_timer* naechster = NULL;
+      for (esp_timer* t : timer) {
+        if (t->aktiv && (naechster == NULL || t->faelligUs < naechster->faelligUs)) naechster = t;
+      }
+      if (naechster == NULL) {
+        cv.wait(l);
+        continue;
+      }
+      int64_t jetzt = esp_timer_get_time();
+      if (naechster->faelligUs > jetzt) {
+        HostUhrFrist frist(naechster->faelligUs, &cv);
+        cv.wait_for(l, std::chrono::microseconds(std::min(naechster->faelligUs - jetzt, HOST_UHR_SCHEIBE_US)));
+        continue;  // es kann sich inzwischen alles geändert haben
+      }
+      if (naechster->periodeUs > 0) {
+        naechster->faelligUs += naechster->periodeUs;
+        if (naechster->args.skip_unhandled_events && naechster->faelligUs < jetzt) {
+          naechster->faelligUs = jetzt + naechster->periodeUs;
+        }
+      } else {
+        naechster->aktiv = false;  // ein einmaliger Timer kann im Rückruf neu gestartet werden
+      }
+      esp_timer_cb_t rueckruf = naechster->args.callback;
+      void* arg = naechster->args.arg;
+      l.unlock();
+      rueckruf(arg);
+      l.lock();
+    }
+  }
+};
+
+}  // namespace
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  if (args == NULL || args->callback == NULL || handle == NULL) return ESP_ERR_INVALID_ARG;
+  TimerTask& task = TimerTask::instanz();
+  esp_timer* t = new esp_timer();
+  t->args = *args;
+  std::lock_guard<std::mutex> l(task.sperre);
+  task.timer.push_back(t);
+  *handle = t;
+  return ESP_OK;
+}
+
+static esp_err_t timerStarten(esp_timer_handle_t t, uint64_t us, uint64_t periodeUs) {
+  if (t == NULL) return ESP_ERR_INVALID_ARG;
+  TimerTask& task = TimerTask::instanz();
+  {
+    std::lock_guard<std::mutex> l(task.sperre);
+    if (t->aktiv) return ESP_ERR_INVALID_STATE;
+    t->aktiv = true;
+    t->faelligUs = esp_timer_get_time() + us;
+    t->periodeUs = periodeUs;
+  }
+  task.cv.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs) { return timerStarten(t, timeoutUs, 0); }
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodeUs) { return timerStarten(t, periodeUs, periodeUs); }
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+  if (t == NULL) return ESP_ERR_INVALID_ARG;
+  TimerTask& task = TimerTask::instanz();
+  std::lock_guard<std::mutex> l(task.sperre);
+  if (!t->aktiv) return ESP_ERR_INVALID_STATE;
+  t->aktiv = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t) {
+  if (t == NULL) return ESP_ERR_INVALID_ARG;
+  TimerTask& task = TimerTask::instanz();
+  std::lock_guard<std::mutex> l(task.sperre);
+  if (t->aktiv) return ESP_ERR_INVALID_STATE;
+  for (auto it = task.timer.begin(); it != task.timer.end(); ++it) {
+    if (*it == t) {
+      task.timer.erase(it);
+      break;
+    }
+  }
+  delete t;
+  return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t t) {
+  TimerTask& task = TimerTask::instanz();
+  std::lock_guard<std::mutex> l(task.sperre);
+  return t && t->aktiv;
+}
@@ -0,0 +1,213 @@
+// Host-Build: FreeRTOS Tasks, Notifications, Semaphoren, Queues und Event Groups auf std::thread
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Arduino.h"
+#include "uhr.h"
+
+// Wartet höchstens warten Ticks (1 ms der Uhr des Hosts) auf bedingung, portMAX_DELAY ohne Grenze
+template <typename Bedingung>
+static bool warten(std::condition_variable& cv, std::unique_lock<std::mutex>& sperre, TickType_t ticks, Bedingung bedingung) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(sperre, bedingung);
+    return true;
+  }
+  return hostUhrWarten(cv, sperre, hostUhrUs() + (int64_t)ticks * 1000, bedingung);
+}
+
+// ---------------------------------------------------------------- Tasks
+
+struct HostTask {
+  std::string name;
+  std::mutex sperre;
+  std::condition_variable cv;
+  uint32_t benachrichtigungen = 0;
+};
+
+static thread_local HostTask* aktuellerTask = NULL;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t funktion, const char* name, uint32_t stack, void* parameter,
+                                   UBaseType_t prio, TaskHandle_t* handle, BaseType_t core) {
+  HostTask* task = new HostTask();
+  task->name = name ? name : "";
+  // Das Handle steht vor dem ersten Schritt des Tasks, wie bei FreeRTOS mit höherer Priorität
+  if (handle) *handle = task;
+  std::thread([task, funktion, parameter] {
+    aktuellerTask = task;
+    funktion(parameter);
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t funktion, const char* name, uint32_t stack, void* parameter,
+                       UBaseType_t prio, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(funktion, name, stack, parameter, prio, handle, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  if (aktuellerTask == NULL) {
+    aktuellerTask = new HostTask();  // Hauptthread oder fremder Thread, lebt bis zum Prozessende
+    aktuellerTask->name = "main";
+  }
+  return aktuellerTask;
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return 4096; }
+
+uint32_t ulTaskNotifyTake(BaseType_t loeschen, TickType_t ticks) {
+  HostTask* task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> sperre(task->sperre);
+  warten(task->cv, sperre, ticks, [task] { return task->benachrichtigungen > 0; });
+  uint32_t wert = task->benachrichtigungen;
+  if (wert > 0) {
+    task->benachrichtigungen = loeschen ? 0 : wert - 1;
+  }
+  return wert;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (task == NULL) return pdFAIL;
+  {
+    std::lock_guard<std::mutex> sperre(task->sperre);
+    task->benachrichtigungen++;
+  }
+  task->cv.notify_all();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* hoeherePrioGeweckt) {
+  xTaskNotifyGive(task);
+  if (hoeherePrioGeweckt) *hoeherePrioGeweckt = pdFALSE;
+}
+
+// ---------------------------------------------------------------- Semaphoren
+
+struct HostSemaphore {
+  std::mutex sperre;
+  std::condition_variable cv;
+  UBaseType_t wert;
+  UBaseType_t maximum;
+};
+
+static SemaphoreHandle_t semaphoreAnlegen(UBaseType_t maximum, UBaseType_t start) {
+  HostSemaphore* s = new HostSemaphore();
+  s->maximum = maximum;
+  s->wert = start;
+  return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return semaphoreAnlegen(1, 0); }
+SemaphoreHandle_t xSemaphoreCreateMutex() { return semaphoreAnlegen(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maximum, UBaseType_t start) { return semaphoreAnlegen(maximum, start); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+  std::unique_lock<std::mutex> sperre(s->sperre);
+  if (!warten(s->cv, sperre, ticks, [s] { return s->wert > 0; })) return pdFALSE;
+  s->wert--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  {
+    std::lock_guard<std::mutex> sperre(s->sperre);
+    if (s->wert >= s->maximum) return pdFALSE;
+    s->wert++;
+  }
+  s->cv.notify_one();
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+
+// ---------------------------------------------------------------- Queues
+
+struct HostQueue {
+  std::mutex sperre;
+  std::condition_variable cv;
+  std::deque<std::vector<uint8_t>> elemente;
+  UBaseType_t laenge;
+  UBaseType_t groesse;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t laenge, UBaseType_t groesse) {
+  HostQueue* q = new HostQueue();
+  q->laenge = laenge;
+  q->groesse = groesse;
+  return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* element, TickType_t ticks) {
+  {
+    std::unique_lock<std::mutex> sperre(q->sperre);
+    if (!warten(q->cv, sperre, ticks, [q] { return q->elemente.size() < q->laenge; })) return errQUEUE_FULL;
+    const uint8_t* bytes = (const uint8_t*)element;
+    q->elemente.emplace_back(bytes, bytes + q->groesse);
+  }
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* element, TickType_t ticks) {
+  {
+    std::unique_lock<std::mutex> sperre(q->sperre);
+    if (!warten(q->cv, sperre, ticks, [q] { return !q->elemente.empty(); })) return pdFALSE;
+    memcpy(element, q->elemente.front().data(), q->groesse);
+    q->elemente.pop_front();
+  }
+  q->cv.notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> sperre(q->sperre);
+  return q->elemente.size();
+}
+
+// ---------------------------------------------------------------- Event Groups
+
+struct HostEventGroup {
+  std::mutex sperre;
+  std::condition_variable cv;
+  EventBits_t bits = 0;
+};
+
+EventGroupHandle_t xEventGroupCreate() { return new HostEventGroup(); }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits) {
+  EventBits_t ergebnis;
+  {
+    std::lock_guard<std::mutex> sperre(g->sperre);
+    g->bits |= bits;
+    ergebnis = g->bits;
+  }
+  g->cv.notify_all();
+  return ergebnis;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits) {
+  std::lock_guard<std::mutex> sperre(g->sperre);
+  EventBits_t vorher = g->bits;
+  g->bits &= ~bits;
+  return vorher;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t g) {
+  std::lock_guard<std::mutex> sperre(g->sperre);
+  return g->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t loeschen, BaseType_t alle, TickType_t ticks) {
+  std::unique_lock<std::mutex> sperre(g->sperre);
+  auto erfuellt = [g, bits, alle] { return alle ? (g->bits & bits) == bits : (g->bits & bits) != 0; };
+  bool ok = warten(g->cv, sperre, ticks, erfuellt);
+  EventBits_t ergebnis = g->bits;  // Stand vor dem Löschen, wie FreeRTOS
+  if (ok && loeschen) g->bits &= ~bits;
+  return ergebnis;
+}
@@ -0,0 +1,228 @@
+// Host-Build: FS, File und LittleFS über ein Verzeichnis des Hosts
+#include <cerrno>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "LittleFS.h"
+
+namespace fs {
+
+struct DateiZustand {
+  std::string pfad;      // im FS, mit führendem /
+  std::string hostPfad;
+  std::string name;      // letzter Teil von pfad
+  FILE* datei = NULL;
+  DIR* verzeichnis = NULL;
+
+  ~DateiZustand() {
+    if (datei) fclose(datei);
+    if (verzeichnis) closedir(verzeichnis);
+  }
+};
+
+static std::shared_ptr<DateiZustand> zustandAnlegen(const std::string& pfad, const std::string& hostPfad) {
+  auto zustand = std::make_shared<DateiZustand>();
+  zustand->pfad = pfad;
+  zustand->hostPfad = hostPfad;
+  size_t schraeg = pfad.find_last_of('/');
+  zustand->name = schraeg == std::string::npos ? pfad : pfad.substr(schraeg + 1);
+  return zustand;
+}
+
+size_t File::write(const uint8_t* puffer, size_t laenge) {
+  if (!zustand || !zustand->datei) return 0;
+  return fwrite(puffer, 1, laenge, zustand->datei);
+}
+
+int File::available() {
+  if (!zustand || !zustand->datei) return 0;
+  long position = ftell(zustand->datei);
+  return position < 0 ? 0 : (int)(size() - position);
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* puffer, size_t laenge) {
+  if (!zustand || !zustand->datei) return 0;
+  return fread(puffer, 1, laenge, zustand->datei);
+}
+
+int File::peek() {
+  if (!zustand || !zustand->datei) return -1;
+  int c = fgetc(zustand->datei);
+  if (c != EOF) ungetc(c, zustand->datei);
+  return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+  if (zustand && zustand->datei) fflush(zustand->datei);
+}
+
+bool File::seek(uint32_t position) {
+  if (!zustand || !zustand->datei) return false;
+  return fseek(zustand->datei, position, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  if (!zustand || !zustand->datei) return 0;
+  long position = ftell(zustand->datei);
+  return position < 0 ? 0 : position;
+}
+
+size_t File::size() const {
+  if (!zustand) return 0;
+  if (zustand->datei) fflush(zustand->datei);
+  struct stat info;
+  return stat(zustand->hostPfad.c_str(), &info) == 0 ? info.st_size : 0;
+}
+
+void File::close() {
+  if (zustand) {
+    if (zustand->datei) {
+      fclose(zustand->datei);
+      zustand->datei = NULL;
+    }
+    if (zustand->verzeichnis) {
+      closedir(zustand->verzeichnis);
+      zustand->verzeichnis = NULL;
+    }
+  }
+  zustand.reset();
+}
+
+const char* File::name() const { return zustand ? zustand->name.c_str() : ""; }
+
+const char* File::path() const { return zustand ? zustand->pfad.c_str() : ""; }
+
+bool File::isDirectory() const { return zustand && zustand->verzeichnis != NULL; }
+
+File File::openNextFile(const char* modus) {
+  if (!zustand || !zustand->verzeichnis) return File();
+  while (dirent* eintrag = readdir(zustand->verzeichnis)) {
+    if (strcmp(eintrag->d_name, ".") == 0 || strcmp(eintrag->d_name, "..") == 0) continue;
+    std::string pfad = zustand->pfad == "/" ? "/" + std::string(eintrag->d_name) : zustand->pfad + "/" + eintrag->d_name;
+    auto kind = zustandAnlegen(pfad, zustand->hostPfad + "/" + eintrag->d_name);
+    struct stat info;
+    if (stat(kind->hostPfad.c_str(), &info) != 0) continue;
+    if (S_ISDIR(info.st_mode)) {
+      kind->verzeichnis = opendir(kind->hostPfad.c_str());
+    } else {
+      kind->datei = fopen(kind->hostPfad.c_str(), "rb");
+    }
+    if (!kind->datei && !kind->verzeichnis) continue;
+    return File(kind);
+  }
+  return File();
+}
+
+std::string FS::hostPfad(const char* pfad) const {
+  std::string p = pfad ? pfad : "";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return basis + p;
+}
+
+File FS::open(const char* pfad, const char* modus, bool anlegen) {
+  if (basis.empty() || pfad == NULL) return File();
+  std::string p = pfad[0] == '/' ? pfad : "/" + std::string(pfad);
+  auto zustand = zustandAnlegen(p, hostPfad(pfad));
+  struct stat info;
+  bool vorhanden = stat(zustand->hostPfad.c_str(), &info) == 0;
+  if (vorhanden && S_ISDIR(info.st_mode)) {
+    zustand->verzeichnis = opendir(zustand->hostPfad.c_str());
+    return zustand->verzeichnis ? File(zustand) : File();
+  }
+  std::string m = modus ? modus : "r";
+  if (m[0] == 'r' && !vorhanden) return File();
+  std::string hostModus = m;
+  if (hostModus.find('b') == std::string::npos) hostModus += "b";
+  zustand->datei = fopen(zustand->hostPfad.c_str(), hostModus.c_str());
+  return zustand->datei ? File(zustand) : File();
+}
+
+bool FS::exists(const char* pfad) {
+  struct stat info;
+  return !basis.empty() && stat(hostPfad(pfad).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* pfad) { return !basis.empty() && ::unlink(hostPfad(pfad).c_str()) == 0; }
+
+bool FS::rename(const char* von, const char* nach) {
+  return !basis.empty() && ::rename(hostPfad(von).c_str(), hostPfad(nach).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* pfad) {
+  if (basis.empty()) return false;
+  return ::mkdir(hostPfad(pfad).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char* pfad) { return !basis.empty() && ::rmdir(hostPfad(pfad).c_str()) == 0; }
+
+bool LittleFSFS::begin(bool formatieren, const char* basisPfad, uint8_t maxDateien, const char* partition) {
+  if (!basis.empty()) return true;
+  const char* umgebung = getenv("SMARTWB_FS");
+  std::string verzeichnis;
+  if (umgebung && *umgebung) {
+    verzeichnis = umgebung;
+  } else {
+    char vorlage[] = "/tmp/smartwb_fs_XXXXXX";
+    if (mkdtemp(vorlage) == NULL) return false;
+    verzeichnis = vorlage;
+  }
+  struct stat info;
+  if (stat(verzeichnis.c_str(), &info) != 0) {
+    if (!formatieren || ::mkdir(verzeichnis.c_str(), 0755) != 0) return false;
+  } else if (!S_ISDIR(info.st_mode)) {
+    return false;
+  }
+  basis = verzeichnis;
+  return true;
+}
+
+static void leeren(const std::string& verzeichnis) {
+  DIR* d = opendir(verzeichnis.c_str());
+  if (!d) return;
+  while (dirent* eintrag = readdir(d)) {
+    if (strcmp(eintrag->d_name, ".") == 0 || strcmp(eintrag->d_name, "..") == 0) continue;
+    std::string pfad = verzeichnis + "/" + eintrag->d_name;
+    struct stat info;
+    if (stat(pfad.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+      leeren(pfad);
+      ::rmdir(pfad.c_str());
+    } else {
+      ::unlink(pfad.c_str());
+    }
+  }
+  closedir(d);
+}
+
+bool LittleFSFS::format() {
+  if (basis.empty()) return false;
+  leeren(basis);
+  return true;
+}
+
+static size_t belegt(const std::string& verzeichnis) {
+  size_t summe = 0;
+  DIR* d = opendir(verzeichnis.c_str());
+  if (!d) return 0;
+  while (dirent* eintrag = readdir(d)) {
+    if (strcmp(eintrag->d_name, ".") == 0 || strcmp(eintrag->d_name, "..") == 0) continue;
+    std::string pfad = verzeichnis + "/" + eintrag->d_name;
+    struct stat info;
+    if (stat(pfad.c_str(), &info) != 0) continue;
+    summe += S_ISDIR(info.st_mode) ? belegt(pfad) : (size_t)info.st_size;
+  }
+  closedir(d);
+  return summe;
+}
+
+size_t LittleFSFS::usedBytes() { return basis.empty() ? 0 : belegt(basis); }
+
+}  // namespace fs
+
+fs::LittleFSFS LittleFS;
@@ -0,0 +1,139 @@
+// Host-Build: Heap Trace. malloc und Co. werden hier definiert und gehen an die von glibc
+// weiter. Nicht Teil von arduino_host, nur Programme mit Heap Trace bekommen diese Datei.
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include "Arduino.h"
+#include "esp_heap_trace.h"
+
+extern "C" {
+void* __libc_malloc(size_t groesse);
+void* __libc_calloc(size_t anzahl, size_t groesse);
+void* __libc_realloc(void* zeiger, size_t groesse);
+void  __libc_free(void* zeiger);
+}
+
+static std::atomic<bool> traceLaeuft{false};
+static std::mutex traceSperre;
+static heap_trace_record_t* spuren = NULL;
+static heap_trace_summary_t stand = {};
+static thread_local bool imTrace = false;  // Anforderungen des Trace selbst nicht zählen
+
+static void angefordert(void* zeiger, size_t groesse) {
+  if (!traceLaeuft.load(std::memory_order_relaxed) || zeiger == NULL || imTrace) return;
+  imTrace = true;
+  {
+    std::lock_guard<std::mutex> sperre(traceSperre);
+    if (traceLaeuft) {
+      stand.total_allocations++;
+      if (stand.count < stand.capacity) {
+        heap_trace_record_t& spur = spuren[stand.count++];
+        spur.ccount = ESP.getCycleCount();
+        spur.address = zeiger;
+        spur.size = groesse;
+        spur.freed = false;
+        if (stand.count > stand.high_water_mark) stand.high_water_mark = stand.count;
+      } else {
+        stand.has_overflowed = 1;
+      }
+    }
+  }
+  imTrace = false;
+}
+
+static void freigegeben(void* zeiger) {
+  if (!traceLaeuft.load(std::memory_order_relaxed) || zeiger == NULL || imTrace) return;
+  imTrace = true;
+  {
+    std::lock_guard<std::mutex> sperre(traceSperre);
+    if (traceLaeuft) {
+      stand.total_frees++;
+      // HEAP_TRACE_LEAKS behält nur, was noch nicht freigegeben ist
+      for (size_t k = 0; k < stand.count; k++) {
+        if (spuren[k].address != zeiger || spuren[k].freed) continue;
+        if (stand.mode == HEAP_TRACE_LEAKS) {
+          spuren[k] = spuren[--stand.count];
+        } else {
+          spuren[k].freed = true;
+        }
+        break;
+      }
+    }
+  }
+  imTrace = false;
+}
+
+extern "C" {
+
+void* malloc(size_t groesse) {
+  void* zeiger = __libc_malloc(groesse);
+  angefordert(zeiger, groesse);
+  return zeiger;
+}
+
+void* calloc(size_t anzahl, size_t groesse) {
+  void* zeiger = __libc_calloc(anzahl, groesse);
+  angefordert(zeiger, anzahl * groesse);
+  return zeiger;
+}
+
+void* realloc(void* alt, size_t groesse) {
+  void* zeiger = __libc_realloc(alt, groesse);
+  if (zeiger != alt || groesse == 0) {
+    freigegeben(alt);
+    angefordert(zeiger, groesse);
+  }
+  return zeiger;
+}
+
+void free(void* zeiger) {
+  freigegeben(zeiger);
+  __libc_free(zeiger);
+}
+
+}  // extern "C"
+
+esp_err_t heap_trace_init_standalone(heap_trace_record_t* record_buffer, size_t num_records) {
+  if (traceLaeuft) return ESP_ERR_INVALID_STATE;
+  std::lock_guard<std::mutex> sperre(traceSperre);
+  spuren = record_buffer;
+  stand = {};
+  stand.capacity = record_buffer != NULL ? num_records : 0;
+  return ESP_OK;
+}
+
+esp_err_t heap_trace_start(heap_trace_mode_t mode) {
+  if (spuren == NULL) return ESP_ERR_INVALID_STATE;
+  std::lock_guard<std::mutex> sperre(traceSperre);
+  size_t capacity = stand.capacity;
+  stand = {};
+  stand.mode = mode;
+  stand.capacity = capacity;
+  memset(spuren, 0, capacity * sizeof(heap_trace_record_t));
+  traceLaeuft = true;
+  return ESP_OK;
+}
+
+esp_err_t heap_trace_stop(void) {
+  if (!traceLaeuft) return ESP_ERR_INVALID_STATE;
+  traceLaeuft = false;
+  return ESP_OK;
+}
+
+esp_err_t heap_trace_resume(void) {
+  if (spuren == NULL) return ESP_ERR_INVALID_STATE;
+  traceLaeuft = true;
+  return ESP_OK;
+}
+
+size_t heap_trace_get_count(void) {
+  std::lock_guard<std::mutex> sperre(traceSperre);
+  return stand.count;
+}
+
+esp_err_t heap_trace_summary(heap_trace_summary_t* summary) {
+  if (summary == NULL) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> sperre(traceSperre);
+  *summary = stand;
+  return ESP_OK;
+}
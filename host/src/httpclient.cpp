@@ -0,0 +1,187 @@
+// Host-Build: HTTPClient, nur GET, mit Keep-alive wie im Arduino ESP32 Core
+#include "Arduino.h"
+#include "HTTPClient.h"
+
+bool HTTPClient::begin(WiFiClient& client, const String& host, uint16_t port, const String& uri, bool https) {
+  if (https) return false;
+  this->client = &client;
+  this->host = host;
+  this->port = port;
+  this->uri = uri.length() > 0 ? uri : String("/");
+  code = 0;
+  groesse = -1;
+  chunked = false;
+  wiederverwendbar = false;
+  return true;
+}
+
+bool HTTPClient::verbinden() {
+  if (client == NULL) return false;
+  if (client->connected()) {
+    // Reste einer nicht ganz gelesenen Antwort verwerfen
+    while (client->available() > 0) client->read();
+    return true;
+  }
+  return client->connect(host.c_str(), port, verbindenZeitlimitMs);
+}
+
+int HTTPClient::GET() {
+  if (!verbinden()) return HTTPC_ERROR_CONNECTION_REFUSED;
+  String anfrage = "GET " + uri + " HTTP/1.1\r\nHost: " + host;
+  if (port != 80) anfrage += ":" + String((unsigned int)port);
+  anfrage += "\r\nUser-Agent: ESP32HTTPClient\r\n";
+  anfrage += reuse ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+  anfrage += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n\r\n";
+  if (client->write((const uint8_t*)anfrage.c_str(), anfrage.length()) != anfrage.length()) {
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  code = kopfLesen();
+  return code;
+}
+
+// Eine Zeile ohne \r\n. false bei Zeitlimit oder geschlossener Verbindung.
+bool HTTPClient::zeileLesen(String& zeile, unsigned long zeitlimitMs) {
+  zeile = String();
+  unsigned long start = millis();
+  for (;;) {
+    int c = client->read();
+    if (c < 0) {
+      if (!client->connected() && client->available() == 0) return false;
+      unsigned long vergangen = millis() - start;
+      if (vergangen >= zeitlimitMs) return false;
+      client->aufDatenWarten(zeitlimitMs - vergangen);  // Daten, Verbindungsende oder Zeitlimit
+      continue;
+    }
+    if (c == '\n') {
+      if (zeile.endsWith("\r")) zeile = zeile.substring(0, zeile.length() - 1);
+      return true;
+    }
+    zeile += (char)c;
+  }
+}
+
+int HTTPClient::kopfLesen() {
+  unsigned long start = millis();
+  // Auf den Anfang der Antwort wartet der Core höchstens tcpZeitlimitMs
+  while (client->available() == 0) {
+    if (!client->connected()) return HTTPC_ERROR_CONNECTION_LOST;
+    unsigned long vergangen = millis() - start;
+    if (vergangen >= tcpZeitlimitMs) return HTTPC_ERROR_READ_TIMEOUT;
+    client->aufDatenWarten(tcpZeitlimitMs - vergangen);
+  }
+  String zeile;
+  int statusCode = 0;
+  bool http10 = false;
+  for (;;) {
+    unsigned long vergangen = millis() - start;
+    if (vergangen >= tcpZeitlimitMs || !zeileLesen(zeile, tcpZeitlimitMs - vergangen)) {
+      return client->connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+    }
+    if (statusCode == 0) {
+      if (!zeile.startsWith("HTTP/1.")) return HTTPC_ERROR_NO_HTTP_SERVER;
+      http10 = zeile.startsWith("HTTP/1.0");
+      statusCode = zeile.substring(9, 12).toInt();
+      wiederverwendbar = !http10;
+      continue;
+    }
+    if (zeile.length() == 0) break;  // Ende des Kopfes
+    int doppelpunkt = zeile.indexOf(':');
+    if (doppelpunkt <= 0) continue;
+    String name = zeile.substring(0, doppelpunkt);
+    String wert = zeile.substring(doppelpunkt + 1);
+    name.toLowerCase();
+    wert.trim();
+    String wertKlein = wert;
+    wertKlein.toLowerCase();
+    if (name == "content-length") {
+      groesse = wert.toInt();
+    } else if (name == "transfer-encoding") {
+      chunked = wertKlein == "chunked";
+    } else if (name == "connection") {
+      if (wertKlein == "close") wiederverwendbar = false;
+      if (wertKlein == "keep-alive" && http10) wiederverwendbar = true;
+    }
+  }
+  if (chunked) groesse = -1;
+  if (groesse < 0 && !chunked) wiederverwendbar = false;  // Ende nur am Schließen erkennbar
+  return statusCode > 0 ? statusCode : HTTPC_ERROR_NO_HTTP_SERVER;
+}
+
+String HTTPClient::getString() {
+  String text;
+  if (client == NULL || code <= 0) return text;
+  char puffer[512];
+  if (chunked) {
+    String zeile;
+    for (;;) {
+      if (!zeileLesen(zeile, client->getTimeout())) {
+        wiederverwendbar = false;
+        break;
+      }
+      long laenge = strtol(zeile.c_str(), NULL, 16);
+      if (laenge <= 0) {
+        zeileLesen(zeile, client->getTimeout());  // Leerzeile nach dem letzten Chunk
+        break;
+      }
+      while (laenge > 0) {
+        size_t n = client->readBytes(puffer, min<long>(laenge, sizeof(puffer)));
+        if (n == 0) {
+          wiederverwendbar = false;
+          return text;
+        }
+        text.concat(puffer, n);
+        laenge -= n;
+      }
+      zeileLesen(zeile, client->getTimeout());  // \r\n nach den Daten
+    }
+  } else if (groesse >= 0) {
+    int rest = groesse;
+    while (rest > 0) {
+      size_t n = client->readBytes(puffer, min<int>(rest, sizeof(puffer)));
+      if (n == 0) {
+        wiederverwendbar = false;
+        break;
+      }
+      text.concat(puffer, n);
+      rest -= n;
+    }
+  } else {
+    // ohne Länge: bis die Gegenstelle schließt
+    for (;;) {
+      size_t n = client->readBytes(puffer, sizeof(puffer));
+      if (n == 0) break;
+      text.concat(puffer, n);
+    }
+  }
+  return text;
+}
+
+void HTTPClient::end() {
+  if (client == NULL) return;
+  if (client->connected()) {
+    while (client->available() > 0) client->read();  // was schon da ist, verwerfen
+    if (!(reuse && wiederverwendbar)) client->stop();
+  } else {
+    client->stop();
+  }
+  code = 0;
+  groesse = -1;
+  chunked = false;
+}
+
+String HTTPClient::errorToString(int fehler) {
+  switch (fehler) {
+    case HTTPC_ERROR_CONNECTION_REFUSED:  return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED:  return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED:       return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST:     return "connection lost";
+    case HTTPC_ERROR_NO_STREAM:           return "no stream";
+    case HTTPC_ERROR_NO_HTTP_SERVER:      return "no HTTP server";
+    case HTTPC_ERROR_TOO_LESS_RAM:        return "too less ram";
+    case HTTPC_ERROR_ENCODING:            return "Transfer-Encoding not supported";
+    case HTTPC_ERROR_STREAM_WRITE:        return "Stream write error";
+    case HTTPC_ERROR_READ_TIMEOUT:        return "read Timeout";
+    default:                              return String();
+  }
+}
@@ -0,0 +1,66 @@
+// Host-Build: Preferences (NVS) im Speicher des Prozesses
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Preferences.h"
+
+static std::mutex nvsSperre;
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+
+void hostNvsLeeren() {
+  std::lock_guard<std::mutex> sperre(nvsSperre);
+  nvs.clear();
+}
+
+bool Preferences::begin(const char* name, bool nurLesen, const char* partition) {
+  if (name == NULL || strlen(name) > 15) return false;  // NVS: höchstens 15 Zeichen
+  namensraum = name;
+  this->nurLesen = nurLesen;
+  return true;
+}
+
+bool Preferences::clear() {
+  if (namensraum.empty() || nurLesen) return false;
+  std::lock_guard<std::mutex> sperre(nvsSperre);
+  nvs[namensraum].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* schluessel) {
+  if (namensraum.empty() || nurLesen) return false;
+  std::lock_guard<std::mutex> sperre(nvsSperre);
+  return nvs[namensraum].erase(schluessel) > 0;
+}
+
+bool Preferences::isKey(const char* schluessel) {
+  if (namensraum.empty()) return false;
+  std::lock_guard<std::mutex> sperre(nvsSperre);
+  return nvs[namensraum].count(schluessel) > 0;
+}
+
+size_t Preferences::putBytes(const char* schluessel, const void* wert, size_t laenge) {
+  if (namensraum.empty() || nurLesen || schluessel == NULL || strlen(schluessel) > 15) return 0;
+  std::lock_guard<std::mutex> sperre(nvsSperre);
+  const uint8_t* bytes = (const uint8_t*)wert;
+  nvs[namensraum][schluessel].assign(bytes, bytes + laenge);
+  return laenge;
+}
+
+size_t Preferences::getBytes(const char* schluessel, void* puffer, size_t maxLaenge) {
+  if (namensraum.empty()) return 0;
+  std::lock_guard<std::mutex> sperre(nvsSperre);
+  auto& bereich = nvs[namensraum];
+  auto it = bereich.find(schluessel);
+  if (it == bereich.end() || it->second.size() > maxLaenge) return 0;  // wie NVS: zu kleiner Puffer liefert nichts
+  memcpy(puffer, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* schluessel) {
+  if (namensraum.empty()) return 0;
+  std::lock_guard<std::mutex> sperre(nvsSperre);
+  auto& bereich = nvs[namensraum];
+  auto it = bereich.find(schluessel);
+  return it == bereich.end() ? 0 : it->second.size();
+}
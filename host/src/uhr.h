@@ -0,0 +1,42 @@
+// Host-Build: Warten mit Frist auf der Uhr des Hosts (hostUhrUs()) für die Stand-ins in host/src.
+// Eine angemeldete Frist kennt hostUhrZurNaechstenFrist(), ihre Bedingungsvariable weckt
+// hostUhrVorstellen(). Gewartet wird in Scheiben: fällt das Wecken zwischen Prüfen und Warten,
+// merkt der Thread es spätestens nach HOST_UHR_SCHEIBE_US.
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include "Arduino.h"
+
+const int64_t HOST_UHR_SCHEIBE_US = 10000;
+
+// Die Fristen hängen ohne Heap in einer Liste (wie ein wartender Task auf dem Gerät), sonst
+// zählte der Heap Trace bei jedem Warten eines Threads mit
+class HostUhrFrist {
+public:
+  HostUhrFrist(int64_t bisUs, std::condition_variable* cv);  // cv darf NULL sein (z.B. poll())
+  ~HostUhrFrist();
+  HostUhrFrist(const HostUhrFrist&) = delete;
+  HostUhrFrist& operator=(const HostUhrFrist&) = delete;
+
+  // gehören der Sperre der Uhr in arduino.cpp
+  int64_t bisUs;
+  std::condition_variable* cv;
+  int64_t seitUs;               // Wanduhr beim Anmelden, für hostUhrZurNaechstenFrist()
+  HostUhrFrist* vorige = NULL;
+  HostUhrFrist* naechste = NULL;
+};
+
+// Wartet bis bedingung gilt oder hostUhrUs() bisUs erreicht, false bei Zeitlimit
+template <typename Bedingung>
+bool hostUhrWarten(std::condition_variable& cv, std::unique_lock<std::mutex>& sperre, int64_t bisUs, Bedingung bedingung) {
+  HostUhrFrist frist(bisUs, &cv);
+  for (;;) {
+    if (bedingung()) return true;
+    int64_t restUs = bisUs - hostUhrUs();
+    if (restUs <= 0) return false;
+    cv.wait_for(sperre, std::chrono::microseconds(std::min(restUs, HOST_UHR_SCHEIBE_US)));
+  }
+}
@@ -0,0 +1,139 @@
+// Host-Build: WiFiClient als TCP Socket des Hosts
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "WiFi.h"
+#include "uhr.h"
+
+WiFiClass WiFi;
+
+// poll() mit Frist auf der Uhr des Hosts, in Scheiben, damit eine gestellte Uhr sofort wirkt.
+// Liefert wie poll() die Anzahl bereiter Sockets, 0 bei Zeitlimit.
+static int pollBis(pollfd* p, int64_t bisUs) {
+  HostUhrFrist frist(bisUs, NULL);
+  for (;;) {
+    int64_t restUs = std::min(bisUs - hostUhrUs(), HOST_UHR_SCHEIBE_US);
+    int n = ::poll(p, 1, restUs > 0 ? (int)((restUs + 999) / 1000) : 0);
+    if (n != 0 || restUs <= 0) return n;
+  }
+}
+
+WiFiClient::Socket::~Socket() {
+  if (fd >= 0) ::close(fd);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t zeitlimitMs) {
+  stop();
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+  auto neu = std::make_shared<Socket>();
+  neu->fd = fd;
+
+  sockaddr_in adresse = {};
+  adresse.sin_family = AF_INET;
+  adresse.sin_port = htons(port);
+  adresse.sin_addr.s_addr = (uint32_t)ip;
+
+  // nicht blockierend verbinden, damit das Zeitlimit gilt (wie der Arduino Core mit select())
+  int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  int ergebnis = ::connect(fd, (sockaddr*)&adresse, sizeof(adresse));
+  if (ergebnis < 0 && errno != EINPROGRESS) return 0;
+  if (ergebnis < 0) {
+    pollfd p = {fd, POLLOUT, 0};
+    if (pollBis(&p, hostUhrUs() + (zeitlimitMs > 0 ? zeitlimitMs * 1000LL : 0)) <= 0) return 0;
+    int fehler = 0;
+    socklen_t laenge = sizeof(fehler);
+    getsockopt(fd, SOL_SOCKET, SO_ERROR, &fehler, &laenge);
+    if (fehler != 0) return 0;
+  }
+  fcntl(fd, F_SETFL, flags);
+  int eins = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &eins, sizeof(eins));
+  timeval senden = {5, 0};
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &senden, sizeof(senden));
+  socket = neu;
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t zeitlimitMs) {
+  IPAddress ip;
+  if (!ip.fromString(host)) {
+    addrinfo hinweis = {};
+    hinweis.ai_family = AF_INET;
+    addrinfo* ergebnis = NULL;
+    if (getaddrinfo(host, NULL, &hinweis, &ergebnis) != 0 || ergebnis == NULL) return 0;
+    ip = IPAddress((uint32_t)((sockaddr_in*)ergebnis->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(ergebnis);
+  }
+  return connect(ip, port, zeitlimitMs);
+}
+
+size_t WiFiClient::write(const uint8_t* puffer, size_t laenge) {
+  if (!socket) return 0;
+  size_t gesendet = 0;
+  while (gesendet < laenge) {
+    ssize_t n = ::send(socket->fd, puffer + gesendet, laenge - gesendet, MSG_NOSIGNAL);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      stop();
+      break;
+    }
+    gesendet += n;
+  }
+  return gesendet;
+}
+
+int WiFiClient::available() {
+  if (!socket) return 0;
+  int anzahl = 0;
+  if (ioctl(socket->fd, FIONREAD, &anzahl) < 0) return 0;
+  return anzahl;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* puffer, size_t laenge) {
+  if (!socket) return -1;
+  ssize_t n = ::recv(socket->fd, puffer, laenge, MSG_DONTWAIT);
+  return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+  if (!socket) return -1;
+  uint8_t c;
+  return ::recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+void WiFiClient::flush() {}
+
+void WiFiClient::stop() { socket.reset(); }
+
+uint8_t WiFiClient::connected() {
+  if (!socket) return 0;
+  uint8_t c;
+  ssize_t n = ::recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0) return 1;                                               // es liegen noch Daten an
+  if (n == 0) return 0;                                              // Gegenstelle hat geschlossen
+  return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 1 : 0;
+}
+
+bool WiFiClient::aufDatenWarten(unsigned long ms) {
+  if (!socket) return false;
+  pollfd p = {socket->fd, POLLIN, 0};
+  int n = pollBis(&p, hostUhrUs() + (int64_t)ms * 1000);
+  if (n <= 0) return false;  // Zeitlimit
+  uint8_t c;
+  // Bereit, aber nichts zu lesen: die Gegenstelle hat geschlossen
+  return ::recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) > 0;
+}
@@ -0,0 +1,4 @@
+// Host-Build: I2C Bus ohne Gerät
+#include "Wire.h"
+
+TwoWire Wire;
@@ -6,5 +6,9 @@
 #define WIFI_SSID "Your_SSID"
 #define WIFI_PASSWORD "Your_Wifi_Password"
 
+// MQTT-Zugangsdaten (nur mit USE_MQTT, leer lassen wenn der Broker keine Anmeldung verlangt)
+#define MQTT_USER ""
+#define MQTT_PASSWORD ""
+
 
 #endif // SECRETS_H
\ No newline at end of file
@@ -0,0 +1,88 @@
+// /api/benchmark: mit Heap Trace die malloc/free Spalten, ohne fehlen sie.
+// Wird zweimal gebaut, mit und ohne CONFIG_HEAP_TRACING_STANDALONE.
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+#include <functional>
+
+static String benchmarkAbrufen(const char* url) {
+  AsyncWebServerRequest request(url);
+  handleBenchmark(&request);
+  EXPECT_EQ(request.antwort()->code, 200);
+  return request.antwort()->alles();
+}
+
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+TEST(HeapTrace, ZaehltMallocUndFree) {
+  static heap_trace_record_t spuren[4];
+  ASSERT_EQ(heap_trace_init_standalone(spuren, 4), ESP_OK);
+  ASSERT_EQ(heap_trace_start(HEAP_TRACE_ALL), ESP_OK);
+  void* a = malloc(10);
+  int* b = new int[3];
+  a = realloc(a, 100000);
+  free(a);
+  delete[] b;
+  free(NULL);
+  ASSERT_EQ(heap_trace_stop(), ESP_OK);
+  free(malloc(1));  // nach stop() nicht mehr gezählt
+
+  heap_trace_summary_t spur;
+  ASSERT_EQ(heap_trace_summary(&spur), ESP_OK);
+  EXPECT_EQ(spur.total_allocations, 3u);  // malloc, new, realloc (verschoben)
+  EXPECT_EQ(spur.total_frees, 3u);        // realloc (verschoben), free, delete
+  EXPECT_EQ(spur.count, 3u);
+  EXPECT_EQ(spuren[0].size, 10u);
+  EXPECT_EQ(spuren[1].size, 3 * sizeof(int));
+  EXPECT_FALSE(spur.has_overflowed);
+}
+
+// Die Anforderungen je String wie im ESP32 Core, nicht wie bei std::string
+TEST(HeapTrace, StringWieImEsp32Core) {
+  static heap_trace_record_t spuren[8];
+  heap_trace_summary_t spur;
+  ASSERT_EQ(heap_trace_init_standalone(spuren, 8), ESP_OK);
+  auto zaehlen = [&](std::function<void()> ablauf) {
+    heap_trace_start(HEAP_TRACE_ALL);
+    ablauf();
+    heap_trace_stop();
+    heap_trace_summary(&spur);
+  };
+
+  zaehlen([] { String s("13 Zeichen ok"); });  // passt ins Objekt
+  EXPECT_EQ(spur.total_allocations, 0u);
+  zaehlen([] { String s("14 Zeichen mit"); });  // std::string hätte noch Platz
+  EXPECT_EQ(spur.total_allocations, 1u);
+  EXPECT_EQ(spuren[0].size, 16u);
+  zaehlen([] { String s(10.87f); });  // Zwischenpuffer von dtostrf()
+  EXPECT_EQ(spur.total_allocations, 1u);
+  EXPECT_EQ(spur.total_frees, 1u);
+  EXPECT_EQ(spuren[0].size, 44u);
+  zaehlen([] { String s = String("Max Cur: ") + String(16) + "A"; });  // die Summe wird weitergereicht
+  EXPECT_EQ(spur.total_allocations, 0u);
+}
+#endif
+
+TEST(Benchmark, AlleHeissenPfadeOhneHeap) {
+  led3.begin(LED3_PIN, LEDC_CHANNEL_2, LEDC_TIMER_2);  // led_modus wie nach setup()
+  led3.setMode(LEDMODE_FLASH);
+  String antwort = benchmarkAbrufen("/api/benchmark");
+  DynamicJsonDocument doc(4096);
+  ASSERT_EQ(deserializeJson(doc, antwort), DeserializationError::Ok) << antwort.c_str();
+  JsonArrayConst benchmarks = doc["benchmarks"];
+  ASSERT_EQ(benchmarks.size(), sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]));
+  for (size_t k = 0; k < benchmarks.size(); k++) {
+    JsonObjectConst b = benchmarks[k];
+    const char* name = b["name"];
+    SCOPED_TRACE(name);
+    EXPECT_GT(b["anzahl"].as<uint32_t>(), 0u);
+    EXPECT_TRUE(b["nsProAufruf"].is<uint32_t>());
+    EXPECT_TRUE(b["bloeckeDelta"].isNull());  // zählte nicht die Anforderungen, sondern nur was übrig blieb
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+    // Die heißen Pfade arbeiten mit festen Puffern, nach dem Aufwärmen kein malloc mehr
+    EXPECT_EQ(b["mallocProAufruf"].as<float>(), 0.0f);
+    EXPECT_EQ(b["freeProAufruf"].as<float>(), 0.0f);
+#else
+    EXPECT_TRUE(b["mallocProAufruf"].isNull());
+    EXPECT_TRUE(b["freeProAufruf"].isNull());
+#endif
+  }
+}
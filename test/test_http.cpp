@@ -0,0 +1,148 @@
+// HttpVerbindung: Zeitbudget gegen einen Stand-in, der hängt (DNS, Antwortkopf, Inhalt).
+// Die Budgets laufen im Zeitraffer ab (test_uhr.h), gemessen wird auf der Uhr des Hosts.
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+#include "test_server.h"
+#include "test_uhr.h"
+
+static const uint32_t BUDGET_MS = 500;
+static const int64_t  SPIELRAUM_US = 5000;  // die Uhr steht, nur Rundung auf ms
+
+static int64_t vergangenUs(int64_t startUs) { return esp_timer_get_time() - startUs; }
+
+TEST(HttpBudget, ServerAntwortetNie) {
+  TestServer server([](const std::string&) { return TestAntwort::stumm(); });
+  HttpVerbindung verbindung("Test");
+  int code = 0;
+  int64_t dauer = 0;
+  imZeitraffer([&] {
+    int64_t start = esp_timer_get_time();
+    code = verbindung.get(server.url("/").c_str(), BUDGET_MS);
+    verbindung.beenden();
+    dauer = vergangenUs(start);
+  });
+
+  EXPECT_EQ(code, HTTPC_ERROR_READ_TIMEOUT);
+  EXPECT_GE(dauer, BUDGET_MS * 1000LL - SPIELRAUM_US);
+  EXPECT_LE(dauer, BUDGET_MS * 1000LL + SPIELRAUM_US);
+  EXPECT_EQ(verbindung.abgebrochen, 1u);  // einmal, nicht noch einmal in beenden()
+  EXPECT_EQ(verbindung.neu, 1u);          // keine Wiederholung, das Budget ist aufgebraucht
+}
+
+TEST(HttpBudget, InhaltBleibtStecken) {
+  // Kopf kommt, vom Inhalt nur der Anfang
+  std::string json = "{\"list\":[{\"maxCurrent\":16,\"actualPower\":1.5}]}";
+  TestServer server([&json](const std::string&) {
+    TestAntwort a = TestAntwort::json(json);
+    a.stillAb = a.text.size() - json.size() + 10;
+    return a;
+  });
+  HttpVerbindung verbindung("Test");
+  int code = 0;
+  DeserializationError fehler;
+  int64_t dauer = 0;
+  imZeitraffer([&] {
+    int64_t start = esp_timer_get_time();
+    code = verbindung.get(server.url("/").c_str(), BUDGET_MS);
+    if (code != HTTP_CODE_OK) return;
+    EXPECT_EQ(verbindung.abgebrochen, 0u);
+    StaticJsonDocument<384> doc;
+    fehler = deserializeJson(doc, verbindung.http().getStream());
+    verbindung.beenden();
+    dauer = vergangenUs(start);
+  });
+  ASSERT_EQ(code, HTTP_CODE_OK);
+
+  EXPECT_EQ(fehler, DeserializationError::IncompleteInput);
+  EXPECT_LE(dauer, BUDGET_MS * 1000LL + SPIELRAUM_US);
+  EXPECT_EQ(verbindung.abgebrochen, 1u);
+
+  // Die Verbindung mit dem Rest der Antwort wurde geschlossen, die nächste Anfrage baut neu auf
+  verbindung.get(server.url("/").c_str(), BUDGET_MS);
+  verbindung.beenden();
+  EXPECT_EQ(verbindung.neu, 2u);
+  EXPECT_EQ(verbindung.wiederverwendet, 0u);
+  EXPECT_EQ(server.angenommen.load(), 2);
+}
+
+TEST(HttpBudget, LangsamAberImBudget) {
+  TestServer server([](const std::string&) {
+    TestAntwort a = TestAntwort::json("{}");
+    a.verzoegerungMs = BUDGET_MS / 4;
+    return a;
+  });
+  HttpVerbindung verbindung("Test");
+  EXPECT_EQ(verbindung.get(server.url("/").c_str(), BUDGET_MS), HTTP_CODE_OK);
+  EXPECT_EQ(verbindung.http().getString(), "{}");
+  verbindung.beenden();
+  EXPECT_EQ(verbindung.abgebrochen, 0u);
+  EXPECT_EQ(verbindung.fehler, 0u);
+
+  // zweite Anfrage über dieselbe Verbindung
+  EXPECT_EQ(verbindung.get(server.url("/").c_str(), BUDGET_MS), HTTP_CODE_OK);
+  verbindung.beenden();
+  EXPECT_EQ(verbindung.wiederverwendet, 1u);
+  EXPECT_EQ(verbindung.abgebrochen, 0u);
+}
+
+TEST(HttpBudget, ZuKleinesBudgetWirdVerschoben) {
+  TestServer server([](const std::string&) { return TestAntwort::json("{}"); });
+  HttpVerbindung verbindung("Test");
+  EXPECT_EQ(verbindung.get(server.url("/").c_str(), HTTP_BUDGET_MIN_MS - 1), HTTP_VERSCHOBEN);
+  verbindung.beenden();
+  EXPECT_EQ(verbindung.verschoben, 1u);
+  EXPECT_EQ(verbindung.abgebrochen, 0u);
+  delay(50);
+  EXPECT_EQ(server.angenommen.load(), 0);  // nichts gesendet
+}
+
+TEST(HttpBudget, DnsHaengt) {
+  static HttpVerbindung verbindung("Test");  // die DNS Antwort kommt erst nach dem Test
+  hostDnsVerzoegerung(BUDGET_MS + 300);
+  int code = 0;
+  int64_t dauer = 0;
+  imZeitraffer([&] {
+    int64_t start = esp_timer_get_time();
+    code = verbindung.get("http://localhost:1/", BUDGET_MS);
+    verbindung.beenden();
+    dauer = vergangenUs(start);
+    delay(BUDGET_MS);  // verspätete DNS Antwort abwarten
+  });
+  hostDnsVerzoegerung(0);
+
+  EXPECT_LT(code, 0);
+  EXPECT_LE(dauer, BUDGET_MS * 1000LL + SPIELRAUM_US);
+  EXPECT_EQ(verbindung.dnsAnfragen, 1u);
+  EXPECT_EQ(verbindung.abgebrochen, 1u);
+  EXPECT_EQ(hostDnsAusserhalbTcpip(), 0u);
+}
+
+TEST(HttpBudget, DnsLaeuftImTcpipTask) {
+  TestServer server([](const std::string&) { return TestAntwort::json("{}"); });
+  HttpVerbindung verbindung("Test");
+  std::string url = "http://localhost:" + std::to_string(server.port) + "/";
+  EXPECT_EQ(verbindung.get(url.c_str(), BUDGET_MS), HTTP_CODE_OK);
+  verbindung.beenden();
+  EXPECT_EQ(verbindung.dnsAnfragen, 1u);
+  EXPECT_EQ(hostDnsAusserhalbTcpip(), 0u);  // auch ohne LWIP_TCPIP_CORE_LOCKING nur im tcpip Task
+}
+
+TEST(HttpBudget, SmartWBAbfrageBleibtImBudget) {
+  TestServer server([](const std::string&) { return TestAntwort::stumm(); });
+  std::string url = server.url("/getParameters");
+  WallboxKonfig konfig = {"Test", "", "", url.c_str()};
+  Wallbox wallbox;
+  wallbox.konfig = &konfig;
+  WallboxWerte werte;
+  int64_t dauer = 0;
+  imZeitraffer([&] {
+    int64_t start = esp_timer_get_time();
+    getSmartWBParameters(wallbox, werte);
+    dauer = vergangenUs(start);
+  });
+
+  EXPECT_LT(werte.httpCode, 0);
+  EXPECT_EQ(werte.maxCurrent, 0);
+  EXPECT_LE(dauer, HTTP_BUDGET_MS * 1000LL + SPIELRAUM_US);
+  EXPECT_EQ(wallbox.smartWB.abgebrochen, 1u);
+}
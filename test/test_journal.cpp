@@ -0,0 +1,227 @@
+// RCR Journal: Segmente, Index (auch neu aufgebaut) und /api/rcr
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <vector>
+
+static const uint32_t T0 = 1735689600;  // 01.01.2025 00:00:00 UTC
+
+class Journal : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_TRUE(LittleFS.begin(true));
+    LittleFS.format();
+    journalSegmente = 0;
+    journalBereit = false;
+  }
+
+  static void TearDownTestSuite() {
+    LittleFS.format();
+    ::rmdir(LittleFS.wurzel().c_str());
+  }
+
+  static JournalEintrag eintragZu(uint32_t zeit) {
+    JournalEintrag eintrag;
+    eintrag.zeit     = zeit;
+    eintrag.ms       = zeit % 1000;
+    eintrag.aktiv    = zeit % 2;
+    eintrag.httpCode = 200;
+    eintrag.latenzUs = 12345;
+    return eintrag;
+  }
+
+  // Segmentdatei direkt schreiben, ohne Index
+  static void segmentSchreiben(uint32_t nummer, uint32_t ersteZeit, uint16_t anzahl) {
+    char name[32];
+    journalDateiname(nummer, name, sizeof(name));
+    File datei = LittleFS.open(name, "w");
+    ASSERT_TRUE(datei);
+    for (uint16_t k = 0; k < anzahl; k++) {
+      JournalEintrag eintrag = eintragZu(ersteZeit + k);
+      datei.write((const uint8_t*)&eintrag, sizeof(eintrag));
+    }
+    datei.close();
+  }
+
+  static size_t dateiGroesse(const char* name) {
+    File datei = LittleFS.open(name, "r");
+    return datei ? datei.size() : 0;
+  }
+
+  static std::vector<std::string> rcrCsv(const char* url) {
+    AsyncWebServerRequest request(url);
+    handleRcrJournal(&request);
+    EXPECT_EQ(request.antwort()->code, 200);
+    std::istringstream text(request.antwort()->alles().c_str());
+    std::vector<std::string> zeilen;
+    std::string zeile;
+    std::getline(text, zeile);
+    EXPECT_EQ(zeile, "time,ms,rse_active,http_code,latency_ms");
+    while (std::getline(text, zeile)) {
+      zeilen.push_back(zeile);
+    }
+    return zeilen;
+  }
+};
+
+TEST_F(Journal, AnhaengenUndAeltestesSegmentLoeschen) {
+  journalStarten();
+  ASSERT_TRUE(journalBereit);
+  EXPECT_EQ(journalSegmente, 0);
+
+  const uint32_t anzahl = JOURNAL_SEGMENTE * JOURNAL_SEGMENT_EINTRAEGE + 10;
+  for (uint32_t k = 0; k < anzahl; k++) {
+    journalAnhaengen(eintragZu(T0 + k));
+  }
+  ASSERT_EQ(journalSegmente, JOURNAL_SEGMENTE);
+  EXPECT_EQ(journalIndex[0].nummer, 1u);
+  EXPECT_EQ(journalIndex[0].erste, T0 + JOURNAL_SEGMENT_EINTRAEGE);
+  EXPECT_EQ(journalIndex[JOURNAL_SEGMENTE - 1].nummer, (uint32_t)JOURNAL_SEGMENTE);
+  EXPECT_EQ(journalIndex[JOURNAL_SEGMENTE - 1].anzahl, 10);
+  EXPECT_EQ(journalIndex[JOURNAL_SEGMENTE - 1].letzte, T0 + anzahl - 1);
+  EXPECT_FALSE(LittleFS.exists("/rcr/00000000.bin"));
+  EXPECT_EQ(dateiGroesse("/rcr/00000001.bin"), JOURNAL_SEGMENT_EINTRAEGE * sizeof(JournalEintrag));
+  EXPECT_EQ(dateiGroesse(JOURNAL_INDEX), JOURNAL_SEGMENTE * sizeof(JournalSegment));
+}
+
+TEST_F(Journal, IndexWirdNachNeustartGeladen) {
+  journalStarten();
+  for (uint32_t k = 0; k < JOURNAL_SEGMENT_EINTRAEGE + 3; k++) {
+    journalAnhaengen(eintragZu(T0 + k));
+  }
+  JournalSegment vorher[JOURNAL_SEGMENTE];
+  memcpy(vorher, journalIndex, sizeof(vorher));
+
+  memset(journalIndex, 0, sizeof(journalIndex));
+  journalSegmente = 0;
+  journalStarten();
+  ASSERT_EQ(journalSegmente, 2);
+  EXPECT_EQ(memcmp(journalIndex, vorher, 2 * sizeof(JournalSegment)), 0);
+}
+
+TEST_F(Journal, AbgeschnittenerIndexWirdNeuAufgebaut) {
+  journalStarten();
+  for (uint32_t k = 0; k < 2 * JOURNAL_SEGMENT_EINTRAEGE + 5; k++) {
+    journalAnhaengen(eintragZu(T0 + k));
+  }
+  JournalSegment vorher[JOURNAL_SEGMENTE];
+  memcpy(vorher, journalIndex, sizeof(vorher));
+  uint8_t segmente = journalSegmente;
+
+  // Stromausfall beim Schreiben des Index
+  ASSERT_EQ(::truncate((LittleFS.wurzel() + JOURNAL_INDEX).c_str(), 3 * sizeof(JournalSegment) - 5), 0);
+  memset(journalIndex, 0, sizeof(journalIndex));
+  journalSegmente = 0;
+  journalStarten();
+  ASSERT_EQ(journalSegmente, segmente);
+  for (uint8_t k = 0; k < segmente; k++) {
+    EXPECT_EQ(journalIndex[k].nummer, vorher[k].nummer);
+    EXPECT_EQ(journalIndex[k].erste, vorher[k].erste);
+    EXPECT_EQ(journalIndex[k].letzte, vorher[k].letzte);
+    EXPECT_EQ(journalIndex[k].anzahl, vorher[k].anzahl);
+  }
+  EXPECT_EQ(dateiGroesse(JOURNAL_INDEX), segmente * sizeof(JournalSegment));
+}
+
+TEST_F(Journal, VeralteterIndexWirdNeuAufgebaut) {
+  journalStarten();
+  for (uint32_t k = 0; k < 20; k++) {
+    journalAnhaengen(eintragZu(T0 + k));
+  }
+  // Eintrag geschrieben, Index nicht mehr: die Dateigröße passt nicht zum Index
+  File datei = LittleFS.open("/rcr/00000000.bin", "a");
+  JournalEintrag eintrag = eintragZu(T0 + 20);
+  datei.write((const uint8_t*)&eintrag, sizeof(eintrag));
+  datei.close();
+
+  journalSegmente = 0;
+  journalStarten();
+  ASSERT_EQ(journalSegmente, 1);
+  EXPECT_EQ(journalIndex[0].anzahl, 21);
+  EXPECT_EQ(journalIndex[0].letzte, T0 + 20);
+}
+
+TEST_F(Journal, AufbauBehaeltDieNeuestenSegmente) {
+  // Mehr Segmente als JOURNAL_SEGMENTE, in zufälliger Reihenfolge angelegt
+  const uint32_t anzahl = JOURNAL_SEGMENTE + 5;
+  std::vector<uint32_t> nummern;
+  for (uint32_t n = 0; n < anzahl; n++) {
+    nummern.push_back(n);
+  }
+  std::shuffle(nummern.begin(), nummern.end(), std::mt19937(42));
+  LittleFS.mkdir(JOURNAL_VERZEICHNIS);
+  for (uint32_t n : nummern) {
+    segmentSchreiben(n, T0 + n * 100, 7);
+  }
+  File notiz = LittleFS.open("/rcr/notiz.txt", "w");  // fremde Datei wird ignoriert
+  notiz.print("x");
+  notiz.close();
+
+  journalStarten();
+  ASSERT_EQ(journalSegmente, JOURNAL_SEGMENTE);
+  for (uint8_t k = 0; k < JOURNAL_SEGMENTE; k++) {
+    uint32_t nummer = anzahl - JOURNAL_SEGMENTE + k;
+    EXPECT_EQ(journalIndex[k].nummer, nummer);
+    EXPECT_EQ(journalIndex[k].erste, T0 + nummer * 100);
+    EXPECT_EQ(journalIndex[k].letzte, T0 + nummer * 100 + 6);
+    EXPECT_EQ(journalIndex[k].anzahl, 7);
+  }
+  char name[32];
+  for (uint32_t n = 0; n < anzahl; n++) {
+    journalDateiname(n, name, sizeof(name));
+    EXPECT_EQ(LittleFS.exists(name), n >= anzahl - JOURNAL_SEGMENTE) << name;
+  }
+  EXPECT_TRUE(LittleFS.exists("/rcr/notiz.txt"));
+
+  // Danach geht es mit der nächsten Nummer weiter
+  journalAnhaengen(eintragZu(T0 + 10000));
+  EXPECT_EQ(journalIndex[JOURNAL_SEGMENTE - 1].nummer, anzahl - 1);
+  EXPECT_EQ(journalIndex[JOURNAL_SEGMENTE - 1].anzahl, 8);
+}
+
+TEST_F(Journal, SucheFindetErstenEintragAbZeit) {
+  LittleFS.mkdir(JOURNAL_VERZEICHNIS);
+  const uint32_t zeiten[] = {10, 20, 20, 20, 30, 40};
+  File datei = LittleFS.open("/rcr/00000000.bin", "w");
+  for (uint32_t zeit : zeiten) {
+    JournalEintrag eintrag = eintragZu(zeit);
+    datei.write((const uint8_t*)&eintrag, sizeof(eintrag));
+  }
+  datei.close();
+
+  datei = LittleFS.open("/rcr/00000000.bin", "r");
+  EXPECT_EQ(journalSuchen(datei, 6, 0), 0);
+  EXPECT_EQ(journalSuchen(datei, 6, 10), 0);
+  EXPECT_EQ(journalSuchen(datei, 6, 11), 1);
+  EXPECT_EQ(journalSuchen(datei, 6, 20), 1);
+  EXPECT_EQ(journalSuchen(datei, 6, 21), 4);
+  EXPECT_EQ(journalSuchen(datei, 6, 40), 5);
+  EXPECT_EQ(journalSuchen(datei, 6, 41), 6);
+  EXPECT_EQ(journalSuchen(datei, 0, 20), 0);
+  datei.close();
+}
+
+TEST_F(Journal, CsvNurImZeitraum) {
+  journalStarten();
+  const uint32_t anzahl = 3 * JOURNAL_SEGMENT_EINTRAEGE;
+  for (uint32_t k = 0; k < anzahl; k++) {
+    journalAnhaengen(eintragZu(T0 + 2 * k));
+  }
+  EXPECT_EQ(rcrCsv("/api/rcr").size(), anzahl);
+
+  // über eine Segmentgrenze, Grenzen liegen zwischen zwei Einträgen bzw. genau auf einem
+  char url[64];
+  snprintf(url, sizeof(url), "/api/rcr?from=%u&to=%u", T0 + 2 * 250 + 1, T0 + 2 * 300);
+  std::vector<std::string> zeilen = rcrCsv(url);
+  ASSERT_EQ(zeilen.size(), 50u);
+  JournalEintrag erster = eintragZu(T0 + 2 * 251);
+  char erwartet[64];
+  snprintf(erwartet, sizeof(erwartet), "%u,%u,%u,200,12.3", erster.zeit, erster.ms, erster.aktiv);
+  EXPECT_EQ(zeilen.front(), erwartet);
+  EXPECT_EQ(zeilen.back().substr(0, 10), std::to_string(T0 + 2 * 300));
+
+  snprintf(url, sizeof(url), "/api/rcr?from=%u", T0 + 2 * anzahl);
+  EXPECT_TRUE(rcrCsv(url).empty());
+}
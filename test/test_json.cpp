@@ -0,0 +1,203 @@
+// SmartWB /getParameters: JSON Filter, Speicherbedarf, fehlerhafte Antworten und die
+// Abfrage über HTTP (Content-Length und chunked)
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+#include "test_server.h"
+
+// Aufgezeichnete Antwort einer SmartWB
+static const char PARAMETER[] = R"({"type":"parameters","list":[{"vehicleState":3,"evseState":true,"maxCurrent":16,"actualCurrent":16,"actualPower":10.87,"duration":5421339,"alwaysActive":false,"lastActionUser":"GUI","lastActionUID":"GUI","energy":14.32,"mileage":95.2,"meterReading":4711.42,"currentP1":15.8,"currentP2":15.7,"currentP3":15.9,"voltageP1":229.6,"voltageP2":231.2,"voltageP3":230.4,"useMeter":true,"RFIDUID":"","lastUsedAt":"","rseActive":false,"rseValue":100}]})";
+
+static DeserializationError gefiltertLesen(JsonDocument& doc, const char* json) {
+  return deserializeJson(doc, json, DeserializationOption::Filter(getSmartWBFilter()));
+}
+
+static void erwarteParameter(const WallboxWerte& werte) {
+  EXPECT_EQ(werte.vehicleState, 3);
+  EXPECT_TRUE(werte.evseState);
+  EXPECT_EQ(werte.maxCurrent, 16);
+  EXPECT_EQ(werte.actualCurrent, 16);
+  EXPECT_FLOAT_EQ(werte.actualPower, 10.87f);
+  EXPECT_FLOAT_EQ(werte.currentP1, 15.8f);
+  EXPECT_FLOAT_EQ(werte.currentP2, 15.7f);
+  EXPECT_FLOAT_EQ(werte.currentP3, 15.9f);
+  EXPECT_FLOAT_EQ(werte.voltageP1, 229.6f);
+  EXPECT_FLOAT_EQ(werte.voltageP2, 231.2f);
+  EXPECT_FLOAT_EQ(werte.voltageP3, 230.4f);
+}
+
+TEST(SmartWBFilter, PasstInSeinDokument) {
+  const JsonDocument& filter = getSmartWBFilter();
+  EXPECT_FALSE(filter.overflowed());
+  EXPECT_LE(filter.memoryUsage(), 256u);
+  EXPECT_EQ(&getSmartWBFilter(), &filter);  // nur einmal aufgebaut
+  EXPECT_TRUE(filter["list"][0]["actualPower"].as<bool>());
+  EXPECT_TRUE(filter["list"][0]["voltageP3"].as<bool>());
+  EXPECT_TRUE(filter["list"][0]["energy"].isNull());
+  EXPECT_TRUE(filter["type"].isNull());
+}
+
+TEST(SmartWBFilter, NurDieAngezeigtenFelder) {
+  StaticJsonDocument<384> doc;
+  ASSERT_EQ(gefiltertLesen(doc, PARAMETER), DeserializationError::Ok);
+  EXPECT_FALSE(doc.overflowed());
+  EXPECT_TRUE(doc["type"].isNull());
+  EXPECT_EQ(doc["list"].size(), 1u);
+  EXPECT_EQ(doc["list"][0].size(), 11u);
+  EXPECT_TRUE(doc["list"][0]["energy"].isNull());
+  EXPECT_TRUE(doc["list"][0]["lastActionUser"].isNull());
+
+  WallboxWerte werte;
+  smartWBWerteLesen(doc["list"][0], werte);
+  erwarteParameter(werte);
+}
+
+TEST(SmartWBFilter, OhneFilterZuGross) {
+  // Darum der Filter: die ganze Antwort passt nicht in das Dokument von getSmartWBParameters()
+  StaticJsonDocument<384> doc;
+  EXPECT_EQ(deserializeJson(doc, PARAMETER), DeserializationError::NoMemory);
+}
+
+TEST(SmartWBFilter, GrosseUebersprungeneFelderKostenNichts) {
+  std::string json = PARAMETER;
+  std::string lang(4000, 'x');
+  std::string zahlen;
+  for (int k = 0; k < 500; k++) {
+    zahlen += std::to_string(k * 7) + ".5,";
+  }
+  json.insert(json.find("\"energy\""), "\"notiz\":\"" + lang + "\",\"feld\":[" + zahlen + "{\"a\":[1,2,3]}],");
+  StaticJsonDocument<384> doc;
+  ASSERT_EQ(gefiltertLesen(doc, json.c_str()), DeserializationError::Ok);
+  WallboxWerte werte;
+  smartWBWerteLesen(doc["list"][0], werte);
+  erwarteParameter(werte);
+}
+
+TEST(SmartWBFilter, FehlerhafteAntworten) {
+  StaticJsonDocument<384> doc;
+  EXPECT_EQ(gefiltertLesen(doc, ""), DeserializationError::EmptyInput);
+  EXPECT_EQ(gefiltertLesen(doc, "<html>502 Bad Gateway</html>"), DeserializationError::InvalidInput);
+  std::string abgeschnitten(PARAMETER, strlen(PARAMETER) / 2);
+  EXPECT_EQ(gefiltertLesen(doc, abgeschnitten.c_str()), DeserializationError::IncompleteInput);
+  // auch übersprungene Werte müssen gültiges JSON sein
+  EXPECT_EQ(gefiltertLesen(doc, R"({"type":parameters,"list":[]})"), DeserializationError::InvalidInput);
+  std::string tief = std::string(40, '[') + std::string(40, ']');
+  EXPECT_EQ(gefiltertLesen(doc, tief.c_str()), DeserializationError::TooDeep);
+}
+
+TEST(SmartWBFilter, FehlendeOderFalscheFelder) {
+  // Leere Liste oder Felder mit falschem Typ ergeben 0, nicht die alten Werte
+  StaticJsonDocument<384> doc;
+  WallboxWerte werte;
+  ASSERT_EQ(gefiltertLesen(doc, R"({"list":[]})"), DeserializationError::Ok);
+  smartWBWerteLesen(doc["list"][0], werte);
+  EXPECT_EQ(werte.maxCurrent, 0);
+  EXPECT_FLOAT_EQ(werte.actualPower, 0.0f);
+
+  ASSERT_EQ(gefiltertLesen(doc, R"({"list":[{"maxCurrent":"sechzehn","actualPower":null,"evseState":1}]})"), DeserializationError::Ok);
+  smartWBWerteLesen(doc["list"][0], werte);
+  EXPECT_EQ(werte.maxCurrent, 0);
+  EXPECT_FLOAT_EQ(werte.actualPower, 0.0f);
+  EXPECT_TRUE(werte.evseState);
+}
+
+// getSmartWBParameters() gegen einen Stand-in der SmartWB
+class SmartWBAbfrage : public ::testing::Test {
+protected:
+  void wallboxSetzen(const std::string& url) {
+    this->url = url;
+    konfig = {"Test", "", "", this->url.c_str()};
+    wallbox.konfig = &konfig;
+  }
+
+  std::string url;
+  WallboxKonfig konfig;
+  Wallbox wallbox;
+};
+
+TEST_F(SmartWBAbfrage, MitContentLength) {
+  TestServer server([](const std::string& anfrage) {
+    EXPECT_EQ(anfrage.rfind("GET /getParameters HTTP/1.1\r\n", 0), 0u);
+    return TestAntwort::json(PARAMETER);
+  });
+  wallboxSetzen(server.url("/getParameters"));
+  WallboxWerte werte;
+  getSmartWBParameters(wallbox, werte);
+  EXPECT_EQ(werte.httpCode, 200);
+  erwarteParameter(werte);
+
+  // zweite Abfrage über dieselbe Verbindung
+  WallboxWerte nochmal;
+  getSmartWBParameters(wallbox, nochmal);
+  EXPECT_EQ(nochmal.httpCode, 200);
+  erwarteParameter(nochmal);
+  EXPECT_EQ(server.angenommen.load(), 1);
+  EXPECT_EQ(wallbox.smartWB.neu, 1u);
+  EXPECT_EQ(wallbox.smartWB.wiederverwendet, 1u);
+}
+
+TEST_F(SmartWBAbfrage, Chunked) {
+  TestServer server([](const std::string&) { return TestAntwort::json(PARAMETER, true); });
+  wallboxSetzen(server.url("/getParameters"));
+  for (int k = 0; k < 2; k++) {
+    WallboxWerte werte;
+    getSmartWBParameters(wallbox, werte);
+    EXPECT_EQ(werte.httpCode, 200);
+    erwarteParameter(werte);
+  }
+  EXPECT_EQ(server.angenommen.load(), 1);
+}
+
+TEST_F(SmartWBAbfrage, FehlerhaftesJsonLaesstWerteStehen) {
+  TestServer server([](const std::string&) {
+    // mit Connection: close endet der Stream nach dem Körper, sonst wartet der Parser das Budget ab
+    TestAntwort a = TestAntwort::json("{\"list\":[{\"maxCurrent\":");
+    a.text.insert(a.text.find("\r\n") + 2, "Connection: close\r\n");
+    return a;
+  });
+  wallboxSetzen(server.url("/getParameters"));
+  WallboxWerte werte;
+  werte.maxCurrent = 13;
+  getSmartWBParameters(wallbox, werte);
+  EXPECT_EQ(werte.httpCode, 200);
+  EXPECT_EQ(werte.maxCurrent, 13);
+}
+
+TEST_F(SmartWBAbfrage, HttpFehler) {
+  TestServer server([](const std::string&) {
+    TestAntwort a;
+    a.text = "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 5\r\n\r\nkaputt";
+    return a;
+  });
+  wallboxSetzen(server.url("/getParameters"));
+  WallboxWerte werte;
+  werte.maxCurrent = 13;
+  getSmartWBParameters(wallbox, werte);
+  EXPECT_EQ(werte.httpCode, 500);
+  EXPECT_EQ(werte.maxCurrent, 13);
+}
+
+TEST_F(SmartWBAbfrage, NichtErreichbarSetztWerteAufNull) {
+  uint16_t port;
+  {
+    TestServer server([](const std::string&) { return TestAntwort(); });
+    port = server.port;
+  }  // Port ist jetzt frei, Verbindungen werden abgelehnt
+  wallboxSetzen("http://127.0.0.1:" + std::to_string(port) + "/getParameters");
+  WallboxWerte werte;
+  werte.maxCurrent = 13;
+  werte.actualPower = 5.0f;
+  getSmartWBParameters(wallbox, werte);
+  EXPECT_LT(werte.httpCode, 0);
+  EXPECT_EQ(werte.maxCurrent, 0);
+  EXPECT_FLOAT_EQ(werte.actualPower, 0.0f);
+}
+
+TEST_F(SmartWBAbfrage, OhneWlan) {
+  hostWlanSetzen(false);
+  wallboxSetzen("http://127.0.0.1:1/getParameters");
+  WallboxWerte werte;
+  getSmartWBParameters(wallbox, werte);
+  hostWlanSetzen(true);
+  EXPECT_EQ(werte.httpCode, -1);
+  EXPECT_EQ(wallbox.smartWB.neu, 0u);
+}
@@ -0,0 +1,162 @@
+// LedController: Betriebsarten im esp_timer Task und LEDC Fade-Modul. Wird zweimal gebaut,
+// für ESP-IDF 5 (ledc_fade_stop) und ESP-IDF 4 (ohne, Wechsel erst am Rampenende).
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+
+class Led : public ::testing::Test {
+protected:
+  void SetUp() override {
+    static int naechsterKanal = 0;
+    kanal = (ledc_channel_t)(naechsterKanal++ % LEDC_CHANNEL_MAX);
+    led.begin(LED1_PIN, kanal, LEDC_TIMER_0);
+  }
+
+  void TearDown() override {
+    // erst wenn der letzte Schritt gelaufen ist, darf led verschwinden
+    led.setMode(LEDMODE_OFF);
+    aufDutyWarten(0, 1000);
+    esp_timer_stop(led.zeitgeber);
+  }
+
+  LedcHostKanal kanalZustand() {
+    std::lock_guard<std::mutex> sperre(ledcHostSperre);
+    return ledcHostKanal(kanal);
+  }
+
+  uint32_t duty() { return ledc_get_duty(LEDC_HIGH_SPEED_MODE, kanal); }
+
+  // wartet bis der Tastgrad erreicht ist, liefert die Wartezeit in ms oder -1
+  int aufDutyWarten(uint32_t ziel, int maxMs) {
+    int64_t start = esp_timer_get_time();
+    while (duty() != ziel) {
+      if (esp_timer_get_time() - start > maxMs * 1000LL) return -1;
+      delay(1);
+    }
+    return (esp_timer_get_time() - start) / 1000;
+  }
+
+  LedController led;
+  ledc_channel_t kanal;
+};
+
+TEST_F(Led, StartIstAus) {
+  EXPECT_EQ(led.mode, LEDMODE_OFF);
+  EXPECT_EQ(kanalZustand().gpio, LED1_PIN);
+  EXPECT_EQ(duty(), 0u);
+  EXPECT_TRUE(ledcHostFadeInstalliert);
+}
+
+TEST_F(Led, EinUndAus) {
+  led.setMode(LEDMODE_ON);
+  EXPECT_GE(aufDutyWarten(255, 100), 0);
+  led.maxBrightness = 100;
+  uint32_t gesetzt = kanalZustand().dutyGesetzt;
+  led.setMode(LEDMODE_ON);  // gleiche Betriebsart: nichts zu tun
+  delay(10);
+  EXPECT_EQ(kanalZustand().dutyGesetzt, gesetzt);
+  EXPECT_EQ(duty(), 255u);
+  led.setMode(LEDMODE_OFF);
+  EXPECT_GE(aufDutyWarten(0, 100), 0);
+}
+
+TEST_F(Led, Blinken) {
+  led.blinkInterval = 20;
+  uint32_t gesetzt = kanalZustand().dutyGesetzt;
+  led.setMode(LEDMODE_BLINK);
+  EXPECT_GE(aufDutyWarten(255, 100), 0);
+  EXPECT_GE(aufDutyWarten(0, 100), 15);   // nach blinkInterval wieder aus
+  EXPECT_GE(aufDutyWarten(255, 100), 15);
+  delay(200);
+  // 10 Wechsel in 200 ms, großzügig wegen der Planung des Hosts
+  uint32_t wechsel = kanalZustand().dutyGesetzt - gesetzt;
+  EXPECT_GE(wechsel, 8u);
+  EXPECT_LE(wechsel, 16u);
+}
+
+TEST_F(Led, Blitzen) {
+  led.flashOn = 10;
+  led.flashOff = 60;
+  led.setMode(LEDMODE_FLASH);
+  EXPECT_GE(aufDutyWarten(255, 100), 0);
+  int an = aufDutyWarten(0, 100);
+  int aus = aufDutyWarten(255, 200);
+  EXPECT_GE(an, 5);
+  EXPECT_LT(an, 40);
+  EXPECT_GE(aus, 50);
+  EXPECT_LT(aus, 120);
+}
+
+TEST_F(Led, FadeLaeuftInDerHardware) {
+  led.fadeStep = 51;
+  led.fadeDelay = 10;  // Rampe 5 * 10 = 50 ms
+  led.setMode(LEDMODE_FADE);
+  delay(5);
+  LedcHostKanal k = kanalZustand();
+  EXPECT_EQ(k.rampen, 1u);
+  EXPECT_EQ(k.rampenZiel, 255u);
+  EXPECT_GT(k.rampenEndeUs - k.rampenStartUs, 45000);
+
+  // auf und ab, die Richtung wechselt am Ende jeder Rampe
+  uint32_t kleinster = 255, groesster = 0;
+  for (int ms = 0; ms < 160; ms++) {
+    uint32_t d = duty();
+    kleinster = std::min(kleinster, d);
+    groesster = std::max(groesster, d);
+    delay(1);
+  }
+  k = kanalZustand();
+  EXPECT_GE(k.rampen, 3u);
+  EXPECT_LE(k.rampen, 5u);
+  EXPECT_LT(kleinster, 30u);
+  EXPECT_GT(groesster, 225u);
+  EXPECT_EQ(k.dutyGesetzt, 1u);  // nur beim Start in begin(), die Rampen setzen keinen Tastgrad
+}
+
+TEST_F(Led, WechselWaehrendDerRampeBlockiertNicht) {
+  led.fadeStep = 5;
+  led.fadeDelay = 10;  // Rampe 51 * 10 = 510 ms
+  led.setMode(LEDMODE_FADE);
+  delay(50);
+  ASSERT_GT(kanalZustand().rampenEndeUs, esp_timer_get_time());
+
+  int64_t start = esp_timer_get_time();
+  led.setMode(LEDMODE_ON);
+  int64_t setModeUs = esp_timer_get_time() - start;
+  EXPECT_LT(setModeUs, 20000);  // setMode() wartet nie auf die Rampe
+  int wartezeit = aufDutyWarten(255, 1000);
+  ASSERT_GE(wartezeit, 0);
+  LedcHostKanal k = kanalZustand();
+  EXPECT_EQ(k.blockiert, 0u);  // auch der esp_timer Task wartet nicht in ledc_set_duty_and_update()
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  // Die Rampe wird abgebrochen, EIN gilt sofort
+  EXPECT_EQ(k.rampenGestoppt, 1u);
+  EXPECT_LT(wartezeit, 50);
+#else
+  // Ohne ledc_fade_stop() kommt der Schritt zum Rampenende wieder
+  EXPECT_EQ(k.rampenGestoppt, 0u);
+  EXPECT_GT(wartezeit, 300);
+#endif
+}
+
+TEST_F(Led, AndereLedsLaufenWaehrendDerRampeWeiter) {
+  // Alle LEDs teilen sich den esp_timer Task: eine Rampe darf die anderen nicht aufhalten
+  led.fadeStep = 5;
+  led.fadeDelay = 10;
+  led.setMode(LEDMODE_FADE);
+  delay(20);
+  led.setMode(LEDMODE_OFF);
+
+  LedController andere;
+  ledc_channel_t andererKanal = (ledc_channel_t)((kanal + 1) % LEDC_CHANNEL_MAX);
+  andere.begin(LED2_PIN, andererKanal, LEDC_TIMER_0);
+  andere.blinkInterval = 20;
+  andere.setMode(LEDMODE_BLINK);
+  delay(100);
+  {
+    std::lock_guard<std::mutex> sperre(ledcHostSperre);
+    EXPECT_GE(ledcHostKanal(andererKanal).dutyGesetzt, 4u);
+  }
+  andere.setMode(LEDMODE_OFF);
+  delay(25);
+  esp_timer_stop(andere.zeitgeber);
+}
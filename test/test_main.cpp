@@ -0,0 +1,13 @@
+// Gemeinsames main() der Host-Tests. Die Tasks des Sketches laufen als Threads ohne Ende,
+// deshalb wird der Prozess nach den Tests direkt beendet statt die globalen Objekte abzubauen.
+#include <cstdio>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  int ergebnis = RUN_ALL_TESTS();
+  fflush(stdout);
+  fflush(stderr);
+  _exit(ergebnis);
+}
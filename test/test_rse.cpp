@@ -0,0 +1,226 @@
+// RSE Ringpuffer (rseFlankeAblegen) und Entprellung im aktorTask
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+#include "test_server.h"
+#include "test_uhr.h"
+
+// Ringpuffer leeren, ohne dass ein aktorTask läuft
+static void rseRingLeeren() {
+  rseSchwanz.store(rseKopf.load());
+  rseUeberlauf = 0;
+  rseFlankenRoh = 0;
+}
+
+TEST(RseRing, UeberlaufZaehltVerloreneFlanken) {
+  rseRingLeeren();
+  for (uint32_t k = 0; k < RSE_PUFFER_GROESSE + 6; k++) {
+    rseFlankeAblegen(k % 2 == 0);
+  }
+  EXPECT_EQ(rseKopf.load() - rseSchwanz.load(), RSE_PUFFER_GROESSE);
+  EXPECT_EQ(rseUeberlauf, 6u);
+  EXPECT_EQ(rseFlankenRoh, RSE_PUFFER_GROESSE + 6);
+
+  // Nach dem Leeren passt wieder etwas hinein
+  rseRingLeeren();
+  rseFlankeAblegen(true);
+  EXPECT_EQ(rseKopf.load() - rseSchwanz.load(), 1u);
+  EXPECT_EQ(rseUeberlauf, 0u);
+  rseRingLeeren();
+}
+
+TEST(RseRing, ZaehlerLaufenUeber) {
+  rseKopf.store(UINT32_MAX - 2);
+  rseSchwanz.store(UINT32_MAX - 2);
+  rseRingLeeren();
+  for (int k = 0; k < 5; k++) {
+    rseFlankeAblegen(k % 2 == 0);
+  }
+  EXPECT_EQ(rseKopf.load(), 2u);
+  EXPECT_EQ(rseKopf.load() - rseSchwanz.load(), 5u);
+  EXPECT_EQ(rseUeberlauf, 0u);
+
+  // In der Reihenfolge des Ablegens lesbar, auch über den Überlauf hinweg
+  int64_t vorher = 0;
+  int k = 0;
+  for (uint32_t nr = rseSchwanz.load(); nr != rseKopf.load(); nr++, k++) {
+    const RseEreignis& e = rsePuffer[nr & (RSE_PUFFER_GROESSE - 1)];
+    EXPECT_EQ(e.aktiv, k % 2 == 0);
+    EXPECT_GE(e.zeitUs, vorher);
+    vorher = e.zeitUs;
+  }
+  EXPECT_EQ(k, 5);
+  rseRingLeeren();
+}
+
+// Ab hier läuft der aktorTask, ohne WLAN schaltet er keine Shelly, legt aber jede
+// entprellte Flanke in die journalQueue
+class RseEntprellung : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    hostWlanSetzen(false);
+    rseRingLeeren();
+    pinMode(RSE, INPUT_PULLUP);
+    attachInterrupt(RSE, isrRSE, CHANGE);
+    journalQueue = xQueueCreate(16, sizeof(JournalEintrag));
+    xTaskCreate(aktorTask, "aktor", AKTOR_TASK_STACK, NULL, AKTOR_TASK_PRIO, &aktorTaskHandle);
+    // Beim Start schreibt der aktorTask einmal den aktuellen Zustand (inaktiv)
+    JournalEintrag eintrag;
+    ASSERT_EQ(xQueueReceive(journalQueue, &eintrag, pdMS_TO_TICKS(1000)), pdTRUE);
+    ASSERT_EQ(eintrag.aktiv, 0);
+  }
+
+  // nächste entprellte Flanke aus der journalQueue, false wenn keine kommt
+  static bool flankeHolen(JournalEintrag& eintrag, uint32_t wartenMs) {
+    return xQueueReceive(journalQueue, &eintrag, pdMS_TO_TICKS(wartenMs)) == pdTRUE;
+  }
+
+  // bei angehaltener Uhr: RSE Pegel setzen, Entprellzeit vorstellen und die Flanke holen
+  static bool flankeHolenAngehalten(int pegel, JournalEintrag& eintrag) {
+    hostPinSetzen(RSE, pegel);
+    hostUhrVorstellen(RSE_ENTPRELL_MS + 1);  // der aktorTask rundet seine Wartezeit um einen Tick auf
+    return warteBis([] { return uxQueueMessagesWaiting(journalQueue) > 0; }, 3000) && flankeHolen(eintrag, 0);
+  }
+};
+
+TEST_F(RseEntprellung, StoerimpulsWirdVerworfen) {
+  uint32_t stoerimpulse = rseStoerimpulse;
+  // Beide Flanken liegen schon im Puffer, wenn der Task aufwacht: 0 µs Abstand
+  rseFlankeAblegen(true);
+  rseFlankeAblegen(false);
+  xTaskNotifyGive(aktorTaskHandle);
+
+  JournalEintrag eintrag;
+  EXPECT_FALSE(flankeHolen(eintrag, 3 * RSE_ENTPRELL_MS));
+  EXPECT_EQ(rseStoerimpulse, stoerimpulse + 1);
+  EXPECT_FALSE(RSEAktiv);
+}
+
+TEST_F(RseEntprellung, KurzerImpulsUeberDieIsr) {
+  uint32_t stoerimpulse = rseStoerimpulse;
+  hostPinSetzen(RSE, LOW);
+  delay(RSE_ENTPRELL_MS / 4);
+  hostPinSetzen(RSE, HIGH);
+
+  JournalEintrag eintrag;
+  EXPECT_FALSE(flankeHolen(eintrag, 3 * RSE_ENTPRELL_MS));
+  EXPECT_EQ(rseStoerimpulse, stoerimpulse + 1);
+  EXPECT_FALSE(RSEAktiv);
+}
+
+TEST_F(RseEntprellung, StabilerPegelSchaltet) {
+  int64_t startUs = esp_timer_get_time();
+  hostPinSetzen(RSE, LOW);
+
+  JournalEintrag eintrag;
+  ASSERT_TRUE(flankeHolen(eintrag, 1000));
+  int64_t dauerUs = esp_timer_get_time() - startUs;
+  EXPECT_TRUE(RSEAktiv);
+  EXPECT_EQ(eintrag.aktiv, 1);
+  EXPECT_EQ(eintrag.httpCode, -1);  // ohne WLAN nicht gesendet
+  EXPECT_GE(dauerUs, RSE_ENTPRELL_US);
+
+  hostPinSetzen(RSE, HIGH);
+  ASSERT_TRUE(flankeHolen(eintrag, 1000));
+  EXPECT_FALSE(RSEAktiv);
+  EXPECT_EQ(eintrag.aktiv, 0);
+}
+
+TEST_F(RseEntprellung, PrellenVorDemNeuenPegel) {
+  // Kontakt prellt beim Schließen, danach bleibt er zu: genau eine Flanke
+  uint32_t stoerimpulse = rseStoerimpulse;
+  for (int k = 0; k < 3; k++) {
+    hostPinSetzen(RSE, LOW);
+    delay(1);
+    hostPinSetzen(RSE, HIGH);
+    delay(1);
+  }
+  hostPinSetzen(RSE, LOW);
+
+  JournalEintrag eintrag;
+  ASSERT_TRUE(flankeHolen(eintrag, 1000));
+  EXPECT_EQ(eintrag.aktiv, 1);
+  EXPECT_FALSE(flankeHolen(eintrag, 3 * RSE_ENTPRELL_MS));
+  EXPECT_EQ(rseStoerimpulse, stoerimpulse + 3);
+  EXPECT_TRUE(RSEAktiv);
+
+  hostPinSetzen(RSE, HIGH);
+  ASSERT_TRUE(flankeHolen(eintrag, 1000));
+  EXPECT_EQ(eintrag.aktiv, 0);
+}
+
+// Bei angehaltener Uhr: Entprellung, Wiederholungen und Frist laufen nur mit hostUhrVorstellen()
+TEST_F(RseEntprellung, ShellyBefehlBleibtOffenBisHttp200) {
+  // Die Shelly antwortet auf das erste EIN mit HTTP 500, danach nach Schalter fehler
+  std::atomic<int>  einFehler{1};
+  std::atomic<bool> fehler{false};
+  TestServer server([&](const std::string& anfrage) {
+    bool ein = anfrage.find("Power%20On") != std::string::npos;
+    if (fehler || (ein && einFehler-- > 0)) {
+      TestAntwort a;
+      a.text = "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n";
+      return a;
+    }
+    return TestAntwort::json(ein ? "{\"POWER\":\"ON\"}" : "{\"POWER\":\"OFF\"}");
+  });
+  std::string urlEin = server.url("/cm?cmnd=Power%20On");
+  std::string urlAus = server.url("/cm?cmnd=Power%20Off");
+  WallboxKonfig konfig = {"WB1", urlEin.c_str(), urlAus.c_str(), ""};
+  Wallbox& wallbox = wallboxen[0];
+  wallbox.konfig = &konfig;
+  if (shellyFertig == NULL) {
+    shellyFertig = xEventGroupCreate();
+  }
+  struct Aufraeumen {  // auch wenn ein ASSERT den Test beendet
+    ~Aufraeumen() {
+      hostWlanSetzen(false);
+      hostUhrAnhalten(false);
+      wallboxen[0].konfig = &WALLBOX_KONFIG[0];
+    }
+  } aufraeumen;
+  hostUhrAnhalten(true);
+  hostWlanSetzen(true);
+  char text[STATUS_WERT_LAENGE];
+
+  // HTTP 500: der Befehl bleibt offen und wird nach SHELLY_NACHHOLEN_MS wiederholt
+  JournalEintrag eintrag;
+  ASSERT_TRUE(flankeHolenAngehalten(LOW, eintrag));
+  EXPECT_EQ(eintrag.aktiv, 1);
+  EXPECT_EQ(eintrag.httpCode, 500);
+  EXPECT_TRUE(wallbox.shellyOffen);
+  EXPECT_NE(shellyNachholenUs, 0);
+  uint32_t nachgeholt = wallbox.shellyNachgeholt;
+  uint32_t fehlgeschlagen = wallbox.shellyFehlgeschlagen;
+  statusWertFormatieren(FELD_SHELLY, text, webWerte);
+  EXPECT_EQ(strncmp(text, "offen seit 0s", 13), 0) << text;
+
+  hostUhrVorstellen(SHELLY_NACHHOLEN_MS - 1);
+  EXPECT_FALSE(warteBis([&] { return !wallbox.shellyOffen; }, 100));  // noch nicht fällig
+  hostUhrVorstellen(2);  // der aktorTask rundet seine Wartezeit um einen Tick auf
+  ASSERT_TRUE(warteBis([&] { return !wallbox.shellyOffen; }, 3000));
+  EXPECT_EQ(wallbox.shellyHttpCode, HTTP_CODE_OK);
+  EXPECT_EQ(wallbox.shellyNachgeholt, nachgeholt + 1);
+  EXPECT_EQ(wallbox.shellyFehlgeschlagen, fehlgeschlagen);
+  EXPECT_TRUE(warteBis([&] { return shellyNachholenUs == 0; }, 1000));
+  EXPECT_EQ(aktorHttpCode, HTTP_CODE_OK);
+
+  // Antwortet die Shelly bis zur Frist nicht mit 200, zählt der Befehl einmal als fehlgeschlagen
+  // und wird weiter wiederholt
+  fehler = true;
+  ASSERT_TRUE(flankeHolenAngehalten(HIGH, eintrag));
+  EXPECT_EQ(eintrag.httpCode, 500);
+  EXPECT_TRUE(wallbox.shellyOffen);
+  hostUhrVorstellen(SHELLY_FRIST_MS);
+  ASSERT_TRUE(warteBis([&] { return wallbox.shellyFehlgeschlagen == fehlgeschlagen + 1; }, 3000));
+  EXPECT_TRUE(wallbox.shellyOffen);
+  statusWertFormatieren(FELD_SHELLY, text, webWerte);
+  EXPECT_EQ(strncmp(text, "offen seit 60s", 14), 0) << text;
+  EXPECT_NE(strstr(text, (", " + std::to_string(fehlgeschlagen + 1) + " fehlgeschlagen").c_str()), nullptr) << text;
+
+  fehler = false;
+  hostUhrVorstellen(2 * SHELLY_NACHHOLEN_MS + 1);
+  ASSERT_TRUE(warteBis([&] { return !wallbox.shellyOffen; }, 3000));
+  EXPECT_EQ(wallbox.shellyFehlgeschlagen, fehlgeschlagen + 1);  // nur einmal gezählt
+  EXPECT_TRUE(warteBis([&] { return shellyNachholenUs == 0; }, 1000));
+  statusWertFormatieren(FELD_SHELLY, text, webWerte);
+  EXPECT_EQ(strncmp(text, "bestätigt", strlen("bestätigt")), 0) << text;
+}
@@ -0,0 +1,129 @@
+// Stand-in für SmartWB und Shelly: HTTP Server auf 127.0.0.1 mit freiem Port. Je Anfrage
+// liefert antwort() die rohe Antwort (Statuszeile, Kopf und Körper). Die Verbindung bleibt
+// offen, solange die Antwort nicht "Connection: close" enthält.
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TestAntwort {
+  std::string text;                          // wird vollständig gesendet ...
+  size_t      stillAb = std::string::npos;   // ... außer ab hier: danach schweigt der Server
+  int         verzoegerungMs = 0;            // vor dem ersten Byte
+
+  static TestAntwort json(const std::string& koerper, bool chunked = false) {
+    TestAntwort a;
+    a.text = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n";
+    if (chunked) {
+      // in Stücken zu 64 Bytes, wie ein Webserver ohne bekannte Länge
+      a.text += "Transfer-Encoding: chunked\r\n\r\n";
+      for (size_t pos = 0; pos < koerper.size(); pos += 64) {
+        std::string stueck = koerper.substr(pos, 64);
+        char laenge[16];
+        snprintf(laenge, sizeof(laenge), "%zx\r\n", stueck.size());
+        a.text += laenge + stueck + "\r\n";
+      }
+      a.text += "0\r\n\r\n";
+    } else {
+      a.text += "Content-Length: " + std::to_string(koerper.size()) + "\r\n\r\n" + koerper;
+    }
+    return a;
+  }
+
+  // nimmt die Anfrage an und antwortet nie
+  static TestAntwort stumm() {
+    TestAntwort a;
+    a.stillAb = 0;
+    return a;
+  }
+};
+
+class TestServer {
+public:
+  explicit TestServer(std::function<TestAntwort(const std::string& anfrage)> antwort) : antwort(antwort) {
+    lauscher = ::socket(AF_INET, SOCK_STREAM, 0);
+    int eins = 1;
+    setsockopt(lauscher, SOL_SOCKET, SO_REUSEADDR, &eins, sizeof(eins));
+    sockaddr_in adresse = {};
+    adresse.sin_family = AF_INET;
+    adresse.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(lauscher, (sockaddr*)&adresse, sizeof(adresse));
+    socklen_t laenge = sizeof(adresse);
+    getsockname(lauscher, (sockaddr*)&adresse, &laenge);
+    port = ntohs(adresse.sin_port);
+    ::listen(lauscher, 8);
+    annehmen = std::thread([this] { schleife(); });
+  }
+
+  ~TestServer() {
+    ende = true;
+    annehmen.join();
+    std::lock_guard<std::mutex> sperre(threadSperre);
+    for (std::thread& t : verbindungen) t.join();
+    ::close(lauscher);
+  }
+
+  std::string url(const char* pfad) const {
+    return "http://127.0.0.1:" + std::to_string(port) + pfad;
+  }
+
+  uint16_t port = 0;
+  std::atomic<int> anfragen{0};
+  std::atomic<int> angenommen{0};
+
+private:
+  void schleife() {
+    while (!ende) {
+      pollfd p = {lauscher, POLLIN, 0};
+      if (::poll(&p, 1, 20) <= 0) continue;
+      int fd = ::accept(lauscher, NULL, NULL);
+      if (fd < 0) continue;
+      angenommen++;
+      std::lock_guard<std::mutex> sperre(threadSperre);
+      verbindungen.emplace_back([this, fd] { bedienen(fd); });
+    }
+  }
+
+  void bedienen(int fd) {
+    std::string eingang;
+    char puffer[1024];
+    while (!ende) {
+      pollfd p = {fd, POLLIN, 0};
+      if (::poll(&p, 1, 20) <= 0) continue;
+      ssize_t n = ::recv(fd, puffer, sizeof(puffer), 0);
+      if (n <= 0) break;
+      eingang.append(puffer, n);
+      size_t kopfEnde = eingang.find("\r\n\r\n");
+      if (kopfEnde == std::string::npos) continue;
+      std::string anfrage = eingang.substr(0, kopfEnde + 4);
+      eingang.erase(0, kopfEnde + 4);
+      anfragen++;
+
+      TestAntwort a = antwort(anfrage);
+      if (a.verzoegerungMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(a.verzoegerungMs));
+      size_t laenge = std::min(a.text.size(), a.stillAb);
+      ::send(fd, a.text.data(), laenge, MSG_NOSIGNAL);
+      if (a.stillAb != std::string::npos) {
+        while (!ende) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        break;
+      }
+      if (a.text.find("Connection: close") != std::string::npos) break;
+    }
+    ::close(fd);
+  }
+
+  std::function<TestAntwort(const std::string&)> antwort;
+  int lauscher = -1;
+  std::atomic<bool> ende{false};
+  std::thread annehmen;
+  std::mutex threadSperre;
+  std::vector<std::thread> verbindungen;
+};
@@ -0,0 +1,37 @@
+// Testhilfen für die angehaltene Uhr des Hosts (hostUhrAnhalten() in host/include/Arduino.h)
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+// Führt ablauf bei angehaltener Uhr in einem eigenen Thread aus. Wartet dort oder in einem Task
+// jemand länger als ruheMs (Wanduhr) auf eine Frist, springt die Uhr zu ihr: Zeitlimits laufen
+// ab, ohne dass der Test sie absitzt. Nur für Abläufe, deren Gegenstelle schweigt, eine Antwort,
+// die später als ruheMs kommt, würde übersprungen.
+inline void imZeitraffer(std::function<void()> ablauf, uint32_t ruheMs = 20) {
+  std::atomic<bool> fertig{false};
+  hostUhrAnhalten(true);
+  std::thread faden([&] {
+    ablauf();
+    fertig = true;
+  });
+  while (!fertig) {
+    hostUhrZurNaechstenFrist(ruheMs);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  faden.join();
+  hostUhrAnhalten(false);
+}
+
+// Wartet höchstens wanduhrMs, bis bedingung gilt. Nach der Wanduhr, delay() stünde bei
+// angehaltener Uhr still.
+template <typename Bedingung>
+bool warteBis(Bedingung bedingung, uint32_t wanduhrMs) {
+  auto ende = std::chrono::steady_clock::now() + std::chrono::milliseconds(wanduhrMs);
+  while (!bedingung()) {
+    if (std::chrono::steady_clock::now() >= ende) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
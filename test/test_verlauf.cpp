@@ -0,0 +1,240 @@
+// Verlauf: varint/ZigZag Kodierung, Blockring und /api/history
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+static const uint32_t T0 = 1735689600;  // 01.01.2025 00:00:00 UTC
+
+class VerlaufRing : public ::testing::Test {
+protected:
+  void SetUp() override {
+    verlaufReservieren();
+    ASSERT_EQ(verlaufBloecke, VERLAUF_BLOECKE);
+    for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+      verlaeufe[wb] = Verlauf();
+    }
+  }
+
+  static void werteSetzen(int16_t* werte, int16_t basis) {
+    for (uint8_t k = 0; k < VERLAUF_WERTE; k++) {
+      werte[k] = basis + k;
+    }
+  }
+
+  // /api/history abrufen und in Zeilen zerlegen (ohne Kopfzeile)
+  static std::vector<std::string> historyCsv(const char* url) {
+    AsyncWebServerRequest request(url);
+    handleHistory(&request);
+    EXPECT_EQ(request.antwort()->code, 200);
+    std::istringstream text(request.antwort()->alles().c_str());
+    std::vector<std::string> zeilen;
+    std::string zeile;
+    std::getline(text, zeile);
+    EXPECT_EQ(zeile.rfind("time,actualPower_kW", 0), 0u);
+    while (std::getline(text, zeile)) {
+      zeilen.push_back(zeile);
+    }
+    return zeilen;
+  }
+};
+
+TEST(Varint, Laengen) {
+  uint8_t puffer[8];
+  EXPECT_EQ(varintSchreiben(puffer, 0), 1u);
+  EXPECT_EQ(varintSchreiben(puffer, 127), 1u);
+  EXPECT_EQ(varintSchreiben(puffer, 128), 2u);
+  EXPECT_EQ(puffer[0], 0x80);
+  EXPECT_EQ(puffer[1], 0x01);
+  EXPECT_EQ(varintSchreiben(puffer, 16383), 2u);
+  EXPECT_EQ(varintSchreiben(puffer, 16384), 3u);
+  EXPECT_EQ(varintSchreiben(puffer, UINT32_MAX), 5u);
+}
+
+TEST(Varint, HinUndZurueck) {
+  const uint32_t werte[] = {0, 1, 10, 127, 128, 300, 16383, 16384, 65535, 1u << 21, 1u << 28, UINT32_MAX - 1, UINT32_MAX};
+  for (uint32_t wert : werte) {
+    uint8_t puffer[8];
+    uint32_t gelesen = 0;
+    size_t n = varintSchreiben(puffer, wert);
+    EXPECT_EQ(varintLesen(puffer, gelesen), n) << wert;
+    EXPECT_EQ(gelesen, wert);
+  }
+}
+
+TEST_F(VerlaufRing, EintragKodiertNurAenderungen) {
+  int16_t werte[VERLAUF_WERTE];
+  werteSetzen(werte, 100);
+  verlaufAnhaengen(0, T0, werte);
+  werte[1] -= 1;   // ZigZag 1
+  werte[6] += 1;   // ZigZag 2
+  werte[7] -= 64;  // ZigZag 127, noch ein Byte
+  verlaufAnhaengen(0, T0 + 10, werte);
+
+  VerlaufKopf* block = verlaufBlock(0, 0);
+  EXPECT_EQ(block->anzahl, 2);
+  const uint8_t* eintrag = (const uint8_t*)block + sizeof(VerlaufKopf);
+  const uint8_t erwartet[] = {10, (1 << 1) | (1 << 6) | (1 << 7), 1, 2, 127};
+  ASSERT_EQ(block->laenge, sizeof(VerlaufKopf) + sizeof(erwartet));
+  EXPECT_EQ(memcmp(eintrag, erwartet, sizeof(erwartet)), 0);
+}
+
+TEST_F(VerlaufRing, ZigZagGrenzwerte) {
+  // größte Sprünge zwischen zwei int16 Werten in beide Richtungen
+  int16_t werte[VERLAUF_WERTE] = {};
+  werte[0] = INT16_MIN;
+  werte[2] = INT16_MAX;
+  verlaufAnhaengen(0, T0, werte);
+  werte[0] = INT16_MAX;
+  werte[2] = INT16_MIN;
+  verlaufAnhaengen(0, T0 + 10, werte);
+  werte[0] = -1;
+  werte[2] = 0;
+  verlaufAnhaengen(0, T0 + 20, werte);
+
+  std::vector<std::string> zeilen = historyCsv("/api/history");
+  ASSERT_EQ(zeilen.size(), 3u);
+  EXPECT_EQ(zeilen[0], std::to_string(T0) + ",-327.68,0,3276.7,0.0,0.0,0.0,0.0,0.0");
+  EXPECT_EQ(zeilen[1], std::to_string(T0 + 10) + ",327.67,0,-3276.8,0.0,0.0,0.0,0.0,0.0");
+  EXPECT_EQ(zeilen[2], std::to_string(T0 + 20) + ",-0.01,0,0.0,0.0,0.0,0.0,0.0,0.0");
+}
+
+TEST_F(VerlaufRing, CsvUeberMehrereBloeckeUndZeitraum) {
+  // genug Einträge für mehrere Blöcke, jeder ändert alle Werte
+  int16_t werte[VERLAUF_WERTE];
+  const int anzahl = 300;
+  for (int n = 0; n < anzahl; n++) {
+    werteSetzen(werte, n * 3);
+    verlaufAnhaengen(0, T0 + n * VERLAUF_INTERVALL_S, werte);
+  }
+  EXPECT_GT(verlaeufe[0].belegt, 1u);
+  EXPECT_EQ(verlaeufe[0].entfernt, 0u);
+
+  std::vector<std::string> zeilen = historyCsv("/api/history?wb=0");
+  ASSERT_EQ(zeilen.size(), (size_t)anzahl);
+  for (int n = 0; n < anzahl; n += 37) {
+    char erwartet[96];
+    snprintf(erwartet, sizeof(erwartet), "%u,%.2f,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f",
+             T0 + n * VERLAUF_INTERVALL_S, n * 3 / 100.0, n * 3 + 1, (n * 3 + 2) / 10.0, (n * 3 + 3) / 10.0,
+             (n * 3 + 4) / 10.0, (n * 3 + 5) / 10.0, (n * 3 + 6) / 10.0, (n * 3 + 7) / 10.0);
+    EXPECT_EQ(zeilen[n], erwartet);
+  }
+
+  // Zeitraum: nur die Einträge 100..199
+  char url[96];
+  snprintf(url, sizeof(url), "/api/history?from=%u&to=%u", T0 + 100 * VERLAUF_INTERVALL_S, T0 + 199 * VERLAUF_INTERVALL_S);
+  zeilen = historyCsv(url);
+  ASSERT_EQ(zeilen.size(), 100u);
+  EXPECT_EQ(zeilen.front().substr(0, 10), std::to_string(T0 + 100 * VERLAUF_INTERVALL_S));
+  EXPECT_EQ(zeilen.back().substr(0, 10), std::to_string(T0 + 199 * VERLAUF_INTERVALL_S));
+}
+
+TEST_F(VerlaufRing, AeltesterBlockFaelltWeg) {
+  int16_t werte[VERLAUF_WERTE];
+  uint32_t zeit = T0;
+  while (verlaeufe[0].entfernt < 3) {
+    werteSetzen(werte, zeit % 1000);
+    verlaufAnhaengen(0, zeit, werte);
+    zeit += VERLAUF_INTERVALL_S;
+  }
+  EXPECT_EQ(verlaeufe[0].belegt, verlaufBloecke);
+
+  // Die Ausgabe beginnt beim ältesten noch vorhandenen Block und ist lückenlos
+  std::vector<std::string> zeilen = historyCsv("/api/history");
+  ASSERT_FALSE(zeilen.empty());
+  EXPECT_EQ(zeilen.front().substr(0, 10), std::to_string(verlaufBlock(0, 0)->startZeit));
+  EXPECT_EQ(zeilen.back().substr(0, 10), std::to_string(zeit - VERLAUF_INTERVALL_S));
+  EXPECT_EQ(zeilen.size(), (zeit - verlaufBlock(0, 0)->startZeit) / VERLAUF_INTERVALL_S);
+}
+
+TEST_F(VerlaufRing, BinaerGibtBloeckeUnveraendert) {
+  int16_t werte[VERLAUF_WERTE];
+  werteSetzen(werte, 5);
+  verlaufAnhaengen(0, T0, werte);
+  werteSetzen(werte, 7);
+  verlaufAnhaengen(0, T0 + 10, werte);
+
+  AsyncWebServerRequest request("/api/history?format=bin");
+  handleHistory(&request);
+  String daten = request.antwort()->alles();
+  VerlaufKopf* block = verlaufBlock(0, 0);
+  ASSERT_EQ(daten.length(), block->laenge);
+  EXPECT_EQ(memcmp(daten.c_str(), block, block->laenge), 0);
+}
+
+TEST_F(VerlaufRing, UnbekannteWallbox) {
+  AsyncWebServerRequest request("/api/history?wb=99");
+  handleHistory(&request);
+  EXPECT_EQ(request.antwort()->code, 404);
+}
+
+TEST_F(VerlaufRing, HaeltEinenGanzenLadetag) {
+  // 24h ununterbrochenes Laden: jedes Raster ändern sich alle Werte außer dem Ladestrom ein wenig
+  int16_t werte[VERLAUF_WERTE] = {1100, 16, 158, 157, 159, 2296, 2312, 2304};
+  uint32_t zufall = 1;
+  const uint32_t eintraege = 24 * 3600 / VERLAUF_INTERVALL_S;
+  for (uint32_t n = 0; n < eintraege; n++) {
+    for (uint8_t k = 0; k < VERLAUF_WERTE; k++) {
+      if (k == 1) continue;
+      zufall = zufall * 1103515245 + 12345;
+      int spanne = (k == 0) ? 30 : (k < 5 ? 3 : 8);
+      int schritt = (int)((zufall >> 16) % spanne) + 1;
+      werte[k] += (zufall & 0x8000) ? schritt : -schritt;
+    }
+    verlaufAnhaengen(0, T0 + n * VERLAUF_INTERVALL_S, werte);
+  }
+  EXPECT_EQ(verlaeufe[0].entfernt, 0u);  // nichts verloren
+  EXPECT_EQ(verlaufBlock(0, 0)->startZeit, T0);
+
+  AsyncWebServerRequest request("/api/history?format=info");
+  handleHistory(&request);
+  ASSERT_EQ(request.antwort()->code, 200);
+  StaticJsonDocument<384> info;
+  ASSERT_EQ(deserializeJson(info, request.antwort()->alles()), DeserializationError::Ok);
+  EXPECT_EQ(info["bloecke"].as<uint32_t>(), VERLAUF_BLOECKE);
+  EXPECT_EQ(info["von"].as<uint32_t>(), T0);
+  EXPECT_EQ(info["abgedecktS"].as<uint32_t>(), 24u * 3600);
+  EXPECT_GE(info["reichtS"].as<uint32_t>(), 24u * 3600);
+  EXPECT_GE(info["reichtLadenS"].as<uint32_t>(), 24u * 3600);
+}
+
+TEST_F(VerlaufRing, InfoNachDemUmlaufGenau) {
+  int16_t werte[VERLAUF_WERTE];
+  uint32_t zeit = T0;
+  while (verlaeufe[0].entfernt < 2) {
+    werteSetzen(werte, zeit % 1000);
+    verlaufAnhaengen(0, zeit, werte);
+    zeit += VERLAUF_INTERVALL_S;
+  }
+  char info[256];
+  verlaufInfo(0, info, sizeof(info));
+  StaticJsonDocument<384> doc;
+  ASSERT_EQ(deserializeJson(doc, info), DeserializationError::Ok);
+  uint32_t von = verlaufBlock(0, 0)->startZeit;
+  EXPECT_EQ(doc["von"].as<uint32_t>(), von);
+  EXPECT_EQ(doc["bis"].as<uint32_t>(), zeit - VERLAUF_INTERVALL_S);
+  EXPECT_EQ(doc["reichtS"].as<uint32_t>(), zeit - von);
+  EXPECT_EQ(doc["belegt"].as<uint32_t>(), verlaufBloecke);
+}
+
+TEST(VerlaufSpeicher, LaesstDieReserveFrei) {
+  // wie ein Heap, in dem nur noch Platz für 20 Blöcke über der Reserve ist
+  for (size_t b = 0; b < verlaufBloecke; b++) {
+    for (int wb = 0; wb < WALLBOX_ANZAHL; wb++) {
+      free(verlaufSpeicher[wb][b]);
+      verlaufSpeicher[wb][b] = NULL;
+    }
+  }
+  verlaufBloecke = 0;
+  hostHeapGroesseSetzen(ESP.getHeapSize() - ESP.getFreeHeap() + VERLAUF_HEAP_RESERVE_KB * 1024 +
+                        20 * WALLBOX_ANZAHL * (VERLAUF_BLOCK_GROESSE + 16));
+  size_t bloecke = verlaufReservieren();
+  hostHeapGroesseSetzen(320 * 1024);
+  EXPECT_GE(bloecke, 20u);
+  EXPECT_LE(bloecke, 20u + 7);  // glibc hält bis zu 7 freigegebene Blöcke im tcache, die zählen noch als belegt
+  EXPECT_EQ(verlaufBloecke, bloecke);
+  EXPECT_LT(verlaufReichtLadenS(), 24u * 3600);  // unter /api/history?format=info zu sehen
+
+  // die fehlenden Blöcke kommen, sobald wieder Platz ist
+  EXPECT_EQ(verlaufReservieren(), VERLAUF_BLOECKE);
+}
@@ -0,0 +1,63 @@
+// Zeitstempel-Dienst: Format, Umschalten der Puffer und ms-Zeitstempel
+#include "SMART_WB_RSE_TIBBER_SOC_V1.cpp"
+#include <gtest/gtest.h>
+
+static const time_t T0 = 1735689600;  // 01.01.2025 00:00:00 UTC
+
+class Zeitstempel : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    setenv("TZ", "UTC0", 1);
+    tzset();
+  }
+};
+
+TEST_F(Zeitstempel, OhneGueltigeZeit) {
+  EXPECT_STREQ(zeitstempelFuerSekunde(0), "[Keine Zeit]");
+  EXPECT_STREQ(zeitstempelFuerSekunde(ZEIT_GUELTIG_AB - 1), "[Keine Zeit]");
+  EXPECT_STRNE(zeitstempelFuerSekunde(ZEIT_GUELTIG_AB), "[Keine Zeit]");
+}
+
+TEST_F(Zeitstempel, Format) {
+  EXPECT_STREQ(zeitstempelFuerSekunde(T0 + 12 * 3600 + 34 * 60 + 56), "[2025-01-01 12:34:56]");
+  EXPECT_STREQ(zeitstempelFuerSekunde(T0 + 30 * 86400 + 86399), "[2025-01-31 23:59:59]");
+  EXPECT_STREQ(zeitstempelFuerSekunde(T0 + 59 * 86400), "[2025-03-01 00:00:00]");
+}
+
+TEST_F(Zeitstempel, VorigerPufferBleibtGueltig) {
+  // nach den Sekunden der anderen Tests, der Dienst formatiert nur vorwärts
+  const time_t t1 = T0 + 365 * 86400;  // 01.01.2026
+  const char* erster = zeitstempelFuerSekunde(t1 + 100);
+  const char* gleicher = zeitstempelFuerSekunde(t1 + 100);
+  EXPECT_EQ(erster, gleicher);  // nicht neu formatiert
+  const char* zweiter = zeitstempelFuerSekunde(t1 + 101);
+  EXPECT_NE(erster, zweiter);
+  EXPECT_STREQ(erster, "[2026-01-01 00:01:40]");
+  EXPECT_STREQ(zweiter, "[2026-01-01 00:01:41]");
+
+  // Eine ältere Sekunde überschreibt den aktuellen Puffer nicht
+  EXPECT_EQ(zeitstempelFuerSekunde(t1 + 99), zweiter);
+  EXPECT_STREQ(erster, "[2026-01-01 00:01:40]");
+  EXPECT_STREQ(zweiter, "[2026-01-01 00:01:41]");
+}
+
+TEST_F(Zeitstempel, Millisekunden) {
+  struct timeval jetzt;
+  gettimeofday(&jetzt, NULL);
+  const char* text = getZeitstempelMs();
+  ASSERT_EQ(strlen(text), 25u);  // "[2025-01-31 12:34:56.789]"
+  EXPECT_EQ(text[0], '[');
+  EXPECT_EQ(text[20], '.');
+  EXPECT_EQ(text[24], ']');
+  EXPECT_EQ(strncmp(text, zeitstempelFuerSekunde(jetzt.tv_sec), 11), 0);  // gleicher Tag
+
+  // Die Puffer werden reihum benutzt
+  const char* puffer[ZEITSTEMPEL_MS_PUFFER];
+  for (uint8_t k = 0; k < ZEITSTEMPEL_MS_PUFFER; k++) {
+    puffer[k] = getZeitstempelMs();
+    for (uint8_t j = 0; j < k; j++) {
+      EXPECT_NE(puffer[k], puffer[j]);
+    }
+  }
+  EXPECT_EQ(getZeitstempelMs(), puffer[0]);
+}
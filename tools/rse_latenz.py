@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Ende-zu-Ende Latenz der RSE Flanken gegen die Stand-ins aus standins.py.
+
+Startet die Stand-ins, hält eine /events Verbindung wie die Statusseite offen und
+startet über /api/simulation?start=N die RSE Simulation der Steuerung (Firmware
+mit USE_RSE_SIMULATION). Ausgegeben werden p50/p99/max der Zeit von der Flanke
+bis zur Shelly Antwort und bis zur /events Nachricht sowie die Zähler der
+Stand-ins. Exit Code 1, wenn die Simulation nicht durchläuft oder Messungen fehlen.
+
+Host-Build (cmake Ziel smartwb_sim, die URLs stehen in host/app/config.h):
+
+    python3 tools/rse_latenz.py --app build/smartwb_sim --zyklen 2000 --shelly latenz=20,abbruch=0.01
+
+Board im LAN, URLs in config.h auf diesen Rechner und die Ports der Stand-ins:
+
+    python3 tools/rse_latenz.py --ziel 10.0.0.20 --bind 0.0.0.0 --zyklen 2000
+"""
+
+import argparse
+import asyncio
+import json
+import os
+import socket
+import sys
+import tempfile
+import time
+
+from standins import alle_starten, argumente_anhaengen
+
+
+async def abrufen(host, port, pfad, timeout=10):
+    """GET mit Connection: close, liefert (Status, Body) auch bei chunked."""
+    reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port), timeout)
+    try:
+        writer.write(f"GET {pfad} HTTP/1.1\r\nHost: {host}\r\nConnection: close\r\n\r\n".encode())
+        await writer.drain()
+        daten = await asyncio.wait_for(reader.read(-1), timeout)
+    finally:
+        writer.close()
+    kopf, _, body = daten.partition(b"\r\n\r\n")
+    zeilen = kopf.decode("latin-1").split("\r\n")
+    status = int(zeilen[0].split()[1])
+    if any(z.lower() == "transfer-encoding: chunked" for z in zeilen[1:]):
+        teile = []
+        while body:
+            laenge, _, body = body.partition(b"\r\n")
+            n = int(laenge, 16)
+            if n == 0:
+                break
+            teile.append(body[:n])
+            body = body[n + 2:]
+        body = b"".join(teile)
+    return status, body
+
+
+async def events_lesen(host, port, zaehler):
+    """Hält /events offen wie die Statusseite und zählt die Nachrichten (ohne keepalive)."""
+    reader, writer = await asyncio.open_connection(host, port)
+    try:
+        writer.write(f"GET /events HTTP/1.1\r\nHost: {host}\r\nAccept: text/event-stream\r\n\r\n".encode())
+        await writer.drain()
+        await reader.readuntil(b"\r\n\r\n")
+        benannt = False
+        async for zeile in reader:
+            zeile = zeile.strip()
+            if zeile.startswith(b"event:"):
+                benannt = True  # nur keepalive ist benannt, die Seite reagiert auf "message"
+            elif not zeile:
+                zaehler["nachrichten"] += not benannt
+                benannt = False
+    finally:
+        writer.close()
+
+
+def freier_port():
+    with socket.socket() as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+async def bereit_warten(host, port, prozess, timeout):
+    """Wartet, bis der Webserver der Steuerung antwortet."""
+    ende = time.monotonic() + timeout
+    while time.monotonic() < ende:
+        if prozess is not None and prozess.returncode is not None:
+            raise RuntimeError(f"Steuerung beendet mit Code {prozess.returncode}")
+        try:
+            status, _ = await abrufen(host, port, "/api/simulation", 2)
+            if status == 200:
+                return
+            raise RuntimeError(f"/api/simulation: HTTP {status}, Firmware ohne USE_RSE_SIMULATION?")
+        except (OSError, asyncio.TimeoutError):
+            await asyncio.sleep(0.2)
+    raise RuntimeError(f"Webserver auf {host}:{port} antwortet nicht")
+
+
+def ms(us):
+    return f"{us / 1000:8.1f}"
+
+
+def bericht(ergebnis, standins, events):
+    print(f"Simulation: {ergebnis['zyklen']} von {ergebnis['geplant']} Zyklen alle {ergebnis['periodeMs']} ms, "
+          f"{ergebnis['verpasst']} verpasst")
+    print(f"{'':<12} {'anzahl':>7} {'fehler':>7} {'p50 ms':>8} {'p99 ms':>8} {'max ms':>8}")
+    for name in ("shelly", "statusseite"):
+        m = ergebnis[name]
+        print(f"{name:<12} {m['anzahl']:7d} {m['fehler']:7d} {ms(m['p50Us'])} {ms(m['p99Us'])} {ms(m['maxUs'])}")
+    print(f"/events: {events['nachrichten']} Nachrichten")
+    for s in standins:
+        print(s.zusammenfassung())
+
+
+def pruefen(ergebnis, standins, min_anteil):
+    """Liefert die Liste der Probleme, leer wenn alles passt."""
+    probleme = []
+    if ergebnis["laeuft"] or ergebnis["zyklen"] != ergebnis["geplant"]:
+        probleme.append("Simulation nicht vollständig gelaufen")
+    erwartet = ergebnis["zyklen"] - ergebnis["verpasst"]
+    for name in ("shelly", "statusseite"):
+        if ergebnis[name]["anzahl"] < erwartet * min_anteil:
+            probleme.append(f"{name}: nur {ergebnis[name]['anzahl']} Messungen bei {erwartet} Flanken")
+    shelly = standins[0]
+    ein = sum(n for p, n in shelly.pfade.items() if "Power%20On" in p)
+    aus = sum(n for p, n in shelly.pfade.items() if "Power%20Off" in p)
+    if min(ein, aus) < ergebnis["zyklen"] // 2 * min_anteil:
+        probleme.append(f"Shelly: nur {ein} EIN und {aus} AUS bei {ergebnis['zyklen']} Flanken")
+    # Jede Flanke mit Fehler braucht eine gestörte Shelly Antwort
+    gestoert = sum(shelly.zaehler[k] for k in ("fehler", "abbruch", "haengen"))
+    if ergebnis["shelly"]["fehler"] > gestoert:
+        probleme.append(f"Shelly: {ergebnis['shelly']['fehler']} Fehler, aber nur {gestoert} Störungen")
+    return probleme
+
+
+async def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ziel = parser.add_mutually_exclusive_group(required=True)
+    ziel.add_argument("--app", help="Host-Build smartwb_sim starten")
+    ziel.add_argument("--ziel", help="IP oder Name eines Boards im LAN")
+    parser.add_argument("--port", type=int, default=80, help="Webserver des Boards")
+    parser.add_argument("--zyklen", type=int, default=2000, help="Anzahl RSE Flanken")
+    parser.add_argument("--min-anteil", type=float, default=0.9,
+                        help="so viele Flanken müssen eine Messung haben")
+    argumente_anhaengen(parser)
+    args = parser.parse_args()
+
+    standins = await alle_starten(args)
+    prozess = None
+    log = None
+    host, port = args.ziel, args.port
+    try:
+        if args.app:
+            host, port = "127.0.0.1", freier_port()
+            verzeichnis = tempfile.mkdtemp(prefix="smartwb_sim_")
+            log = open(os.path.join(verzeichnis, "serial.log"), "wb")
+            umgebung = dict(os.environ, SMARTWB_HTTP_PORT=str(port), SMARTWB_FS=verzeichnis)
+            prozess = await asyncio.create_subprocess_exec(args.app, env=umgebung, stdout=log, stderr=log)
+        await bereit_warten(host, port, prozess, 30)
+
+        events = {"nachrichten": 0}
+        events_task = asyncio.ensure_future(events_lesen(host, port, events))
+        status, body = await abrufen(host, port, f"/api/simulation?start={args.zyklen}")
+        if status != 200:
+            raise RuntimeError(f"/api/simulation?start: HTTP {status} {body.decode(errors='replace')}")
+        ergebnis = json.loads(body)
+        dauer = args.zyklen * ergebnis["periodeMs"] / 1000
+        ende = time.monotonic() + dauer * 1.5 + 30
+        while ergebnis["laeuft"] and time.monotonic() < ende:
+            await asyncio.sleep(min(1.0, dauer / 10 + 0.1))
+            _, body = await abrufen(host, port, "/api/simulation")
+            ergebnis = json.loads(body)
+        await asyncio.sleep(0.5)  # letzte Antworten der Stand-ins
+        events_task.cancel()
+
+        bericht(ergebnis, standins, events)
+        probleme = pruefen(ergebnis, standins, args.min_anteil)
+    except RuntimeError as fehler:
+        probleme = [str(fehler)]
+    finally:
+        if prozess is not None and prozess.returncode is None:
+            prozess.kill()
+            await prozess.wait()
+        if log is not None:
+            log.close()
+        for s in standins:
+            await s.beenden()
+    for p in probleme:
+        print("FEHLER:", p)
+    if probleme and log is not None:
+        print("Serielle Ausgabe der Steuerung:", log.name)
+    return 1 if probleme else 0
+
+
+if __name__ == "__main__":
+    sys.exit(asyncio.run(main()))
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""Stand-ins für die Gegenstellen der SmartWB Steuerung: Shelly (URL_ON/URL_OFF),
+SmartWB (URL_PARAM) und EV SoC Server (EV_SOC_URL).
+
+HTTP/1.1 mit keep-alive wie die echten Geräte. Je Stand-in lassen sich Störungen
+einstellen, als Liste name=wert (Anteile 0..1, Zeiten in ms):
+
+    latenz=20      feste Verzögerung vor der Antwort
+    streuung=30    zusätzlich zufällig 0..streuung
+    fehler=0.02    HTTP 500
+    gross=0.1      übergroßes JSON (lange Zusatzfelder, gültig)
+    kaputt=0.05    ungültiges JSON
+    abbruch=0.01   Verbindung nach der Anfrage ohne Antwort schließen
+    haengen=0.01   Anfrage annehmen und nie antworten, bis der Client aufgibt
+
+Für ein Board im LAN auf 0.0.0.0 lauschen und die URLs in config.h auf diesen
+Rechner richten (Ports siehe --help), dann tools/rse_latenz.py --ziel benutzen:
+
+    python3 tools/standins.py --bind 0.0.0.0 --shelly latenz=20,abbruch=0.01 --smartwb gross=0.2
+"""
+
+import argparse
+import asyncio
+import json
+import random
+
+SHELLY_PORT = 18081
+SMARTWB_PORT = 18082
+SOC_PORT = 18083
+
+STOERUNGEN = ("latenz", "streuung", "fehler", "gross", "kaputt", "abbruch", "haengen")
+
+# Aufgezeichnete Antwort einer SmartWB, wie in test/test_json.cpp
+SMARTWB_PARAMETER = {
+    "type": "parameters",
+    "list": [{
+        "vehicleState": 3, "evseState": True, "maxCurrent": 16, "actualCurrent": 16,
+        "actualPower": 10.87, "duration": 5421339, "alwaysActive": False,
+        "lastActionUser": "GUI", "lastActionUID": "GUI", "energy": 14.32, "mileage": 95.2,
+        "meterReading": 4711.42, "currentP1": 15.8, "currentP2": 15.7, "currentP3": 15.9,
+        "voltageP1": 229.6, "voltageP2": 231.2, "voltageP3": 230.4, "useMeter": True,
+        "RFIDUID": "", "lastUsedAt": "", "rseActive": False, "rseValue": 100,
+    }],
+}
+
+
+def stoerungen_lesen(text):
+    """"latenz=20,fehler=0.1" -> dict, unbekannte Namen sind ein Fehler."""
+    werte = dict.fromkeys(STOERUNGEN, 0.0)
+    for teil in filter(None, (text or "").split(",")):
+        name, _, wert = teil.partition("=")
+        if name not in werte:
+            raise argparse.ArgumentTypeError(f"unbekannte Störung {name!r}, erlaubt: {', '.join(STOERUNGEN)}")
+        werte[name] = float(wert)
+    return werte
+
+
+class StandIn:
+    """Ein HTTP Server mit Störungen. antwort(pfad) liefert (status, dict)."""
+
+    def __init__(self, name, port, antwort, stoerungen, zufall):
+        self.name = name
+        self.port = port
+        self.antwort = antwort
+        self.stoerungen = stoerungen
+        self.zufall = zufall
+        self.server = None
+        self.zaehler = dict.fromkeys(("verbindungen", "anfragen", "ok", "fehler", "gross", "kaputt",
+                                      "abbruch", "haengen"), 0)
+        self.pfade = {}
+
+    async def starten(self, bind):
+        self.server = await asyncio.start_server(self.bedienen, bind, self.port)
+
+    async def beenden(self):
+        if self.server:
+            self.server.close()
+            await self.server.wait_closed()
+
+    def wuerfeln(self, name):
+        return self.zufall.random() < self.stoerungen[name]
+
+    async def bedienen(self, reader, writer):
+        self.zaehler["verbindungen"] += 1
+        try:
+            while True:
+                kopf = await reader.readuntil(b"\r\n\r\n")
+                zeile = kopf.split(b"\r\n", 1)[0].decode("latin-1").split()
+                pfad = zeile[1] if len(zeile) > 1 else "/"
+                self.zaehler["anfragen"] += 1
+                self.pfade[pfad] = self.pfade.get(pfad, 0) + 1
+                if not await self.antworten(reader, writer, pfad):
+                    break
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            writer.close()
+
+    async def antworten(self, reader, writer, pfad):
+        """Eine Antwort samt Störungen senden, False: Verbindung schließen."""
+        s = self.stoerungen
+        verzoegerung = s["latenz"] + self.zufall.random() * s["streuung"]
+        if verzoegerung > 0:
+            await asyncio.sleep(verzoegerung / 1000)
+        if self.wuerfeln("abbruch"):
+            self.zaehler["abbruch"] += 1
+            return False
+        if self.wuerfeln("haengen"):
+            self.zaehler["haengen"] += 1
+            await reader.read()  # bis der Client die Verbindung abbricht
+            return False
+
+        status, inhalt = self.antwort(pfad)
+        if status == 200 and self.wuerfeln("fehler"):
+            self.zaehler["fehler"] += 1
+            status, koerper = 500, b"Internal Server Error"
+        elif status == 200 and self.wuerfeln("kaputt"):
+            self.zaehler["kaputt"] += 1
+            koerper = json.dumps(inhalt).replace(":", " ", 2).encode()  # ungültig, aber vollständig
+        elif status == 200 and self.wuerfeln("gross"):
+            self.zaehler["gross"] += 1
+            inhalt = dict(inhalt, notiz="x" * 8000, werte=[k * 7.5 for k in range(2000)])
+            koerper = json.dumps(inhalt).encode()
+        else:
+            koerper = json.dumps(inhalt).encode() if isinstance(inhalt, dict) else inhalt
+            if status == 200:
+                self.zaehler["ok"] += 1
+        grund = {200: "OK", 404: "Not Found", 500: "Internal Server Error"}.get(status, "")
+        writer.write(f"HTTP/1.1 {status} {grund}\r\nContent-Type: application/json\r\n"
+                     f"Content-Length: {len(koerper)}\r\n\r\n".encode() + koerper)
+        await writer.drain()
+        return True
+
+    def zusammenfassung(self):
+        z = self.zaehler
+        teile = [f"{z['anfragen']} Anfragen über {z['verbindungen']} Verbindungen"]
+        teile += [f"{z[k]} {k}" for k in ("fehler", "gross", "kaputt", "abbruch", "haengen") if z[k]]
+        return f"{self.name:<8} " + ", ".join(teile)
+
+
+def shelly_antwort(pfad):
+    if "Power%20On" in pfad:
+        return 200, {"POWER": "ON"}
+    if "Power%20Off" in pfad:
+        return 200, {"POWER": "OFF"}
+    return 404, b""
+
+
+def smartwb_antwort(pfad):
+    if pfad.startswith("/getParameters"):
+        return 200, SMARTWB_PARAMETER
+    return 404, b""
+
+
+def soc_antwort(pfad):
+    if pfad.startswith("/api/ev_soc"):
+        return 200, {"success": True, "soc": 64}
+    return 404, b""
+
+
+async def alle_starten(args):
+    """Startet Shelly, SmartWB und SoC Stand-in nach den Argumenten von argumente_anhaengen()."""
+    zufall = random.Random(args.seed)
+    standins = [
+        StandIn("shelly", args.shelly_port, shelly_antwort, args.shelly, zufall),
+        StandIn("smartwb", args.smartwb_port, smartwb_antwort, args.smartwb, zufall),
+        StandIn("soc", args.soc_port, soc_antwort, args.soc, zufall),
+    ]
+    for s in standins:
+        await s.starten(args.bind)
+    return standins
+
+
+def argumente_anhaengen(parser):
+    parser.add_argument("--bind", default="127.0.0.1", help="0.0.0.0 für ein Board im LAN")
+    parser.add_argument("--shelly", type=stoerungen_lesen, default=stoerungen_lesen(""), help="Störungen der Shelly")
+    parser.add_argument("--smartwb", type=stoerungen_lesen, default=stoerungen_lesen(""), help="Störungen der SmartWB")
+    parser.add_argument("--soc", type=stoerungen_lesen, default=stoerungen_lesen(""), help="Störungen des SoC Servers")
+    parser.add_argument("--shelly-port", type=int, default=SHELLY_PORT)
+    parser.add_argument("--smartwb-port", type=int, default=SMARTWB_PORT)
+    parser.add_argument("--soc-port", type=int, default=SOC_PORT)
+    parser.add_argument("--seed", type=int, default=1, help="Zufall reproduzierbar")
+
+
+async def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    argumente_anhaengen(parser)
+    parser.add_argument("--intervall", type=float, default=10, help="s zwischen den Zählerständen")
+    args = parser.parse_args()
+
+    standins = await alle_starten(args)
+    print(f"Shelly :{args.shelly_port}, SmartWB :{args.smartwb_port}, SoC :{args.soc_port} auf {args.bind}")
+    try:
+        while True:
+            await asyncio.sleep(args.intervall)
+            for s in standins:
+                print(s.zusammenfassung())
+    finally:
+        for s in standins:
+            await s.beenden()
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
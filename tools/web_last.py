@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Lasttest für den Webserver der SmartWB Steuerung im LAN.
+
+Hält N /events Verbindungen offen und ruft gleichzeitig mit M parallelen
+Verbindungen /, /metrics, /api/history und /api/rcr ab. Ausgegeben werden je
+Pfad Anzahl, Fehler sowie p50/p99/max der Zeit bis zum vollständigen Body,
+dazu die Zahl der empfangenen SSE Nachrichten.
+
+    python3 tools/web_last.py 10.0.0.20 --dauer 60 --parallel 8 --events 4
+"""
+
+import argparse
+import asyncio
+import time
+
+PFADE = ["/", "/metrics", "/api/history?format=csv", "/api/rcr"]
+
+
+def perzentil(werte, p):
+    if not werte:
+        return 0.0
+    werte = sorted(werte)
+    return werte[min(len(werte) - 1, int(len(werte) * p / 100))]
+
+
+async def abrufen(host, port, pfad, timeout):
+    """Eine GET Anfrage mit Connection: close, liefert (Status, Bytes)."""
+    reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port), timeout)
+    try:
+        writer.write(f"GET {pfad} HTTP/1.1\r\nHost: {host}\r\nConnection: close\r\n\r\n".encode())
+        await writer.drain()
+        daten = await asyncio.wait_for(reader.read(-1), timeout)
+    finally:
+        writer.close()
+    kopf, _, body = daten.partition(b"\r\n\r\n")
+    zeile = kopf.split(b"\r\n", 1)[0].split()
+    status = int(zeile[1]) if len(zeile) > 1 else 0
+    return status, len(body)
+
+
+async def arbeiter(host, port, ende, timeout, ergebnis, nr):
+    i = nr
+    while time.monotonic() < ende:
+        pfad = PFADE[i % len(PFADE)]
+        i += 1
+        eintrag = ergebnis.setdefault(pfad, {"zeiten": [], "fehler": 0, "bytes": 0})
+        start = time.monotonic()
+        try:
+            status, laenge = await abrufen(host, port, pfad, timeout)
+        except (OSError, asyncio.TimeoutError, ValueError, IndexError):
+            eintrag["fehler"] += 1
+            continue
+        if status != 200:
+            eintrag["fehler"] += 1
+            continue
+        eintrag["zeiten"].append(time.monotonic() - start)
+        eintrag["bytes"] += laenge
+
+
+async def zuhoerer(host, port, ende, zaehler):
+    """Hält eine /events Verbindung offen und zählt die data: Zeilen."""
+    try:
+        reader, writer = await asyncio.open_connection(host, port)
+    except OSError:
+        zaehler["fehler"] += 1
+        return
+    writer.write(f"GET /events HTTP/1.1\r\nHost: {host}\r\nAccept: text/event-stream\r\n\r\n".encode())
+    await writer.drain()
+    try:
+        while time.monotonic() < ende:
+            zeile = await asyncio.wait_for(reader.readline(), max(0.1, ende - time.monotonic()))
+            if not zeile:
+                zaehler["fehler"] += 1  # vom Server geschlossen
+                break
+            if zeile.startswith(b"data:") and zeile[5:].strip():  # Keepalives haben leere Daten
+                zaehler["nachrichten"] += 1
+    except asyncio.TimeoutError:
+        pass
+    finally:
+        writer.close()
+
+
+async def hauptprogramm(args):
+    ende = time.monotonic() + args.dauer
+    ergebnis = {}
+    sse = {"nachrichten": 0, "fehler": 0}
+    aufgaben = [zuhoerer(args.host, args.port, ende, sse) for _ in range(args.events)]
+    aufgaben += [arbeiter(args.host, args.port, ende, args.timeout, ergebnis, n) for n in range(args.parallel)]
+    await asyncio.gather(*aufgaben)
+
+    print(f"{'Pfad':28} {'Anzahl':>7} {'Fehler':>7} {'p50 ms':>8} {'p99 ms':>8} {'max ms':>8} {'KB/s':>8}")
+    for pfad, e in ergebnis.items():
+        z = e["zeiten"]
+        print(f"{pfad:28} {len(z):7d} {e['fehler']:7d} {perzentil(z, 50) * 1000:8.1f} "
+              f"{perzentil(z, 99) * 1000:8.1f} {max(z, default=0) * 1000:8.1f} "
+              f"{e['bytes'] / 1024 / args.dauer:8.1f}")
+    print(f"/events: {args.events} Verbindungen, {sse['nachrichten']} Nachrichten, {sse['fehler']} Fehler")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--dauer", type=float, default=30, help="Sekunden")
+    parser.add_argument("--parallel", type=int, default=4, help="gleichzeitige Abrufe")
+    parser.add_argument("--events", type=int, default=2, help="offene /events Verbindungen")
+    parser.add_argument("--timeout", type=float, default=10, help="Sekunden je Abruf")
+    asyncio.run(hauptprogramm(parser.parse_args()))
+
+
+if __name__ == "__main__":
+    main()